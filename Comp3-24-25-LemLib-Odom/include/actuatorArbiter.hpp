@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "pros/adi.hpp"
+#include "pros/motors.hpp"
+
+/**
+ * @brief Who a command comes from. When more than one has a command in, the highest wins
+ */
+enum class CommandSource { Driver = 0, Auton = 1, Sort = 2 };
+
+/**
+ * @brief A motor or piston that more than one task commands
+ *
+ * Tasks never write the device themselves. Each source gets a slot the actuator keeps its last
+ * command in, a single atomic word, so posting from any task never waits on a lock and a command
+ * can't be read half written. Once a tick ActuatorArbiter::resolve() picks the highest source with
+ * a command in and writes it to the device, only if it differs from what was written last.
+ *
+ * A command stays in until its source posts another or releases it. A motor nobody has a command
+ * in is sent 0, a piston is left where it is.
+ *
+ * @b Example
+ * @code {.cpp}
+ * Actuator hooks("hooks", intakeHigh);
+ * // opcontrol, every loop
+ * hooks.move(CommandSource::Driver, 127);
+ * // sorting task, on a wrong ring and when it's gone
+ * hooks.move(CommandSource::Sort, 127);
+ * hooks.release(CommandSource::Sort);
+ * @endcode
+ */
+class Actuator {
+    public:
+        static constexpr int SOURCES = 3;
+        /**
+         * @brief Longest name, not counting the \0
+         */
+        static constexpr int MAX_NAME = 15;
+
+        /**
+         * @brief Construct an Actuator for a motor
+         *
+         * @param name what the stats call it
+         */
+        Actuator(const char* name, pros::Motor& motor);
+        /**
+         * @brief Construct an Actuator for a piston
+         *
+         * @param name what the stats call it
+         */
+        Actuator(const char* name, pros::adi::DigitalOut& piston);
+
+        Actuator(const Actuator&) = delete;
+        Actuator& operator=(const Actuator&) = delete;
+
+        /**
+         * @brief Ask for a voltage, like pros::Motor::move()
+         *
+         * @param voltage -127 to 127
+         */
+        void move(CommandSource source, int voltage);
+
+        /**
+         * @brief Ask for a position, like pros::Motor::move_absolute()
+         *
+         * @param position motor degrees
+         * @param velocity most rpm on the way there
+         */
+        void moveAbsolute(CommandSource source, double position, int velocity);
+
+        /**
+         * @brief Ask for a position this far from where the motor is now. Turned into an absolute
+         * position when it's posted, so it only moves the motor once however long it stays in
+         *
+         * @param position motor degrees
+         * @param velocity most rpm on the way there
+         */
+        void moveRelative(CommandSource source, double position, int velocity);
+
+        /**
+         * @brief Ask for a piston to be extended or not, like pros::adi::DigitalOut::set_value()
+         */
+        void set(CommandSource source, bool extended);
+
+        /**
+         * @brief Take back a source's command, so the next one down gets the actuator
+         */
+        void release(CommandSource source);
+
+        /**
+         * @brief Write whichever command wins to the device if it isn't what was written last.
+         * Only ActuatorArbiter::resolve() should call it, from one task
+         */
+        void apply();
+
+        /**
+         * @brief The source whose command was written last, or -1 when nobody had one in
+         */
+        int getOwner() const;
+
+        /**
+         * @brief How the actuator has been commanded since it was made
+         */
+        struct Stats {
+                std::uint32_t requests; // commands and releases posted
+                std::uint32_t redundant; // posted the same as that source already had in
+                std::uint32_t writes; // reached the device
+        };
+
+        /**
+         * @brief Summarize, from any task
+         */
+        Stats getStats() const;
+
+        const char* getName() const;
+    private:
+        char name[MAX_NAME + 1];
+        pros::Motor* motor = nullptr;
+        pros::adi::DigitalOut* piston = nullptr;
+
+        // a command packed into one word, see actuatorArbiter.cpp
+        std::atomic<std::uint64_t> slots[SOURCES] = {};
+        std::uint64_t written; // only apply() touches it
+        std::atomic<int> owner = -1;
+
+        std::atomic<std::uint32_t> requests = 0;
+        std::atomic<std::uint32_t> redundant = 0;
+        std::atomic<std::uint32_t> writes = 0;
+
+        void post(CommandSource source, std::uint64_t command);
+};
+
+/**
+ * @brief Writes every actuator once a tick, from one task
+ *
+ * @b Example
+ * @code {.cpp}
+ * ActuatorArbiter actuators;
+ * void initialize() {
+ *     actuators.add(&hooks);
+ *     pros::Task([] {
+ *         std::uint32_t now = pros::millis();
+ *         while (true) {
+ *             actuators.resolve();
+ *             pros::Task::delay_until(&now, 10);
+ *         }
+ *     });
+ * }
+ * @endcode
+ */
+class ActuatorArbiter {
+    public:
+        static constexpr int MAX_ACTUATORS = 8;
+
+        /**
+         * @brief Add an actuator, before resolve() runs
+         *
+         * @return false if there are already MAX_ACTUATORS
+         */
+        bool add(Actuator* actuator);
+
+        /**
+         * @brief Apply every actuator's winning command. Call once per control tick
+         */
+        void resolve();
+
+        /**
+         * @brief Take back a source's command on every actuator, like an auton's when driver
+         * control starts
+         */
+        void release(CommandSource source);
+
+        int count() const;
+        Actuator* get(int index) const;
+    private:
+        Actuator* actuators[MAX_ACTUATORS] = {};
+        std::atomic<int> actuatorCount = 0;
+};
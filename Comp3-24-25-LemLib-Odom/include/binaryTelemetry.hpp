@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+
+#include "byteRing.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * Binary telemetry, for logging many channels without formatting text on the brain.
+ *
+ * The stream is a series of COBS encoded records, each followed by a 0 byte. Because COBS
+ * never puts a 0 inside a record, a reader that starts mid-stream or hits garbage only loses
+ * the record it is in. Each batch written out also starts with a 0, so text printed in between
+ * doesn't run into the next record. Before encoding, every record is
+ *
+ *   type (1 byte) | body | CRC-8 of type and body (1 byte)
+ *
+ * and the bodies are
+ *
+ *   SCHEMA: version (1) | channel id (1) | field count (1) | channel name \0 | field names \0 ...
+ *   DATA:   channel id (1) | time in ms (4) | one float per field (4 each)
+ *
+ * Everything is little endian, same as the brain. The schema of every channel is sent when the
+ * sink starts and again every schemaPeriod ms, so a capture started late still decodes.
+ * Sim/apps/telemetry_decode turns a capture back into CSV or column files.
+ */
+namespace telemetry {
+
+constexpr std::uint8_t VERSION = 1;
+constexpr int MAX_CHANNELS = 32;
+constexpr int MAX_FIELDS = 16;
+/**
+ * @brief Longest channel or field name, not counting the \0
+ */
+constexpr int MAX_NAME = 23;
+
+/**
+ * @brief What a record holds
+ */
+enum class RecordType : std::uint8_t {
+    SCHEMA = 0, // names a channel and its fields
+    DATA = 1 // one sample of a channel
+};
+
+/**
+ * @brief Largest record before encoding, a schema with every name at full length
+ */
+constexpr std::size_t MAX_RECORD = 1 + 3 + (MAX_FIELDS + 1) * (MAX_NAME + 1) + 1;
+
+/**
+ * @brief Largest a record can grow to once COBS encoded, not counting the 0 after it
+ *
+ * @param size record size before encoding
+ */
+constexpr std::size_t cobsMaxSize(std::size_t size) { return size + size / 254 + 1; }
+
+/**
+ * @brief COBS encode a record
+ *
+ * @param in record to encode
+ * @param size bytes in the record
+ * @param out at least cobsMaxSize(size) bytes
+ * @return bytes written to out, which never contains a 0
+ */
+std::size_t cobsEncode(const std::uint8_t* in, std::size_t size, std::uint8_t* out);
+
+/**
+ * @brief Decode one COBS encoded record, without the 0 after it
+ *
+ * @param in encoded record
+ * @param size bytes in the encoded record
+ * @param out at least size bytes
+ * @return bytes written to out, or -1 if in isn't valid COBS
+ */
+int cobsDecode(const std::uint8_t* in, std::size_t size, std::uint8_t* out);
+
+/**
+ * @brief CRC-8 with polynomial 0x07, as used at the end of every record
+ */
+std::uint8_t crc8(const std::uint8_t* data, std::size_t size);
+
+/**
+ * @brief Sink that writes fixed layout binary records instead of formatted text
+ *
+ * Does the job of lemlib::telemetrySink(), but a sample costs a few float copies and a COBS
+ * pass rather than two rounds of fmt formatting and a std::string per message. Records go into
+ * a ByteRing and a background task writes them out at a fixed rate. When the output can't keep
+ * up, new records are dropped and counted rather than making the logging task wait.
+ *
+ * Each sink takes samples from one task. Give every task that logs its own sink.
+ *
+ * When out is stdout, turn off PROS' own stream multiplexing first with
+ * pros::c::serctl(SERCTL_DISABLE_COBS, nullptr) so the records reach the computer as they are.
+ * Anything else printed in between is skipped by the decoder.
+ *
+ * @b Example
+ * @code {.cpp}
+ * telemetry::BinarySink sink;
+ * int poseChannel = sink.addChannel("pose", {"x", "y", "theta"});
+ * sink.start();
+ * sink.log(poseChannel, {pose.x, pose.y, pose.theta});
+ * @endcode
+ */
+class BinarySink {
+    public:
+        /**
+         * @brief Bytes that can wait to be written
+         */
+        static constexpr std::size_t CAPACITY = 4096;
+
+        /**
+         * @brief Construct a new BinarySink. Nothing is written until start()
+         *
+         * @param out where records go, stdout by default
+         * @param rate ms between writes
+         * @param schemaPeriod ms between repeats of the schema, 0 to only send it at start
+         */
+        BinarySink(std::FILE* out = stdout, std::uint32_t rate = 10, std::uint32_t schemaPeriod = 1000);
+
+        BinarySink(const BinarySink&) = delete;
+        BinarySink& operator=(const BinarySink&) = delete;
+
+        /**
+         * @brief Add a channel. Has to be done before start()
+         *
+         * @param name channel name, at most MAX_NAME characters
+         * @param fields name of each value in a sample, at most MAX_FIELDS of them
+         * @return channel id to pass to log(), or -1 if the sink is full, already started or a
+         * name is too long
+         */
+        int addChannel(const char* name, std::initializer_list<const char*> fields);
+
+        /**
+         * @brief Send the schema and start the task that writes records out
+         */
+        void start();
+
+        /**
+         * @brief Queue one sample of a channel, stamped with pros::millis(). Never allocates or blocks
+         *
+         * @param channel id from addChannel()
+         * @param values one per field, in the order the fields were added
+         * @return false if the sample was dropped because the queue is full or the channel doesn't
+         * match the values
+         */
+        bool log(int channel, std::initializer_list<float> values);
+
+        /**
+         * @brief Queue one sample of a channel. Never allocates or blocks
+         *
+         * @param channel id from addChannel()
+         * @param time ms the sample was taken at
+         * @param values one per field, in the order the fields were added
+         * @param count number of values
+         * @return false if the sample was dropped because the queue is full or the channel doesn't
+         * match the values
+         */
+        bool log(int channel, std::uint32_t time, const float* values, int count);
+
+        /**
+         * @brief Write out everything queued so far, and the schema if it's due. The task started
+         * by start() calls this
+         *
+         * @return number of bytes written
+         */
+        std::size_t flush();
+
+        /**
+         * @brief Samples dropped because the queue was full
+         */
+        std::uint32_t getDropped();
+
+        /**
+         * @brief Bytes written out so far
+         */
+        std::uint32_t getWritten();
+
+        /**
+         * @brief Most bytes that have been waiting at once
+         */
+        std::uint32_t getHighWater();
+    private:
+        struct Channel {
+                char name[MAX_NAME + 1];
+                char fields[MAX_FIELDS][MAX_NAME + 1];
+                std::uint8_t fieldCount;
+        };
+
+        std::size_t writeSchema();
+
+        ByteRing<CAPACITY> ring;
+        Channel channels[MAX_CHANNELS] = {};
+        int channelCount = 0;
+        std::FILE* out;
+        std::uint32_t rate;
+        std::uint32_t schemaPeriod;
+        std::uint32_t lastSchema = 0;
+        std::uint32_t written = 0;
+        pros::Task* task = nullptr;
+};
+} // namespace telemetry
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Fixed size, lock-free byte queue for one writer task and one reader task
+ *
+ * Storage lives inside the object, so nothing is allocated after construction. Writes are all
+ * or nothing: if a message doesn't fit it's dropped and counted, and the writer carries on
+ * instead of waiting for the reader. This is what lets a control task log without ever
+ * blocking.
+ *
+ * Only one task may call write() and only one task may call read(), peek() and consume().
+ *
+ * @tparam Capacity size in bytes, a power of two
+ */
+template <std::size_t Capacity> class ByteRing {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    public:
+        /**
+         * @brief Add bytes to the ring, either all of them or none
+         *
+         * @param data bytes to add
+         * @param size number of bytes
+         * @return true if they were added, false if there wasn't room
+         */
+        bool write(const void* data, std::size_t size) {
+            const std::uint32_t h = head.load(std::memory_order_relaxed);
+            const std::uint32_t used = h - tail.load(std::memory_order_acquire);
+            if (size > Capacity - used) {
+                droppedMessages.fetch_add(1, std::memory_order_relaxed);
+                droppedBytes.fetch_add(size, std::memory_order_relaxed);
+                return false;
+            }
+            const std::size_t start = h & (Capacity - 1);
+            const std::size_t first = size < Capacity - start ? size : Capacity - start;
+            std::memcpy(storage + start, data, first);
+            std::memcpy(storage, static_cast<const std::uint8_t*>(data) + first, size - first);
+            head.store(h + size, std::memory_order_release);
+            writtenBytes.fetch_add(size, std::memory_order_relaxed);
+            if (used + size > highWater.load(std::memory_order_relaxed))
+                highWater.store(used + size, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief Get the bytes that can be read without wrapping around, without removing them
+         *
+         * @param data set to the first readable byte
+         * @return number of bytes at data, 0 if the ring is empty
+         */
+        std::size_t peek(const std::uint8_t** data) const {
+            const std::uint32_t t = tail.load(std::memory_order_relaxed);
+            const std::uint32_t available = head.load(std::memory_order_acquire) - t;
+            const std::size_t start = t & (Capacity - 1);
+            *data = storage + start;
+            return available < Capacity - start ? available : Capacity - start;
+        }
+
+        /**
+         * @brief Remove bytes that have been read with peek()
+         *
+         * @param size number of bytes to remove
+         */
+        void consume(std::size_t size) { tail.store(tail.load(std::memory_order_relaxed) + size, std::memory_order_release); }
+
+        /**
+         * @brief Copy bytes out of the ring and remove them
+         *
+         * @param out where to copy to
+         * @param size most bytes to copy
+         * @return number of bytes copied
+         */
+        std::size_t read(void* out, std::size_t size) {
+            std::size_t copied = 0;
+            while (copied < size) {
+                const std::uint8_t* data;
+                std::size_t available = peek(&data);
+                if (available == 0) break;
+                if (available > size - copied) available = size - copied;
+                std::memcpy(static_cast<std::uint8_t*>(out) + copied, data, available);
+                consume(available);
+                copied += available;
+            }
+            return copied;
+        }
+
+        /**
+         * @brief Bytes waiting to be read
+         */
+        std::size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Total size in bytes
+         */
+        static constexpr std::size_t capacity() { return Capacity; }
+
+        /**
+         * @brief Bytes accepted by write() since construction
+         */
+        std::uint32_t getWrittenBytes() const { return writtenBytes.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Writes turned away because the ring was full
+         */
+        std::uint32_t getDroppedMessages() const { return droppedMessages.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Bytes turned away because the ring was full
+         */
+        std::uint32_t getDroppedBytes() const { return droppedBytes.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Most bytes that have been waiting at once
+         */
+        std::uint32_t getHighWater() const { return highWater.load(std::memory_order_relaxed); }
+    private:
+        // free running counters, wrapped into storage with a mask
+        alignas(64) std::atomic<std::uint32_t> head = 0;
+        alignas(64) std::atomic<std::uint32_t> tail = 0;
+
+        std::atomic<std::uint32_t> writtenBytes = 0;
+        std::atomic<std::uint32_t> droppedMessages = 0;
+        std::atomic<std::uint32_t> droppedBytes = 0;
+        std::atomic<std::uint32_t> highWater = 0;
+
+        std::uint8_t storage[Capacity];
+};
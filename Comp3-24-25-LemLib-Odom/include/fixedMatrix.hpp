@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+ * Small matrices with their size fixed at compile time, for filters that run every control loop.
+ *
+ * Everything lives in a plain array inside the object, so nothing here ever allocates, and the
+ * compiler sees every loop bound.
+ */
+namespace fixedmatrix {
+
+/**
+ * @brief A Rows by Cols matrix of floats, stored row by row
+ */
+template <int Rows, int Cols> class Matrix {
+    public:
+        static_assert(Rows > 0 && Cols > 0, "matrices need at least one row and column");
+
+        /**
+         * @brief Construct a matrix of zeros
+         */
+        Matrix() = default;
+
+        /**
+         * @brief The identity matrix
+         */
+        static Matrix identity() {
+            static_assert(Rows == Cols, "only square matrices have an identity");
+            Matrix out;
+            for (int i = 0; i < Rows; i++) out(i, i) = 1;
+            return out;
+        }
+
+        float& operator()(int row, int col) { return data[row][col]; }
+
+        float operator()(int row, int col) const { return data[row][col]; }
+
+        Matrix operator+(const Matrix& other) const {
+            Matrix out;
+            for (int r = 0; r < Rows; r++)
+                for (int c = 0; c < Cols; c++) out(r, c) = data[r][c] + other(r, c);
+            return out;
+        }
+
+        Matrix operator-(const Matrix& other) const {
+            Matrix out;
+            for (int r = 0; r < Rows; r++)
+                for (int c = 0; c < Cols; c++) out(r, c) = data[r][c] - other(r, c);
+            return out;
+        }
+
+        Matrix operator*(float scale) const {
+            Matrix out;
+            for (int r = 0; r < Rows; r++)
+                for (int c = 0; c < Cols; c++) out(r, c) = data[r][c] * scale;
+            return out;
+        }
+
+        template <int Other> Matrix<Rows, Other> operator*(const Matrix<Cols, Other>& other) const {
+            Matrix<Rows, Other> out;
+            for (int r = 0; r < Rows; r++)
+                for (int k = 0; k < Cols; k++) {
+                    const float value = data[r][k];
+                    for (int c = 0; c < Other; c++) out(r, c) += value * other(k, c);
+                }
+            return out;
+        }
+
+        Matrix<Cols, Rows> transpose() const {
+            Matrix<Cols, Rows> out;
+            for (int r = 0; r < Rows; r++)
+                for (int c = 0; c < Cols; c++) out(c, r) = data[r][c];
+            return out;
+        }
+    private:
+        float data[Rows][Cols] = {};
+};
+
+template <int Size> using Vector = Matrix<Size, 1>;
+} // namespace fixedmatrix
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "poseFilter.hpp"
+
+/**
+ * @brief The fused odometry task's PoseFilter, and the poses autons set on it
+ *
+ * Each tick update() turns how far the trackers, drive sides and imu have gone into velocities
+ * for the filter. The filter never reads the chassis pose back, so nothing it writes there can
+ * leak into it. Instead setPose() posts a pose from any task, and the next update() moves the
+ * filter there, keeping how fast the robot is going since autons set it mid move too. Posting
+ * bumps a sequence number, odd while the pose is half written, so the fused task never waits on a
+ * lock and never mistakes a torn pose or a fast turn for an auton setting it.
+ *
+ * Nothing here touches PROS, so Sim runs it as it is.
+ *
+ * @b Example
+ * @code {.cpp}
+ * FusedPose fused({-1, -6, -6.75, 6.75, 1, 3, 0.003, 0.05});
+ * // any task
+ * fused.setPose(0, 0, 0);
+ * // fused odometry task, every 10 ms
+ * fused.update({vertical, horizontal, left, right, imuRadians, imuRadiansPerSecond}, 0.01);
+ * @endcode
+ */
+class FusedPose {
+    public:
+        /**
+         * @brief Where each sensor is and how far its velocity can be off when it isn't slipping
+         */
+        struct Sensors {
+                float verticalOffset; // inches right of the tracking center
+                float horizontalOffset; // inches forward of the tracking center
+                float leftOffset; // inches right of the tracking center, negative
+                float rightOffset; // inches right of the tracking center
+                float trackerStd; // inches per second
+                float driveStd; // inches per second
+                float headingStd; // radians
+                float turnRateStd; // radians per second
+        };
+
+        /**
+         * @brief What the sensors say this tick
+         */
+        struct Reading {
+                float vertical; // inches the vertical tracker has rolled
+                float horizontal; // inches the horizontal tracker has rolled
+                float left; // inches the left side has rolled
+                float right; // inches the right side has rolled
+                float heading; // radians clockwise, not wrapped, like pros::Imu::get_rotation()
+                float turnRate; // radians per second clockwise
+        };
+
+        /**
+         * @brief Construct a new FusedPose, which starts at the origin on the first update()
+         *
+         * @param sensors where the sensors are
+         * @param noise the filter's process noise and gate
+         */
+        explicit FusedPose(const Sensors& sensors, PoseFilter::Noise noise = {});
+
+        FusedPose(const FusedPose&) = delete;
+        FusedPose& operator=(const FusedPose&) = delete;
+
+        /**
+         * @brief Move the filter to a pose on the next update(). Safe from any task, one at a time
+         *
+         * @param x inches
+         * @param y inches
+         * @param theta radians
+         */
+        void setPose(float x, float y, float theta);
+
+        /**
+         * @brief Run the filter one tick. Only call from one task
+         *
+         * @param reading what the sensors say now
+         * @param dt seconds since the last update
+         * @return true if it moved to a pose setPose() posted, instead of moving on
+         */
+        bool update(const Reading& reading, float dt);
+
+        /**
+         * @brief Where the filter thinks the robot is now
+         *
+         * @param x set to inches
+         * @param y set to inches
+         * @param theta set to radians
+         */
+        void getPose(float& x, float& y, float& theta) const;
+        /**
+         * @brief Where the robot will be if it keeps its current velocities, see
+         * PoseFilter::getAhead()
+         */
+        void getAhead(float seconds, float& x, float& y, float& theta) const;
+        /**
+         * @brief Times update() moved to a posted pose, the first one included
+         */
+        std::uint32_t getResets() const;
+        /**
+         * @brief The filter, for its state and how many readings it rejected
+         */
+        const PoseFilter& getFilter() const;
+    private:
+        Sensors sensors;
+        PoseFilter filter;
+        // the filter's heading is the imu's plus whatever setPose() asked for
+        float headingOffset = 0;
+        Reading last = {};
+
+        // setPose() writes these, odd while it's writing
+        std::atomic<std::uint32_t> sequence = 0;
+        std::atomic<float> setX = 0;
+        std::atomic<float> setY = 0;
+        std::atomic<float> setTheta = 0;
+        // never a sequence setPose() finishes on, so the first update() starts at the origin
+        std::uint32_t seen = ~std::uint32_t(0);
+        std::atomic<std::uint32_t> resets = 0;
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "binaryTelemetry.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * @brief Measures how a task's loop actually runs against the period it's meant to
+ *
+ * Every pass through the loop records the time since the last one into a histogram of 1 ms
+ * buckets, how late it woke, and how long the loop body took from begin() to end(). A pass more
+ * than deadline ms late counts as a miss. A task made with spawn() has its unused stack filled
+ * with a pattern when the loop starts, and whatever is still untouched is how close the task has
+ * come to overflowing it. Only spawn() knows where the task's stack starts, so a loop in a task
+ * made some other way, like opcontrol(), isn't painted and reports -1.
+ *
+ * Everything lives inside the object in fixed arrays, so measuring never allocates and costs two
+ * pros::micros() calls a pass. Counters are atomic, so another task can read them while the loop
+ * runs. Every monitor registers itself the first time its loop starts, for printLoopStats() and
+ * logLoopStats() to find.
+ *
+ * Busy time is wall time between begin() and end(), so it includes time the loop was preempted by
+ * higher priority tasks. PROS has no per task CPU time.
+ *
+ * @b Example
+ * @code {.cpp}
+ * LoopMonitor sortingMonitor("sorting", 10);
+ * void sorting() {
+ *     sortingMonitor.start();
+ *     while (true) {
+ *         sortingMonitor.begin();
+ *         // ...
+ *         sortingMonitor.delay(10);
+ *     }
+ * }
+ * // in initialize()
+ * sortingMonitor.spawn(sorting);
+ * @endcode
+ */
+class LoopMonitor {
+    public:
+        /**
+         * @brief Histogram buckets, 1 ms each. The last one holds every longer period
+         */
+        static constexpr int BUCKETS = 32;
+        /**
+         * @brief Most monitors that can register
+         */
+        static constexpr int MAX_MONITORS = 8;
+        /**
+         * @brief Longest name, not counting the \0
+         */
+        static constexpr int MAX_NAME = 11;
+
+        /**
+         * @brief Construct a new LoopMonitor. Nothing is measured until start()
+         *
+         * @param name what printLoopStats() and the telemetry channel call it
+         * @param period ms the loop is meant to run every
+         * @param deadline ms late a pass can be before it counts as a miss, half the period by default
+         * @param stackWords words of stack spawn() gives the task
+         */
+        LoopMonitor(const char* name, std::uint32_t period, std::uint32_t deadline = 0,
+                    std::uint32_t stackWords = TASK_STACK_DEPTH_DEFAULT);
+
+        LoopMonitor(const LoopMonitor&) = delete;
+        LoopMonitor& operator=(const LoopMonitor&) = delete;
+
+        /**
+         * @brief Make the task the loop runs in, with the monitor's name and stack size. start()
+         * can only paint the stack of a task made this way
+         *
+         * @param function the task, which calls start() before its loop
+         * @param priority the task's priority
+         */
+        template <typename F> pros::Task spawn(F&& function, std::uint32_t priority = TASK_PRIORITY_DEFAULT) {
+            return pros::Task(
+                [this, function = std::forward<F>(function)]() mutable {
+                    markStackTop();
+                    function();
+                },
+                priority, stackBytes / 4, name);
+        }
+
+        /**
+         * @brief Call from the task before its loop. The first call registers the monitor and, in
+         * a task from spawn(), fills the unused stack below it with the pattern. Later calls, like
+         * opcontrol() starting again each time driver control does, only reset()
+         */
+        void start();
+
+        /**
+         * @brief Mark the start of a pass, at the top of the loop
+         */
+        void begin();
+
+        /**
+         * @brief Mark the end of a pass, before the loop sleeps
+         */
+        void end();
+
+        /**
+         * @brief end() then pros::delay(), for loops that sleep a fixed time
+         */
+        void delay(std::uint32_t ms);
+
+        /**
+         * @brief end() then pros::Task::delay_until(), for loops that keep a fixed period
+         */
+        void delayUntil(std::uint32_t* previous, std::uint32_t ms);
+
+        /**
+         * @brief Forget everything measured so far, to measure from a known point like the start of
+         * a match. Can be called from any task. The stack isn't painted again
+         */
+        void reset();
+
+        /**
+         * @brief Summary of everything measured since start() or reset()
+         */
+        struct Stats {
+                std::uint32_t passes; // periods measured
+                float periodMean; // ms
+                std::uint32_t periodMax; // ms
+                std::uint32_t lateMax; // ms the latest wake was behind the period
+                std::uint32_t misses; // passes more than deadline late
+                float busyPercent; // of the time, in the loop body
+                std::uint32_t busyMax; // us, longest loop body
+                std::int32_t stackFree; // bytes never touched below the loop, -1 if not measured
+        };
+
+        /**
+         * @brief Summarize, from any task
+         */
+        Stats getStats() const;
+
+        /**
+         * @brief Passes whose period was in a bucket. Bucket i holds periods of i ms, the last one
+         * everything from BUCKETS - 1 ms up
+         */
+        std::uint32_t getBucket(int bucket) const;
+
+        const char* getName() const;
+        std::uint32_t getPeriod() const;
+
+        /**
+         * @brief Bytes of stack never touched since start(). Scans the painted stack, so call it
+         * from a slow task, not the loop
+         *
+         * @return bytes, or -1 if start() hasn't painted it
+         */
+        std::int32_t getStackFree() const;
+
+        /**
+         * @brief Monitors that have started, in the order they did
+         */
+        static int count();
+        static LoopMonitor* get(int index);
+    private:
+        char name[MAX_NAME + 1];
+        std::uint32_t period;
+        std::uint32_t deadline;
+        std::uint32_t stackBytes;
+
+        std::atomic<std::uint32_t> buckets[BUCKETS] = {};
+        std::atomic<std::uint32_t> passes = 0;
+        std::atomic<std::uint64_t> periodTotal = 0; // us
+        std::atomic<std::uint32_t> periodMax = 0; // us
+        std::atomic<std::uint32_t> lateMax = 0; // us
+        std::atomic<std::uint32_t> misses = 0;
+        std::atomic<std::uint64_t> busyTotal = 0; // us
+        std::atomic<std::uint32_t> busyMax = 0; // us
+        std::atomic<std::uint64_t> since = 0; // us, when measuring started
+        std::uint64_t lastBegin = 0;
+        std::uint64_t passBegin = 0;
+        std::atomic<bool> fresh = true; // next begin() has no period before it to measure
+        std::atomic<bool> started = false;
+        std::uintptr_t stackTop = 0; // where spawn()'s task started, 0 if it didn't make the task
+        volatile std::uint32_t* stackLow = nullptr; // painted from here up to stackHigh
+        volatile std::uint32_t* stackHigh = nullptr;
+
+        void markStackTop();
+};
+
+/**
+ * @brief Print the monitors on the brain screen, one line each from firstLine. When there are more
+ * than fit below it they're shown a page at a time, so call it with a page that counts up to
+ * cycle through them all
+ *
+ * @param firstLine screen line the first monitor goes on
+ * @param page which screenful of monitors to show, wrapping around past the last
+ */
+void printLoopStats(int firstLine, int page = 0);
+
+/**
+ * @brief Add a channel per monitor to a sink, with fields periodMean, periodMax, lateMax, misses,
+ * busyPercent and stackFree. Do it before the sink starts, after the monitors are made
+ *
+ * @param monitors the monitors to log, in the order logLoopStats() will log them
+ * @param count number of monitors
+ * @param channels gets each monitor's channel id
+ */
+void addLoopChannels(telemetry::BinarySink& sink, LoopMonitor* const* monitors, int count, int* channels);
+
+/**
+ * @brief Log every monitor added with addLoopChannels()
+ */
+void logLoopStats(telemetry::BinarySink& sink, LoopMonitor* const* monitors, int count, const int* channels);
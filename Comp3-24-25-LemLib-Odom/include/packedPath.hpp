@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "lemlib/asset.hpp"
+
+/**
+ * Paths packed at build time, so follow() can read them straight out of the linked asset.
+ *
+ * path-asset.mk runs its host path_pack over every .txt path in static/ from path.jerryio
+ * and links the result as static/<name>.path, which ASSET(<name>_path) picks up like any other
+ * asset. A packed path is a Header followed by one Point per path point. Everything is little
+ * endian floats, same as the brain, and the asset is 4 byte aligned so points are read in place.
+ */
+namespace packedpath {
+
+constexpr char MAGIC[4] = {'P', 'P', 'T', 'H'};
+constexpr std::uint16_t VERSION = 2;
+
+/**
+ * @brief Start of every packed path
+ */
+struct Header {
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t pointSize; // sizeof(Point), so a reader can tell the layout changed
+        std::uint32_t count;
+        float length; // inches along the whole path
+        float duration; // seconds the time profile takes, 0 if the path was packed without one
+};
+
+/**
+ * @brief One point of a packed path
+ */
+struct Point {
+        float x; // inches
+        float y; // inches
+        float speed; // 0 to 127, 0 marks the end of the path
+        float distance; // inches along the path from the first point
+        float curvature; // 1 / inches, positive when the path turns left, 0 at both ends
+        // time profile, see pathProfile.hpp. All 0 if the path was packed without one
+        float velocity; // inches per second
+        float acceleration; // inches per second squared, until the next point
+        float time; // seconds from the first point
+};
+
+/**
+ * @brief Read-only view of a packed path. Nothing is copied, the asset has to outlive the view
+ *
+ * @b Example
+ * @code {.cpp}
+ * ASSET(example_path); // built from static/example.txt
+ *
+ * void autonomous() {
+ *     chassis.follow(packedpath::Path(example_path), 15, 4000);
+ * }
+ * @endcode
+ */
+class Path {
+    public:
+        /**
+         * @brief Construct an empty, invalid path
+         */
+        Path() = default;
+        /**
+         * @brief Construct a view of a packed path asset
+         *
+         * @param asset asset made from a .path file
+         */
+        explicit Path(const asset& asset);
+        /**
+         * @brief Construct a view of a packed path in memory
+         *
+         * @param data start of the header, 4 byte aligned
+         * @param size bytes at data
+         */
+        Path(const void* data, std::size_t size);
+
+        /**
+         * @brief Whether the data was a packed path with at least one point
+         */
+        bool isValid() const;
+        /**
+         * @brief Number of points
+         */
+        int size() const;
+        /**
+         * @brief Length of the path in inches
+         */
+        float length() const;
+        /**
+         * @brief Seconds the path's time profile takes, 0 if it doesn't have one
+         */
+        float duration() const;
+        /**
+         * @brief Get a point. No bounds checking
+         */
+        const Point& operator[](int i) const { return points[i]; }
+
+        const Point* begin() const { return points; }
+
+        const Point* end() const { return points + count; }
+    private:
+        const Point* points = nullptr;
+        int count = 0;
+        float totalLength = 0;
+        float totalDuration = 0;
+};
+
+/**
+ * @brief Grid over the segments of a path, for finding the closest point without checking them all
+ *
+ * Every segment is listed in each cell its bounding box touches. A search looks at the cell the
+ * robot is in, then rings of cells around it, and stops once no unchecked cell can hold anything
+ * closer, so it checks a handful of segments however long the path is. Built once per path, the
+ * only allocation is here.
+ */
+class PathIndex {
+    public:
+        /**
+         * @brief Construct an index over a path
+         *
+         * @param path path to index, has to outlive this
+         * @param cellSize width of a grid cell in inches, 0 to pick one from the path's size
+         */
+        explicit PathIndex(const Path& path, float cellSize = 0);
+
+        /**
+         * @brief Find the path point closest to a position
+         *
+         * Gives the same point as checking every point, ties going to the lowest index.
+         *
+         * @param x x in inches
+         * @param y y in inches
+         * @param from only points from this index on are considered
+         * @return index of the closest point, -1 if there are none from that index on
+         */
+        int closest(float x, float y, int from = 0) const;
+
+        /**
+         * @brief Width of a grid cell in inches
+         */
+        float getCellSize() const;
+    private:
+        int cellOf(float value, float min, int cells) const;
+
+        const Path& path;
+        float cellSize = 1;
+        float minX = 0;
+        float minY = 0;
+        int columns = 0;
+        int rows = 0;
+        std::vector<int> cellStart; // cell c holds segments[cellStart[c]] up to segments[cellStart[c + 1]]
+        std::vector<int> segments; // segment i runs from point i to point i + 1
+};
+
+/**
+ * @brief Pure pursuit over a packed path, one step at a time
+ *
+ * Does what lemlib::Chassis::follow does each iteration, closest point, lookahead point and the
+ * curvature of the arc to it, without owning the motors or the loop. That keeps it usable off
+ * the robot, and lets the chassis decide how often it runs.
+ *
+ * Unlike LemLib, the closest point never moves backwards and is only looked for a little way
+ * ahead of where it was, so a path that crosses itself can't pull the robot onto a later pass
+ * and each step costs the same however long the path is. If the robot ends up further than the
+ * lookahead from that stretch, say it got pushed, the closest point comes from a PathIndex
+ * instead.
+ */
+class PurePursuit {
+    public:
+        /**
+         * @brief Construct a new PurePursuit
+         *
+         * @param path path to follow, has to outlive this
+         * @param lookahead lookahead distance in inches
+         * @param trackWidth drivetrain track width in inches
+         * @param slew most the target speed can change per step, 0 for no limit
+         */
+        PurePursuit(const Path& path, float lookahead, float trackWidth, float slew = 0);
+
+        /**
+         * @brief Work out the drivetrain speeds for where the robot is now
+         *
+         * @param x robot x in inches
+         * @param y robot y in inches
+         * @param theta robot heading in radians as lemlib reports it, already turned around if
+         * the robot is following the path backwards
+         * @param left set to the left side speed, -127 to 127
+         * @param right set to the right side speed, -127 to 127
+         * @return false once the robot has reached the end of the path, left and right are
+         * untouched then
+         */
+        bool update(float x, float y, float theta, float& left, float& right);
+
+        /**
+         * @brief Index of the path point closest to the robot at the last update
+         */
+        int getClosest() const;
+        /**
+         * @brief Inches along the path to the closest point at the last update
+         */
+        float getProgress() const;
+        /**
+         * @brief How many times the closest point had to be found with the PathIndex
+         */
+        int getRelocalizations() const;
+    private:
+        const Path& path;
+        PathIndex index;
+        float lookahead;
+        float trackWidth;
+        float slew;
+        float window; // inches along the path past the closest point that are searched
+
+        int closest = -1;
+        float lookaheadX;
+        float lookaheadY;
+        int lookaheadIndex = 0;
+        float prevSpeed = 0;
+        int relocalizations = 0;
+};
+} // namespace packedpath
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "fusedPose.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "packedPath.hpp"
+#include "ramsete.hpp"
+
+/**
+ * @brief lemlib::Chassis that can also follow packed paths
+ *
+ * Everything lemlib::Chassis does still works, including follow() with a text path asset. The
+ * packed overload reads points straight from the asset instead of parsing the text into a
+ * std::vector every time it's called.
+ */
+class PathChassis : public lemlib::Chassis {
+    public:
+        using lemlib::Chassis::Chassis;
+        using lemlib::Chassis::follow;
+
+        /**
+         * @brief Move the chassis along a packed path
+         *
+         * Same behaviour as lemlib::Chassis::follow, and waitUntil() still measures inches
+         * driven. A path packed with a time profile runs at its speeds without the slew, see
+         * pathProfile.hpp.
+         *
+         * @param path the packed path to follow, its asset has to stay around until the motion ends
+         * @param lookahead the lookahead distance. Units in inches. Larger values will make the robot move
+         * faster but will follow the path less accurately
+         * @param timeout the maximum time the robot can spend moving
+         * @param forwards whether the robot should follow the path going forwards. true by default
+         * @param async whether the function should be run asynchronously. true by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * ASSET(example_path); // packed from static/example.txt when the project is built
+         *
+         * void autonomous() {
+         *     chassis.follow(packedpath::Path(example_path), 15, 4000);
+         * }
+         * @endcode
+         */
+        void follow(packedpath::Path path, float lookahead, int timeout, bool forwards = true, bool async = true);
+
+        /**
+         * @brief Move the chassis along a time profiled packed path with Ramsete
+         *
+         * Follows the path where its time profile says the robot should be, instead of chasing a
+         * lookahead point, so turns aren't cut and the robot keeps up at speed, see ramsete.hpp.
+         * Wheel velocities go to the motors through the feedforward from setFeedforward(), and
+         * waitUntil() measures inches driven like follow().
+         *
+         * @param path the packed path to follow, packed with a time profile, its asset has to stay
+         * around until the motion ends
+         * @param timeout the maximum time the robot can spend moving
+         * @param forwards whether the robot should follow the path going forwards. true by default
+         * @param async whether the function should be run asynchronously. true by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * ASSET(example_path); // packed from static/example.txt when the project is built
+         *
+         * void autonomous() {
+         *     chassis.followTrajectory(packedpath::Path(example_path), 4000);
+         * }
+         * @endcode
+         */
+        void followTrajectory(packedpath::Path path, int timeout, bool forwards = true, bool async = true);
+
+        /**
+         * @brief Set the motor power followTrajectory() gives for a wheel velocity and acceleration
+         *
+         * Until this is called it's just the drivetrain's free speed at full power.
+         *
+         * @param feedforward the drive's constants, in motor power
+         */
+        void setFeedforward(const packedpath::WheelFeedforward& feedforward);
+
+        /**
+         * @brief Set the pose of the chassis, like lemlib::Chassis::setPose, and start the fused
+         * pose over from it if there is one
+         *
+         * @param x new x value
+         * @param y new y value
+         * @param theta new theta value
+         * @param radians true if theta is in radians, false if not. False by default
+         */
+        void setPose(float x, float y, float theta, bool radians = false);
+        /**
+         * @brief Set the pose of the chassis, like lemlib::Chassis::setPose, and start the fused
+         * pose over from it if there is one
+         *
+         * @param pose the new pose
+         * @param radians whether pose theta is in radians (true) or not (false). false by default
+         */
+        void setPose(lemlib::Pose pose, bool radians = false);
+
+        /**
+         * @brief Have setPose() start a fused pose over. The task writing the fused pose into the
+         * chassis calls lemlib::Chassis::setPose itself, which doesn't
+         *
+         * @param fused the fused pose, nullptr for none
+         */
+        void setFusedPose(FusedPose* fused);
+    private:
+        packedpath::WheelFeedforward feedforward = {0, 0, 0};
+        FusedPose* fused = nullptr;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "packedPath.hpp"
+
+/**
+ * Time-optimal speeds along a path, for a tank drive.
+ *
+ * Every point gets the fastest speed where neither wheel goes over the top speed and the robot
+ * doesn't slide sideways in the turn. A pass forwards then caps it by how fast the robot can
+ * speed up from the start, and a pass backwards by how fast it can stop for everything after.
+ * The limits are on the outside wheel, like squiggles' TankModel, so tight turns slow down and
+ * accelerate gently. The result is the fastest the path can be driven, as long as the limits are
+ * what the robot can really do.
+ *
+ * Speeds end up in each point's speed column too, scaled so 127 is maxVelocity, which is what
+ * follow() and EZ's pure pursuit already read.
+ *
+ * @b Example
+ * @code {.cpp}
+ * packedpath::Limits limits = {.maxVelocity = 60, .maxAcceleration = 150, .maxDeceleration = 150,
+ *                              .maxLateralAcceleration = 150, .trackWidth = 13.5, .maxCurvature = 0.13};
+ * float seconds = packedpath::timeProfile(points, count, limits);
+ * @endcode
+ */
+namespace packedpath {
+
+/**
+ * @brief What the drivetrain can do
+ */
+struct Limits {
+        float maxVelocity; // inches per second, of either wheel
+        float maxAcceleration; // inches per second squared, of either wheel
+        float maxDeceleration; // inches per second squared, of either wheel
+        float maxLateralAcceleration; // inches per second squared before the robot slides, 0 for no limit
+        float trackWidth; // inches
+        // sharpest turn the follower really drives, 1 / inches, 0 for no limit. Pure pursuit cuts
+        // corners to an arc through the lookahead point, no tighter than 2 / lookahead, so
+        // slowing for anything sharper only loses time
+        float maxCurvature = 0;
+        // pure pursuit takes its speed from the closest point, so a robot at rest only gets going
+        // if the first one has some. Every point but the last gets at least this, inches per second
+        float minVelocity = 10;
+};
+
+/**
+ * @brief Fill in the time profile of a path's points
+ *
+ * The points need their distance and curvature set already, like path_pack does. The robot
+ * starts at minVelocity and ends at rest on the first point whose speed is 0, where the follower
+ * stops. Points past it, like path.jerryio's ghost point, are left at rest.
+ *
+ * @param points the path's points with their text speeds, velocity, acceleration, time and speed
+ * are overwritten
+ * @param count number of points
+ * @param limits what the drivetrain can do
+ * @return seconds it takes to drive the path
+ */
+float timeProfile(Point* points, int count, const Limits& limits);
+} // namespace packedpath
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstdint>
+
+#include "fixedMatrix.hpp"
+
+/**
+ * @brief Extended Kalman filter for the robot's pose
+ *
+ * Dead reckoning believes whichever sensor it integrates, so one tracking wheel bouncing off
+ * the field during a goal rush moves the pose for the rest of the match. This filter keeps a
+ * pose and velocity with a covariance, and checks every reading against what the other sensors
+ * already said before trusting it. Readings further than the gate from the prediction are
+ * rejected and counted, so a slipping drive wheel or a tracker that lost contact is ignored
+ * while the rest keep the pose going.
+ *
+ * The state is x and y in inches, theta in radians clockwise from +y, same as LemLib, then the
+ * forward, sideways (right) and turning (clockwise) velocities in inches and radians per second.
+ * Each tick call predict() once, then any of the update functions for whatever was read. Every
+ * update is a single scalar measurement, so sensors can come and go without resizing anything.
+ * Nothing here allocates or touches PROS.
+ *
+ * @b Example
+ * @code {.cpp}
+ * PoseFilter filter;
+ * filter.reset(0, 0, 0);
+ * while (true) {
+ *     filter.predict(0.01);
+ *     filter.updateVerticalWheel(verticalVelocity, -1, 0.5);
+ *     filter.updateHorizontalWheel(horizontalVelocity, -6, 0.5);
+ *     filter.updateHeading(imuRadians, 0.005);
+ *     pros::delay(10);
+ * }
+ * @endcode
+ */
+class PoseFilter {
+    public:
+        static constexpr int STATES = 6;
+
+        enum State { X = 0, Y, THETA, FORWARD, SIDEWAYS, TURN };
+
+        /**
+         * @brief How much the robot's motion can change between ticks, and how strict the gate is
+         */
+        struct Noise {
+                float forwardAcceleration = 150; // in/s^2, standard deviation of unmodelled acceleration
+                float sidewaysAcceleration = 60; // in/s^2
+                float turnAcceleration = 20; // rad/s^2
+                float gate = 4; // readings more than this many standard deviations out are rejected
+        };
+
+        /**
+         * @brief An axis aligned wall, for distance sensor readings
+         */
+        struct Wall {
+                bool vertical; // true for a wall along x = position, false for y = position
+                float position; // inches
+        };
+
+        /**
+         * @brief Where a distance sensor sits on the robot
+         */
+        struct RangeSensor {
+                float x; // inches right of the tracking center
+                float y; // inches forward of the tracking center
+                float angle; // radians clockwise from straight ahead
+        };
+
+        /**
+         * @brief Construct a new PoseFilter at the origin with no confidence in anything
+         */
+        PoseFilter();
+        /**
+         * @brief Construct a new PoseFilter at the origin with no confidence in anything
+         *
+         * @param noise process noise and gate
+         */
+        explicit PoseFilter(Noise noise);
+
+        /**
+         * @brief Start again from a known pose, stopped
+         *
+         * @param x inches
+         * @param y inches
+         * @param theta radians
+         * @param positionStd how sure the pose is, inches
+         * @param thetaStd how sure the heading is, radians
+         */
+        void reset(float x, float y, float theta, float positionStd = 0.5, float thetaStd = 0.02);
+        /**
+         * @brief Move to a known pose, keeping the velocities, like an auton setting the pose mid move
+         *
+         * @param x inches
+         * @param y inches
+         * @param theta radians
+         * @param positionStd how sure the pose is, inches
+         * @param thetaStd how sure the heading is, radians
+         */
+        void setPose(float x, float y, float theta, float positionStd = 0.5, float thetaStd = 0.02);
+
+        /**
+         * @brief Move the estimate forward in time assuming constant velocity
+         *
+         * @param dt seconds since the last predict
+         */
+        void predict(float dt);
+
+        /**
+         * @brief A wheel rolling forward, either a vertical tracking wheel or a side of the drive
+         *
+         * @param velocity inches per second, positive forward
+         * @param offset inches right of the tracking center, negative for the left
+         * @param std standard deviation of the reading
+         * @return false if the reading was rejected
+         */
+        bool updateVerticalWheel(float velocity, float offset, float std);
+        /**
+         * @brief A wheel rolling sideways
+         *
+         * @param velocity inches per second, positive right
+         * @param offset inches forward of the tracking center, negative for the back
+         * @param std standard deviation of the reading
+         * @return false if the reading was rejected
+         */
+        bool updateHorizontalWheel(float velocity, float offset, float std);
+        /**
+         * @brief An imu heading, not wrapped, like pros::Imu::get_rotation()
+         *
+         * @param theta radians clockwise
+         * @param std standard deviation of the reading
+         * @return false if the reading was rejected
+         */
+        bool updateHeading(float theta, float std);
+        /**
+         * @brief An imu yaw rate
+         *
+         * @param rate radians per second clockwise
+         * @param std standard deviation of the reading
+         * @return false if the reading was rejected
+         */
+        bool updateTurnRate(float rate, float std);
+        /**
+         * @brief An absolute position, like a pros::Gps fix
+         *
+         * @param x inches
+         * @param y inches
+         * @param std standard deviation of each coordinate
+         * @return false if either coordinate was rejected
+         */
+        bool updatePosition(float x, float y, float std);
+        /**
+         * @brief A distance sensor reading off a known wall
+         *
+         * Readings where the beam is closer than about 20 degrees to parallel with the wall are
+         * rejected, since the beam probably hit something else.
+         *
+         * @param distance inches from the sensor to the wall
+         * @param sensor where the sensor is on the robot
+         * @param wall the wall it's pointed at
+         * @param std standard deviation of the reading
+         * @return false if the reading was rejected
+         */
+        bool updateRange(float distance, const RangeSensor& sensor, const Wall& wall, float std);
+
+        float getX() const;
+        float getY() const;
+        float getTheta() const;
+        /**
+         * @brief Where the robot will be if it keeps its current velocities, as an arc
+         *
+         * Controllers acting on this instead of the pose act on where the robot will be when
+         * their commands land, rather than where it was when the sensors read.
+         *
+         * @param seconds how far ahead, command latency plus how old the sensors are
+         * @param x set to the predicted x
+         * @param y set to the predicted y
+         * @param theta set to the predicted heading, radians
+         */
+        void getAhead(float seconds, float& x, float& y, float& theta) const;
+        /**
+         * @brief One element of the state
+         */
+        float get(State state) const;
+        /**
+         * @brief Variance of one element of the state
+         */
+        float getVariance(State state) const;
+        /**
+         * @brief Readings rejected by the gate since construction
+         */
+        std::uint32_t getRejected() const;
+    private:
+        bool update(const fixedmatrix::Matrix<1, STATES>& h, float innovation, float variance);
+
+        Noise noise;
+        fixedmatrix::Vector<STATES> state;
+        fixedmatrix::Matrix<STATES, STATES> covariance;
+        std::uint32_t rejected = 0;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "packedPath.hpp"
+
+/**
+ * Ramsete trajectory tracking over a time profiled packed path.
+ *
+ * Pure pursuit chases a point ahead of the robot, so it cuts inside every turn and falls behind
+ * when the path is fast. Ramsete instead follows where the profile says the robot should be at
+ * this moment: the reference pose, velocity and turn rate come from the path's time profile, and
+ * the robot's error from the reference, along the path, across it and in heading, is fed back so
+ * it converges on the reference at a rate set by b and zeta. With the profile inside what the
+ * robot can do, the cross-track error stays bounded by how well the drive follows its wheel
+ * speeds, however fast the path is.
+ *
+ * The path has to be packed with a time profile, see pathProfile.hpp. The .path assets' profile
+ * caps curvature for pure pursuit, so the reference takes the sharpest corners faster than the
+ * robot can turn them and Ramsete rounds them off a little. Packed without the cap it tracks
+ * even closer, but slows down for every corner.
+ *
+ * @b Example
+ * @code {.cpp}
+ * ASSET(skills_path); // packed from static/skills.txt when the project is built
+ *
+ * void autonomous() {
+ *     chassis.followTrajectory(packedpath::Path(skills_path), 8000);
+ * }
+ * @endcode
+ */
+namespace packedpath {
+
+/**
+ * @brief Motor power a drive side needs for a wheel velocity and acceleration, -127 to 127
+ *
+ * Same constants as a voltage feedforward, scaled from 12000 mV to 127.
+ */
+struct WheelFeedforward {
+        float kS; // power that goes to friction
+        float kV; // power per inch per second
+        float kA; // power per inch per second squared
+
+        float power(float velocity, float acceleration) const;
+};
+
+/**
+ * @brief Ramsete over a packed path, one step at a time
+ *
+ * Like PurePursuit, this works out the wheel speeds and leaves the motors and the loop to the
+ * chassis.
+ */
+class Ramsete {
+    public:
+        /**
+         * @brief Where the profile says the robot should be
+         */
+        struct Reference {
+                float x; // inches
+                float y; // inches
+                float theta; // radians, as lemlib reports it
+                float velocity; // inches per second
+                float acceleration; // inches per second squared
+                float angularVelocity; // radians per second, positive turning left
+        };
+
+        /**
+         * @brief Construct a new Ramsete
+         *
+         * @param path path to follow, packed with a time profile, has to outlive this
+         * @param trackWidth drivetrain track width in inches
+         * @param b how hard errors are corrected, per inch squared. The usual 2 per meter squared
+         * is 0.0013, but a drive this light and short follows its wheel speeds well enough to take
+         * much more
+         * @param zeta damping, between 0 and 1
+         * @param minGain least the along-track and heading errors are corrected by, per second
+         */
+        Ramsete(const Path& path, float trackWidth, float b = 0.02, float zeta = 0.7, float minGain = 3);
+
+        /**
+         * @brief Where the profile says the robot should be some time in
+         *
+         * @param seconds time since the start of the path, clamped to the profile
+         */
+        Reference reference(float seconds) const;
+
+        /**
+         * @brief Work out the wheel velocities for where the robot is now
+         *
+         * @param x robot x in inches
+         * @param y robot y in inches
+         * @param theta robot heading in radians as lemlib reports it, already turned around if
+         * the robot is following the path backwards
+         * @param seconds time since the robot started the path
+         * @param left set to the left wheel velocity, inches per second
+         * @param right set to the right wheel velocity, inches per second
+         * @param leftAccel set to the left wheel acceleration, inches per second squared
+         * @param rightAccel set to the right wheel acceleration, inches per second squared
+         * @return false once the profile is over and the robot is at the end of the path or has had
+         * half a second more to get there, or if the path has no time profile. Nothing is set then
+         */
+        bool update(float x, float y, float theta, float seconds, float& left, float& right, float& leftAccel,
+                    float& rightAccel);
+
+        /**
+         * @brief Inches the robot was from the reference across the path at the last update,
+         * positive to its left
+         */
+        float getCrossTrackError() const;
+        /**
+         * @brief Inches the robot was behind the reference along the path at the last update
+         */
+        float getAlongTrackError() const;
+    private:
+        const Path& path;
+        float trackWidth;
+        float b;
+        float zeta;
+        float minGain;
+
+        float crossTrack = 0;
+        float alongTrack = 0;
+};
+} // namespace packedpath
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#define FMT_HEADER_ONLY
+#include "fmt/core.h"
+
+#include "byteRing.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * @brief Logger that never allocates or blocks the task logging
+ *
+ * Does the job of lemlib::Buffer and lemlib::bufferedStdout(), but messages are formatted into
+ * a stack buffer and copied into a ByteRing instead of a std::deque<std::string> behind a
+ * pros::Mutex. A background task writes the ring out at a fixed rate. When the output can't
+ * keep up, new messages are dropped and counted rather than making the logging task wait.
+ *
+ * Each logger takes messages from one task. Give every task that logs its own logger.
+ *
+ * @b Example
+ * @code {.cpp}
+ * RingLogger poseLog;
+ * poseLog.start();
+ * poseLog.print("pose {:.2f} {:.2f} {:.2f}\n", pose.x, pose.y, pose.theta);
+ * @endcode
+ */
+class RingLogger {
+    public:
+        /**
+         * @brief Bytes that can wait to be written
+         */
+        static constexpr std::size_t CAPACITY = 4096;
+        /**
+         * @brief Longest message, longer ones are cut off
+         */
+        static constexpr std::size_t MAX_MESSAGE = 256;
+
+        /**
+         * @brief Construct a new RingLogger. Nothing is written until start()
+         *
+         * @param out where messages go, stdout by default
+         * @param rate ms between writes
+         */
+        RingLogger(std::FILE* out = stdout, std::uint32_t rate = 10);
+
+        RingLogger(const RingLogger&) = delete;
+        RingLogger& operator=(const RingLogger&) = delete;
+
+        /**
+         * @brief Start the task that writes messages out
+         */
+        void start();
+
+        /**
+         * @brief Format a message and queue it. Never allocates or blocks
+         *
+         * @param format fmt format string, use "{}" as placeholders
+         * @param args values substituted into the placeholders
+         * @return false if the message was dropped because the queue is full
+         */
+        template <typename... T> bool print(fmt::format_string<T...> format, T&&... args) {
+            char message[MAX_MESSAGE];
+            const auto result = fmt::format_to_n(message, sizeof(message), format, std::forward<T>(args)...);
+            return write(message, result.size < sizeof(message) ? result.size : sizeof(message));
+        }
+
+        /**
+         * @brief Queue bytes as they are
+         *
+         * @return false if they were dropped because the queue is full
+         */
+        bool write(const char* data, std::size_t size);
+
+        /**
+         * @brief Write out everything queued so far. The task started by start() calls this
+         *
+         * @return number of bytes written
+         */
+        std::size_t flush();
+
+        /**
+         * @brief Messages dropped because the queue was full
+         */
+        std::uint32_t getDropped();
+
+        /**
+         * @brief Bytes written out so far
+         */
+        std::uint32_t getWritten();
+
+        /**
+         * @brief Most bytes that have been waiting at once
+         */
+        std::uint32_t getHighWater();
+    private:
+        ByteRing<CAPACITY> ring;
+        std::FILE* out;
+        std::uint32_t rate;
+        std::uint32_t written = 0;
+        pros::Task* task = nullptr;
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * Binary log of what the odometry sensors reported, for replaying matches off the robot.
+ *
+ * A log is a Header followed by one frame per sample.  Each frame is the time in ms followed
+ * by one 4 byte value per channel, in the order the channels are listed in the header.
+ * Everything is little endian, same as the brain.
+ */
+namespace sensorlog {
+
+constexpr char MAGIC[4] = {'S', 'L', 'O', 'G'};
+constexpr std::uint16_t VERSION = 1;
+constexpr int MAX_CHANNELS = 16;
+
+/**
+ * @brief What a channel holds
+ */
+enum class ChannelKind : std::uint8_t {
+    IMU_ROTATION = 0, // pros::Imu::get_rotation(), float degrees
+    ROTATION_POSITION = 1, // pros::Rotation::get_position(), int32 centidegrees
+    MOTOR_POSITION = 2 // pros::MotorGroup::get_position(i), float encoder units
+};
+
+/**
+ * @brief One sensor in the log
+ */
+struct Channel {
+        ChannelKind kind;
+        std::int8_t port; // negative if the device was constructed reversed
+        std::uint8_t units; // pros::MotorUnits for motors, 0 otherwise
+        std::uint8_t reserved;
+};
+
+/**
+ * @brief Start of every log file
+ */
+struct Header {
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t periodMs;
+        std::uint16_t channelCount;
+        std::uint16_t reserved;
+        Channel channels[MAX_CHANNELS];
+};
+
+/**
+ * @brief A single channel value. Which member is valid depends on the channel kind
+ */
+union Value {
+        float f;
+        std::int32_t i;
+};
+
+/**
+ * @brief Size of one frame on disk
+ *
+ * @param channelCount number of channels in the log
+ */
+constexpr int frameSize(int channelCount) { return 4 + 4 * channelCount; }
+
+/**
+ * @brief Records the odometry sensors to the SD card
+ *
+ * Sampling runs in its own task at a fixed rate and only copies readings into RAM. A second,
+ * low priority task drains RAM to the card, so a slow SD write never holds up sampling or the
+ * control loop. If the card falls more than BUFFER_FRAMES behind, new frames are dropped and
+ * counted instead of blocking.
+ *
+ * @b Example
+ * @code {.cpp}
+ * sensorlog::Recorder recorder("/usd/match.slog");
+ * recorder.addImu(&imu);
+ * recorder.addRotation(&horizontalEnc);
+ * recorder.addRotation(&verticalEnc);
+ * recorder.addMotors(&leftMotors);
+ * recorder.addMotors(&rightMotors);
+ * recorder.start();
+ * @endcode
+ */
+class Recorder {
+    public:
+        /**
+         * @brief Frames held in RAM while waiting for the card, 2.56 s at 100 Hz
+         */
+        static constexpr int BUFFER_FRAMES = 256;
+
+        /**
+         * @brief Construct a new Recorder. Nothing is opened until start()
+         *
+         * @param path file to write, on the SD card this starts with /usd/
+         * @param periodMs time between samples, 10 ms by default for 100 Hz
+         */
+        Recorder(const char* path, int periodMs = 10);
+
+        /**
+         * @brief Stops recording if it's still running
+         */
+        ~Recorder();
+
+        /**
+         * @brief Record an inertial sensor's rotation
+         *
+         * @return false if the recorder is full or already running
+         */
+        bool addImu(pros::Imu* imu);
+        /**
+         * @brief Record a rotation sensor's position
+         *
+         * @return false if the recorder is full or already running
+         */
+        bool addRotation(pros::Rotation* rotation);
+        /**
+         * @brief Record the position of every motor in a group, one channel per motor
+         *
+         * @return false if the recorder is full or already running
+         */
+        bool addMotors(pros::MotorGroup* motors);
+
+        /**
+         * @brief Open the file, write the header and start sampling
+         *
+         * @return false if the file couldn't be opened or the recorder is already running
+         */
+        bool start();
+        /**
+         * @brief Stop sampling, write out everything left in RAM and close the file
+         *
+         * Blocks until the file is closed.
+         */
+        void stop();
+        /**
+         * @brief Whether the recorder is sampling
+         */
+        bool isRunning();
+
+        /**
+         * @brief Frames written to the file so far
+         */
+        std::uint32_t getFramesWritten();
+        /**
+         * @brief Frames lost because the card fell too far behind
+         */
+        std::uint32_t getFramesDropped();
+    private:
+        struct Frame {
+                std::uint32_t time;
+                Value values[MAX_CHANNELS];
+        };
+
+        struct Source {
+                void* device;
+                std::uint8_t index; // motor within a group
+        };
+
+        void sampleLoop();
+        void writeLoop();
+        void sample(Frame& frame);
+        void drain();
+
+        const char* path;
+        int periodMs;
+        Header header = {};
+        Source sources[MAX_CHANNELS] = {};
+        std::FILE* file = nullptr;
+
+        // single producer (sampleLoop), single consumer (writeLoop)
+        Frame buffer[BUFFER_FRAMES];
+        std::atomic<std::uint32_t> head = 0;
+        std::atomic<std::uint32_t> tail = 0;
+
+        std::atomic<bool> running = false;
+        std::atomic<bool> writerDone = true;
+        std::atomic<std::uint32_t> framesWritten = 0;
+        std::atomic<std::uint32_t> framesDropped = 0;
+        pros::Task* sampler = nullptr;
+        pros::Task* writer = nullptr;
+};
+} // namespace sensorlog
@@ -4,7 +4,9 @@
 #include "pros/adi.hpp"
 #include "pros/motors.hpp"
 #include "lemlib/api.hpp"
+#include "pathChassis.hpp"
 #include "pros/optical.hpp"
+#include "actuatorArbiter.hpp"
 #include <atomic>
 
 extern std::atomic<bool> isRedTeam; // Atomic for thread safety
@@ -15,7 +17,7 @@ void selectBlueTeam();
 extern pros::Controller controller;
 extern pros::MotorGroup leftMotors;
 extern pros::MotorGroup rightMotors;
-extern lemlib::Chassis chassis;
+extern PathChassis chassis;
 extern pros::Motor intakeLow;
 extern pros::Motor intakeHigh;
 extern pros::Optical colorsort;
@@ -23,6 +25,13 @@ extern pros::Motor ladybrown;
 // extern pros::ADIDigitalOut doinker;
 extern pros::ADIDigitalOut mogoclamp;
 extern pros::ADIDigitalOut intakePiston;
+// command these instead of the devices, see main.cpp
+extern Actuator intakeLowActuator;
+extern Actuator intakeHighActuator;
+extern Actuator ladybrownActuator;
+extern Actuator intakePistonActuator;
+extern Actuator mogoclampActuator;
+extern ActuatorArbiter actuators;
 
 void initializeSubsystems();
 
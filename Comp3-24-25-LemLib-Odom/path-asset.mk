@@ -0,0 +1,55 @@
+# Packs every static/*.txt path into a binary static/<name>.path asset, see include/packedPath.hpp.
+# Use it with ASSET(<name>_path). The packer is a small host program built from the path sources
+# alone, so building the robot needs a host C++ compiler as well as the ARM one, see the README.
+#
+# The Makefile includes this after common.mk, on purpose outside firmware/ where common.mk would
+# pick it up before the link rules it adds to exist
+ifndef HOT_ELF
+$(error path-asset.mk has to be included after common.mk)
+endif
+
+SIM_DIR?=../Sim
+# common.mk's CXX is the ARM one
+HOST_CXX?=c++
+PATH_PACK=$(BINDIR)/host/path_pack
+# only what packing needs, none of the simulator, so it builds with any C++17 compiler
+PATH_PACK_SRC=$(SIM_DIR)/apps/path_pack.cpp $(SIM_DIR)/src/path.cpp src/packedPath.cpp src/pathProfile.cpp
+PATH_PACK_HEADERS=$(SIM_DIR)/include/sim/path.hpp include/packedPath.hpp include/pathProfile.hpp include/lemlib/asset.hpp
+# time-optimal speeds for the drivetrain instead of the ones in the text, see include/pathProfile.hpp:
+# wheel speed at full power (in/s, 450 rpm on 2.75" is 65 unloaded), acceleration, deceleration,
+# lateral acceleration before the omnis slide (in/s^2), track width (in) and the sharpest turn pure
+# pursuit drives with a 15" lookahead (1/in). Deceleration is lower than acceleration because the
+# wheels lag the speed pure pursuit asks for, so braking at 150 overshoots the end on Sim's drive model.
+PATH_PROFILE?=--profile 60 150 80 150 13.5 0.13
+# Paths that get it, by name, e.g. PATH_PROFILED=example for the Ramsete example, since
+# followTrajectory needs a profile. None by default: on Sim's drive model pure pursuit strays further
+# off red_negative at the profile's speeds than at the text's, see Sim's profile_check. Run make
+# clean after changing this, the assets don't know which speeds they were packed with
+PATH_PROFILED?=
+
+PATH_FILES=$(patsubst static/%.txt,$(BINDIR)/static/%.path,$(wildcard static/*.txt))
+PATH_OBJ=$(addsuffix .o,$(PATH_FILES))
+
+# the link rules' prerequisites are already expanded, so add the assets to them directly. The hot
+# link takes its objects from the prerequisites and the monolith one from ELF_DEPS
+ELF_DEPS+=$(PATH_OBJ)
+$(HOT_ELF) $(MONOLITH_ELF): $(PATH_OBJ)
+
+# rebuilt whenever the format or the profile changes, so an old packer never writes assets the
+# robot can't read
+$(PATH_PACK): $(PATH_PACK_SRC) $(PATH_PACK_HEADERS)
+	$(VV)mkdir -p $(dir $@)
+	@echo "HOST $@"
+	$(VV)$(HOST_CXX) -std=c++17 -O2 -I$(SIM_DIR)/include -Iinclude $(PATH_PACK_SRC) -o $@
+
+$(BINDIR)/static/%.path: static/%.txt $(PATH_PACK)
+	$(VV)mkdir -p $(BINDIR)/static
+	@echo "PATH $@"
+	$(VV)$(PATH_PACK) $(if $(filter $*,$(PATH_PROFILED)),$(PATH_PROFILE)) $< $@
+
+# built from inside bin so the symbols come out as _binary_static_<name>_path, and aligned so
+# the points can be read in place
+$(PATH_OBJ): %.path.o: %.path
+	@echo "ASSET $@"
+	$(VV)cd $(BINDIR) && $(OBJCOPY) -I binary -O elf32-littlearm -B arm --set-section-alignment .data=4 \
+		$(patsubst $(BINDIR)/%,%,$<) $(patsubst $(BINDIR)/%,%,$@)
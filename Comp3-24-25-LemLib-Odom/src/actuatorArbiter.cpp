@@ -0,0 +1,123 @@
+#include "actuatorArbiter.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+// a command is its kind in the low byte, a velocity in the next 16 bits and a float value in the
+// top 32, so a slot is one word the V5's processor loads and stores whole
+enum Kind : std::uint64_t { EMPTY = 0, VOLTAGE = 1, ABSOLUTE = 2, PISTON = 3 };
+// never a command, so the first resolve writes whatever wins
+constexpr std::uint64_t NOTHING_WRITTEN = ~std::uint64_t(0);
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "slots have to be lock free");
+
+std::uint64_t pack(Kind kind, int velocity, float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return kind | std::uint64_t(std::uint16_t(velocity)) << 8 | std::uint64_t(bits) << 32;
+}
+
+Kind kindOf(std::uint64_t command) { return Kind(command & 0xff); }
+
+int velocityOf(std::uint64_t command) { return std::uint16_t(command >> 8); }
+
+float valueOf(std::uint64_t command) {
+    const std::uint32_t bits = command >> 32;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+} // namespace
+
+Actuator::Actuator(const char* name, pros::Motor& motor)
+    : motor(&motor),
+      written(NOTHING_WRITTEN) {
+    std::strncpy(this->name, name, MAX_NAME);
+    this->name[MAX_NAME] = '\0';
+}
+
+Actuator::Actuator(const char* name, pros::adi::DigitalOut& piston)
+    : piston(&piston),
+      written(NOTHING_WRITTEN) {
+    std::strncpy(this->name, name, MAX_NAME);
+    this->name[MAX_NAME] = '\0';
+}
+
+void Actuator::move(CommandSource source, int voltage) { post(source, pack(VOLTAGE, 0, std::clamp(voltage, -127, 127))); }
+
+void Actuator::moveAbsolute(CommandSource source, double position, int velocity) {
+    // the sign of the velocity does nothing, same as for move_absolute()
+    post(source, pack(ABSOLUTE, std::min(std::abs(velocity), 600), position));
+}
+
+void Actuator::moveRelative(CommandSource source, double position, int velocity) {
+    moveAbsolute(source, motor->get_position() + position, velocity);
+}
+
+void Actuator::set(CommandSource source, bool extended) { post(source, pack(PISTON, 0, extended)); }
+
+void Actuator::release(CommandSource source) { post(source, EMPTY); }
+
+void Actuator::post(CommandSource source, std::uint64_t command) {
+    requests.fetch_add(1, std::memory_order_relaxed);
+    const std::uint64_t previous = slots[int(source)].exchange(command, std::memory_order_release);
+    if (previous == command) redundant.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Actuator::apply() {
+    std::uint64_t command = EMPTY;
+    int from = -1;
+    for (int source = SOURCES - 1; source >= 0 && from < 0; source--) {
+        command = slots[source].load(std::memory_order_acquire);
+        if (kindOf(command) != EMPTY) from = source;
+    }
+    owner.store(from, std::memory_order_relaxed);
+    if (from < 0) {
+        // nobody wants the piston anywhere in particular, so it stays put
+        if (piston) return;
+        command = pack(VOLTAGE, 0, 0);
+    }
+    if (command == written) return;
+    written = command;
+    writes.fetch_add(1, std::memory_order_relaxed);
+
+    switch (kindOf(command)) {
+        case VOLTAGE: motor->move(std::int32_t(valueOf(command))); break;
+        case ABSOLUTE: motor->move_absolute(valueOf(command), velocityOf(command)); break;
+        case PISTON: piston->set_value(valueOf(command) != 0); break;
+        default: break;
+    }
+}
+
+int Actuator::getOwner() const { return owner.load(std::memory_order_relaxed); }
+
+Actuator::Stats Actuator::getStats() const {
+    return {requests.load(std::memory_order_relaxed), redundant.load(std::memory_order_relaxed),
+            writes.load(std::memory_order_relaxed)};
+}
+
+const char* Actuator::getName() const { return name; }
+
+bool ActuatorArbiter::add(Actuator* actuator) {
+    const int index = actuatorCount.load();
+    if (index >= MAX_ACTUATORS) return false;
+    actuators[index] = actuator;
+    actuatorCount.store(index + 1);
+    return true;
+}
+
+void ActuatorArbiter::resolve() {
+    const int n = actuatorCount.load();
+    for (int i = 0; i < n; i++) actuators[i]->apply();
+}
+
+void ActuatorArbiter::release(CommandSource source) {
+    const int n = actuatorCount.load();
+    for (int i = 0; i < n; i++) actuators[i]->release(source);
+}
+
+int ActuatorArbiter::count() const { return actuatorCount.load(); }
+
+Actuator* ActuatorArbiter::get(int index) const { return index >= 0 && index < count() ? actuators[index] : nullptr; }
@@ -7,6 +7,8 @@
 // get a path used for pure pursuit
 // in the static folder 
 ASSET(example_txt); // '.' replaced with "_" to make c++ happy 
+// the same path packed at build time by path-asset.mk, nothing to parse at runtime
+ASSET(example_path);
 // void example_drive(){
 //     selectBlueTeam();
 //     chassis.moveToPoint(0, 10, 4000);
@@ -56,7 +58,7 @@ void auton_example() {
     // Follow the path in path.txt. Lookahead at 15, Timeout set to 4000
     // following the path with the back of the robot (forwards = false)
     // see line 116 to see how to define a path
-    chassis.follow(example_txt, 15, 4000, false);
+    chassis.follow(packedpath::Path(example_path), 15, 4000, false);
     // wait until the chassis has traveled 10 inches. Otherwise the code directly after
     // the movement will run immediately
     // Unless its another movement, in which case it will wait
@@ -65,6 +67,11 @@ void auton_example() {
     // wait until the movement is done
     chassis.waitUntilDone();
     pros::lcd::print(4, "pure pursuit finished!");
+    // Follow the same path with Ramsete, at the speeds its time profile gives. Timeout set to 4000
+    // Build with PATH_PROFILED=example so the path has a profile
+    // Stays on the path through the turns instead of cutting them like pure pursuit
+    chassis.followTrajectory(packedpath::Path(example_path), 4000, false);
+    chassis.waitUntilDone();
 }
 
 // Initialize autonomous selection
@@ -0,0 +1,179 @@
+#include "binaryTelemetry.hpp"
+
+#include <cstring>
+
+namespace telemetry {
+
+std::size_t cobsEncode(const std::uint8_t* in, std::size_t size, std::uint8_t* out) {
+    // each code byte says how far it is to the next 0, which gets dropped
+    std::size_t code = 0;
+    std::size_t o = 1;
+    for (std::size_t i = 0; i < size; i++) {
+        if (in[i] != 0) out[o++] = in[i];
+        if (in[i] == 0 || o - code == 0xFF) {
+            out[code] = o - code;
+            code = o++;
+        }
+    }
+    out[code] = o - code;
+    return o;
+}
+
+int cobsDecode(const std::uint8_t* in, std::size_t size, std::uint8_t* out) {
+    std::size_t o = 0;
+    std::size_t i = 0;
+    while (i < size) {
+        const std::uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > size) return -1;
+        for (std::uint8_t j = 1; j < code; j++) {
+            if (in[i] == 0) return -1;
+            out[o++] = in[i++];
+        }
+        // a full block of 254 has no 0 after it, and neither does the last block
+        if (code != 0xFF && i < size) out[o++] = 0;
+    }
+    return o;
+}
+
+namespace {
+
+// crc of every byte on its own, so each byte of a record is one lookup instead of eight shifts
+struct Crc8Table {
+        std::uint8_t entries[256];
+
+        constexpr Crc8Table()
+            : entries() {
+            for (int i = 0; i < 256; i++) {
+                std::uint8_t crc = i;
+                for (int bit = 0; bit < 8; bit++) crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+                entries[i] = crc;
+            }
+        }
+};
+
+constexpr Crc8Table CRC8_TABLE;
+
+} // namespace
+
+std::uint8_t crc8(const std::uint8_t* data, std::size_t size) {
+    std::uint8_t crc = 0;
+    for (std::size_t i = 0; i < size; i++) crc = CRC8_TABLE.entries[crc ^ data[i]];
+    return crc;
+}
+
+namespace {
+
+// finish a record with its crc, encode it and end it with the 0 delimiter
+std::size_t frame(std::uint8_t* record, std::size_t size, std::uint8_t* out) {
+    record[size] = crc8(record, size);
+    std::size_t encoded = cobsEncode(record, size + 1, out);
+    out[encoded] = 0;
+    return encoded + 1;
+}
+
+} // namespace
+
+BinarySink::BinarySink(std::FILE* out, std::uint32_t rate, std::uint32_t schemaPeriod)
+    : out(out),
+      rate(rate),
+      schemaPeriod(schemaPeriod) {}
+
+int BinarySink::addChannel(const char* name, std::initializer_list<const char*> fields) {
+    if (task != nullptr || channelCount >= MAX_CHANNELS || fields.size() > MAX_FIELDS) return -1;
+    if (std::strlen(name) > MAX_NAME) return -1;
+    for (const char* field : fields)
+        if (std::strlen(field) > MAX_NAME) return -1;
+    Channel& channel = channels[channelCount];
+    std::strcpy(channel.name, name);
+    channel.fieldCount = 0;
+    for (const char* field : fields) std::strcpy(channel.fields[channel.fieldCount++], field);
+    return channelCount++;
+}
+
+void BinarySink::start() {
+    if (task != nullptr) return;
+    written += writeSchema();
+    lastSchema = pros::millis();
+    // below the control loops, telemetry only gets what time is left over
+    task = new pros::Task(
+        [this] {
+            std::uint32_t now = pros::millis();
+            while (true) {
+                flush();
+                pros::Task::delay_until(&now, rate);
+            }
+        },
+        TASK_PRIORITY_DEFAULT - 1, TASK_STACK_DEPTH_DEFAULT, "binary telemetry");
+}
+
+bool BinarySink::log(int channel, std::initializer_list<float> values) {
+    return log(channel, pros::millis(), values.begin(), values.size());
+}
+
+bool BinarySink::log(int channel, std::uint32_t time, const float* values, int count) {
+    if (channel < 0 || channel >= channelCount || count != channels[channel].fieldCount) return false;
+    std::uint8_t record[1 + 1 + 4 + 4 * MAX_FIELDS + 1];
+    record[0] = (std::uint8_t)RecordType::DATA;
+    record[1] = channel;
+    std::memcpy(record + 2, &time, 4);
+    std::memcpy(record + 6, values, 4 * count);
+    std::uint8_t encoded[cobsMaxSize(sizeof(record)) + 1];
+    return ring.write(encoded, frame(record, 6 + 4 * count, encoded));
+}
+
+std::size_t BinarySink::writeSchema() {
+    std::size_t total = std::fwrite("", 1, 1, out);
+    for (int id = 0; id < channelCount; id++) {
+        const Channel& channel = channels[id];
+        std::uint8_t record[MAX_RECORD];
+        std::size_t size = 0;
+        record[size++] = (std::uint8_t)RecordType::SCHEMA;
+        record[size++] = VERSION;
+        record[size++] = id;
+        record[size++] = channel.fieldCount;
+        std::size_t length = std::strlen(channel.name) + 1;
+        std::memcpy(record + size, channel.name, length);
+        size += length;
+        for (int f = 0; f < channel.fieldCount; f++) {
+            length = std::strlen(channel.fields[f]) + 1;
+            std::memcpy(record + size, channel.fields[f], length);
+            size += length;
+        }
+        std::uint8_t encoded[cobsMaxSize(MAX_RECORD) + 1];
+        total += std::fwrite(encoded, 1, frame(record, size, encoded), out);
+    }
+    return total;
+}
+
+std::size_t BinarySink::flush() {
+    // only what's queued now, so a busy logger can't keep this going forever. Records are
+    // queued whole, so once this is written out the stream is between records
+    std::size_t remaining = ring.size();
+    std::size_t total = 0;
+    // anything else printed to out since the last flush ends here instead of running into the
+    // first record
+    if (remaining > 0) total += std::fwrite("", 1, 1, out);
+    while (remaining > 0) {
+        const std::uint8_t* data;
+        std::size_t size = ring.peek(&data);
+        if (size > remaining) size = remaining;
+        std::fwrite(data, 1, size, out);
+        ring.consume(size);
+        remaining -= size;
+        total += size;
+    }
+    if (schemaPeriod > 0 && pros::millis() - lastSchema >= schemaPeriod) {
+        total += writeSchema();
+        lastSchema = pros::millis();
+    }
+    if (total > 0) std::fflush(out);
+    written += total;
+    return total;
+}
+
+std::uint32_t BinarySink::getDropped() { return ring.getDroppedMessages(); }
+
+std::uint32_t BinarySink::getWritten() { return written; }
+
+std::uint32_t BinarySink::getHighWater() { return ring.getHighWater(); }
+} // namespace telemetry
@@ -0,0 +1,56 @@
+#include "fusedPose.hpp"
+
+FusedPose::FusedPose(const Sensors& sensors, PoseFilter::Noise noise)
+    : sensors(sensors),
+      filter(noise) {}
+
+void FusedPose::setPose(float x, float y, float theta) {
+    sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    setX.store(x, std::memory_order_relaxed);
+    setY.store(y, std::memory_order_relaxed);
+    setTheta.store(theta, std::memory_order_relaxed);
+    sequence.fetch_add(1, std::memory_order_release);
+}
+
+bool FusedPose::update(const Reading& reading, float dt) {
+    const std::uint32_t posted = sequence.load(std::memory_order_acquire);
+    // a pose half written is picked up next tick
+    if (posted != seen && posted % 2 == 0) {
+        const float x = setX.load(std::memory_order_relaxed);
+        const float y = setY.load(std::memory_order_relaxed);
+        const float theta = setTheta.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == posted) {
+            seen = posted;
+            headingOffset = theta - reading.heading;
+            // the first pose starts the filter, later ones can come mid move and keep its velocities
+            if (resets.fetch_add(1, std::memory_order_relaxed) == 0) filter.reset(x, y, theta);
+            else filter.setPose(x, y, theta);
+            last = reading;
+            return true;
+        }
+    }
+
+    filter.predict(dt);
+    filter.updateVerticalWheel((reading.vertical - last.vertical) / dt, sensors.verticalOffset, sensors.trackerStd);
+    filter.updateHorizontalWheel((reading.horizontal - last.horizontal) / dt, sensors.horizontalOffset, sensors.trackerStd);
+    filter.updateVerticalWheel((reading.left - last.left) / dt, sensors.leftOffset, sensors.driveStd);
+    filter.updateVerticalWheel((reading.right - last.right) / dt, sensors.rightOffset, sensors.driveStd);
+    filter.updateHeading(reading.heading + headingOffset, sensors.headingStd);
+    filter.updateTurnRate(reading.turnRate, sensors.turnRateStd);
+    last = reading;
+    return false;
+}
+
+void FusedPose::getPose(float& x, float& y, float& theta) const {
+    x = filter.getX();
+    y = filter.getY();
+    theta = filter.getTheta();
+}
+
+void FusedPose::getAhead(float seconds, float& x, float& y, float& theta) const { filter.getAhead(seconds, x, y, theta); }
+
+std::uint32_t FusedPose::getResets() const { return resets.load(std::memory_order_relaxed); }
+
+const PoseFilter& FusedPose::getFilter() const { return filter; }
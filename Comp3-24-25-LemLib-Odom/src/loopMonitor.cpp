@@ -0,0 +1,176 @@
+#include "loopMonitor.hpp"
+
+#include <cstring>
+
+#include "liblvgl/llemu.hpp"
+#include "pros/llemu.hpp"
+
+namespace {
+// painted into the unused stack, anything else there has been written by the task
+constexpr std::uint32_t STACK_PATTERN = 0xa5a5a5a5;
+// bytes left alone just below start(), for its own frame
+constexpr std::uint32_t STACK_GUARD = 512;
+// bytes the kernel's task entry, pros::Task's wrapper and spawn()'s lambda can take above
+// markStackTop(). The stack's base is at least this far above where it says the task started
+// less the stack size, so painting never goes below it
+constexpr std::uint32_t STACK_ENTRY = 512;
+
+// lines on the brain screen LLEMU prints to
+constexpr int SCREEN_LINES = 8;
+
+LoopMonitor* monitors[LoopMonitor::MAX_MONITORS] = {};
+std::atomic<int> monitorCount = 0;
+
+// only the loop's task writes these, so the largest doesn't need a compare exchange
+void raise(std::atomic<std::uint32_t>& largest, std::uint32_t value) {
+    if (value > largest.load(std::memory_order_relaxed)) largest.store(value, std::memory_order_relaxed);
+}
+} // namespace
+
+LoopMonitor::LoopMonitor(const char* name, std::uint32_t period, std::uint32_t deadline, std::uint32_t stackWords)
+    : period(period),
+      deadline(deadline > 0 ? deadline : (period + 1) / 2),
+      stackBytes(stackWords * 4) {
+    std::strncpy(this->name, name, MAX_NAME);
+    this->name[MAX_NAME] = '\0';
+}
+
+void LoopMonitor::markStackTop() {
+    std::uint32_t marker = 0;
+    stackTop = reinterpret_cast<std::uintptr_t>(&marker);
+}
+
+void LoopMonitor::start() {
+    if (started.exchange(true)) {
+        reset();
+        return;
+    }
+    // the stack grows down from here, and everything below is free until the loop uses it, down
+    // to the base of the stack spawn() made
+    std::uint32_t marker = 0;
+    const std::uintptr_t here = reinterpret_cast<std::uintptr_t>(&marker) & ~std::uintptr_t(3);
+    const std::uintptr_t base = (stackTop - stackBytes + STACK_ENTRY + 3) & ~std::uintptr_t(3);
+    if (stackTop != 0 && here <= stackTop && stackTop - here + STACK_ENTRY + STACK_GUARD < stackBytes) {
+        stackHigh = reinterpret_cast<volatile std::uint32_t*>(here - STACK_GUARD);
+        stackLow = reinterpret_cast<volatile std::uint32_t*>(base);
+        for (volatile std::uint32_t* word = stackLow; word < stackHigh; word++) *word = STACK_PATTERN;
+    }
+    const int index = monitorCount.fetch_add(1);
+    if (index < MAX_MONITORS) monitors[index] = this;
+    else monitorCount.store(MAX_MONITORS);
+    reset();
+}
+
+void LoopMonitor::begin() {
+    const std::uint64_t now = pros::micros();
+    if (!fresh.load(std::memory_order_relaxed)) {
+        const std::uint32_t took = now - lastBegin;
+        const int bucket = took / 1000 < BUCKETS - 1 ? took / 1000 : BUCKETS - 1;
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        passes.fetch_add(1, std::memory_order_relaxed);
+        periodTotal.fetch_add(took, std::memory_order_relaxed);
+        raise(periodMax, took);
+        const std::uint32_t late = took > period * 1000 ? took - period * 1000 : 0;
+        raise(lateMax, late);
+        if (late > deadline * 1000) misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    fresh.store(false, std::memory_order_relaxed);
+    lastBegin = now;
+    passBegin = now;
+}
+
+void LoopMonitor::end() {
+    const std::uint32_t took = pros::micros() - passBegin;
+    busyTotal.fetch_add(took, std::memory_order_relaxed);
+    raise(busyMax, took);
+}
+
+void LoopMonitor::delay(std::uint32_t ms) {
+    end();
+    pros::delay(ms);
+}
+
+void LoopMonitor::delayUntil(std::uint32_t* previous, std::uint32_t ms) {
+    end();
+    pros::Task::delay_until(previous, ms);
+}
+
+void LoopMonitor::reset() {
+    for (std::atomic<std::uint32_t>& bucket : buckets) bucket.store(0);
+    passes.store(0);
+    periodTotal.store(0);
+    periodMax.store(0);
+    lateMax.store(0);
+    misses.store(0);
+    busyTotal.store(0);
+    busyMax.store(0);
+    since.store(pros::micros());
+    fresh.store(true);
+}
+
+LoopMonitor::Stats LoopMonitor::getStats() const {
+    Stats s;
+    s.passes = passes.load();
+    s.periodMean = s.passes > 0 ? periodTotal.load() / 1000.0f / s.passes : 0;
+    s.periodMax = periodMax.load() / 1000;
+    s.lateMax = lateMax.load() / 1000;
+    s.misses = misses.load();
+    const std::uint64_t elapsed = pros::micros() - since.load();
+    s.busyPercent = elapsed > 0 ? 100.0f * busyTotal.load() / elapsed : 0;
+    s.busyMax = busyMax.load();
+    s.stackFree = getStackFree();
+    return s;
+}
+
+std::uint32_t LoopMonitor::getBucket(int bucket) const {
+    return bucket >= 0 && bucket < BUCKETS ? buckets[bucket].load(std::memory_order_relaxed) : 0;
+}
+
+const char* LoopMonitor::getName() const { return name; }
+
+std::uint32_t LoopMonitor::getPeriod() const { return period; }
+
+std::int32_t LoopMonitor::getStackFree() const {
+    if (stackLow == nullptr) return -1;
+    volatile std::uint32_t* word = stackLow;
+    while (word < stackHigh && *word == STACK_PATTERN) word++;
+    return (word - stackLow) * 4;
+}
+
+int LoopMonitor::count() { return monitorCount.load(); }
+
+LoopMonitor* LoopMonitor::get(int index) { return index >= 0 && index < count() ? monitors[index] : nullptr; }
+
+void printLoopStats(int firstLine, int page) {
+    const int lines = SCREEN_LINES - firstLine;
+    if (lines <= 0 || LoopMonitor::count() == 0) return;
+    const int pages = (LoopMonitor::count() + lines - 1) / lines;
+    const int first = (page % pages + pages) % pages * lines;
+    for (int line = 0; line < lines; line++) {
+        const LoopMonitor* monitor = LoopMonitor::get(first + line);
+        // the last page can be short, and shouldn't leave the page before it showing under it
+        if (monitor == nullptr) {
+            pros::lcd::clear_line(firstLine + line);
+            continue;
+        }
+        const LoopMonitor::Stats s = monitor->getStats();
+        pros::lcd::print(firstLine + line, "%-8s %4.1f/%-3lu max %3lu miss %-4lu %3.0f%% stk %ld", monitor->getName(),
+                         s.periodMean, (unsigned long)monitor->getPeriod(), (unsigned long)s.periodMax,
+                         (unsigned long)s.misses, s.busyPercent, (long)s.stackFree);
+    }
+}
+
+void addLoopChannels(telemetry::BinarySink& sink, LoopMonitor* const* monitors, int count, int* channels) {
+    for (int i = 0; i < count; i++) {
+        char channel[telemetry::MAX_NAME + 1];
+        std::snprintf(channel, sizeof(channel), "loop %s", monitors[i]->getName());
+        channels[i] = sink.addChannel(channel, {"periodMean", "periodMax", "lateMax", "misses", "busyPercent", "stackFree"});
+    }
+}
+
+void logLoopStats(telemetry::BinarySink& sink, LoopMonitor* const* monitors, int count, const int* channels) {
+    for (int i = 0; i < count; i++) {
+        const LoopMonitor::Stats s = monitors[i]->getStats();
+        sink.log(channels[i], {s.periodMean, (float)s.periodMax, (float)s.lateMax, (float)s.misses, s.busyPercent, (float)s.stackFree});
+    }
+}
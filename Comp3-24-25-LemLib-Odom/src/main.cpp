@@ -8,6 +8,13 @@
 #include <atomic>
 #include "autons.hpp"
 #include "subsystems.hpp"
+#include "sensorLog.hpp"
+#include "ringLogger.hpp"
+#include "binaryTelemetry.hpp"
+#include "loopMonitor.hpp"
+#include "fusedPose.hpp"
+#include "actuatorArbiter.hpp"
+#include "pros/apix.h"
 
 //electronics variables
 bool isClamp = false;
@@ -19,6 +26,8 @@ bool doinkerLatch = false;
 bool isIntakePiston = false;
 bool intakePistonLatch = false;
 
+bool outtakeLatch = false;
+
 int currentPositionIndex = 0;
 
 const int lbDown = 0;
@@ -26,7 +35,7 @@ const int lbMid = 420;
 const int lbScore = 2000;
 const int positions[] = {lbDown, lbMid, lbScore};
 
-bool isColorSortEnabled = true;  // Start enabled by default
+std::atomic<bool> isColorSortEnabled(true);  // Start enabled by default, the sorting task reads it
 std::atomic<bool> isRedTeam(true); // Atomic for thread safety
 pros::Task* colorSortTask = nullptr;
 
@@ -92,7 +101,47 @@ lemlib::OdomSensors sensors(&vertical, // vertical tracking wheel
 
 
 // create the chassis
-lemlib::Chassis chassis(drivetrain, linearController, angularController, sensors);
+PathChassis chassis(drivetrain, linearController, angularController, sensors);
+// motor power for a wheel velocity (in/s) and acceleration (in/s^2) in followTrajectory. These are
+// what this drivetrain's model in Sim works out, measure the real robot's to replace them
+const packedpath::WheelFeedforward driveFeedforward = {.kS = 9.52, .kV = 1.960, .kA = 0.274};
+
+// records the odometry sensors for replaying on a computer, see Sim/replay
+sensorlog::Recorder odomRecorder("/usd/odom.slog");
+// pose telemetry from the screen task, never allocates or waits on a lock
+RingLogger poseLog;
+// send telemetry as binary records instead of text, decode captures with Sim/apps/telemetry_decode
+const bool binaryTelemetryEnabled = false;
+telemetry::BinarySink binaryTelemetry;
+int poseChannel = -1;
+int driveChannel = -1;
+
+// how each task's loop really runs, on the brain screen under the pose and in telemetry every second
+LoopMonitor sortingMonitor("sorting", 10);
+LoopMonitor fusedOdomMonitor("fused odom", 10);
+LoopMonitor screenMonitor("screen", 50);
+LoopMonitor driverMonitor("opcontrol", 10); // in PROS' own task, so its stack isn't measured
+LoopMonitor actuatorMonitor("actuators", 10);
+LoopMonitor* const loopMonitors[] = {&sortingMonitor, &fusedOdomMonitor, &screenMonitor, &driverMonitor, &actuatorMonitor};
+const int LOOP_MONITORS = sizeof(loopMonitors) / sizeof(loopMonitors[0]);
+int loopChannels[LOOP_MONITORS];
+
+// fuse the trackers, drive encoders and imu into the chassis pose, ignoring whichever one slips.
+// Sim/apps/filter_bench compares it with plain odometry on a recorded goal rush
+const bool fusedOdomEnabled = false;
+// drive sides read like tracking wheels, only the pose filter uses them
+lemlib::TrackingWheel leftSide(&leftMotors, lemlib::Omniwheel::NEW_275, -6.75, 450);
+lemlib::TrackingWheel rightSide(&rightMotors, lemlib::Omniwheel::NEW_275, 6.75, 450);
+// chassis.setPose() starts it over, so autons set the pose the same way with or without it.
+// How far each sensor's velocity can be off when it isn't slipping, inches or radians per second
+FusedPose fusedPose({.verticalOffset = vertical.getOffset(),
+                     .horizontalOffset = horizontal.getOffset(),
+                     .leftOffset = leftSide.getOffset(),
+                     .rightOffset = rightSide.getOffset(),
+                     .trackerStd = 1,
+                     .driveStd = 3,
+                     .headingStd = 0.003, // radians
+                     .turnRateStd = 0.05});
 
 pros::Motor intakeLow(-4);
 pros::Motor intakeHigh(-5);
@@ -105,6 +154,15 @@ pros::Motor ladybrown(16);
 pros::ADIDigitalOut intakePiston('B');
 pros::ADIDigitalOut mogoclamp('C');
 
+// opcontrol, autons and the sorting task all command these, never the devices above. The
+// actuators task writes whichever command wins once a tick, and only when it changes
+Actuator intakeLowActuator("intakeLow", intakeLow);
+Actuator intakeHighActuator("intakeHigh", intakeHigh);
+Actuator ladybrownActuator("ladybrown", ladybrown);
+Actuator intakePistonActuator("intakePiston", intakePiston);
+Actuator mogoclampActuator("mogoclamp", mogoclamp);
+ActuatorArbiter actuators;
+
 //use these with the autons selector
 void selectRedTeam() {
     isRedTeam.store(true);
@@ -115,38 +173,66 @@ void selectBlueTeam() {
     isRedTeam.store(false);
 }
 
+// hook travel in degrees that flings a wrong ring, what 200 ms at full speed used to do
+const double EJECT_TRAVEL = 240;
+// give up on an eject after this long in case the hooks are jammed
+const std::uint32_t EJECT_TIMEOUT = 400;
+// then hold the hooks stopped this long, over the driver or auton, since the sudden stop is what
+// throws the ring off
+const std::uint32_t EJECT_STOP = 100;
+
 void sorting() {
+    // ejects run off where the hooks have got to instead of a delay, so the sensor keeps being
+    // read and the eject ends on time whatever speed the hooks are going
+    bool ejecting = false;
+    bool stopping = false;
+    bool ringPresent = false;
+    double ejectStart = 0;
+    std::uint32_t ejectStartTime = 0;
+    std::uint32_t stopStartTime = 0;
+    sortingMonitor.start();
     while (true) {
-        if (isColorSortEnabled) {
+        sortingMonitor.begin();
+        const std::uint32_t now = pros::millis();
+        if (isColorSortEnabled.load()) {
             auto values = colorsort.get_rgb();
             bool bad_ring_detected;
-            
+
             if (isRedTeam.load()) {  // check team color multithread
                 bad_ring_detected = values.blue > 220 && values.red < 220; //red team
-                if (bad_ring_detected) {
-                    intakeHigh.move(127); // Fling off wrong color
-                    pros::delay(200);
-                    intakeHigh.move(0);
-                }
-            } 
+            }
             else {
                 bad_ring_detected = values.blue < 220 && values.red > 220; //blue team
-                if (bad_ring_detected) {
-                    intakeHigh.move(127); // Fling off wrong color
-                    pros::delay(200);
-                    intakeHigh.move(0);
-                }
             }
-            
+            // only once per ring, it stays in front of the sensor for a few reads
+            if (bad_ring_detected && !ringPresent && !ejecting && !stopping) {
+                intakeHighActuator.move(CommandSource::Sort, 127); // Fling off wrong color, over whatever else wants the hooks
+                ejecting = true;
+                ejectStart = intakeHigh.get_position();
+                ejectStartTime = now;
+            }
+            ringPresent = bad_ring_detected;
+
             // Update LED based on sorting status
             colorsort.set_led_pwm(100); //if color sort on then led on
-        } 
+        }
         else {
             // Turn off LED when sorting is disabled
             colorsort.set_led_pwm(0);
         }
-        
-        pros::delay(20); // Small delay to prevent killing our CPU
+
+        if (ejecting && (intakeHigh.get_position() - ejectStart >= EJECT_TRAVEL || now - ejectStartTime >= EJECT_TIMEOUT)) {
+            intakeHighActuator.move(CommandSource::Sort, 0); // stop dead to throw the ring
+            ejecting = false;
+            stopping = true;
+            stopStartTime = now;
+        }
+        if (stopping && now - stopStartTime >= EJECT_STOP) {
+            intakeHighActuator.release(CommandSource::Sort); // back to the driver or auton
+            stopping = false;
+        }
+
+        sortingMonitor.delay(10);
     }
 }
 
@@ -154,6 +240,31 @@ void sorting() {
 
 
 
+// write the pose this far ahead so moves act on where the robot will be when their commands land,
+// seconds.  Motor command latency plus half the imu's update period, Sim/apps/latency_bench shows
+// what it buys.  Only the chassis pose leads: the filter keeps tracking the real pose and never
+// reads the chassis pose back, so the lead can't build on itself, see Sim/apps/fused_pose_check
+const float POSE_LEAD = 0.025;
+
+void fusedOdom() {
+    const lemlib::Pose start = chassis.getPose(true);
+    fusedPose.setPose(start.x, start.y, start.theta);
+    std::uint32_t now = pros::millis();
+    fusedOdomMonitor.start();
+    while (true) {
+        fusedOdomMonitor.delayUntil(&now, 10);
+        fusedOdomMonitor.begin();
+        fusedPose.update({vertical.getDistanceTraveled(), horizontal.getDistanceTraveled(), leftSide.getDistanceTraveled(),
+                          rightSide.getDistanceTraveled(), float(lemlib::degToRad(imu.get_rotation())),
+                          float(lemlib::degToRad(imu.get_gyro_rate().z))},
+                         0.01);
+        float x, y, theta;
+        fusedPose.getAhead(POSE_LEAD, x, y, theta);
+        // lemlib's setPose, chassis.setPose() would start the filter over from here
+        chassis.lemlib::Chassis::setPose(x, y, theta, true);
+    }
+}
+
 /**
  * Runs initialization code. This occurs as soon as the program is started.
  *
@@ -165,8 +276,38 @@ void sorting() {
 void initialize() {
     pros::lcd::initialize(); // initialize brain screen
     chassis.calibrate(); // calibrate sensors
+    chassis.setFeedforward(driveFeedforward);
+    // log odometry sensors at 100 Hz if there's an sd card
+    if (pros::usd::is_installed()) {
+        odomRecorder.addImu(&imu);
+        odomRecorder.addRotation(&horizontalEnc);
+        odomRecorder.addRotation(&verticalEnc);
+        odomRecorder.addMotors(&leftMotors);
+        odomRecorder.addMotors(&rightMotors);
+        odomRecorder.start();
+    }
+    if (fusedOdomEnabled) {
+        // above the motion task, so moves see this tick's pose
+        chassis.setFusedPose(&fusedPose);
+        fusedOdomMonitor.spawn(fusedOdom, TASK_PRIORITY_DEFAULT + 2);
+    }
+    // writes the actuators, above the tasks that command them so a tick's commands go out together
+    actuators.add(&intakeLowActuator);
+    actuators.add(&intakeHighActuator);
+    actuators.add(&ladybrownActuator);
+    actuators.add(&intakePistonActuator);
+    actuators.add(&mogoclampActuator);
+    actuatorMonitor.spawn([]() {
+        std::uint32_t now = pros::millis();
+        actuatorMonitor.start();
+        while (true) {
+            actuatorMonitor.begin();
+            actuators.resolve();
+            actuatorMonitor.delayUntil(&now, 10);
+        }
+    }, TASK_PRIORITY_DEFAULT + 1);
     // thread to for brain screen and position logging
-    colorSortTask = new pros::Task(sorting);
+    colorSortTask = new pros::Task(sortingMonitor.spawn(sorting));
     
     // AutonSelector::getInstance().init();    
     
@@ -178,17 +319,54 @@ void initialize() {
     //     }
     // });
 
-    pros::Task screenTask([&]() {
-        while (true) {
+    if (binaryTelemetryEnabled) {
+        // records have to reach the computer as they are, not wrapped in PROS' own streams
+        pros::c::serctl(SERCTL_DISABLE_COBS, nullptr);
+        poseChannel = binaryTelemetry.addChannel("pose", {"x", "y", "theta"});
+        driveChannel = binaryTelemetry.addChannel("drive", {"leftVelocity", "rightVelocity", "vertical", "horizontal"});
+        addLoopChannels(binaryTelemetry, loopMonitors, LOOP_MONITORS, loopChannels);
+        binaryTelemetry.start();
+    } else {
+        poseLog.start();
+    }
+    screenMonitor.spawn([&]() {
+        screenMonitor.start();
+        for (std::uint32_t pass = 0;; pass++) {
+            screenMonitor.begin();
             // print robot location to the brain screen
             pros::lcd::print(0, "X: %f", chassis.getPose().x); // x
             pros::lcd::print(1, "Y: %f", chassis.getPose().y); // y
             pros::lcd::print(2, "Theta: %f", chassis.getPose().theta); // heading
             pros::lcd::print(3, "Rotation Sensor: %i", verticalEnc.get_position());
+            // and how every monitored task is keeping up, four at a time for 2 s each
+            printLoopStats(4, pass / 40);
+            const bool second = pass % 20 == 0;
             // log position telemetry
-            lemlib::telemetrySink()->info("Chassis pose: {}", chassis.getPose());
+            lemlib::Pose pose = chassis.getPose();
+            if (binaryTelemetryEnabled) {
+                binaryTelemetry.log(poseChannel, {pose.x, pose.y, pose.theta});
+                binaryTelemetry.log(driveChannel, {(float)leftMotors.get_actual_velocity(),
+                                                   (float)rightMotors.get_actual_velocity(),
+                                                   verticalEnc.get_position() / 100.0f,
+                                                   horizontalEnc.get_position() / 100.0f});
+                if (second) logLoopStats(binaryTelemetry, loopMonitors, LOOP_MONITORS, loopChannels);
+            } else {
+                poseLog.print("Chassis pose: x: {:.3f}, y: {:.3f}, theta: {:.3f}\n", pose.x, pose.y, pose.theta);
+                for (int i = 0; second && i < LOOP_MONITORS; i++) {
+                    const LoopMonitor::Stats stats = loopMonitors[i]->getStats();
+                    poseLog.print("Loop {}: period {:.2f} max {} late {} misses {} busy {:.1f}% stack free {}\n",
+                                  loopMonitors[i]->getName(), stats.periodMean, stats.periodMax, stats.lateMax, stats.misses,
+                                  stats.busyPercent, stats.stackFree);
+                }
+                // every request was a smart port or adi write before the actuators task
+                for (int i = 0; second && i < actuators.count(); i++) {
+                    const Actuator::Stats stats = actuators.get(i)->getStats();
+                    poseLog.print("Actuator {}: requests {} redundant {} writes {}\n", actuators.get(i)->getName(),
+                                  stats.requests, stats.redundant, stats.writes);
+                }
+            }
             // delay to save resources
-            pros::delay(50);
+            screenMonitor.delay(50);
         }
     });
 }
@@ -222,7 +400,7 @@ void example_drive(){
 void autonomous() {
     ladybrown.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);  	
   	// doinker.set_value(LOW);
-  	mogoclamp.set_value(LOW);
+  	mogoclampActuator.set(CommandSource::Auton, LOW);
 	isColorSortEnabled = true; //enable color sort for all of auto -- we could cook on the corners??
 
     example_drive();
@@ -237,12 +415,16 @@ void opcontrol() {
 	chassis.setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
 	ladybrown.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
     isColorSortEnabled = true; //start with color sort on
+    actuators.release(CommandSource::Auton); // whatever auton left commanded is the driver's now
 
+    driverMonitor.start();
 	while (true) {
+        driverMonitor.begin();
         if (!pros::competition::is_connected()) {
             if (controller.get_digital(DIGITAL_B) && 
                 controller.get_digital(DIGITAL_DOWN)) {
                 autonomous(); //runs auton
+                actuators.release(CommandSource::Auton);
                 chassis.setBrakeMode(pros::E_MOTOR_BRAKE_COAST); //when done go back to coast for driver
             }
         //     //switches from auton selector to the coords and vise versa
@@ -254,24 +436,36 @@ void opcontrol() {
 
         //intake 
         if (controller.get_digital(DIGITAL_R1)) {
-            intakeLow.move(127);
-            intakeHigh.move(127);
+            intakeLowActuator.move(CommandSource::Driver, 127);
+            intakeHighActuator.move(CommandSource::Driver, 127);
+            outtakeLatch = false;
         } 
         else if (controller.get_digital(DIGITAL_R2)) {
-            intakeLow.move(-127);
-            intakeHigh.move(-127);
+            intakeLowActuator.move(CommandSource::Driver, -127);
+            intakeHighActuator.move(CommandSource::Driver, -127);
+            outtakeLatch = false;
         } 
+        else if (controller.get_digital(DIGITAL_LEFT)) {
+            // the short outtake is posted once on the press, moveRelative() measures from where the
+            // hooks are so posting it every loop would keep pushing the target back
+            intakeLowActuator.move(CommandSource::Driver, 0);
+            if (!outtakeLatch) {
+                intakeHighActuator.moveRelative(CommandSource::Driver, 200, -127); //need to get a super short outtake
+                outtakeLatch = true;
+            }
+        }
         else {
-            intakeLow.move(0);
-            intakeHigh.move(0);
+            intakeLowActuator.move(CommandSource::Driver, 0);
+            intakeHighActuator.move(CommandSource::Driver, 0);
+            outtakeLatch = false;
         }   
 
         //mogo
         if (isClamp){
-            mogoclamp.set_value(HIGH);
+            mogoclampActuator.set(CommandSource::Driver, HIGH);
         } 
         else {
-            mogoclamp.set_value(LOW);
+            mogoclampActuator.set(CommandSource::Driver, LOW);
         }
         if (controller.get_digital(DIGITAL_L2)) {
             if (!clampLatch) {
@@ -285,10 +479,10 @@ void opcontrol() {
 
         //intake piston
         if (isIntakePiston){
-            intakePiston.set_value(HIGH);
+            intakePistonActuator.set(CommandSource::Driver, HIGH);
         } 
         else {
-            intakePiston.set_value(LOW);
+            intakePistonActuator.set(CommandSource::Driver, LOW);
         }
         if (controller.get_digital(DIGITAL_L1)) {
             if (!intakePistonLatch) {
@@ -320,13 +514,13 @@ void opcontrol() {
         // ladybrown
         if (controller.get_digital(DIGITAL_DOWN)) {
             // currentPositionIndex = (currentPositionIndex + 1) % 3;
-            ladybrown.move_absolute(0, 127);
+            ladybrownActuator.moveAbsolute(CommandSource::Driver, 0, 127);
             // ladyBrownAngle(positions[currentPositionIndex]);
         }
 
         if (controller.get_digital(DIGITAL_UP)) {
             // currentPositionIndex = 0;
-            ladybrown.move_absolute(1850, 127);
+            ladybrownActuator.moveAbsolute(CommandSource::Driver, 1850, 127);
 
             // ladyBrownAngle(positions[0]);
             // ladybrown.tare_position();
@@ -334,8 +528,7 @@ void opcontrol() {
 
         if (controller.get_digital(DIGITAL_LEFT)) {
             // currentPositionIndex = 0;
-            ladybrown.move_absolute(380, 127);
-            intakeHigh.move_relative(200, -127); //need to get a super short outtake
+            ladybrownActuator.moveAbsolute(CommandSource::Driver, 380, 127);
         }
 
 
@@ -360,7 +553,7 @@ void opcontrol() {
         // move the chassis with curvature drive
         chassis.arcade(-1* leftY, rightX);
         // delay to save resources
-        pros::delay(10);
+        driverMonitor.delay(10);
 
 		// //other Arcade control scheme
 		// int dir = controller.get_analog(ANALOG_LEFT_Y);    // Gets amount forward/backward from left joystick
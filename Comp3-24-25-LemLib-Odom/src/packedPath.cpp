@@ -0,0 +1,239 @@
+#include "packedPath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace packedpath {
+
+Path::Path(const asset& asset)
+    : Path(asset.buf, asset.size) {}
+
+Path::Path(const void* data, std::size_t size) {
+    // points are read in place, so a misaligned asset can't be used
+    if (data == nullptr || size < sizeof(Header) || reinterpret_cast<std::uintptr_t>(data) % alignof(Point) != 0) return;
+    const Header* header = static_cast<const Header*>(data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+        header->pointSize != sizeof(Point) || header->count > (size - sizeof(Header)) / sizeof(Point))
+        return;
+    points = reinterpret_cast<const Point*>(header + 1);
+    count = header->count;
+    totalLength = header->length;
+    totalDuration = header->duration;
+}
+
+bool Path::isValid() const { return count > 0; }
+
+int Path::size() const { return count; }
+
+float Path::length() const { return totalLength; }
+
+float Path::duration() const { return totalDuration; }
+
+namespace {
+
+// where along p1 -> p2 a circle around the robot crosses, the furthest crossing first, -1 if none
+float circleIntersect(const Point& p1, const Point& p2, float x, float y, float radius) {
+    const float dx = p2.x - p1.x;
+    const float dy = p2.y - p1.y;
+    const float fx = p1.x - x;
+    const float fy = p1.y - y;
+    const float a = dx * dx + dy * dy;
+    const float b = 2 * (fx * dx + fy * dy);
+    const float c = fx * fx + fy * fy - radius * radius;
+    float discriminant = b * b - 4 * a * c;
+    if (discriminant >= 0) {
+        discriminant = std::sqrt(discriminant);
+        const float t1 = (-b - discriminant) / (2 * a);
+        const float t2 = (-b + discriminant) / (2 * a);
+        if (t2 >= 0 && t2 <= 1) return t2;
+        if (t1 >= 0 && t1 <= 1) return t1;
+    }
+    return -1;
+}
+
+} // namespace
+
+PathIndex::PathIndex(const Path& path, float cellSize)
+    : path(path) {
+    if (!path.isValid()) return;
+    // a single point is indexed as a segment from itself to itself
+    const int count = std::max(path.size() - 1, 1);
+    const int last = path.size() - 1;
+    minX = path[0].x;
+    minY = path[0].y;
+    float maxX = minX;
+    float maxY = minY;
+    for (const Point& point : path) {
+        minX = std::min(minX, point.x);
+        minY = std::min(minY, point.y);
+        maxX = std::max(maxX, point.x);
+        maxY = std::max(maxY, point.y);
+    }
+    const float width = maxX - minX;
+    const float height = maxY - minY;
+    // about one segment per cell, but never finer than the segments themselves or 256 cells a side
+    if (cellSize <= 0) cellSize = std::max({std::sqrt(width * height / count), path.length() / count, 1.0f});
+    this->cellSize = std::max({cellSize, width / 256, height / 256});
+    columns = static_cast<int>(width / this->cellSize) + 1;
+    rows = static_cast<int>(height / this->cellSize) + 1;
+
+    // counting pass, then fill, so everything lands in two flat arrays
+    cellStart.assign(columns * rows + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+        std::vector<int> next(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < count; i++) {
+            const Point& a = path[i];
+            const Point& b = path[std::min(i + 1, last)];
+            const int x0 = cellOf(std::min(a.x, b.x), minX, columns);
+            const int x1 = cellOf(std::max(a.x, b.x), minX, columns);
+            const int y0 = cellOf(std::min(a.y, b.y), minY, rows);
+            const int y1 = cellOf(std::max(a.y, b.y), minY, rows);
+            for (int cy = y0; cy <= y1; cy++) {
+                for (int cx = x0; cx <= x1; cx++) {
+                    if (pass == 0) cellStart[cy * columns + cx + 1]++;
+                    else segments[next[cy * columns + cx]++] = i;
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int c = 0; c < columns * rows; c++) cellStart[c + 1] += cellStart[c];
+            segments.resize(cellStart.back());
+        }
+    }
+}
+
+int PathIndex::cellOf(float value, float min, int cells) const {
+    return std::clamp(static_cast<int>((value - min) / cellSize), 0, cells - 1);
+}
+
+int PathIndex::closest(float x, float y, int from) const {
+    if (cellStart.empty() || from < 0 || from >= path.size()) return -1;
+    const int last = path.size() - 1;
+    const int cx = cellOf(x, minX, columns);
+    const int cy = cellOf(y, minY, rows);
+    int best = -1;
+    float bestDist = INFINITY;
+    const auto check = [&](int i) {
+        if (i < from) return;
+        const float dx = path[i].x - x;
+        const float dy = path[i].y - y;
+        const float dist = dx * dx + dy * dy;
+        if (dist < bestDist || (dist == bestDist && i < best)) {
+            bestDist = dist;
+            best = i;
+        }
+    };
+    const auto checkCell = [&](int cellX, int cellY) {
+        if (cellX < 0 || cellX >= columns || cellY < 0 || cellY >= rows) return;
+        const int cell = cellY * columns + cellX;
+        for (int s = cellStart[cell]; s < cellStart[cell + 1]; s++) {
+            check(segments[s]);
+            check(std::min(segments[s] + 1, last));
+        }
+    };
+    for (int ring = 0; ring <= std::max(columns, rows); ring++) {
+        // only the edge of the ring, the inside was searched already
+        for (int cellX = cx - ring; cellX <= cx + ring; cellX++) {
+            checkCell(cellX, cy - ring);
+            if (ring != 0) checkCell(cellX, cy + ring);
+        }
+        for (int cellY = cy - ring + 1; cellY <= cy + ring - 1; cellY++) {
+            checkCell(cx - ring, cellY);
+            checkCell(cx + ring, cellY);
+        }
+        // every cell further out is at least ring cells away, even if the position is off the grid
+        const float reach = ring * cellSize;
+        if (best != -1 && bestDist <= reach * reach) break;
+    }
+    return best;
+}
+
+float PathIndex::getCellSize() const { return cellSize; }
+
+PurePursuit::PurePursuit(const Path& path, float lookahead, float trackWidth, float slew)
+    : path(path),
+      index(path),
+      lookahead(lookahead),
+      trackWidth(trackWidth),
+      slew(slew),
+      window(2 * lookahead),
+      lookaheadX(path.isValid() ? path[0].x : 0),
+      lookaheadY(path.isValid() ? path[0].y : 0) {}
+
+bool PurePursuit::update(float x, float y, float theta, float& left, float& right) {
+    if (!path.isValid()) return false;
+
+    // closest point to the robot, searched for from the last one up to the end of the window. A
+    // point can't be any closer than this one's distance less the path between them, so the
+    // search skips ahead by that much and only looks at a few points however finely spaced they are
+    float closestDist = INFINITY;
+    if (closest != -1) {
+        const auto byDistance = [](const Point& point, float distance) { return point.distance < distance; };
+        const Point* windowEnd =
+            std::lower_bound(path.begin() + closest, path.end(), path[closest].distance + window, byDistance);
+        const Point* point = path.begin() + closest;
+        do {
+            const float dist = std::hypot(point->x - x, point->y - y);
+            if (dist < closestDist) {
+                closestDist = dist;
+                closest = point - path.begin();
+            }
+            point = std::lower_bound(point + 1, windowEnd, point->distance + (dist - closestDist), byDistance);
+        } while (point < windowEnd);
+    }
+    // first update, or the robot is nowhere near that stretch of the path
+    if (closestDist > lookahead) {
+        closest = index.closest(x, y, std::max(closest, 0));
+        relocalizations++;
+    }
+    if (path[closest].speed == 0) return false;
+
+    // lookahead point, only past the closest point and the last lookahead point, and no further
+    // along than the window. If the robot has wandered off the path the last lookahead point is kept
+    const int start = closest > lookaheadIndex ? closest : lookaheadIndex;
+    const float searchEnd = path[start].distance + window;
+    for (int i = start; i < path.size() - 1 && path[i].distance <= searchEnd; i++) {
+        const float t = circleIntersect(path[i], path[i + 1], x, y, lookahead);
+        if (t != -1) {
+            lookaheadX = path[i].x + (path[i + 1].x - path[i].x) * t;
+            lookaheadY = path[i].y + (path[i + 1].y - path[i].y) * t;
+            lookaheadIndex = i;
+            break;
+        }
+    }
+
+    // curvature of the arc from the robot to the lookahead point
+    const float heading = M_PI / 2 - theta;
+    const float sideValue = std::sin(heading) * (lookaheadX - x) - std::cos(heading) * (lookaheadY - y);
+    const float side = sideValue < 0 ? -1 : 1;
+    const float a = -std::tan(heading);
+    const float c = std::tan(heading) * x - y;
+    const float offset = std::fabs(a * lookaheadX + lookaheadY + c) / std::sqrt(a * a + 1);
+    const float d = std::hypot(lookaheadX - x, lookaheadY - y);
+    const float curvature = side * ((2 * offset) / (d * d));
+
+    // speed from the path, rate limited
+    float speed = path[closest].speed;
+    if (slew != 0) {
+        if (speed - prevSpeed > slew) speed = prevSpeed + slew;
+        else if (speed - prevSpeed < -slew) speed = prevSpeed - slew;
+    }
+    prevSpeed = speed;
+
+    left = speed * (2 + curvature * trackWidth) / 2;
+    right = speed * (2 - curvature * trackWidth) / 2;
+    const float ratio = std::fmax(std::fabs(left), std::fabs(right)) / 127;
+    if (ratio > 1) {
+        left /= ratio;
+        right /= ratio;
+    }
+    return true;
+}
+
+int PurePursuit::getClosest() const { return closest < 0 ? 0 : closest; }
+
+float PurePursuit::getProgress() const { return closest < 0 ? 0 : path[closest].distance; }
+
+int PurePursuit::getRelocalizations() const { return relocalizations; }
+} // namespace packedpath
@@ -0,0 +1,139 @@
+#include "pathChassis.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+#include "lemlib/util.hpp"
+#include "pros/misc.hpp"
+
+void PathChassis::follow(packedpath::Path path, float lookahead, int timeout, bool forwards, bool async) {
+    this->requestMotionStart();
+    // were all motions cancelled?
+    if (!this->motionRunning) return;
+    // if the function is async, run it in a new task
+    if (async) {
+        pros::Task task([=, this]() { follow(path, lookahead, timeout, forwards, false); });
+        this->endMotion();
+        pros::delay(10); // delay to give the task time to start
+        return;
+    }
+
+    if (!path.isValid()) {
+        std::printf("follow: not a packed path this build can read (packedpath::VERSION %u), repack it\n",
+                    unsigned(packedpath::VERSION));
+        this->endMotion();
+        return;
+    }
+
+    // a time profile already keeps acceleration in check, slew on top would only hold it back
+    const float slew = path.duration() > 0 ? 0 : lateralSettings.slew;
+    packedpath::PurePursuit pursuit(path, lookahead, drivetrain.trackWidth, slew);
+    lemlib::Pose lastPose = this->getPose(true);
+    const int compState = pros::competition::get_status();
+    distTraveled = 0;
+
+    for (int i = 0; i < timeout / 10 && pros::competition::get_status() == compState && this->motionRunning; i++) {
+        lemlib::Pose pose = this->getPose(true);
+        if (!forwards) pose.theta -= M_PI;
+
+        distTraveled += std::hypot(pose.x - lastPose.x, pose.y - lastPose.y);
+        lastPose = pose;
+
+        float left, right;
+        if (!pursuit.update(pose.x, pose.y, pose.theta, left, right)) break;
+
+        if (forwards) {
+            drivetrain.leftMotors->move(left);
+            drivetrain.rightMotors->move(right);
+        } else {
+            drivetrain.leftMotors->move(-right);
+            drivetrain.rightMotors->move(-left);
+        }
+
+        pros::delay(10);
+    }
+
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    // -1 tells waitUntil the motion is done
+    distTraveled = -1;
+    this->endMotion();
+}
+
+void PathChassis::followTrajectory(packedpath::Path path, int timeout, bool forwards, bool async) {
+    this->requestMotionStart();
+    // were all motions cancelled?
+    if (!this->motionRunning) return;
+    // if the function is async, run it in a new task
+    if (async) {
+        pros::Task task([=, this]() { followTrajectory(path, timeout, forwards, false); });
+        this->endMotion();
+        pros::delay(10); // delay to give the task time to start
+        return;
+    }
+
+    if (!path.isValid() || path.duration() <= 0) {
+        std::printf("followTrajectory: %s, repack it\n",
+                    path.isValid() ? "the path has no time profile, add it to PATH_PROFILED in path-asset.mk"
+                                   : "not a packed path this build can read");
+        this->endMotion();
+        return;
+    }
+
+    packedpath::WheelFeedforward ff = feedforward;
+    if (ff.kV == 0) ff.kV = 127 / (drivetrain.rpm * drivetrain.wheelDiameter * M_PI / 60);
+    packedpath::Ramsete ramsete(path, drivetrain.trackWidth);
+    lemlib::Pose lastPose = this->getPose(true);
+    const int compState = pros::competition::get_status();
+    distTraveled = 0;
+
+    const std::uint32_t start = pros::millis();
+    std::uint32_t now = start;
+    while (now - start < std::uint32_t(timeout) && pros::competition::get_status() == compState && this->motionRunning) {
+        lemlib::Pose pose = this->getPose(true);
+        if (!forwards) pose.theta -= M_PI;
+
+        distTraveled += std::hypot(pose.x - lastPose.x, pose.y - lastPose.y);
+        lastPose = pose;
+
+        float leftVelocity, rightVelocity, leftAccel, rightAccel;
+        if (!ramsete.update(pose.x, pose.y, pose.theta, (now - start) / 1000.0f, leftVelocity, rightVelocity, leftAccel,
+                            rightAccel))
+            break;
+        float left = ff.power(leftVelocity, leftAccel);
+        float right = ff.power(rightVelocity, rightAccel);
+        // scale both down together so the robot still turns as much when one side is saturated
+        const float ratio = std::fmax(std::fabs(left), std::fabs(right)) / 127;
+        if (ratio > 1) {
+            left /= ratio;
+            right /= ratio;
+        }
+
+        if (forwards) {
+            drivetrain.leftMotors->move(left);
+            drivetrain.rightMotors->move(right);
+        } else {
+            drivetrain.leftMotors->move(-right);
+            drivetrain.rightMotors->move(-left);
+        }
+
+        pros::Task::delay_until(&now, 10);
+    }
+
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    // -1 tells waitUntil the motion is done
+    distTraveled = -1;
+    this->endMotion();
+}
+
+void PathChassis::setFeedforward(const packedpath::WheelFeedforward& feedforward) { this->feedforward = feedforward; }
+
+void PathChassis::setPose(float x, float y, float theta, bool radians) {
+    lemlib::Chassis::setPose(x, y, theta, radians);
+    if (fused) fused->setPose(x, y, radians ? theta : lemlib::degToRad(theta));
+}
+
+void PathChassis::setPose(lemlib::Pose pose, bool radians) { setPose(pose.x, pose.y, pose.theta, radians); }
+
+void PathChassis::setFusedPose(FusedPose* fused) { this->fused = fused; }
@@ -0,0 +1,73 @@
+#include "pathProfile.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace packedpath {
+
+float timeProfile(Point* points, int count, const Limits& limits) {
+    if (count <= 0) return 0;
+    // the follower stops at the first point with speed 0, path.jerryio puts a ghost point past it
+    // to look ahead to. Profile up to there and leave the rest at rest
+    int stop = 0;
+    while (stop < count - 1 && points[stop].speed != 0) stop++;
+    const int n = stop + 1;
+    const auto curvature = [&](const Point& point) {
+        const float k = std::fabs(point.curvature);
+        return limits.maxCurvature > 0 ? std::min(k, limits.maxCurvature) : k;
+    };
+    // how much faster the outside wheel goes than the center
+    const auto outside = [&](const Point& point) { return 1 + curvature(point) * limits.trackWidth / 2; };
+
+    // fastest each point can be taken on its own
+    for (int i = 0; i < n; i++) {
+        float velocity = limits.maxVelocity / outside(points[i]);
+        if (limits.maxLateralAcceleration > 0 && curvature(points[i]) > 0)
+            velocity = std::min(velocity, std::sqrt(limits.maxLateralAcceleration / curvature(points[i])));
+        points[i].velocity = velocity;
+    }
+
+    // speeding up from the start, then slowing down to rest. v^2 changes by at most 2 a ds between points
+    points[0].velocity = std::min(points[0].velocity, limits.minVelocity);
+    for (int i = 1; i < n; i++) {
+        const float ds = points[i].distance - points[i - 1].distance;
+        const float accel = limits.maxAcceleration / outside(points[i - 1]);
+        points[i].velocity = std::min(points[i].velocity,
+                                      std::sqrt(points[i - 1].velocity * points[i - 1].velocity + 2 * accel * ds));
+    }
+    points[n - 1].velocity = 0;
+    for (int i = n - 2; i >= 0; i--) {
+        const float ds = points[i + 1].distance - points[i].distance;
+        const float decel = limits.maxDeceleration / outside(points[i + 1]);
+        points[i].velocity = std::min(points[i].velocity,
+                                      std::sqrt(points[i + 1].velocity * points[i + 1].velocity + 2 * decel * ds));
+    }
+
+    // constant acceleration between points, so the average speed over each gap is the mean of its ends
+    points[0].time = 0;
+    for (int i = 0; i < n; i++) {
+        Point& point = points[i];
+        point.acceleration = 0;
+        if (i + 1 < n) {
+            const Point& next = points[i + 1];
+            const float ds = next.distance - point.distance;
+            const float sum = point.velocity + next.velocity;
+            if (ds > 0) point.acceleration = (next.velocity * next.velocity - point.velocity * point.velocity) / (2 * ds);
+            points[i + 1].time = point.time + (sum > 0 ? 2 * ds / sum : 0);
+        }
+        // pure pursuit holds a point's speed until it gets to the next one, so give it the slower of
+        // the two or it arrives at each slowdown, and the stop, too fast
+        if (i + 1 < n) {
+            const float velocity = std::min(point.velocity, points[i + 1].velocity);
+            point.speed = 127 * std::max(velocity, limits.minVelocity) / limits.maxVelocity;
+        } else {
+            point.speed = 0;
+        }
+    }
+    for (int i = n; i < count; i++) {
+        points[i].velocity = points[i].acceleration = points[i].speed = 0;
+        points[i].time = points[n - 1].time;
+    }
+    return points[n - 1].time;
+}
+} // namespace packedpath
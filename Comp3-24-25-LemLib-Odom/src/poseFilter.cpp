@@ -0,0 +1,186 @@
+#include "poseFilter.hpp"
+
+#include <cmath>
+
+using fixedmatrix::Matrix;
+
+PoseFilter::PoseFilter()
+    : PoseFilter(Noise()) {}
+
+PoseFilter::PoseFilter(Noise noise)
+    : noise(noise) {
+    reset(0, 0, 0, 1000, 1000);
+}
+
+void PoseFilter::reset(float x, float y, float theta, float positionStd, float thetaStd) {
+    state = {};
+    state(X, 0) = x;
+    state(Y, 0) = y;
+    state(THETA, 0) = theta;
+    covariance = {};
+    covariance(X, X) = positionStd * positionStd;
+    covariance(Y, Y) = positionStd * positionStd;
+    covariance(THETA, THETA) = thetaStd * thetaStd;
+    // stopped, give or take
+    covariance(FORWARD, FORWARD) = 1;
+    covariance(SIDEWAYS, SIDEWAYS) = 1;
+    covariance(TURN, TURN) = 0.01;
+}
+
+void PoseFilter::setPose(float x, float y, float theta, float positionStd, float thetaStd) {
+    state(X, 0) = x;
+    state(Y, 0) = y;
+    state(THETA, 0) = theta;
+    // the new pose says nothing about the old one, or how fast the robot is going
+    for (int i = 0; i < STATES; i++) {
+        for (int pose = X; pose <= THETA; pose++) {
+            covariance(i, pose) = 0;
+            covariance(pose, i) = 0;
+        }
+    }
+    covariance(X, X) = positionStd * positionStd;
+    covariance(Y, Y) = positionStd * positionStd;
+    covariance(THETA, THETA) = thetaStd * thetaStd;
+}
+
+void PoseFilter::predict(float dt) {
+    const float forward = state(FORWARD, 0);
+    const float sideways = state(SIDEWAYS, 0);
+    // move along the heading halfway through the tick, like an arc
+    const float theta = state(THETA, 0) + state(TURN, 0) * dt / 2;
+    const float s = std::sin(theta);
+    const float c = std::cos(theta);
+
+    state(X, 0) += (forward * s + sideways * c) * dt;
+    state(Y, 0) += (forward * c - sideways * s) * dt;
+    state(THETA, 0) += state(TURN, 0) * dt;
+
+    // how the new state moves with the old one
+    auto jacobian = Matrix<STATES, STATES>::identity();
+    jacobian(X, THETA) = (forward * c - sideways * s) * dt;
+    jacobian(X, FORWARD) = s * dt;
+    jacobian(X, SIDEWAYS) = c * dt;
+    jacobian(X, TURN) = jacobian(X, THETA) * dt / 2;
+    jacobian(Y, THETA) = (-forward * s - sideways * c) * dt;
+    jacobian(Y, FORWARD) = c * dt;
+    jacobian(Y, SIDEWAYS) = -s * dt;
+    jacobian(Y, TURN) = jacobian(Y, THETA) * dt / 2;
+    jacobian(THETA, TURN) = dt;
+
+    // velocities drift by however much the robot could have accelerated, before the pose moves
+    // with them, so a wheel reading for this tick corrects the pose along with the velocity
+    Matrix<STATES, STATES> process;
+    process(FORWARD, FORWARD) = noise.forwardAcceleration * noise.forwardAcceleration * dt * dt;
+    process(SIDEWAYS, SIDEWAYS) = noise.sidewaysAcceleration * noise.sidewaysAcceleration * dt * dt;
+    process(TURN, TURN) = noise.turnAcceleration * noise.turnAcceleration * dt * dt;
+
+    covariance = jacobian * (covariance + process) * jacobian.transpose();
+}
+
+bool PoseFilter::update(const Matrix<1, STATES>& h, float innovation, float variance) {
+    const Matrix<STATES, 1> ht = h.transpose();
+    const Matrix<STATES, 1> pht = covariance * ht;
+    const float s = (h * pht)(0, 0) + variance;
+    if (innovation * innovation > noise.gate * noise.gate * s) {
+        rejected++;
+        return false;
+    }
+    const Matrix<STATES, 1> gain = pht * (1 / s);
+    state = state + gain * innovation;
+    // Joseph form, stays symmetric and positive through float rounding
+    const Matrix<STATES, STATES> keep = Matrix<STATES, STATES>::identity() - gain * h;
+    covariance = keep * covariance * keep.transpose() + gain * gain.transpose() * variance;
+    return true;
+}
+
+bool PoseFilter::updateVerticalWheel(float velocity, float offset, float std) {
+    Matrix<1, STATES> h;
+    h(0, FORWARD) = 1;
+    h(0, TURN) = -offset;
+    return update(h, velocity - (state(FORWARD, 0) - state(TURN, 0) * offset), std * std);
+}
+
+bool PoseFilter::updateHorizontalWheel(float velocity, float offset, float std) {
+    Matrix<1, STATES> h;
+    h(0, SIDEWAYS) = 1;
+    h(0, TURN) = offset;
+    return update(h, velocity - (state(SIDEWAYS, 0) + state(TURN, 0) * offset), std * std);
+}
+
+bool PoseFilter::updateHeading(float theta, float std) {
+    Matrix<1, STATES> h;
+    h(0, THETA) = 1;
+    return update(h, theta - state(THETA, 0), std * std);
+}
+
+bool PoseFilter::updateTurnRate(float rate, float std) {
+    Matrix<1, STATES> h;
+    h(0, TURN) = 1;
+    return update(h, rate - state(TURN, 0), std * std);
+}
+
+bool PoseFilter::updatePosition(float x, float y, float std) {
+    Matrix<1, STATES> hx;
+    hx(0, X) = 1;
+    const bool xAccepted = update(hx, x - state(X, 0), std * std);
+    Matrix<1, STATES> hy;
+    hy(0, Y) = 1;
+    const bool yAccepted = update(hy, y - state(Y, 0), std * std);
+    return xAccepted && yAccepted;
+}
+
+bool PoseFilter::updateRange(float distance, const RangeSensor& sensor, const Wall& wall, float std) {
+    const float theta = state(THETA, 0);
+    const float s = std::sin(theta);
+    const float c = std::cos(theta);
+    // sensor position on the field, and how it moves as the robot turns
+    const float sensorX = state(X, 0) + sensor.x * c + sensor.y * s;
+    const float sensorY = state(Y, 0) - sensor.x * s + sensor.y * c;
+    const float sensorXdTheta = -sensor.x * s + sensor.y * c;
+    const float sensorYdTheta = -sensor.x * c - sensor.y * s;
+    const float beam = theta + sensor.angle;
+
+    Matrix<1, STATES> h;
+    float expected;
+    if (wall.vertical) {
+        // distance along the beam to x = position
+        const float along = std::sin(beam);
+        if (std::fabs(along) < 0.34f) return false;
+        expected = (wall.position - sensorX) / along;
+        h(0, X) = -1 / along;
+        h(0, THETA) = -sensorXdTheta / along - expected * std::cos(beam) / along;
+    } else {
+        const float along = std::cos(beam);
+        if (std::fabs(along) < 0.34f) return false;
+        expected = (wall.position - sensorY) / along;
+        h(0, Y) = -1 / along;
+        h(0, THETA) = -sensorYdTheta / along + expected * std::sin(beam) / along;
+    }
+    // pointed away from the wall
+    if (expected <= 0) return false;
+    return update(h, distance - expected, std * std);
+}
+
+float PoseFilter::getX() const { return state(X, 0); }
+
+float PoseFilter::getY() const { return state(Y, 0); }
+
+float PoseFilter::getTheta() const { return state(THETA, 0); }
+
+void PoseFilter::getAhead(float seconds, float& x, float& y, float& theta) const {
+    const float turn = state(TURN, 0) * seconds;
+    const float forward = state(FORWARD, 0) * seconds;
+    const float sideways = state(SIDEWAYS, 0) * seconds;
+    const float mid = state(THETA, 0) + turn / 2;
+    // an arc's chord is shorter than the arc by sin(turn / 2) / (turn / 2)
+    const float chord = std::fabs(turn) > 1e-6f ? std::sin(turn / 2) / (turn / 2) : 1.0f;
+    x = state(X, 0) + chord * (forward * std::sin(mid) + sideways * std::cos(mid));
+    y = state(Y, 0) + chord * (forward * std::cos(mid) - sideways * std::sin(mid));
+    theta = state(THETA, 0) + turn;
+}
+
+float PoseFilter::get(State which) const { return state(which, 0); }
+
+float PoseFilter::getVariance(State which) const { return covariance(which, which); }
+
+std::uint32_t PoseFilter::getRejected() const { return rejected; }
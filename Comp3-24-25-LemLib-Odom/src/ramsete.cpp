@@ -0,0 +1,104 @@
+#include "ramsete.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace packedpath {
+
+namespace {
+// once the profile is over the robot has this long to close the rest of the gap, seconds
+const float SETTLE_TIME = 0.5;
+// inches short of or past the end that count as there
+const float EXIT_ERROR = 1;
+
+float sign(float x) { return x > 0 ? 1 : x < 0 ? -1 : 0; }
+
+// angle in (-pi, pi]
+float wrap(float angle) { return std::remainder(angle, 2 * float(M_PI)); }
+
+// direction the path runs at a point, counterclockwise from +x, from the points either side of it
+float pointDirection(const Path& path, int i) {
+    const Point& before = path[std::max(i - 1, 0)];
+    const Point& after = path[std::min(i + 1, path.size() - 1)];
+    return std::atan2(after.y - before.y, after.x - before.x);
+}
+} // namespace
+
+float WheelFeedforward::power(float velocity, float acceleration) const {
+    return kS * sign(velocity) + kV * velocity + kA * acceleration;
+}
+
+Ramsete::Ramsete(const Path& path, float trackWidth, float b, float zeta, float minGain)
+    : path(path),
+      trackWidth(trackWidth),
+      b(b),
+      zeta(zeta),
+      minGain(minGain) {}
+
+Ramsete::Reference Ramsete::reference(float seconds) const {
+    const int last = path.size() - 1;
+    if (last < 1 || seconds >= path.duration()) {
+        const Point& end = path[last];
+        return {end.x, end.y, float(M_PI / 2) - pointDirection(path, last), 0, 0, 0};
+    }
+    seconds = std::max(seconds, 0.0f);
+
+    // the segment the time falls in, constant acceleration along it
+    const auto byTime = [](float t, const Point& point) { return t < point.time; };
+    const int i = std::clamp(int(std::upper_bound(path.begin(), path.end(), seconds, byTime) - path.begin()) - 1, 0, last - 1);
+    const Point& from = path[i];
+    const Point& to = path[i + 1];
+    const float t = seconds - from.time;
+    const float ds = to.distance - from.distance;
+    const float along = from.velocity * t + from.acceleration * t * t / 2;
+    const float f = ds > 0 ? std::clamp(along / ds, 0.0f, 1.0f) : 0;
+
+    const float start = pointDirection(path, i);
+    const float direction = start + wrap(pointDirection(path, i + 1) - start) * f;
+    const float velocity = std::max(from.velocity + from.acceleration * t, 0.0f);
+    const float curvature = from.curvature + (to.curvature - from.curvature) * f;
+    return {from.x + (to.x - from.x) * f,
+            from.y + (to.y - from.y) * f,
+            float(M_PI / 2) - direction,
+            velocity,
+            from.acceleration,
+            velocity * curvature};
+}
+
+bool Ramsete::update(float x, float y, float theta, float seconds, float& left, float& right, float& leftAccel,
+                     float& rightAccel) {
+    if (!path.isValid() || path.duration() <= 0 || seconds >= path.duration() + SETTLE_TIME) return false;
+    const Reference ref = reference(seconds);
+
+    // error in the robot's frame, x forwards and y to its left, angles counterclockwise
+    const float heading = M_PI / 2 - theta;
+    const float dx = ref.x - x;
+    const float dy = ref.y - y;
+    const float errorX = std::cos(heading) * dx + std::sin(heading) * dy;
+    const float errorY = -std::sin(heading) * dx + std::cos(heading) * dy;
+    const float errorTheta = wrap(theta - ref.theta);
+    alongTrack = errorX;
+    crossTrack = -errorY;
+    // stopped, any error left is across the end, which only driving away and back could fix
+    if (seconds >= path.duration() && std::fabs(errorX) < EXIT_ERROR) return false;
+
+    // the usual gain goes to 0 as the reference stops, which would leave any lag behind it uncorrected
+    const float k = std::max(2 * zeta * std::sqrt(ref.angularVelocity * ref.angularVelocity + b * ref.velocity * ref.velocity),
+                             minGain);
+    const float sinc = std::fabs(errorTheta) < 1e-4 ? 1 : std::sin(errorTheta) / errorTheta;
+    const float velocity = ref.velocity * std::cos(errorTheta) + k * errorX;
+    const float angular = ref.angularVelocity + k * errorTheta + b * ref.velocity * sinc * errorY;
+
+    left = velocity - angular * trackWidth / 2;
+    right = velocity + angular * trackWidth / 2;
+    // the outside wheel speeds up more in a turn
+    const float turn = ref.velocity > 0 ? ref.angularVelocity / ref.velocity * trackWidth / 2 : 0;
+    leftAccel = ref.acceleration * (1 - turn);
+    rightAccel = ref.acceleration * (1 + turn);
+    return true;
+}
+
+float Ramsete::getCrossTrackError() const { return crossTrack; }
+
+float Ramsete::getAlongTrackError() const { return alongTrack; }
+} // namespace packedpath
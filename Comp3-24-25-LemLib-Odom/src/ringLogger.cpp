@@ -0,0 +1,45 @@
+#include "ringLogger.hpp"
+
+RingLogger::RingLogger(std::FILE* out, std::uint32_t rate)
+    : out(out),
+      rate(rate) {}
+
+void RingLogger::start() {
+    if (task != nullptr) return;
+    // below the control loops, logging only gets what time is left over
+    task = new pros::Task(
+        [this] {
+            std::uint32_t now = pros::millis();
+            while (true) {
+                flush();
+                pros::Task::delay_until(&now, rate);
+            }
+        },
+        TASK_PRIORITY_DEFAULT - 1, TASK_STACK_DEPTH_DEFAULT, "ring logger");
+}
+
+bool RingLogger::write(const char* data, std::size_t size) { return ring.write(data, size); }
+
+std::size_t RingLogger::flush() {
+    // only what's queued now, so a busy writer can't keep this going forever
+    std::size_t remaining = ring.size();
+    std::size_t total = 0;
+    while (remaining > 0) {
+        const std::uint8_t* data;
+        std::size_t size = ring.peek(&data);
+        if (size > remaining) size = remaining;
+        std::fwrite(data, 1, size, out);
+        ring.consume(size);
+        remaining -= size;
+        total += size;
+    }
+    if (total > 0) std::fflush(out);
+    written += total;
+    return total;
+}
+
+std::uint32_t RingLogger::getDropped() { return ring.getDroppedMessages(); }
+
+std::uint32_t RingLogger::getWritten() { return written; }
+
+std::uint32_t RingLogger::getHighWater() { return ring.getHighWater(); }
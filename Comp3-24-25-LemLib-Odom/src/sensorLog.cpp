@@ -0,0 +1,139 @@
+#include "sensorLog.hpp"
+
+#include <cstring>
+
+namespace sensorlog {
+
+// how often the writer drains RAM to the card, in milliseconds
+constexpr int WRITE_PERIOD = 100;
+
+Recorder::Recorder(const char* path, int periodMs)
+    : path(path),
+      periodMs(periodMs) {
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.periodMs = periodMs;
+}
+
+Recorder::~Recorder() { stop(); }
+
+bool Recorder::addImu(pros::Imu* imu) {
+    if (running || header.channelCount >= MAX_CHANNELS) return false;
+    sources[header.channelCount] = {imu, 0};
+    header.channels[header.channelCount++] = {ChannelKind::IMU_ROTATION, (std::int8_t)imu->get_port(), 0, 0};
+    return true;
+}
+
+bool Recorder::addRotation(pros::Rotation* rotation) {
+    if (running || header.channelCount >= MAX_CHANNELS) return false;
+    // a reversed sensor reports its port as negative
+    std::int8_t port = rotation->get_port();
+    if (rotation->get_reversed()) port = -port;
+    sources[header.channelCount] = {rotation, 0};
+    header.channels[header.channelCount++] = {ChannelKind::ROTATION_POSITION, port, 0, 0};
+    return true;
+}
+
+bool Recorder::addMotors(pros::MotorGroup* motors) {
+    if (running || header.channelCount + motors->size() > MAX_CHANNELS) return false;
+    for (std::uint8_t i = 0; i < motors->size(); i++) {
+        sources[header.channelCount] = {motors, i};
+        header.channels[header.channelCount++] = {ChannelKind::MOTOR_POSITION, motors->get_port(i),
+                                                  (std::uint8_t)motors->get_encoder_units(i), 0};
+    }
+    return true;
+}
+
+bool Recorder::start() {
+    if (running) return false;
+    file = std::fopen(path, "wb");
+    if (file == nullptr) return false;
+    std::fwrite(&header, sizeof(header), 1, file);
+    head = 0;
+    tail = 0;
+    framesWritten = 0;
+    framesDropped = 0;
+    running = true;
+    writerDone = false;
+    // sampling outranks the control loop so it stays on time, writing only runs when nothing else wants to
+    sampler = new pros::Task([this] { sampleLoop(); }, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT,
+                             "sensor log sample");
+    writer = new pros::Task([this] { writeLoop(); }, TASK_PRIORITY_MIN + 1, TASK_STACK_DEPTH_DEFAULT,
+                            "sensor log write");
+    return true;
+}
+
+void Recorder::stop() {
+    if (!running) return;
+    running = false;
+    while (!writerDone) pros::delay(WRITE_PERIOD / 10);
+    delete sampler;
+    delete writer;
+    sampler = nullptr;
+    writer = nullptr;
+}
+
+bool Recorder::isRunning() { return running; }
+
+std::uint32_t Recorder::getFramesWritten() { return framesWritten; }
+
+std::uint32_t Recorder::getFramesDropped() { return framesDropped; }
+
+void Recorder::sample(Frame& frame) {
+    frame.time = pros::millis();
+    for (int i = 0; i < header.channelCount; i++) {
+        const Source& source = sources[i];
+        switch (header.channels[i].kind) {
+            case ChannelKind::IMU_ROTATION:
+                frame.values[i].f = static_cast<pros::Imu*>(source.device)->get_rotation();
+                break;
+            case ChannelKind::ROTATION_POSITION:
+                frame.values[i].i = static_cast<pros::Rotation*>(source.device)->get_position();
+                break;
+            case ChannelKind::MOTOR_POSITION:
+                frame.values[i].f = static_cast<pros::MotorGroup*>(source.device)->get_position(source.index);
+                break;
+        }
+    }
+}
+
+void Recorder::sampleLoop() {
+    std::uint32_t now = pros::millis();
+    while (running) {
+        const std::uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) < BUFFER_FRAMES) {
+            sample(buffer[h % BUFFER_FRAMES]);
+            head.store(h + 1, std::memory_order_release);
+        } else {
+            framesDropped++;
+        }
+        pros::Task::delay_until(&now, periodMs);
+    }
+}
+
+void Recorder::drain() {
+    const std::uint32_t h = head.load(std::memory_order_acquire);
+    std::uint32_t t = tail.load(std::memory_order_relaxed);
+    for (; t != h; t++) {
+        const Frame& frame = buffer[t % BUFFER_FRAMES];
+        std::fwrite(&frame, frameSize(header.channelCount), 1, file);
+        framesWritten++;
+    }
+    tail.store(t, std::memory_order_release);
+}
+
+void Recorder::writeLoop() {
+    while (running) {
+        drain();
+        // keep what's been written if power is lost mid match
+        std::fflush(file);
+        pros::delay(WRITE_PERIOD);
+    }
+    // the sampler may finish one more frame after running goes false
+    pros::delay(periodMs);
+    drain();
+    std::fclose(file);
+    file = nullptr;
+    writerDone = true;
+}
+} // namespace sensorlog
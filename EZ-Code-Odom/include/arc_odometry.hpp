@@ -0,0 +1,164 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "pros/rtos.hpp"
+
+/**
+ * Tracking wheel odometry with a choice of how each step is integrated.
+ *
+ * Every update turns the change in the trackers and the imu into a step in the robot's frame and
+ * adds it to the pose.  How that step is rotated into the field matters more the farther the
+ * robot goes per update: at 450 rpm on 2.75" wheels that's about 0.65" every 10 ms, which
+ * first order integration turns into a steady error through fast turns.
+ *
+ * Poses are inches and degrees clockwise from +y, same as EZ's odom.
+ */
+class ArcOdometry {
+ public:
+  enum integration {
+    EULER,        // heading at the start of the step, first order
+    MIDPOINT,     // heading halfway through the step
+    EXACT_ARC,    // the chord of a constant curvature arc, exact when the twist doesn't change
+    RUNGE_KUTTA,  // RK4 with the twist changing linearly from the last step, for accelerating turns
+  };
+
+  struct pose {
+    double x, y, theta;
+  };
+
+  /**
+   * What the sensors read, inches each tracker has rolled and the imu's heading in degrees.
+   */
+  struct reading {
+    double vertical, horizontal, theta;
+  };
+
+  integration mode = EXACT_ARC;
+
+  /**
+   * Where the trackers are.  The vertical one's distance right of the tracking center and the
+   * horizontal one's distance forward of it, in inches.
+   */
+  double vertical_offset = 0;
+  double horizontal_offset = 0;
+
+  /**
+   * Starts from a pose, with the sensors as they read now.
+   */
+  void reset(const pose& start, const reading& sensors);
+
+  /**
+   * Integrates the step since the last update and returns the new pose.
+   */
+  const pose& update(const reading& sensors);
+
+  const pose& pose_get() const;
+
+  /**
+   * Where the robot will be if it keeps moving like it did over the last few updates, as an arc.
+   * It's averaged over RECENT updates since the imu updates slower than the trackers and most
+   * steps see no turn at all.
+   *
+   * \param updates
+   *        how far ahead, in updates
+   */
+  pose ahead(double updates) const;
+
+ private:
+  struct twist {
+    double forward, sideways, turn;  // inches and radians over one update
+  };
+
+  static constexpr int RECENT = 4;
+
+  pose current = {0, 0, 0};
+  reading last = {0, 0, 0};
+  twist last_step = {0, 0, 0};
+  twist recent[RECENT] = {};
+  int recent_next = 0;
+};
+
+/**
+ * Runs ArcOdometry in its own task, faster than the PID loop and at a higher priority so it keeps
+ * its period while the drive is busy.
+ *
+ * It only writes x and y.  Heading stays the imu's, so nothing here ever sets the imu or moves
+ * a heading PID's target mid motion.
+ *
+ * Anything else that moves odometry, like wall relocalization or the reset at the start of
+ * autonomous, is picked up on the next update since x and y won't be what it last wrote, or the
+ * imu jumped further than the robot can turn in one update.  The sensors are taken as they read
+ * then too, in case they were reset along with it.
+ *
+ * With lead_ms set, predicted() is where the robot will be that far ahead, for followers to act
+ * on.  It's never written back, so odometry always integrates from where the robot is.
+ */
+class OdometryService {
+ public:
+  ArcOdometry odometry;
+
+  std::uint32_t period = 5;  // ms, 2 - 5 is worth it
+  std::uint32_t priority = TASK_PRIORITY_DEFAULT + 2;
+
+  /**
+   * How far ahead predicted() looks, so controllers act on the pose their commands will land
+   * at.  Set it to what latency_measure() finds.
+   */
+  double lead_ms = 0;
+
+  /**
+   * Starts the task.
+   *
+   * \param sensors_get
+   *        returns the trackers and the imu
+   * \param pose_get
+   *        returns where odometry thinks the robot is, heading from the imu
+   * \param xy_set
+   *        moves odometry to a new x and y without touching theta
+   */
+  void start(std::function<ArcOdometry::reading()> sensors_get, std::function<ArcOdometry::pose()> pose_get,
+             std::function<void(double, double)> xy_set);
+
+  /**
+   * Same as start() without the task, for running update() from a ControlExecutive.  Set period
+   * to how often update() is called.
+   */
+  void attach(std::function<ArcOdometry::reading()> sensors_get, std::function<ArcOdometry::pose()> pose_get,
+              std::function<void(double, double)> xy_set);
+
+  /**
+   * Reads the sensors and writes x and y once.
+   */
+  void update();
+
+  /**
+   * Where the robot will be lead_ms from the last update, where it is with no lead.  Safe from
+   * any task.
+   */
+  ArcOdometry::pose predicted() const;
+
+  /**
+   * Longest time between two updates so far, in ms.
+   */
+  std::uint32_t worst_period = 0;
+
+ private:
+  void service();
+
+  std::function<ArcOdometry::reading()> read;
+  std::function<ArcOdometry::pose()> get;
+  std::function<void(double, double)> set;
+  ArcOdometry::pose written = {0, 0, 0};
+  double last_heading = 0;  // imu at the last update
+  std::uint32_t previous = 0;
+  std::atomic<double> ahead_x{0}, ahead_y{0}, ahead_theta{0};
+};
@@ -0,0 +1,217 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * A move along one axis within velocity, acceleration and optionally jerk limits.
+ *
+ * With no jerk limit it's a trapezoid: full acceleration, cruise, full deceleration.  With one
+ * the acceleration ramps up and down too, an S-curve, so the motor's torque never steps and the
+ * arm doesn't get jolted at the corners.  Moves end at rest.  A move can start moving, from where
+ * an earlier one was cut off, but only as a trapezoid, the S-curve is planned from rest.
+ */
+class MotionProfile {
+ public:
+  struct state {
+    double position = 0;
+    double velocity = 0;
+    double acceleration = 0;
+  };
+
+  /**
+   * Plans a move, replacing the last one.
+   *
+   * \param from
+   *        where it starts
+   * \param velocity
+   *        how fast it's already moving
+   * \param to
+   *        where it ends
+   * \param max_velocity
+   *        units per second
+   * \param max_acceleration
+   *        units per second squared
+   * \param max_jerk
+   *        units per second cubed, 0 for a trapezoid
+   */
+  void plan(double from, double velocity, double to, double max_velocity, double max_acceleration, double max_jerk = 0);
+
+  /**
+   * Where the move is at a time, at the end after it's over.
+   *
+   * \param t
+   *        seconds from the start
+   */
+  state sample(double t) const;
+
+  /**
+   * Seconds the move takes.
+   */
+  double duration() const;
+
+ private:
+  struct piece {
+    double duration;
+    double jerk;
+    state start;
+  };
+  static constexpr int MAX_PIECES = 8;
+
+  void add(double duration, double acceleration, double jerk);
+  void rest_to_rest(double from, double to, double max_velocity, double max_acceleration, double max_jerk);
+
+  piece pieces[MAX_PIECES] = {};
+  int count = 0;
+  double total = 0;
+  double end = 0;
+  double start_velocity = 0;
+};
+
+/**
+ * Drives an arm on one motor, like the lady brown, to positions without blocking.
+ *
+ * Every move is a MotionProfile from wherever the arm is.  Feedforward gives the voltage the
+ * profile needs, including kg * cos(angle) to hold the arm up against gravity, so the feedback
+ * only fixes small errors and the arm gets to the target without overshooting it.  Without the
+ * gravity term an arm past vertical falls into its target, and below it sags off it.
+ *
+ * go_to() only asks for the move, update() plans and runs it from the control loop, so the
+ * caller goes on.  Each go_to() returns a completion that says when that move is over and
+ * whether it got there, to wait on or check later.
+ *
+ * Positions are motor degrees, what the motor's get_position() reads.
+ *
+ * \b Example
+ * \code
+ * ArmController::completion scored = lb_arm.go_to(2000);
+ * chassis.pid_drive_set(6, 110);
+ * chassis.pid_wait();
+ * scored.wait(1500);
+ * \endcode
+ */
+class ArmController {
+ public:
+  double max_velocity = 1000;      // deg/s of the motor
+  double max_acceleration = 12000;  // deg/s^2
+  double max_jerk = 0;             // deg/s^3, 0 for a trapezoid, otherwise an S-curve
+  double kg = 0;                   // mV to hold the arm level
+  double ks = 0;                   // mV to overcome friction
+  double kv = 0;                   // mV per deg/s
+  double ka = 0;                   // mV per deg/s^2
+  double kp = 0;                   // mV per degree the arm is off the profile
+  double kd = 0;                   // mV per deg/s the arm is off the profile
+  double level = 0;                // motor degrees where the arm is level
+  double ratio = 1;                // motor degrees per degree the arm turns
+  double settle_error = 20;        // degrees from the target that counts as there
+  std::uint32_t settle_time = 50;  // ms it has to stay there
+  std::uint32_t timeout = 750;     // ms after the profile ends before the move gives up
+
+  /**
+   * Whether one go_to() is over, and how it went.  Cheap to copy, and safe to check from any
+   * task.
+   */
+  class completion {
+   public:
+    completion() = default;
+
+    /**
+     * True once the arm settled at the target, gave up, or was sent somewhere else.
+     */
+    bool done() const;
+
+    /**
+     * True if the arm settled at the target.
+     */
+    bool reached() const;
+
+    /**
+     * Waits until done(), or until timeout runs out if the arm never gets there, like when
+     * nothing is calling update().
+     *
+     * \param timeout
+     *        ms to wait at most, TIMEOUT_MAX to wait as long as it takes
+     *
+     * \return reached(), false if it timed out
+     */
+    bool wait(std::uint32_t timeout = TIMEOUT_MAX) const;
+
+   private:
+    friend class ArmController;
+    completion(const ArmController* arm, std::uint32_t id) : arm(arm), id(id) {}
+    const ArmController* arm = nullptr;
+    std::uint32_t id = 0;
+  };
+
+  /**
+   * \param motor
+   *        the arm's motor, tared with the arm at rest
+   */
+  explicit ArmController(pros::Motor& motor);
+
+  /**
+   * Sends the arm to a position.  A move still running is cut off, and the new one starts from
+   * where the arm is meant to be, at the speed it's going.  Sending it where it's already going
+   * gives back that move's completion.  Safe from any task.
+   *
+   * \param position
+   *        motor degrees
+   */
+  completion go_to(double position);
+
+  /**
+   * Plans new moves and drives the motor.  Call every tick of the control loop.  Before the
+   * first go_to() it leaves the motor alone.
+   */
+  void update();
+
+  /**
+   * Stops driving the motor and finishes the move, not reached, until the next go_to().
+   */
+  void release();
+
+  /**
+   * Where the last go_to() sends the arm.
+   */
+  double target() const;
+
+  /**
+   * Where the profile says the arm should be now.
+   */
+  MotionProfile::state reference() const;
+
+  /**
+   * Voltage update() last sent, in mV.
+   */
+  double output() const;
+
+ private:
+  // outcomes of the last few moves, a move older than that reads as not reached
+  static constexpr int OUTCOMES = 8;
+
+  void finish(bool reached);
+
+  pros::Motor& motor;
+  MotionProfile profile;
+  std::atomic<double> goal{0};
+  std::atomic<std::uint32_t> requested{0};  // id of the last go_to()
+  std::atomic<std::uint32_t> finished{0};   // every move up to this id is over
+  std::atomic<std::uint32_t> outcomes[OUTCOMES] = {};  // id * 2 + 1 if it was reached
+  std::uint32_t active = 0;                 // id update() is running
+  double goal_running = NAN;                // and where it goes, NAN after release()
+  std::uint32_t started = 0;                // ms the profile started
+  std::uint32_t in_range_since = 0;
+  bool in_range = false;
+  std::atomic<double> ref_position{0}, ref_velocity{0}, ref_acceleration{0};
+  std::atomic<double> last_output{0};
+};
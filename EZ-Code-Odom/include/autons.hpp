@@ -1,5 +1,26 @@
 #pragma once
 
+#include "feedforward.hpp"
+#include "latency.hpp"
+#include "motion_queue.hpp"
+#include "odom_calibration.hpp"
+#include "ramsete_follower.hpp"
+
+// Where calibrate_odom() saves and initialize() loads from
+inline const char* ODOM_CALIBRATION_PATH = "/usd/odom_calibration.txt";
+// Where characterize_drive() saves and initialize() loads from
+inline const char* FEEDFORWARD_PATH = "/usd/feedforward.txt";
+
+// Drives straight on the drive's feedforward constants instead of EZ's drive PID
+extern ProfiledDrive profiled_drive;
+// Follows time profiled paths with Ramsete instead of EZ's pure pursuit, on the same constants
+extern RamseteFollower ramsete;
+// Runs queued drives and turns as one motion on ramsete, without stopping between them
+extern MotionQueue motion_queue;
+
+// The pose ramsete acts on, arc odometry's prediction ARC_ODOM_LEAD ahead when it's running
+ez::pose follower_pose_get();
+
 void default_constants();
 
 void drive_example();
@@ -12,10 +33,18 @@ void combining_movements();
 void interfered_example();
 void odom_drive_example();
 void odom_pure_pursuit_example();
+void odom_profiled_path_example();
+void odom_ramsete_example();
+void motion_queue_example();
+void feedforward_drive_example();
 void odom_pure_pursuit_wait_until_example();
 void odom_boomerang_example();
 void odom_boomerang_injected_pure_pursuit_example();
 void measure_offsets();
+void measure_latency();
+void characterize_drive();
+void calibrate_odom();
+void odom_calibration_apply(const OdomCalibration::result& r);
 void old_blue_negative_auton();
 void old_red_negative_auton();
 void old_skills_auton();
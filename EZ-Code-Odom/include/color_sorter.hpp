@@ -0,0 +1,275 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "intake_jam.hpp"
+#include "pros/motors.hpp"
+#include "pros/optical.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * Throws wrong colored rings off the top of the hooks without ever blocking the intake.
+ *
+ * Rings are timestamped when they reach the optical sensor, along with where the hook motor was
+ * right then.  A wrong colored ring is ejected once the hooks have carried it eject_travel
+ * degrees further, so the eject follows the belt whether it's running at full speed, slowed by
+ * a jam or stopped.  Every call to output() gives the hook speed to use right now, which is the
+ * commanded speed except while ejecting, so the intake keeps getting fresh commands.
+ *
+ * Nothing here talks to devices, SortingIntake feeds it from the optical sensor and hook motor.
+ */
+class ColorSorter {
+ public:
+  enum ring_color { NONE = 0,
+                    RED = 1,
+                    BLUE = 2 };
+
+  /**
+   * Most rings the sorter tracks between the sensor and the top of the hooks at once.
+   */
+  static constexpr int MAX_RINGS = 4;
+
+  /**
+   * Proximity a ring has to come within to count as seen.  It has to drop back below
+   * proximity_clear before the next ring counts.
+   */
+  int proximity_seen = 200;
+  int proximity_clear = 150;
+
+  /**
+   * Hue ranges for each color.  Blue is 240 and red is 0, and our hooks are purple at about 300.
+   */
+  double red_hue_max = 50;
+  double blue_hue_min = 180;
+  double blue_hue_max = 240;
+
+  /**
+   * Hook motor degrees from the sensor to where a ring flies off.  The old sorter waited 180 ms
+   * at about 190 rpm.
+   */
+  double eject_travel = 205;
+
+  /**
+   * Hook speed while ejecting and for how long.  Stopping the hooks flings the ring.
+   */
+  int eject_speed = 0;
+  std::uint32_t eject_ms = 400;
+
+  /**
+   * Sets the color to keep.  NONE turns sorting off, rings already seen are forgotten.
+   *
+   * \param color
+   *        RED or BLUE to keep, NONE to keep everything
+   */
+  void keep_set(ring_color color);
+
+  /**
+   * Returns the color being kept.
+   */
+  ring_color keep_get() const;
+
+  /**
+   * Works out the color of a hue, NONE if it's neither.
+   *
+   * \param hue
+   *        optical sensor hue, 0 to 360
+   */
+  ring_color classify(double hue) const;
+
+  /**
+   * Checks one optical reading.  Returns true when a new ring just reached the sensor.
+   *
+   * This is cheap, and is meant to run in a task that watches the sensor and wakes the intake
+   * task when it returns true.
+   *
+   * \param proximity
+   *        optical sensor proximity, 0 to 255
+   */
+  bool proximity_check(int proximity);
+
+  /**
+   * Records a ring at the sensor.  Rings that are the right color or not a ring color are only
+   * counted.
+   *
+   * \param time
+   *        ms when the ring was seen
+   * \param hue
+   *        optical sensor hue
+   * \param hook_position
+   *        hook motor position in degrees when the ring was seen
+   */
+  void ring_seen(std::uint32_t time, double hue, double hook_position);
+
+  /**
+   * Returns the hook speed to use now.  Call this every time the intake is serviced.
+   *
+   * \param time
+   *        ms now
+   * \param hook_position
+   *        hook motor position in degrees, increasing as rings go up
+   * \param commanded
+   *        -127 to 127, hook speed the rest of the code wants
+   */
+  int output(std::uint32_t time, double hook_position, int commanded);
+
+  /**
+   * Returns how many ms the intake task can wait before output() would change, given how fast
+   * the hooks are going.  At least 1 and never more than most_ms.
+   *
+   * \param time
+   *        ms now
+   * \param hook_position
+   *        hook motor position in degrees
+   * \param hook_rpm
+   *        hook motor velocity
+   * \param most_ms
+   *        the intake task's normal period
+   */
+  std::uint32_t wait_ms(std::uint32_t time, double hook_position, double hook_rpm, std::uint32_t most_ms) const;
+
+  /**
+   * Returns true while the hooks are being held for an eject.
+   */
+  bool ejecting() const;
+
+  /**
+   * Rings seen, rings ejected and rings dropped because MAX_RINGS were already being tracked.
+   */
+  std::uint32_t seen = 0;
+  std::uint32_t ejected = 0;
+  std::uint32_t dropped = 0;
+
+  /**
+   * ms from seeing the last ejected ring to ejecting it, so eject_travel can be checked against
+   * how long the old fixed delay was.
+   */
+  std::uint32_t last_travel_ms = 0;
+
+ private:
+  struct ring {
+    std::uint32_t time;
+    double position;
+  };
+  ring rings[MAX_RINGS] = {};  // wrong colored rings on the hooks, oldest first
+  int ring_count = 0;
+  ring_color keep = NONE;
+  bool present = false;
+  bool holding = false;
+  std::uint32_t hold_until = 0;
+};
+
+/**
+ * The intake with color sorting and jam recovery, run by two tasks or by update().
+ *
+ * The watch task reads the optical sensor as often as it updates and notifies the intake task the
+ * moment a ring shows up, with the time it was seen.  The intake task sleeps until that
+ * notification, the next eject, the end of a jam reversal, or its normal period, whichever comes
+ * first, and moves both intake motors every time it wakes up.
+ *
+ * The intake is the only thing that moves its motors.  Everything else asks it for speeds with
+ * request(), and the highest source asking gets them.  A jam reversal overrides that, and a color
+ * sort eject overrides everything.
+ */
+class SortingIntake {
+ public:
+  /**
+   * Who can ask for intake speeds, lowest priority first.
+   */
+  enum source { DRIVER = 0,
+                AUTON = 1,
+                SOURCES = 2 };
+
+  /**
+   * \param hooks
+   *        top stage, the one that flings rings
+   * \param low
+   *        bottom stage
+   * \param sensor
+   *        optical sensor looking at rings on the hooks
+   */
+  SortingIntake(pros::Motor& hooks, pros::Motor& low, pros::Optical& sensor);
+
+  /**
+   * Starts both tasks.  The team is read every time the intake is serviced.
+   *
+   * \param team
+   *        1 keeps red, 0 keeps blue, anything else keeps everything
+   */
+  void start(const int* team);
+
+  /**
+   * Same as start() without the tasks, for running update() from a ControlExecutive.
+   */
+  void attach(const int* team);
+
+  /**
+   * Asks for both stage speeds, replacing what this source asked for before.  Safe from any
+   * task.
+   *
+   * \param from
+   *        who's asking
+   * \param hooks_speed
+   *        -127 to 127, top stage
+   * \param low_speed
+   *        -127 to 127, bottom stage
+   */
+  void request(source from, int hooks_speed, int low_speed);
+
+  /**
+   * Asks for one stage's speed and keeps what this source asked of the other.
+   */
+  void hooks_request(source from, int speed);
+  void low_request(source from, int speed);
+
+  /**
+   * Drops a source's request, so the one below gets the intake.  With nobody asking it stops.
+   */
+  void release(source from);
+
+  /**
+   * Returns the source the intake is listening to, SOURCES if nobody is asking.
+   */
+  source owner() const;
+
+  /**
+   * Checks the optical sensor and moves both intake motors once.  A ring is seen on the first
+   * update after it shows up instead of within watch_period, so call this at least that often.
+   */
+  void update();
+
+  /**
+   * Longest the intake task goes between commands, in ms.
+   */
+  std::uint32_t period = 10;
+
+  /**
+   * Optical integration time and how often the watch task reads it, in ms.
+   */
+  std::uint32_t watch_period = 5;
+
+  ColorSorter sorter;
+  JamDetector jam;
+
+ private:
+  void watch();
+  void service();
+  // moves both motors, given when the last ring was seen or 0, and returns how long it can wait
+  std::uint32_t serve(std::uint32_t seen_at);
+
+  pros::Motor& hooks;
+  pros::Motor& low;
+  pros::Optical& sensor;
+  std::atomic<int> hooks_speeds[SOURCES] = {};
+  std::atomic<int> low_speeds[SOURCES] = {};
+  std::atomic<bool> asking[SOURCES] = {};
+  int hooks_sent = 0;
+  const int* team = nullptr;
+  pros::task_t intake_task = nullptr;
+};
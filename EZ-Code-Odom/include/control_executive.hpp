@@ -0,0 +1,104 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "pros/rtos.hpp"
+
+/**
+ * Runs every subsystem's update from one fixed rate task, in the order they were added.
+ *
+ * With a task per subsystem, each sleeping its own pros::delay, nothing decides which runs first
+ * or how long after a sensor read its motor command goes out, and that changes from tick to
+ * tick.  Here one high priority task wakes on pros::Task::delay_until, so ticks start exactly a
+ * period apart, and runs each update once in a fixed order, sensors before the controllers that
+ * use them.  Every update is timed so a slow one shows up by name.
+ *
+ * Updates must not block.  One that runs past the end of the period delays the whole tick, the
+ * next tick starts straight away and the schedule skips ahead rather than running several ticks
+ * back to back to catch up.
+ *
+ * \b Example
+ * \code
+ * ControlExecutive executive;
+ * executive.add("lady brown", [] { lb_arm.update(); });
+ * executive.add("screen", ez_screen_update, 5);
+ * executive.start();
+ * \endcode
+ */
+class ControlExecutive {
+ public:
+  std::uint32_t period = 10;                       // ms between ticks
+  std::uint32_t priority = TASK_PRIORITY_MAX - 2;  // above EZ's tasks and anything left on the default
+
+  /**
+   * How one update has been running.
+   */
+  struct timing {
+    std::string name;
+    std::uint32_t every;        // runs every this many ticks
+    std::uint32_t budget_us;    // longer than this is an overrun
+    std::uint32_t runs = 0;
+    std::uint32_t overruns = 0;
+    std::uint32_t last_us = 0;
+    std::uint32_t worst_us = 0;
+    std::uint64_t total_us = 0;
+
+    double mean_us() const { return runs > 0 ? (double)total_us / runs : 0; }
+  };
+
+  /**
+   * Adds an update to the end of the order.  Add them all before start().
+   *
+   * \param name
+   *        what it's called in timings()
+   * \param update
+   *        runs once a tick, must not block
+   * \param every
+   *        runs every this many ticks, for things like the screen that don't need every one
+   * \param budget_us
+   *        how long it should take, 0 for the whole period
+   */
+  void add(const std::string& name, std::function<void()> update, std::uint32_t every = 1, std::uint32_t budget_us = 0);
+
+  /**
+   * Runs one tick, every update that's due, in order.  start() calls this every period, call it
+   * yourself to step the executive without a task.
+   */
+  void tick();
+
+  /**
+   * Starts the task.
+   */
+  void start();
+
+  /**
+   * Every update's timing, in order.
+   */
+  const std::vector<timing>& timings() const;
+
+  /**
+   * Clears every timing and the counts below, to measure from a known point like the start of
+   * an auton.
+   */
+  void timings_reset();
+
+  std::uint32_t ticks = 0;            // ticks run
+  std::uint32_t overruns = 0;         // ticks that took longer than the period
+  std::uint32_t skipped = 0;          // ticks dropped catching up after an overrun
+  std::uint32_t worst_tick_us = 0;    // longest tick
+
+ private:
+  void service();
+
+  std::vector<std::function<void()>> updates;
+  std::vector<timing> times;
+};
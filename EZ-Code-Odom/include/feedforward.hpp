@@ -0,0 +1,194 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "pros/motors.hpp"
+
+/**
+ * Voltage a drive side needs for a velocity and acceleration, before any feedback.
+ *
+ *   mV = ks * sign(velocity) + kv * velocity + ka * acceleration
+ *
+ * ks is what friction takes, kv is back emf and ka is the robot's mass.  A DC motor drive is
+ * close to linear like this, so with the constants right a PID only has to fix small errors and
+ * doesn't need the large kD that keeps a feedback only drive from overshooting.
+ *
+ * Velocities are inches per second and accelerations inches per second squared.
+ */
+struct Feedforward {
+  double ks = 0;  // mV
+  double kv = 0;  // mV per in/s
+  double ka = 0;  // mV per in/s^2
+
+  double voltage(double velocity, double acceleration) const;
+};
+
+/**
+ * Fits Feedforward constants to what a drive side did, by least squares.
+ *
+ * Samples are kept as running sums, so any number can go in.  Samples where the robot is nearly
+ * stopped are left out, static friction isn't ks and the sign of the velocity isn't known.
+ */
+class FeedforwardFit {
+ public:
+  /**
+   * \param mv
+   *        voltage the motors had
+   * \param velocity
+   *        how fast that side went, in/s
+   * \param acceleration
+   *        how fast it sped up, in/s^2
+   */
+  void sample_add(double mv, double velocity, double acceleration);
+
+  /**
+   * Solves for the constants.  Returns false if the samples can't tell them apart, which
+   * takes both steady driving and accelerating.
+   */
+  bool solve(Feedforward& out) const;
+
+  /**
+   * Fraction of the voltage's variance the constants explain, 1 is a perfect fit.
+   */
+  double r_squared(const Feedforward& ff) const;
+
+  int samples() const;
+  void clear();
+
+  /**
+   * Writes constants to a file, one "name value" per line.  Returns false if the file couldn't be
+   * opened.
+   */
+  static bool save(const Feedforward& ff, const char* path);
+
+  /**
+   * Reads a file save() wrote.  Returns false and leaves ff alone if it isn't there or is
+   * incomplete.
+   */
+  static bool load(Feedforward& ff, const char* path);
+
+ private:
+  double xtx[3][3] = {};  // sums of products of sign(v), v and a
+  double xty[3] = {};     // and each with the voltage
+  double yy = 0, y = 0;
+  int n = 0;
+};
+
+/**
+ * Finds the drive's Feedforward constants by driving straight.
+ *
+ * Quasistatic tests ramp the voltage slowly, so the robot barely accelerates and the voltage is
+ * all ks and kv.  Step tests jump straight to a voltage, so early on most of it goes to ka.  Each
+ * runs forwards then backwards, so the robot ends up about where it started, but it needs about 5
+ * feet clear in front.
+ *
+ * \param left
+ *        left drive motors, like chassis.left_motors
+ * \param right
+ *        right drive motors, like chassis.right_motors
+ * \param inches_per_rev
+ *        inches the robot goes per motor turn, wheel circumference times the gear ratio
+ * \param fit
+ *        if given, gets every sample, for r_squared()
+ */
+Feedforward feedforward_characterize(std::vector<pros::Motor>& left, std::vector<pros::Motor>& right, double inches_per_rev,
+                                     FeedforwardFit* fit = nullptr);
+
+/**
+ * Trapezoidal velocity profile, speeding up at max_acceleration to max_velocity, cruising, and
+ * slowing to a stop at the target.  Short moves never reach max_velocity and are a triangle.
+ */
+class Trapezoid {
+ public:
+  struct state {
+    double position, velocity, acceleration;
+  };
+
+  /**
+   * \param distance
+   *        inches, negative to go backwards
+   * \param max_velocity
+   *        in/s
+   * \param max_acceleration
+   *        in/s^2
+   */
+  Trapezoid(double distance, double max_velocity, double max_acceleration);
+
+  /**
+   * Where the profile is this many seconds in.
+   */
+  state at(double seconds) const;
+
+  /**
+   * Seconds the whole profile takes.
+   */
+  double duration() const;
+
+ private:
+  double direction, accel, cruise, accel_time, cruise_time;
+};
+
+/**
+ * Drives straight with feedforward plus feedback, tracking a Trapezoid instead of chasing the
+ * target.
+ *
+ * Every loop the profile says where the robot should be, how fast it should be going and how
+ * fast it should be speeding up.  The feedforward gives the voltage for that velocity and
+ * acceleration, and a PD on how far the robot is behind or ahead of the profile fixes the rest.
+ * The feedback only ever sees small errors, so it can be gentle and the robot settles as soon as
+ * the profile ends.
+ */
+class ProfiledDrive {
+ public:
+  Feedforward feedforward;
+
+  double max_velocity = 54;       // in/s, leave headroom under the top speed for feedback
+  double max_acceleration = 200;  // in/s^2
+  double kp = 600;                // mV per inch off the profile
+  double kd = 30;                 // mV per in/s off the profile
+  double heading_kp = 150;        // mV per degree off the starting heading
+  double exit_error = 0.5;        // inches from the target to count as there
+  std::uint32_t settle_time = 50; // ms it has to stay there
+  std::uint32_t period = 10;      // ms
+
+  /**
+   * \param distance_get
+   *        inches the drive has gone, like the average of chassis.drive_sensor_left() and right
+   * \param heading_get
+   *        degrees, like chassis.drive_imu_get()
+   * \param voltage_set
+   *        sets each side's voltage in mV
+   */
+  ProfiledDrive(std::function<double()> distance_get, std::function<double()> heading_get,
+                std::function<void(double, double)> voltage_set);
+
+  /**
+   * Drives a distance and stops.  Blocks until it's there or timed out.
+   *
+   * \param inches
+   *        negative to go backwards
+   * \param timeout
+   *        ms, 0 for no timeout
+   *
+   * \return false if it timed out
+   */
+  bool drive(double inches, std::uint32_t timeout = 0);
+
+  /**
+   * Largest distance the robot was behind or ahead of the profile on the last drive, in inches.
+   */
+  double worst_error = 0;
+
+ private:
+  std::function<double()> distance_get;
+  std::function<double()> heading_get;
+  std::function<void(double, double)> voltage_set;
+};
@@ -0,0 +1,88 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Notices the hooks jamming and runs them back to free the ring.
+ *
+ * A jammed motor is one being driven that isn't turning and is drawing close to its current
+ * limit.  Once the hooks have been like that for stall_ticks updates in a row they're reversed
+ * for reverse_ms, then handed back to whatever was commanded.  If they jam again straight away
+ * they're reversed again, up to max_retries times, and then left stopped until the command
+ * changes, so a ring that won't come free doesn't burn out the motor.
+ *
+ * Right after the hooks start driving they're slow and draw a lot while they speed up, so the
+ * first spin_up_ms doesn't count.
+ *
+ * Nothing here talks to devices, SortingIntake feeds it from the hook motor.
+ */
+class JamDetector {
+ public:
+  bool enabled = true;
+  double stall_rpm = 30;             // hooks slower than this, in the direction driven, aren't turning
+  int stall_current = 1800;          // mA, and drawing at least this are stalled
+  int min_speed = 40;                // speeds sent below this are never a jam
+  int stall_ticks = 2;               // updates in a row stalled before it's a jam
+  std::uint32_t spin_up_ms = 100;    // after the hooks start driving, before they can stall
+  int reverse_speed = 127;           // run back at this, against the way they jammed
+  std::uint32_t reverse_ms = 150;
+  int max_retries = 3;               // reversals in a row before giving up
+  std::uint32_t clear_ms = 1000;     // without a jam this long, the retries start over
+
+  /**
+   * Returns the hook speed to use now.  Call every time the intake is serviced.
+   *
+   * \param time
+   *        ms now
+   * \param commanded
+   *        -127 to 127, hook speed the rest of the code wants
+   * \param sent
+   *        -127 to 127, what the hooks were last sent, which can differ while ejecting
+   * \param rpm
+   *        hook motor velocity, positive the way a positive speed drives them
+   * \param current_ma
+   *        hook motor current draw
+   */
+  int output(std::uint32_t time, int commanded, int sent, double rpm, int current_ma);
+
+  /**
+   * Returns how many ms the intake task can wait before output() would change.  At least 1 and
+   * never more than most_ms.
+   */
+  std::uint32_t wait_ms(std::uint32_t time, std::uint32_t most_ms) const;
+
+  /**
+   * Returns true while the hooks are being run back.
+   */
+  bool reversing() const;
+
+  /**
+   * Returns true once it's given up and is holding the hooks stopped.
+   */
+  bool stuck() const;
+
+  /**
+   * Jams found, reversals run and times it gave up.
+   */
+  std::uint32_t jams = 0;
+  std::uint32_t reversals = 0;
+  std::uint32_t give_ups = 0;
+
+ private:
+  int driving = 0;                 // -1, 0 or 1, direction the hooks were last sent
+  std::uint32_t driving_since = 0;
+  int stalled = 0;                 // updates in a row
+  int jam_direction = 0;
+  bool backing = false;
+  std::uint32_t reverse_until = 0;
+  int retries = 0;
+  std::uint32_t last_jam = 0;
+  bool holding = false;
+  int holding_command = 0;         // the command it gave up on
+};
@@ -0,0 +1,43 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "pros/imu.hpp"
+#include "pros/motors.hpp"
+
+/**
+ * How stale the robot's view of itself is.
+ *
+ * A command takes actuation_ms to show up as the wheels moving, and by the time a controller
+ * reads the pose its sensors are sensor_age_ms old on average.  A controller looking lead_ms()
+ * ahead acts on where the robot will be when its command lands.
+ */
+struct latency_model {
+  double actuation_ms = 0;
+  double sensor_age_ms = 0;
+
+  double lead_ms() const { return actuation_ms + sensor_age_ms; }
+};
+
+/**
+ * Measures latency_model by spinning the robot in place a few times.
+ *
+ * Each trial commands full power and times how long until the motors report moving, then keeps
+ * spinning to see how often the imu's reading changes.  The robot needs room to turn.
+ *
+ * \param left
+ *        left drive motors, like chassis.left_motors
+ * \param right
+ *        right drive motors, like chassis.right_motors
+ * \param imu
+ *        the imu odometry uses
+ * \param trials
+ *        how many spins to average, alternating directions
+ */
+latency_model latency_measure(std::vector<pros::Motor>& left, std::vector<pros::Motor>& right, pros::Imu& imu, int trials = 4);
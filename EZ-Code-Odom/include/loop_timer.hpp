@@ -0,0 +1,133 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "pros/rtos.hpp"
+
+/**
+ * Measures how a loop actually runs against the period it's meant to.
+ *
+ * Every pass records the time since the last one, how late it came and how long the body took
+ * from begin() to end().  A pass more than the deadline late counts as a miss.  Works the same
+ * for a loop in its own task, like opcontrol(), and for an update the ControlExecutive runs,
+ * where the executive's own timing only sees how long the update took and not when it ran.
+ *
+ * Counters are atomic so the screen can read them while the loop runs, and every timer registers
+ * itself the first time it starts, for loop_timers_print() to find.
+ *
+ * \b Example
+ * \code
+ * LoopTimer driver_loop("opcontrol", ez::util::DELAY_TIME);
+ * void opcontrol() {
+ *   driver_loop.start();
+ *   while (true) {
+ *     driver_loop.begin();
+ *     // ...
+ *     driver_loop.delay(ez::util::DELAY_TIME);
+ *   }
+ * }
+ * \endcode
+ */
+class LoopTimer {
+ public:
+  static constexpr int MAX_TIMERS = 8;  // most that can register
+  static constexpr int MAX_NAME = 11;   // longest name, not counting the \0
+
+  /**
+   * \param name
+   *        what loop_timers_print() calls it
+   * \param period
+   *        ms the loop is meant to run every
+   * \param deadline
+   *        ms late a pass can be before it's a miss, half the period by default
+   */
+  LoopTimer(const char* name, std::uint32_t period, std::uint32_t deadline = 0);
+
+  LoopTimer(const LoopTimer&) = delete;
+  LoopTimer& operator=(const LoopTimer&) = delete;
+
+  /**
+   * Call before the loop.  The first call registers the timer, later ones, like opcontrol()
+   * starting again each time driver control does, only reset().
+   */
+  void start();
+
+  /**
+   * Marks the start of a pass.
+   */
+  void begin();
+
+  /**
+   * Marks the end of a pass.
+   */
+  void end();
+
+  /**
+   * end() then pros::delay().
+   */
+  void delay(std::uint32_t ms);
+
+  /**
+   * Forgets everything measured so far.  Can be called from any task.
+   */
+  void reset();
+
+  struct stats {
+    std::uint32_t passes = 0;     // periods measured
+    double period_mean = 0;       // ms
+    std::uint32_t period_max = 0; // ms
+    std::uint32_t late_max = 0;   // ms the latest pass was behind the period
+    std::uint32_t misses = 0;     // passes more than the deadline late
+    double busy_percent = 0;      // of the time, in the loop body
+    std::uint32_t busy_max = 0;   // us, longest loop body
+  };
+
+  /**
+   * Everything measured since start() or reset(), from any task.
+   */
+  stats stats_get() const;
+
+  const char* name_get() const;
+  std::uint32_t period_get() const;
+
+  /**
+   * Timers that have started, in the order they did.
+   */
+  static int count();
+  static LoopTimer* get(int index);
+
+ private:
+  char name[MAX_NAME + 1];
+  std::uint32_t period;
+  std::uint32_t deadline;
+
+  std::atomic<std::uint32_t> passes = 0;
+  std::atomic<std::uint64_t> period_total = 0;  // us
+  std::atomic<std::uint32_t> period_max = 0;    // us
+  std::atomic<std::uint32_t> late_max = 0;      // us
+  std::atomic<std::uint32_t> misses = 0;
+  std::atomic<std::uint64_t> busy_total = 0;    // us
+  std::atomic<std::uint32_t> busy_max = 0;      // us
+  std::atomic<std::uint64_t> since = 0;         // us, when measuring started
+  std::atomic<bool> fresh = true;               // next begin() has no period before it
+  std::atomic<bool> started = false;
+  std::uint64_t last_begin = 0;
+};
+
+/**
+ * Prints every timer on the brain screen, one a line from first_line.  When there are more than
+ * fit below it they're shown a page at a time, counting page up cycles through them.
+ *
+ * \param first_line
+ *        screen line the first timer goes on
+ * \param page
+ *        which screenful to show, wrapping around past the last
+ */
+void loop_timers_print(int first_line, int page = 0);
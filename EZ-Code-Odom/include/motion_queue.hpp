@@ -0,0 +1,188 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "EZ-Template/util.hpp"
+#include "profiled_path.hpp"
+#include "ramsete_follower.hpp"
+
+/**
+ * Queues drives, turns, swings and paths ahead of time and runs them as one motion.
+ *
+ * EZ's motions each run their own PID to an exit condition, so the robot slows and settles
+ * between every pair of them, even chained.  Here the whole queue is planned up front into one
+ * trajectory.  A turn between two drives the same way becomes an arc of blend_radius, drives in
+ * a row become one, and the speed runs straight through every boundary it can, limited only by
+ * what the wheels can do.  The robot only stops where it has to, where it changes direction or
+ * turns in place.  RamseteFollower then tracks the plan, so there are no exit conditions until
+ * the very end.
+ *
+ * Triggers queued after a motion fire from the control loop, the tick the robot gets close to
+ * where that motion ends, so mechanisms don't wait for the drive to settle.
+ *
+ * \b Example
+ * \code
+ * motion_queue.drive(-23).within(1, [] { mogoclamp.set(true); })
+ *             .turn(-110).drive(21).start();
+ * motion_queue.wait();
+ * \endcode
+ */
+class MotionQueue {
+ public:
+  double max_velocity = 54;       // in/s, of either wheel, leave headroom for feedback
+  double max_acceleration = 150;  // in/s^2, of either wheel
+  double max_lateral = 150;       // in/s^2 before the omnis slide in a turn
+  double max_jump = 20;           // in/s either wheel's speed can change by at once, entering or leaving an arc
+  double blend_radius = 8;        // inches, turns between drives become arcs this tight, 0 turns in place
+  double spacing = 0.5;           // inches of wheel travel between planned points
+
+  /**
+   * \param follower
+   *        tracks the plan, with the drive's feedforward set
+   * \param pose_get
+   *        where the robot is, like chassis.odom_pose_get(), the plan starts there
+   */
+  MotionQueue(RamseteFollower& follower, std::function<ez::pose()> pose_get);
+
+  /**
+   * Drives straight.
+   *
+   * \param inches
+   *        negative to go backwards
+   */
+  MotionQueue& drive(double inches);
+
+  /**
+   * Turns to face a heading, in place or, between two drives the same way, as an arc.
+   *
+   * \param heading
+   *        degrees, same as chassis.odom_theta_get()
+   */
+  MotionQueue& turn(double heading);
+
+  /**
+   * Turns to face a heading on one side of the drive, the other side holding still.
+   *
+   * \param heading
+   *        degrees, same as chassis.odom_theta_get()
+   * \param side
+   *        ez::LEFT_SWING moves the left side, like pid_swing_set
+   */
+  MotionQueue& swing(double heading, ez::e_swing side);
+
+  /**
+   * Drives through a path's points from where the last motion ends, facing along it.  Only the
+   * points are used, the queue plans its own speeds.
+   *
+   * \param points
+   *        from profiled_path_trajectory()
+   * \param direction
+   *        fwd, or rev to drive it with the back of the robot
+   */
+  MotionQueue& path(const std::vector<trajectory_point>& points, ez::drive_directions direction = ez::fwd);
+
+  /**
+   * Runs action once, from the control loop, when the robot comes within some distance of where
+   * the last queued motion ends, or the plan passes there.
+   *
+   * \param inches
+   *        how close is close enough
+   * \param action
+   *        keep it quick, it runs between control steps
+   */
+  MotionQueue& within(double inches, std::function<void()> action);
+
+  /**
+   * Plans everything queued from where the robot is, tracks it and empties the queue.  Blocks
+   * until the robot is at the end or it timed out.
+   *
+   * \param timeout
+   *        ms, 0 for no timeout
+   *
+   * \return false if it timed out
+   */
+  bool run(std::uint32_t timeout = 0);
+
+  /**
+   * run() in its own task, so the auton can go on.
+   */
+  void start(std::uint32_t timeout = 0);
+
+  /**
+   * Waits for start() to finish.
+   *
+   * \return false if it timed out
+   */
+  bool wait();
+
+  /**
+   * Whether start()'s task is still running.
+   */
+  bool running() const;
+
+  /**
+   * Seconds the last plan takes, from run().
+   */
+  double duration() const;
+
+  /**
+   * One planned point.  Progress is wheel travel, inches of the faster wheel, and everything
+   * else moves with it at a fixed rate within a piece.
+   */
+  struct sample {
+    double progress;         // inches of wheel travel from the start
+    double x, y, direction;  // inches, radians counterclockwise from +x the robot faces
+    double forward;          // inches the robot moves per inch of progress, negative backwards
+    double turn;             // radians it turns counterclockwise per inch of progress
+    double velocity;         // of the faster wheel, in/s
+    double acceleration;     // of the faster wheel until the next sample, in/s^2
+    double time;             // seconds from the start
+  };
+
+  /**
+   * Plans the queue from a pose without running it or emptying the queue.
+   */
+  std::vector<sample> plan(const ez::pose& start) const;
+
+ private:
+  enum piece_kind { LINE, ARC, SPIN };
+  struct piece {
+    piece_kind kind;
+    double length;  // inches the center goes, 0 spinning
+    double angle;   // radians turned counterclockwise
+    int direction;  // 1 forwards, -1 backwards
+  };
+  struct motion {
+    enum { DRIVE, TURN, SWING, PATH } kind;
+    double value;  // inches or degrees
+    ez::e_swing side;
+    std::vector<trajectory_point> points;
+    ez::drive_directions path_direction;
+  };
+  struct trigger {
+    int motion;  // fires near where queue[motion] ends
+    double inches;
+    std::function<void()> action;
+  };
+
+  std::vector<piece> pieces_build(const ez::pose& start, std::vector<int>& motion_ends) const;
+  std::vector<sample> samples_build(const ez::pose& start, const std::vector<piece>& pieces, const std::vector<int>& piece_ends,
+                                    std::vector<int>& motion_samples) const;
+
+  RamseteFollower& follower;
+  std::function<ez::pose()> pose_get;
+  std::vector<motion> queue;
+  std::vector<trigger> triggers;
+  double planned = 0;
+  std::atomic<bool> busy = false;
+  bool last_result = true;
+};
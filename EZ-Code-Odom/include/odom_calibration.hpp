@@ -0,0 +1,127 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Solves for tracking wheel offsets, tracking wheel diameters and the imu's scale from samples
+ * taken while the robot spins and drives, by least squares.
+ *
+ * Three kinds of samples go in:
+ *  - spins, every loop while turning in place, where the trackers only roll because they're off
+ *    center
+ *  - legs, once per straight drive, with how far the robot really went from a distance sensor
+ *    reading off a wall before and after
+ *  - headings, once per trip away from a wall and back, with how far the imu says the robot
+ *    turned in between.  Squaring against the wall again makes the real turn a whole number of
+ *    revolutions
+ *
+ * Headings give the imu's scale, legs give the vertical tracker's diameter, and spins give both
+ * offsets.  A tank drive never slides sideways far enough to measure the horizontal tracker's
+ * diameter, so it's assumed to be off by as much as the vertical one's, which is right when
+ * they're the same wheel.
+ *
+ * Offsets are inches right of center for the vertical tracker and forward of center for the
+ * horizontal one.  Every result comes with the half width of its 95% confidence interval.
+ */
+class OdomCalibration {
+ public:
+  static constexpr int MAX_SPINS = 3000;
+  static constexpr int MAX_LEGS = 32;
+  static constexpr int MAX_HEADINGS = 32;
+
+  struct estimate {
+    double value = 0;
+    double plus_minus = 0;  // 95% confidence
+  };
+
+  struct result {
+    bool valid = false;
+    estimate imu_scale;  // for drive_imu_scaler_set()
+    estimate vertical_offset;
+    estimate horizontal_offset;
+    estimate vertical_diameter;
+    estimate horizontal_diameter;
+    int spins = 0, legs = 0, headings = 0;
+  };
+
+  /**
+   * \param vertical_diameter
+   *        what the vertical tracker's readings assume its diameter is
+   * \param horizontal_diameter
+   *        what the horizontal tracker's readings assume its diameter is
+   */
+  OdomCalibration(double vertical_diameter, double horizontal_diameter);
+
+  /**
+   * One loop of turning in place.
+   *
+   * \param vertical
+   *        inches the vertical tracker read
+   * \param horizontal
+   *        inches the horizontal tracker read
+   * \param imu
+   *        degrees the imu turned, unscaled
+   */
+  void spin_add(double vertical, double horizontal, double imu);
+
+  /**
+   * One straight drive.
+   *
+   * \param vertical
+   *        inches the vertical tracker read
+   * \param imu
+   *        degrees the imu turned, unscaled
+   * \param forward
+   *        inches the robot really went, from a distance sensor
+   */
+  void leg_add(double vertical, double imu, double forward);
+
+  /**
+   * Degrees the imu turned, unscaled, between two times the robot was squared on the same wall.
+   */
+  void heading_add(double imu);
+
+  /**
+   * Solves with everything added so far.  Not valid until there are at least two of each kind
+   * of sample.
+   */
+  result solve() const;
+
+  /**
+   * Forgets every sample.
+   */
+  void clear();
+
+  /**
+   * Writes a result to a file, one "name value plus_minus" per line.  Returns false if the file
+   * couldn't be opened.
+   */
+  static bool save(const result& r, const char* path);
+
+  /**
+   * Reads a file save() wrote.  Returns false and leaves r alone if it isn't there or is
+   * incomplete.
+   */
+  static bool load(result& r, const char* path);
+
+ private:
+  struct spin {
+    float vertical, horizontal, imu;
+  };
+  struct leg {
+    float vertical, imu, forward;
+  };
+
+  double vertical_diameter;
+  double horizontal_diameter;
+  spin spins[MAX_SPINS] = {};
+  leg legs[MAX_LEGS] = {};
+  float headings[MAX_HEADINGS] = {};
+  int spin_count = 0, leg_count = 0, heading_count = 0;
+};
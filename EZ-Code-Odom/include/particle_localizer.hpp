@@ -0,0 +1,281 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "pros/distance.hpp"
+#include "pros/gps.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * A straight edge of the field map, in inches.
+ */
+struct field_segment {
+  float x1, y1, x2, y2;
+};
+
+/**
+ * What a distance sensor can see, as segments.
+ */
+struct field_map {
+  const field_segment* segments;
+  int count;
+};
+
+/**
+ * The High Stakes field, centered on the middle of the field with +y away from the red
+ * alliance wall: the perimeter and the base of the ladder.  It's const, so it stays in the
+ * program image instead of being built at runtime.
+ */
+extern const field_map HIGH_STAKES_FIELD;
+
+/**
+ * Monte Carlo localization against a field_map.
+ *
+ * Each particle is a guess at the robot's pose.  Odometry moves every particle by the same
+ * amount plus noise, distance sensor beams and GPS fixes weight them by how well they agree with
+ * what each particle would have seen, and systematic resampling keeps the likely ones.  The
+ * estimate is the weighted mean.
+ *
+ * Particles live in fixed arrays, one per field, so the per particle loops run straight through
+ * memory and vectorize, and nothing allocates after construction.  Ray casting loops over
+ * segments outside and particles inside for the same reason.
+ *
+ * Poses are inches and degrees clockwise from +y, same as odometry, in the map's frame.
+ */
+class ParticleLocalizer {
+ public:
+  static constexpr int MAX_PARTICLES = 1000;
+  static constexpr int MAX_BEAMS = 4;
+
+  struct pose {
+    double x, y, theta;
+  };
+
+  /**
+   * Where a distance sensor is, inches right and forward of the tracking center, and which way
+   * it points in degrees clockwise from straight ahead.
+   */
+  struct beam {
+    float x;
+    float y;
+    float angle;
+  };
+
+  /**
+   * Odometry noise, as a fraction of each move plus a floor per update.
+   */
+  float move_noise = 0.05;
+  float move_floor = 0.02;    // inches
+  float turn_noise = 0.03;
+  float turn_floor = 0.1;     // degrees
+
+  /**
+   * Distance sensor model.  Readings are off by about range_noise of the distance, and
+   * sometimes hit something that isn't on the map, which random_hit accounts for.
+   */
+  float range_noise = 0.04;
+  float range_floor = 0.5;    // inches
+  float random_hit = 0.1;
+  int max_range = 2000;       // mm, readings past this are ignored
+
+  /**
+   * Resample when the effective number of particles falls below this fraction of the count.
+   */
+  float resample_below = 0.5;
+
+  /**
+   * \param map
+   *        what the distance sensors can see, has to outlive the localizer
+   * \param seed
+   *        random seed, so runs can be repeated
+   */
+  explicit ParticleLocalizer(const field_map& map, std::uint32_t seed = 1);
+
+  /**
+   * Adds a distance sensor.  Returns its index, or -1 if there are already MAX_BEAMS.
+   */
+  int beam_add(const beam& b);
+
+  /**
+   * Spreads particles around a pose.
+   *
+   * \param count
+   *        number of particles, at most MAX_PARTICLES
+   * \param start
+   *        where the robot probably is
+   * \param spread
+   *        standard deviation of x and y in inches
+   * \param theta_spread
+   *        standard deviation of theta in degrees
+   */
+  void reset(int count, const pose& start, double spread, double theta_spread);
+
+  /**
+   * Moves every particle by an odometry step.
+   *
+   * \param forward
+   *        inches forward in the robot's frame
+   * \param sideways
+   *        inches right in the robot's frame
+   * \param turn
+   *        degrees clockwise
+   */
+  void move(double forward, double sideways, double turn);
+
+  /**
+   * Weights particles by the distance sensors.
+   *
+   * \param ranges_mm
+   *        one pros::Distance::get() per beam, in the order they were added.  Anything out of
+   *        range is skipped
+   */
+  void ranges_update(const int* ranges_mm);
+
+  /**
+   * Weights particles by a GPS fix.
+   *
+   * \param x
+   *        inches, in the map's frame
+   * \param y
+   *        inches, in the map's frame
+   * \param error
+   *        standard deviation in inches, pros::Gps::get_error() converted
+   */
+  void gps_update(double x, double y, double error);
+
+  /**
+   * Resamples if the weights have gotten too uneven.  Returns true if it did.
+   */
+  bool resample();
+
+  /**
+   * Weighted mean of the particles.
+   */
+  pose estimate() const;
+
+  /**
+   * Standard deviation of the particles' distance from the estimate, in inches.
+   */
+  double spread() const;
+
+  int count() const;
+
+  std::uint32_t resamples = 0;
+
+ private:
+  void ray_cast(const beam& b);
+  void normalize();
+  float gaussian();
+  float uniform();
+
+  const field_map& map;
+  beam beams[MAX_BEAMS] = {};
+  int beam_count = 0;
+  int n = 0;
+  std::uint32_t rng;
+
+  // Structure of arrays, with a second set to resample into
+  float xs[2][MAX_PARTICLES] = {};
+  float ys[2][MAX_PARTICLES] = {};
+  float thetas[2][MAX_PARTICLES] = {};
+  float weights[MAX_PARTICLES] = {};
+  int current = 0;
+
+  // Per particle scratch for the sensor update: where each beam starts and points, and what it hits
+  float sines[MAX_PARTICLES] = {};
+  float cosines[MAX_PARTICLES] = {};
+  float origin_x[MAX_PARTICLES] = {};
+  float origin_y[MAX_PARTICLES] = {};
+  float direction_x[MAX_PARTICLES] = {};
+  float direction_y[MAX_PARTICLES] = {};
+  float expected[MAX_PARTICLES] = {};
+};
+
+/**
+ * Runs a ParticleLocalizer off odometry, distance sensors and an optional GPS, and writes the
+ * estimate back into odometry once the particles agree.
+ */
+class LocalizerService {
+ public:
+  /**
+   * \param map
+   *        what the distance sensors can see, has to outlive the service
+   */
+  explicit LocalizerService(const field_map& map);
+
+  ParticleLocalizer localizer;
+
+  /**
+   * Only corrects odometry while true.
+   */
+  bool enabled = false;
+
+  /**
+   * Odometry is only corrected when the particles are within this many inches of each other.
+   */
+  double correct_below = 1.5;
+
+  /**
+   * Where odometry's origin is in the map's frame.  Skills starts against the red wall.
+   */
+  double origin_x = 0;
+  double origin_y = 0;
+
+  int particles = 500;
+  std::uint32_t period = 10;
+
+  /**
+   * Adds a distance sensor.  Returns false if there are already ParticleLocalizer::MAX_BEAMS.
+   */
+  bool sensor_add(int port, const ParticleLocalizer::beam& where);
+
+  /**
+   * Uses a GPS sensor as well.
+   */
+  void gps_set(int port);
+
+  /**
+   * Starts the task, with the particles around where odometry is now.
+   *
+   * \param pose_get
+   *        returns where odometry thinks the robot is
+   * \param xy_set
+   *        moves odometry to a new x and y without touching theta
+   */
+  void start(std::function<ParticleLocalizer::pose()> pose_get, std::function<void(double, double)> xy_set);
+
+  /**
+   * Same as start() except the task only posts its corrections and update() makes them.  The
+   * filter takes too long to run inside a ControlExecutive tick, so it keeps its task, and
+   * update() goes in the executive after odometry so a correction can't land between odometry
+   * reading the pose and writing it back.
+   */
+  void attach(std::function<ParticleLocalizer::pose()> pose_get, std::function<void(double, double)> xy_set);
+
+  /**
+   * Moves odometry by the last correction the task posted, if it hasn't been made yet.  Never
+   * waits, a correction posted while the task is reading odometry is made next time.
+   */
+  void update();
+
+ private:
+  void service(bool correct);
+
+  pros::Distance* distances[ParticleLocalizer::MAX_BEAMS] = {};
+  pros::Gps* gps = nullptr;
+  std::function<ParticleLocalizer::pose()> get;
+  std::function<void(double, double)> set;
+
+  // Held while the task reads odometry and shift together, and while update() changes both
+  pros::Mutex correcting;
+  bool posted = false;
+  double posted_dx = 0, posted_dy = 0;
+  double shift_x = 0, shift_y = 0;  // every correction update() has made, so the task can take them out of odometry's moves
+};
@@ -0,0 +1,127 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+/**
+ * A fixed set of PID controllers stored as one array per field.
+ *
+ * ez::PID and lemlib::PID keep their constants and state spread over each object, so stepping
+ * every controller a drive owns touches a couple dozen objects each tick.  PIDBank keeps the
+ * same numbers side by side and steps all of them with one call, four lanes at a time with
+ * NEON on the brain.
+ *
+ * Each controller follows ez::PID::compute_error: i only builds within start_i and resets when
+ * the error changes sign, and controllers with kI of 0 never build i.  Derivative is taken on
+ * the error since that's all update_all() gets, which is the same as ez::PID's derivative on
+ * measurement while the target isn't moving.
+ */
+class PIDBank {
+ public:
+  /**
+   * Most controllers a bank can hold.  ez::Drive owns 19.
+   */
+  static constexpr int MAX = 32;
+
+  /**
+   * Adds a controller, returns its slot or -1 if the bank is full.  New controllers start active.
+   *
+   * \param p
+   *        kP
+   * \param i
+   *        kI
+   * \param d
+   *        kD
+   * \param p_start_i
+   *        error value that i starts within
+   */
+  int add(float p, float i = 0, float d = 0, float p_start_i = 0);
+
+  /**
+   * Set constants for one controller.
+   *
+   * \param slot
+   *        slot returned by add()
+   * \param p
+   *        kP
+   * \param i
+   *        kI
+   * \param d
+   *        kD
+   * \param p_start_i
+   *        error value that i starts within
+   */
+  void constants_set(int slot, float p, float i = 0, float d = 0, float p_start_i = 0);
+
+  /**
+   * Resets all variables of one controller to 0.  This does not reset constants.
+   *
+   * \param slot
+   *        slot returned by add()
+   */
+  void variables_reset(int slot);
+
+  /**
+   * Inactive controllers output 0 and are held reset, so they start clean when they're active again.
+   *
+   * \param slot
+   *        slot returned by add()
+   * \param toggle
+   *        true runs the controller, false skips it
+   */
+  void active_set(int slot, bool toggle);
+
+  /**
+   * Returns true if the controller runs in update_all().
+   *
+   * \param slot
+   *        slot returned by add()
+   */
+  bool active_get(int slot);
+
+  /**
+   * Steps every controller once.  Results are in output.
+   *
+   * \param errors
+   *        one error per controller, at least size() of them
+   * \param dt
+   *        ms since the last update, ez::util::DELAY_TIME keeps the same gains as ez::PID
+   */
+  void update_all(const float* errors, float dt);
+
+  /**
+   * Returns the output of one controller from the last update_all().
+   *
+   * \param slot
+   *        slot returned by add()
+   */
+  float output_get(int slot);
+
+  /**
+   * Returns how many controllers have been added.
+   */
+  int size();
+
+  /**
+   * Constants, one per slot.
+   */
+  alignas(16) float kp[MAX] = {};
+  alignas(16) float ki[MAX] = {};
+  alignas(16) float kd[MAX] = {};
+  alignas(16) float start_i[MAX] = {};
+
+  /**
+   * PID variables, one per slot.
+   */
+  alignas(16) float output[MAX] = {};
+  alignas(16) float error[MAX] = {};        // also the previous error until the next update
+  alignas(16) float integral[MAX] = {};
+  alignas(16) float derivative[MAX] = {};
+
+ private:
+  alignas(16) float active[MAX] = {};  // 1 runs, 0 holds reset
+  int count = 0;
+};
@@ -0,0 +1,67 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "EZ-Template/util.hpp"
+
+/**
+ * Turns a packed path into EZ pure pursuit movements, one per point at the point's speed.
+ *
+ * Packed paths come from Sim's path_pack, the same .path files the LemLib project links in.
+ * Packed with --profile, each point's speed is the fastest the drive can take it without going
+ * over its wheel speed, acceleration or sliding in turns, so the path runs at the robot's limit
+ * instead of one speed throughout.  Give them to pid_odom_pp_set() with slew off, the profile
+ * already ramps up and down, and not the smoothing one, which would move the points off the
+ * profile.
+ *
+ * \param data
+ *        the .path file's contents
+ * \param size
+ *        bytes at data
+ * \param direction
+ *        fwd or rev, for every point
+ *
+ * \return empty if it isn't a packed path
+ */
+std::vector<ez::odom> profiled_path_movements(const void* data, std::size_t size, ez::drive_directions direction = ez::fwd);
+
+/**
+ * Same as above, reading the path from a file, like "/usd/paths/skills.path".
+ */
+std::vector<ez::odom> profiled_path_movements(const char* path, ez::drive_directions direction = ez::fwd);
+
+/**
+ * One point of a packed path's time profile, for RamseteFollower.
+ */
+struct trajectory_point {
+  double x, y;          // inches
+  double distance;      // inches along the path
+  double curvature;     // 1 / inches, positive turning left
+  double velocity;      // in/s
+  double acceleration;  // in/s^2, until the next point
+  double time;          // seconds from the start
+};
+
+/**
+ * Reads the time profile out of a packed path.
+ *
+ * \param data
+ *        the .path file's contents
+ * \param size
+ *        bytes at data
+ *
+ * \return empty if it isn't a packed path or was packed without --profile
+ */
+std::vector<trajectory_point> profiled_path_trajectory(const void* data, std::size_t size);
+
+/**
+ * Same as above, reading the path from a file, like "/usd/paths/skills.trajectory".
+ */
+std::vector<trajectory_point> profiled_path_trajectory(const char* path);
@@ -0,0 +1,116 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "EZ-Template/util.hpp"
+#include "feedforward.hpp"
+#include "profiled_path.hpp"
+
+/**
+ * Follows a time profiled path with Ramsete instead of EZ's pure pursuit.
+ *
+ * Pure pursuit aims at a point a lookahead ahead, so it rounds off every turn and lags once the
+ * path is fast.  Ramsete tracks where the profile says the robot should be right now.  The
+ * reference pose, velocity and turn rate come from the profile, and the robot's error from it,
+ * along the path, across it and in heading, is corrected at a rate set by b and zeta.  Wheel
+ * velocities go to the motors through the drive's Feedforward, so the feedback only has small
+ * errors left to fix.
+ *
+ * Paths come from profiled_path_trajectory(), the same .path files odom_profiled_path_example()
+ * runs, packed with path_pack --profile.
+ */
+class RamseteFollower {
+ public:
+  Feedforward feedforward;
+
+  double b = 0.02;                 // per inch squared, how hard errors are corrected
+  double zeta = 0.7;               // damping, between 0 and 1
+  double min_gain = 3;             // per second, so lag is still corrected as the profile stops
+  double exit_error = 1;           // inches short of or past the end to count as there
+  std::uint32_t settle_time = 500; // ms after the profile ends to get there
+  std::uint32_t period = 10;       // ms
+
+  /**
+   * \param track_width
+   *        inches between the left and right wheels
+   * \param pose_get
+   *        where the robot is, like chassis.odom_pose_get()
+   * \param voltage_set
+   *        sets each side's voltage in mV
+   */
+  RamseteFollower(double track_width, std::function<ez::pose()> pose_get, std::function<void(double, double)> voltage_set);
+
+  /**
+   * Where the robot should be and how it should be moving at one instant.
+   */
+  struct reference {
+    double x, y;                  // inches
+    double direction;             // radians counterclockwise from +x, the way the robot faces
+    double velocity;              // in/s, negative backwards
+    double acceleration;          // in/s^2
+    double angular;               // radians per second counterclockwise
+    double angular_acceleration;  // radians per second squared counterclockwise
+  };
+
+  /**
+   * How far the robot is from a reference, in its own frame.
+   */
+  struct error {
+    double along;   // inches the reference is ahead of the robot
+    double across;  // inches the reference is to the robot's left
+    double heading; // radians the reference is turned counterclockwise from the robot
+  };
+
+  /**
+   * One step of tracking: sets the voltages that bring the robot onto the reference from where
+   * it is now.  For anything that makes its own references, call once every period.
+   *
+   * \return the robot's error from the reference
+   */
+  error track(const reference& ref);
+
+  /**
+   * Sets both sides to 0 V, for after the last track().
+   */
+  void stop();
+
+  /**
+   * The drive's track width in inches.
+   */
+  double track_width_get() const;
+
+  /**
+   * Drives a path and stops.  Blocks until the profile is over and the robot is at the end, or
+   * it timed out.
+   *
+   * \param trajectory
+   *        the path, from profiled_path_trajectory()
+   * \param direction
+   *        fwd, or rev to drive it with the back of the robot
+   * \param timeout
+   *        ms, 0 for no timeout
+   *
+   * \return false if the path was empty or it timed out
+   */
+  bool follow(const std::vector<trajectory_point>& trajectory, ez::drive_directions direction = ez::fwd, std::uint32_t timeout = 0);
+
+  /**
+   * Root mean square and largest distance the robot was to the side of where the profile had
+   * it on the last follow, in inches.
+   */
+  double rms_error = 0;
+  double worst_error = 0;
+
+ private:
+  double track_width;
+  std::function<ez::pose()> pose_get;
+  std::function<void(double, double)> voltage_set;
+};
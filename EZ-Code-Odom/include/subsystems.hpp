@@ -2,9 +2,14 @@
 
 #include "EZ-Template/api.hpp"
 #include "api.h"
+#include "arm_controller.hpp"
+#include "color_sorter.hpp"
+#include "particle_localizer.hpp"
 #include "pros/optical.hpp"
+#include "wall_relocalizer.hpp"
 
 extern Drive chassis;
+extern SortingIntake intake;
 
 // Your motors, sensors, etc. should go here.  Below are examples
 
@@ -15,20 +20,16 @@ inline ez::Piston doinker('B');
 inline pros::Optical colorsort(1);
 
 inline ez::Piston intakePiston('H');
-inline ez::Piston mogoclamp('A');
-
 
-inline void set_lb(int input) {
-  ladybrown.move(input);
-}
+// Corrects odom off the field walls with distance sensors, skills routines turn it on
+inline RelocalizationService wall_relocalization;
+// Particle filter on the same sensors against the whole field, for when the walls aren't enough
+inline LocalizerService particle_localization{HIGH_STAKES_FIELD};
+inline ez::Piston mogoclamp('A');
 
-inline ez::PID lbPID{0.45, 0, 1.5, 0, "ladybrown"};
 
-inline void lb_wait() {
-  while (lbPID.exit_condition({ladybrown}, true) == ez::RUNNING) {
-    pros::delay(ez::util::DELAY_TIME);
-  }
-}
+// Profiled lady brown with gravity feedforward, the executive runs it
+inline ArmController lb_arm{ladybrown};
 
 //vars
 
@@ -47,7 +48,13 @@ inline void selectSkills() {
     isRedTeam = 2;
 }
 
-inline int intake_speed_high = 0;
-inline int intake_speed_low = 0;
+// Intake speeds for autons, -127 to 127.  They outrank the driver's until opcontrol() starts
+inline void set_intake_high(int speed) {
+  intake.hooks_request(SortingIntake::AUTON, speed);
+}
+
+inline void set_intake_low(int speed) {
+  intake.low_request(SortingIntake::AUTON, speed);
+}
 // inline pros::Motor intake(1);
 // inline pros::adi::DigitalIn limit_switch('A');
\ No newline at end of file
@@ -0,0 +1,243 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "pros/distance.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * Corrects odometry from distance sensors pointed at the field walls.
+ *
+ * When a sensor's beam is square to a wall, the reading says exactly how far the robot is from
+ * that wall, which pins down x for the left and right walls or y for the top and bottom ones.
+ * The difference between where the reading puts the robot and where odometry thinks it is, the
+ * residual, is moved into odometry a little at a time.  Residuals too large to be drift mean
+ * the beam hit a goal or another robot, and are rejected.
+ *
+ * Poses are odometry's, inches and degrees clockwise from +y.  Walls have to be given in the
+ * same frame, so they depend on where the routine starts the robot.  Nothing here talks to
+ * devices, RelocalizationService feeds it from the distance sensors.
+ */
+class WallRelocalizer {
+ public:
+  static constexpr int MAX_WALLS = 16;
+  static constexpr int MAX_SENSORS = 4;
+
+  struct pose {
+    double x, y, theta;
+  };
+
+  /**
+   * A straight wall along x = at, from y = from to y = to when vertical, or along y = at, from
+   * x = from to x = to when not.
+   */
+  struct wall {
+    bool vertical;
+    double at;
+    double from;
+    double to;
+  };
+
+  /**
+   * Where a distance sensor is, inches right and forward of the tracking center, and which way
+   * it points in degrees clockwise from straight ahead.
+   */
+  struct sensor {
+    double x;
+    double y;
+    double angle;
+  };
+
+  /**
+   * What one sensor's readings have said so far.  Residuals are in inches, before correcting.
+   */
+  struct residual_stats {
+    std::uint32_t samples = 0;     // readings square to a wall and in range
+    std::uint32_t rejected = 0;    // of those, residual too big to be drift
+    double sum = 0;
+    double sum_squares = 0;
+    double worst = 0;              // largest accepted residual, either sign
+    double last = 0;
+    double corrected = 0;          // total distance moved into odometry
+
+    double mean() const;
+    double rms() const;
+  };
+
+  /**
+   * A change to make to odometry.
+   */
+  struct correction {
+    bool valid = false;
+    bool x_axis = false;     // true to move x, false for y
+    double delta = 0;
+  };
+
+  /**
+   * Furthest the beam can be from square to a wall, in degrees.
+   */
+  double square_tolerance = 4;
+
+  /**
+   * Readings further than this, in mm, are too inaccurate to use.  The sensor is good to about
+   * 5% past 200 mm.
+   */
+  int max_range = 1000;
+
+  /**
+   * Readings the sensor isn't confident in are skipped.  It only reports confidence past 200
+   * mm, and says 63 when closer.
+   */
+  int min_confidence = 40;
+
+  /**
+   * Residuals bigger than this, in inches, are something other than a wall.
+   */
+  double max_residual = 6;
+
+  /**
+   * Fraction of the residual moved into odometry each reading, so noise averages out.
+   */
+  double gain = 0.25;
+
+  /**
+   * Adds a wall.  Returns false if there are already MAX_WALLS.
+   */
+  bool wall_add(const wall& w);
+
+  /**
+   * Adds the four walls of a rectangular field.
+   *
+   * \param left
+   *        x of the left wall
+   * \param right
+   *        x of the right wall
+   * \param bottom
+   *        y of the wall behind the robot at the start
+   * \param top
+   *        y of the far wall
+   */
+  void field_set(double left, double right, double bottom, double top);
+
+  /**
+   * Adds a sensor.  Returns its index, or -1 if there are already MAX_SENSORS.
+   */
+  int sensor_add(const sensor& s);
+
+  /**
+   * Checks one reading and returns how to correct odometry, if at all.  Updates that sensor's
+   * stats.
+   *
+   * \param index
+   *        sensor index from sensor_add()
+   * \param odom
+   *        where odometry thinks the robot is
+   * \param distance_mm
+   *        pros::Distance::get()
+   * \param confidence
+   *        pros::Distance::get_confidence()
+   */
+  correction check(int index, const pose& odom, int distance_mm, int confidence);
+
+  /**
+   * Stats for one sensor.
+   */
+  const residual_stats& stats(int index) const;
+
+  /**
+   * Forgets every sensor's stats.
+   */
+  void stats_reset();
+
+  int sensor_count() const;
+
+ private:
+  const wall* wall_hit(double x, double y, double beam, double& distance) const;
+
+  wall walls[MAX_WALLS] = {};
+  int wall_count = 0;
+  sensor sensors[MAX_SENSORS] = {};
+  residual_stats sensor_stats[MAX_SENSORS];
+  int count = 0;
+};
+
+/**
+ * Runs WallRelocalizer in a task, or from a ControlExecutive, while the robot is sitting still.
+ *
+ * The distance sensor averages over tens of ms, so readings while driving are from somewhere
+ * the robot was.  It only corrects odometry once the pose has stopped moving for
+ * settle_ms, which in a routine is every time a motion finishes.
+ */
+class RelocalizationService {
+ public:
+  WallRelocalizer relocalizer;
+
+  /**
+   * Only corrects while true, so it can be turned on for routines whose start matches the walls.
+   */
+  bool enabled = false;
+
+  /**
+   * How long the pose has to be still, and how still, before correcting.
+   */
+  std::uint32_t settle_ms = 100;
+  double settle_speed = 2;   // inches per second
+  double settle_turn = 10;   // degrees per second
+
+  std::uint32_t period = 20;
+
+  /**
+   * Adds a distance sensor.
+   *
+   * \param port
+   *        distance sensor port
+   * \param where
+   *        where it is on the robot and which way it points
+   *
+   * \return false if there are already WallRelocalizer::MAX_SENSORS
+   */
+  bool sensor_add(int port, const WallRelocalizer::sensor& where);
+
+  /**
+   * Starts the task.
+   *
+   * \param pose_get
+   *        returns where odometry thinks the robot is
+   * \param xy_set
+   *        moves odometry to a new x and y without touching theta
+   */
+  void start(std::function<WallRelocalizer::pose()> pose_get, std::function<void(double, double)> xy_set);
+
+  /**
+   * Same as start() without the task, for running update() from the ControlExecutive that runs
+   * odometry, so a correction can't land between odometry reading the pose and writing it back.
+   * Set period to how often update() is called.
+   */
+  void attach(std::function<WallRelocalizer::pose()> pose_get, std::function<void(double, double)> xy_set);
+
+  /**
+   * Checks whether the robot is still and corrects odometry off the walls once.
+   */
+  void update();
+
+  /**
+   * Prints every sensor's residual stats to the terminal.
+   */
+  void stats_print() const;
+
+ private:
+  void service();
+
+  pros::Distance* distances[WallRelocalizer::MAX_SENSORS] = {};
+  std::function<WallRelocalizer::pose()> get;
+  std::function<void(double, double)> set;
+  WallRelocalizer::pose last = {0, 0, 0};
+  std::uint32_t still_ms = 0;
+};
@@ -0,0 +1,149 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "arc_odometry.hpp"
+
+#include <cmath>
+
+namespace {
+
+const double DEGREES = M_PI / 180.0;
+
+// How far the pose can drift from what the service wrote before it counts as moved by someone else
+const double MOVED = 1e-3;
+// Faster than the robot can turn, deg/s.  An imu jump past this in one update was someone setting it
+const double MAX_TURN_RATE = 1500;
+
+}  // namespace
+
+void ArcOdometry::reset(const pose& start, const reading& sensors) {
+  current = start;
+  last = sensors;
+  last_step = {0, 0, 0};
+  for (twist& t : recent) t = {0, 0, 0};
+}
+
+const ArcOdometry::pose& ArcOdometry::pose_get() const { return current; }
+
+ArcOdometry::pose ArcOdometry::ahead(double updates) const {
+  twist average = {0, 0, 0};
+  for (const twist& t : recent) {
+    average.forward += t.forward / RECENT;
+    average.sideways += t.sideways / RECENT;
+    average.turn += t.turn / RECENT;
+  }
+  const double turn = average.turn * updates;
+  const double forward = average.forward * updates;
+  const double sideways = average.sideways * updates;
+  const double mid = current.theta * DEGREES + turn / 2;
+  const double chord = std::fabs(turn) > 1e-9 ? std::sin(turn / 2) / (turn / 2) : 1.0;
+  return {current.x + chord * (forward * std::sin(mid) + sideways * std::cos(mid)),
+          current.y + chord * (forward * std::cos(mid) - sideways * std::sin(mid)), current.theta + turn / DEGREES};
+}
+
+const ArcOdometry::pose& ArcOdometry::update(const reading& sensors) {
+  const double turn = (sensors.theta - last.theta) * DEGREES;
+  // trackers off center roll when the robot turns, take that out to get the center's step
+  const twist step = {sensors.vertical - last.vertical + turn * vertical_offset,
+                      sensors.horizontal - last.horizontal - turn * horizontal_offset, turn};
+  last = sensors;
+
+  const double start = current.theta * DEGREES;
+  double dx = 0, dy = 0;
+  switch (mode) {
+    case EULER:
+      dx = step.forward * std::sin(start) + step.sideways * std::cos(start);
+      dy = step.forward * std::cos(start) - step.sideways * std::sin(start);
+      break;
+    case MIDPOINT:
+    case EXACT_ARC: {
+      const double mid = start + turn / 2;
+      // an arc's chord is shorter than the arc by sin(turn / 2) / (turn / 2)
+      const double chord = mode == EXACT_ARC && std::fabs(turn) > 1e-9 ? std::sin(turn / 2) / (turn / 2) : 1.0;
+      dx = chord * (step.forward * std::sin(mid) + step.sideways * std::cos(mid));
+      dy = chord * (step.forward * std::cos(mid) - step.sideways * std::sin(mid));
+      break;
+    }
+    case RUNGE_KUTTA: {
+      // The step is the average twist over the update, assume it changes by as much as it did
+      // since the last one.  The derivative only depends on time, so RK4's stages land on the
+      // start, middle and end, weighted 1 4 1.
+      const twist slope = {step.forward - last_step.forward, step.sideways - last_step.sideways, step.turn - last_step.turn};
+      const double s[3] = {0.0, 0.5, 1.0};
+      const double weight[3] = {1.0 / 6, 4.0 / 6, 1.0 / 6};
+      for (int i = 0; i < 3; i++) {
+        double forward = step.forward + slope.forward * (s[i] - 0.5);
+        double sideways = step.sideways + slope.sideways * (s[i] - 0.5);
+        double heading = start + step.turn * s[i] + slope.turn * (s[i] * s[i] - s[i]) / 2;
+        dx += weight[i] * (forward * std::sin(heading) + sideways * std::cos(heading));
+        dy += weight[i] * (forward * std::cos(heading) - sideways * std::sin(heading));
+      }
+      break;
+    }
+  }
+  current.x += dx;
+  current.y += dy;
+  current.theta += step.turn / DEGREES;
+  last_step = step;
+  recent[recent_next] = step;
+  recent_next = (recent_next + 1) % RECENT;
+  return current;
+}
+
+void OdometryService::start(std::function<ArcOdometry::reading()> sensors_get, std::function<ArcOdometry::pose()> pose_get,
+                            std::function<void(double, double)> xy_set) {
+  pros::Task([this, sensors_get, pose_get, xy_set] {
+    attach(sensors_get, pose_get, xy_set);
+    service();
+  }, priority, TASK_STACK_DEPTH_DEFAULT, "arc odom");
+}
+
+void OdometryService::attach(std::function<ArcOdometry::reading()> sensors_get, std::function<ArcOdometry::pose()> pose_get,
+                             std::function<void(double, double)> xy_set) {
+  read = sensors_get;
+  get = pose_get;
+  set = xy_set;
+  const ArcOdometry::reading sensors = read();
+  odometry.reset(get(), sensors);
+  written = odometry.pose_get();
+  last_heading = sensors.theta;
+  ahead_x.store(written.x);
+  ahead_y.store(written.y);
+  ahead_theta.store(written.theta);
+  previous = pros::millis();
+}
+
+void OdometryService::service() {
+  std::uint32_t now = pros::millis();
+  while (true) {
+    pros::Task::delay_until(&now, period);
+    update();
+  }
+}
+
+void OdometryService::update() {
+  std::uint32_t time = pros::millis();
+  if (time - previous > worst_period) worst_period = time - previous;
+  previous = time;
+
+  const ArcOdometry::reading sensors = read();
+  ArcOdometry::pose p = get();
+  const bool heading_set = std::fabs(sensors.theta - last_heading) > MAX_TURN_RATE * period / 1000.0;
+  last_heading = sensors.theta;
+  if (std::fabs(p.x - written.x) > MOVED || std::fabs(p.y - written.y) > MOVED || heading_set)
+    odometry.reset(p, sensors);
+  else
+    odometry.update(sensors);
+  written = odometry.pose_get();
+  set(written.x, written.y);
+
+  const ArcOdometry::pose ahead = lead_ms > 0 ? odometry.ahead(lead_ms / period) : written;
+  ahead_x.store(ahead.x);
+  ahead_y.store(ahead.y);
+  ahead_theta.store(ahead.theta);
+}
+
+ArcOdometry::pose OdometryService::predicted() const { return {ahead_x.load(), ahead_y.load(), ahead_theta.load()}; }
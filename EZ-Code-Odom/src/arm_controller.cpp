@@ -0,0 +1,240 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "arm_controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "pros/rtos.hpp"
+
+namespace {
+double sgn(double x) { return (x > 0) - (x < 0); }
+}  // namespace
+
+/////
+// MotionProfile
+/////
+void MotionProfile::add(double duration, double acceleration, double jerk) {
+  if (duration <= 0 || count >= MAX_PIECES) return;
+  state s;
+  if (count == 0) {
+    s.position = end;
+    s.velocity = start_velocity;
+  } else {
+    // where the last piece leaves off
+    const piece& p = pieces[count - 1];
+    const double t = p.duration;
+    s.position = p.start.position + p.start.velocity * t + p.start.acceleration * t * t / 2 + p.jerk * t * t * t / 6;
+    s.velocity = p.start.velocity + p.start.acceleration * t + p.jerk * t * t / 2;
+  }
+  s.acceleration = acceleration;
+  pieces[count++] = {duration, jerk, s};
+  total += duration;
+}
+
+void MotionProfile::plan(double from, double velocity, double to, double max_velocity, double max_acceleration, double max_jerk) {
+  count = 0;
+  total = 0;
+  end = from;
+  start_velocity = velocity;
+  const double a = max_acceleration;
+  const double direction = to >= from ? 1 : -1;
+  const double distance = std::fabs(to - from);
+  const double speed = velocity * direction;  // toward the target
+
+  if (speed == 0) {
+    rest_to_rest(from, to, max_velocity, max_acceleration, max_jerk);
+  } else if (speed < 0 || speed * speed / (2 * a) > distance) {
+    // going the wrong way or too fast to stop in time, stop and come back
+    const double stop = std::fabs(velocity) / a;
+    add(stop, -sgn(velocity) * a, 0);
+    rest_to_rest(from + velocity * stop / 2, to, max_velocity, max_acceleration, 0);
+  } else {
+    // speed up or slow down to the peak, cruise, and slow to a stop at the target
+    const double peak = std::min(max_velocity, std::sqrt(a * distance + speed * speed / 2));
+    const double change = std::fabs(peak - speed) / a;
+    const double slow = peak / a;
+    const double cruise = (distance - (speed + peak) / 2 * change - peak * slow / 2) / peak;
+    add(change, direction * sgn(peak - speed) * a, 0);
+    add(std::max(0.0, cruise), 0, 0);
+    add(slow, -direction * a, 0);
+  }
+  end = to;
+}
+
+void MotionProfile::rest_to_rest(double from, double to, double max_velocity, double max_acceleration, double max_jerk) {
+  const double direction = to >= from ? 1 : -1;
+  const double distance = std::fabs(to - from);
+  double v = max_velocity, a = max_acceleration;
+  if (distance == 0) return;
+
+  if (max_jerk <= 0) {
+    v = std::min(v, std::sqrt(a * distance));
+    add(v / a, direction * a, 0);
+    add(distance / v - v / a, 0, 0);
+    add(v / a, -direction * a, 0);
+  } else {
+    const double j = max_jerk;
+    // time to ramp the acceleration up or down, and to hold it
+    double ramp = a / j, hold;
+    if (v * j < a * a) {
+      // the velocity limit comes before the acceleration limit does
+      a = std::sqrt(v * j);
+      ramp = a / j;
+    }
+    hold = v / a - ramp;
+    if (v * (2 * ramp + hold) > distance) {
+      // too short to reach the velocity limit, find the peak that just gets there
+      v = a / 2 * (-ramp + std::sqrt(ramp * ramp + 4 * distance / a));
+      if (v >= a * ramp) {
+        hold = v / a - ramp;
+      } else {
+        // or the acceleration limit
+        a = std::cbrt(distance * j * j / 2);
+        ramp = a / j;
+        hold = 0;
+        v = a * ramp;
+      }
+    }
+    const double cruise = std::max(0.0, distance / v - (2 * ramp + hold));
+    add(ramp, 0, direction * j);
+    add(hold, direction * a, 0);
+    add(ramp, direction * a, -direction * j);
+    add(cruise, 0, 0);
+    add(ramp, 0, -direction * j);
+    add(hold, -direction * a, 0);
+    add(ramp, -direction * a, direction * j);
+  }
+}
+
+MotionProfile::state MotionProfile::sample(double t) const {
+  for (int i = 0; i < count; i++) {
+    const piece& p = pieces[i];
+    if (t > p.duration && i < count - 1) {
+      t -= p.duration;
+      continue;
+    }
+    if (t > p.duration) break;
+    t = std::max(0.0, t);
+    state s;
+    s.position = p.start.position + p.start.velocity * t + p.start.acceleration * t * t / 2 + p.jerk * t * t * t / 6;
+    s.velocity = p.start.velocity + p.start.acceleration * t + p.jerk * t * t / 2;
+    s.acceleration = p.start.acceleration + p.jerk * t;
+    return s;
+  }
+  state s;
+  s.position = end;
+  return s;
+}
+
+double MotionProfile::duration() const { return total; }
+
+/////
+// ArmController
+/////
+ArmController::ArmController(pros::Motor& motor) : motor(motor) {}
+
+bool ArmController::completion::done() const { return arm == nullptr || arm->finished.load() >= id; }
+
+bool ArmController::completion::reached() const {
+  return arm != nullptr && arm->outcomes[id % OUTCOMES].load() == id * 2 + 1;
+}
+
+bool ArmController::completion::wait(std::uint32_t timeout) const {
+  const std::uint32_t start = pros::millis();
+  while (!done()) {
+    if (pros::millis() - start >= timeout) return false;
+    pros::delay(10);
+  }
+  return reached();
+}
+
+ArmController::completion ArmController::go_to(double position) {
+  // already on its way there, don't start over
+  const std::uint32_t last = requested.load();
+  if (last != 0 && goal.load() == position && finished.load() < last) return completion(this, last);
+  goal.store(position);
+  return completion(this, requested.fetch_add(1) + 1);
+}
+
+void ArmController::release() {
+  goal.store(NAN);
+  requested.fetch_add(1);
+}
+
+void ArmController::finish(bool reached) {
+  outcomes[active % OUTCOMES].store(active * 2 + (reached ? 1 : 0));
+  finished.store(active);
+}
+
+void ArmController::update() {
+  const std::uint32_t now = pros::millis();
+  const double position = motor.get_position();
+  const double velocity = motor.get_actual_velocity() * 6;  // rpm to deg/s
+  const std::uint32_t latest = requested.load();
+
+  if (latest != active) {
+    // a move cut off goes on from where the arm was meant to be, otherwise from where it is
+    const bool moving = active != 0 && std::isfinite(goal_running) && now - started < profile.duration() * 1000;
+    const MotionProfile::state from = moving ? reference() : MotionProfile::state{position, 0, 0};
+    if (active != 0 && finished.load() < active) finish(false);
+    active = latest;
+    // go_to()s that came in since the last tick never ran
+    finished.store(active - 1);
+    goal_running = goal.load();
+    if (std::isfinite(goal_running))
+      profile.plan(from.position, from.velocity, goal_running, max_velocity, max_acceleration, max_jerk);
+    started = now;
+    in_range = false;
+  }
+
+  if (active == 0) return;
+  if (!std::isfinite(goal_running)) {
+    if (finished.load() < active) {
+      motor.move_voltage(0);
+      last_output.store(0);
+      finish(false);
+    }
+    return;
+  }
+
+  const double t = (now - started) / 1000.0;
+  const MotionProfile::state ref = profile.sample(t);
+  ref_position.store(ref.position);
+  ref_velocity.store(ref.velocity);
+  ref_acceleration.store(ref.acceleration);
+
+  const double angle = (ref.position - level) / ratio * M_PI / 180;
+  const double mv = kg * std::cos(angle) + ks * sgn(ref.velocity) + kv * ref.velocity + ka * ref.acceleration +
+                    kp * (ref.position - position) + kd * (ref.velocity - velocity);
+  const double out = std::clamp(mv, -12000.0, 12000.0);
+  motor.move_voltage(out);
+  last_output.store(out);
+
+  if (finished.load() >= active) return;
+  const bool over = t >= profile.duration();
+  if (over && std::fabs(goal_running - position) < settle_error) {
+    if (!in_range) in_range_since = now;
+    in_range = true;
+    if (now - in_range_since >= settle_time) finish(true);
+  } else {
+    in_range = false;
+    if (over && t * 1000 >= profile.duration() * 1000 + timeout) finish(false);
+  }
+}
+
+double ArmController::target() const { return goal.load(); }
+
+MotionProfile::state ArmController::reference() const {
+  MotionProfile::state s;
+  s.position = ref_position.load();
+  s.velocity = ref_velocity.load();
+  s.acceleration = ref_acceleration.load();
+  return s;
+}
+
+double ArmController::output() const { return last_output.load(); }
@@ -1,10 +1,12 @@
 #include "autons.hpp"
+#include <memory>
 #include <sys/select.h>
 #include "EZ-Template/drive/drive.hpp"
 #include "EZ-Template/util.hpp"
 #include "main.h"
 #include "pros/motors.h"
 #include "pros/rtos.hpp"
+#include "profiled_path.hpp"
 #include "subsystems.hpp"
 
 /////
@@ -17,6 +19,30 @@ const int DRIVE_SPEED = 110; // 110
 const int TURN_SPEED = 90; //90
 const int SWING_SPEED = 110; // 110
 
+// Longest an auton waits on the lady brown to score, ms, the fixed wait it used to get
+const std::uint32_t LB_SCORE_TIMEOUT = 2000;
+
+// Inches the drive goes per motor turn, 2.75" wheels at 450 rpm on blue motors
+const double FEEDFORWARD_INCHES_PER_REV = M_PI * 2.75 * 450.0 / 600.0;
+
+ProfiledDrive profiled_drive(
+    [] { return (chassis.drive_sensor_left() + chassis.drive_sensor_right()) / 2; },
+    [] { return chassis.drive_imu_get(); },
+    [](double left, double right) {
+      for (pros::Motor& m : chassis.left_motors) m.move_voltage(left);
+      for (pros::Motor& m : chassis.right_motors) m.move_voltage(right);
+    });
+
+RamseteFollower ramsete(
+    13.5,  // track width
+    [] { return follower_pose_get(); },
+    [](double left, double right) {
+      for (pros::Motor& m : chassis.left_motors) m.move_voltage(left);
+      for (pros::Motor& m : chassis.right_motors) m.move_voltage(right);
+    });
+
+MotionQueue motion_queue(ramsete, [] { return chassis.odom_pose_get(); });
+
 ///
 // Constants
 ///
@@ -69,8 +95,8 @@ void drive_example() {
   chassis.pid_odom_set(-4_in, DRIVE_SPEED, true);
   chassis.pid_wait();
   mogoclamp.set(true);
-  intake_speed_high = 127;
-  intake_speed_low = 127;
+  set_intake_high(127);
+  set_intake_low(127);
   pros::delay(100000);
 
   // chassis.pid_drive_set(24_in, DRIVE_SPEED, true);
@@ -277,6 +303,72 @@ void odom_pure_pursuit_example() {
   chassis.pid_wait();
 }
 
+///
+// Profiled Pure Pursuit, runs a path packed with a time profile off the SD card at the drive's limit
+///
+void odom_profiled_path_example() {
+  std::vector<ez::odom> path = profiled_path_movements("/usd/paths/example.path");
+  if (path.empty()) {
+    ez::screen_print("No /usd/paths/example.path, pack one with\nSim/bin/path_pack --profile", 1);
+    return;
+  }
+  // start on the first point facing along the path
+  const ez::pose& a = path[0].target;
+  const ez::pose& b = path[std::min<std::size_t>(1, path.size() - 1)].target;
+  chassis.odom_xyt_set(a.x, a.y, util::to_deg(std::atan2(b.x - a.x, b.y - a.y)));
+  chassis.pid_odom_pp_set(path, false);  // the profile ramps up and down already
+  chassis.pid_wait();
+}
+
+///
+// Ramsete, the same path as the profiled pure pursuit example, tracked where its profile says the
+// robot should be instead of chasing a lookahead point.  Run characterize_drive first
+///
+void odom_ramsete_example() {
+  std::vector<trajectory_point> path = profiled_path_trajectory("/usd/paths/example.path");
+  if (path.size() < 2) {
+    ez::screen_print("No /usd/paths/example.path, pack one with\nSim/bin/path_pack --profile", 1);
+    return;
+  }
+  chassis.odom_xyt_set(path[0].x, path[0].y, util::to_deg(std::atan2(path[1].x - path[0].x, path[1].y - path[0].y)));
+  chassis.drive_mode_set(ez::DISABLE);  // so EZ's PID doesn't fight it for the motors
+  ramsete.follow(path, fwd, 10000);
+  printf("ramsete off the path %.2f in rms, %.2f in worst\n", ramsete.rms_error, ramsete.worst_error);
+}
+
+///
+// Motion Queue, the opening of new_negative_blue queued as one motion.  The clamp closes as the
+// robot reaches the goal instead of after it settles, and the turn and drive after it don't wait
+// for anything.  Run characterize_drive first
+///
+void motion_queue_example() {
+  chassis.odom_xyt_set(0_in, 0_in, 0_deg);
+  chassis.drive_mode_set(ez::DISABLE);  // so EZ's PID doesn't fight it for the motors
+  motion_queue.drive(-23).within(1, [] {
+    mogoclamp.set(true);
+    set_intake_low(127);
+  });
+  motion_queue.turn(-110).drive(21).drive(-6).turn(-87).drive(15);
+  motion_queue.start(10000);
+
+  // the auton goes on while it drives
+  pros::delay(300);
+  set_intake_high(127);
+  if (!motion_queue.wait()) printf("motion queue timed out\n");
+  printf("motion queue planned %.2f s\n", motion_queue.duration());
+  intake.request(SortingIntake::AUTON, 0, 0);
+}
+
+///
+// Feedforward Drive, the drive example on profiled_drive.  Run characterize_drive first
+///
+void feedforward_drive_example() {
+  chassis.drive_mode_set(ez::DISABLE);  // so EZ's PID doesn't fight it for the motors
+  profiled_drive.drive(24, 3000);
+  profiled_drive.drive(-12, 3000);
+  profiled_drive.drive(-12, 3000);
+}
+
 ///
 // Odom Pure Pursuit Wait Until
 ///
@@ -287,9 +379,9 @@ void odom_pure_pursuit_wait_until_example() {
                         {{0_in, 0_in}, rev, DRIVE_SPEED}},
                        true);
   chassis.pid_wait_until_index(1);  // Waits until the robot passes 12, 24
-  intake_speed_high = 127;  // Set your intake to start moving once it passes through the second point in the index
+  set_intake_high(127);  // Set your intake to start moving once it passes through the second point in the index
   chassis.pid_wait();
-  intake_speed_high = 0; // Turn the intake off
+  set_intake_high(0); // Turn the intake off
 }
 
 ///
@@ -380,6 +472,136 @@ void measure_offsets() {
   if (chassis.odom_tracker_front != nullptr) chassis.odom_tracker_front->distance_to_center_set(f_offset);
 }
 
+///
+// Measure how stale odometry is, set ARC_ODOM lead to what this shows.  Needs room to spin
+///
+void measure_latency() {
+  chassis.drive_brake_set(pros::E_MOTOR_BRAKE_COAST);
+  latency_model latency = latency_measure(chassis.left_motors, chassis.right_motors, chassis.imu);
+  ez::screen_print("actuation " + util::to_string_with_precision(latency.actuation_ms, 1) + " ms\nsensor age " +
+                       util::to_string_with_precision(latency.sensor_age_ms, 1) + " ms\nlead " +
+                       util::to_string_with_precision(latency.lead_ms(), 1) + " ms",
+                   1);
+  printf("actuation %.1f ms, sensor age %.1f ms, lead %.1f ms\n", latency.actuation_ms, latency.sensor_age_ms, latency.lead_ms());
+}
+
+///
+// Find the drive's feedforward constants for profiled_drive.  Needs about 5 feet clear in front
+///
+void characterize_drive() {
+  chassis.drive_mode_set(ez::DISABLE);
+  chassis.drive_brake_set(pros::E_MOTOR_BRAKE_COAST);
+  FeedforwardFit fit;
+  Feedforward ff = feedforward_characterize(chassis.left_motors, chassis.right_motors, FEEDFORWARD_INCHES_PER_REV, &fit);
+  printf("ks %.1f mV, kv %.2f mV per in/s, ka %.2f mV per in/s^2, r^2 %.4f over %d samples\n", ff.ks, ff.kv, ff.ka,
+         fit.r_squared(ff), fit.samples());
+  ez::screen_print("ks " + util::to_string_with_precision(ff.ks, 0) + "  kv " + util::to_string_with_precision(ff.kv, 1) + "  ka " +
+                       util::to_string_with_precision(ff.ka, 1) + "\nr^2 " + util::to_string_with_precision(fit.r_squared(ff), 4) +
+                       (FeedforwardFit::save(ff, FEEDFORWARD_PATH) ? "\nsaved" : "\nnot saved, no SD card"),
+                   1);
+  profiled_drive.feedforward = ff;
+  ramsete.feedforward = ff;
+}
+
+///
+// Calibrate the trackers and imu together, start square against a wall with room in front
+///
+void calibrate_odom() {
+  const int REPEATS = 6;
+  const int TURNS = 2;
+  pros::Distance back_range(14);  // same back sensor as wall relocalization
+
+  ez::tracking_wheel* vertical = chassis.odom_tracker_left != nullptr ? chassis.odom_tracker_left : chassis.odom_tracker_right;
+  ez::tracking_wheel* horizontal = chassis.odom_tracker_front != nullptr ? chassis.odom_tracker_front : chassis.odom_tracker_back;
+  if (vertical == nullptr || horizontal == nullptr) {
+    ez::screen_print("Calibration needs a vertical and a horizontal tracker", 1);
+    return;
+  }
+  // too big for the task's stack
+  auto calibration = std::make_unique<OdomCalibration>(vertical->wheel_diameter_get(), horizontal->wheel_diameter_get());
+  chassis.drive_imu_scaler_set(1.0);
+  chassis.drive_brake_set(pros::E_MOTOR_BRAKE_HOLD);
+
+  // Inches from the wall behind, averaged since the sensor is noisy
+  auto range = [&] {
+    double total = 0;
+    for (int i = 0; i < 10; i++) {
+      total += back_range.get();
+      pros::delay(40);
+    }
+    return total / 10 / 25.4;
+  };
+  auto wall_square = [] {
+    chassis.drive_set(-40, -40);
+    pros::delay(800);
+    chassis.drive_set(0, 0);
+    pros::delay(300);
+  };
+
+  wall_square();
+  double squared = chassis.drive_imu_get();
+  for (int i = 0; i < REPEATS; i++) {
+    // Drive out from the wall
+    double r0 = range(), v0 = vertical->get(), t0 = chassis.drive_imu_get();
+    chassis.pid_drive_set(24, 80);
+    chassis.pid_wait();
+    pros::delay(250);
+    calibration->leg_add(vertical->get() - v0, chassis.drive_imu_get() - t0, range() - r0);
+
+    // Spin, alternating directions, every loop is a sample
+    int direction = i % 2 == 0 ? 1 : -1;
+    double target = chassis.drive_imu_get() + direction * 360.0 * TURNS;
+    double v = vertical->get(), h = horizontal->get(), t = chassis.drive_imu_get();
+    chassis.drive_set(60 * direction, -60 * direction);
+    while ((target - t) * direction > 20) {
+      pros::delay(ez::util::DELAY_TIME);
+      double v1 = vertical->get(), h1 = horizontal->get(), t1 = chassis.drive_imu_get();
+      calibration->spin_add(v1 - v, h1 - h, t1 - t);
+      v = v1, h = h1, t = t1;
+    }
+    chassis.drive_set(0, 0);
+    pros::delay(250);
+
+    // Face away from the wall and square up on it, which makes the real turn whole revolutions
+    chassis.pid_turn_set(std::round(chassis.drive_imu_get() / 360.0) * 360.0, 60, ez::raw);
+    chassis.pid_wait();
+    chassis.pid_drive_set(-20, 80);
+    chassis.pid_wait();
+    wall_square();
+    calibration->heading_add(chassis.drive_imu_get() - squared);
+    squared = chassis.drive_imu_get();
+  }
+
+  OdomCalibration::result r = calibration->solve();
+  if (!r.valid) {
+    ez::screen_print("Calibration failed, not enough samples", 1);
+    return;
+  }
+  printf("imu scale %.5f +/- %.5f\n", r.imu_scale.value, r.imu_scale.plus_minus);
+  printf("vertical offset %.3f +/- %.3f, diameter %.4f +/- %.4f\n", r.vertical_offset.value, r.vertical_offset.plus_minus,
+         r.vertical_diameter.value, r.vertical_diameter.plus_minus);
+  printf("horizontal offset %.3f +/- %.3f, diameter %.4f +/- %.4f\n", r.horizontal_offset.value, r.horizontal_offset.plus_minus,
+         r.horizontal_diameter.value, r.horizontal_diameter.plus_minus);
+  ez::screen_print(OdomCalibration::save(r, ODOM_CALIBRATION_PATH) ? "Calibration saved" : "Calibration not saved, no SD card", 1);
+  odom_calibration_apply(r);
+}
+
+///
+// Use a calibration from calibrate_odom()
+///
+void odom_calibration_apply(const OdomCalibration::result& r) {
+  chassis.drive_imu_scaler_set(r.imu_scale.value);
+  // offsets are right of and forward of center, EZ wants them from whichever side the tracker is on
+  if (chassis.odom_tracker_left != nullptr) chassis.odom_tracker_left->distance_to_center_set(-r.vertical_offset.value);
+  if (chassis.odom_tracker_right != nullptr) chassis.odom_tracker_right->distance_to_center_set(r.vertical_offset.value);
+  if (chassis.odom_tracker_front != nullptr) chassis.odom_tracker_front->distance_to_center_set(r.horizontal_offset.value);
+  if (chassis.odom_tracker_back != nullptr) chassis.odom_tracker_back->distance_to_center_set(-r.horizontal_offset.value);
+  for (ez::tracking_wheel* t : {chassis.odom_tracker_left, chassis.odom_tracker_right})
+    if (t != nullptr) t->wheel_diameter_set(r.vertical_diameter.value);
+  for (ez::tracking_wheel* t : {chassis.odom_tracker_front, chassis.odom_tracker_back})
+    if (t != nullptr) t->wheel_diameter_set(r.horizontal_diameter.value);
+}
+
 // . . .
 // Make your own autonomous functions here!
 // . . .
@@ -404,8 +626,8 @@ void old_blue_negative_auton() {
     chassis.pid_turn_relative_set(205_deg, TURN_SPEED);
     chassis.pid_wait();
     // BLOCK 2 - get 3 rings 
-    intake_speed_high = 106;
-    intake_speed_low = 127;
+    set_intake_high(106);
+    set_intake_low(127);
     pros::delay(100);
     chassis.pid_drive_set(12_in, DRIVE_SPEED);
     chassis.pid_wait();
@@ -416,14 +638,14 @@ void old_blue_negative_auton() {
     pros::delay(800);
     chassis.pid_turn_relative_set(86_deg, TURN_SPEED);
     chassis.pid_wait();
-    lbPID.target_set(570);
+    lb_arm.go_to(570);
     chassis.pid_drive_set(13_in, DRIVE_SPEED);
     chassis.pid_wait();
     pros::delay(700);
-    intake_speed_low = 0;
-    // intake_speed_high = -10;
+    set_intake_low(0);
+    // set_intake_high(-10);
     // pros::delay(10);
-    // intake_speed_high = 0;
+    // set_intake_high(0);
     // chassis.pid_turn_relative_set(-180_deg, TURN_SPEED);
     // chassis.pid_wait();
     // chassis.pid_drive_set(-24_in, DRIVE_SPEED);
@@ -432,16 +654,16 @@ void old_blue_negative_auton() {
 
     chassis.pid_odom_set({{13_in, -4.68_in, 28_deg}, fwd, DRIVE_SPEED}, true);
     chassis.pid_wait();
-    lbPID.target_set(2550);
-    intake_speed_high = 0;
-    pros::delay(2000);
+    ArmController::completion scored = lb_arm.go_to(2550);
+    set_intake_high(0);
+    scored.wait(LB_SCORE_TIMEOUT);
     chassis.pid_drive_set(-10_in, DRIVE_SPEED);
     chassis.pid_wait();
-    lbPID.target_set(0);
+    lb_arm.go_to(0);
 
     chassis.pid_odom_set({{1.21_in, -22.67_in, 133.9_deg}, fwd, DRIVE_SPEED}, true);
     chassis.pid_wait();
-    lbPID.target_set(400);
+    lb_arm.go_to(400);
     
 }
 
@@ -466,8 +688,8 @@ void old_red_negative_auton() {
     chassis.pid_turn_relative_set(-205_deg, TURN_SPEED);
     chassis.pid_wait();
     // BLOCK 2 - get 3 rings 
-    intake_speed_high = 106;
-    intake_speed_low = 127;
+    set_intake_high(106);
+    set_intake_low(127);
     pros::delay(100);
     chassis.pid_drive_set(12_in, DRIVE_SPEED);
     chassis.pid_wait();
@@ -478,14 +700,14 @@ void old_red_negative_auton() {
     pros::delay(800);
     chassis.pid_turn_relative_set(-102_deg, TURN_SPEED);
     chassis.pid_wait();
-    lbPID.target_set(200);
+    lb_arm.go_to(200);
     chassis.pid_drive_set(13_in, DRIVE_SPEED);
     chassis.pid_wait();
     pros::delay(700);
-    intake_speed_low = 0;
-    // intake_speed_high = -10;
+    set_intake_low(0);
+    // set_intake_high(-10);
     // pros::delay(10);
-    // intake_speed_high = 0;
+    // set_intake_high(0);
     // chassis.pid_turn_relative_set(-180_deg, TURN_SPEED);
     // chassis.pid_wait();
     // chassis.pid_drive_set(-24_in, DRIVE_SPEED);
@@ -494,23 +716,24 @@ void old_red_negative_auton() {
 
     chassis.pid_odom_set({{-13_in, -4.68_in, 1_deg}, fwd, DRIVE_SPEED}, true);
     chassis.pid_wait();
-    lbPID.target_set(2550);
-    intake_speed_high = 0;
-    pros::delay(2000);
+    ArmController::completion scored = lb_arm.go_to(2550);
+    set_intake_high(0);
+    scored.wait(LB_SCORE_TIMEOUT);
     chassis.pid_drive_set(-10_in, DRIVE_SPEED);
     chassis.pid_wait();
-    lbPID.target_set(0);
+    lb_arm.go_to(0);
 
     chassis.pid_odom_set({{-13_in, -52.7_in, -133.9_deg}, fwd, DRIVE_SPEED}, true);
     chassis.pid_wait();
-    lbPID.target_set(400);
+    lb_arm.go_to(400);
 }
 
 void old_skills_auton() {
     selectSkills();
-    intake_speed_high = 127;
+    wall_relocalization.enabled = true;
+    set_intake_high(127);
     pros::delay(500);
-    intake_speed_high = 0;
+    set_intake_high(0);
     
     chassis.pid_odom_set(14_in, DRIVE_SPEED);
     chassis.pid_wait();
@@ -524,8 +747,8 @@ void old_skills_auton() {
     chassis.pid_wait();
     chassis.pid_turn_relative_set(90_deg, TURN_SPEED);
     chassis.pid_wait();
-    intake_speed_high = 127;
-    intake_speed_low = 106;
+    set_intake_high(127);
+    set_intake_low(106);
     chassis.pid_odom_set(24_in, DRIVE_SPEED);
     chassis.pid_wait();
     pros::delay(200);
@@ -549,9 +772,9 @@ void old_skills_auton() {
     pros::delay(500);
     chassis.pid_turn_relative_set(125_deg, TURN_SPEED);
     chassis.pid_wait();
-    intake_speed_high = -100;
+    set_intake_high(-100);
     pros::delay(100);
-    intake_speed_high = 0;
+    set_intake_high(0);
     chassis.pid_drive_set(-17_in, DRIVE_SPEED);
     chassis.pid_wait();
     mogoclamp.set(false);
@@ -566,8 +789,8 @@ void old_skills_auton() {
     chassis.pid_wait();
     chassis.pid_turn_set(360, TURN_SPEED);
     chassis.pid_wait();
-    intake_speed_high = 127;
-    intake_speed_low = 106;
+    set_intake_high(127);
+    set_intake_low(106);
     chassis.pid_drive_set(24_in, DRIVE_SPEED); //drives fwd 1 tile , first ring on mogo 2
     chassis.pid_wait();
     pros::delay(200);
@@ -587,9 +810,9 @@ void old_skills_auton() {
     pros::delay(500);
     chassis.pid_turn_relative_set(-125_deg, TURN_SPEED);
     chassis.pid_wait();
-    intake_speed_high = -100;
+    set_intake_high(-100);
     pros::delay(100);
-    intake_speed_high = 0;
+    set_intake_high(0);
     chassis.pid_drive_set(-17_in, DRIVE_SPEED);
     chassis.pid_wait();
     mogoclamp.set(false);
@@ -614,9 +837,9 @@ void old_skills_auton() {
     chassis.pid_wait();
     chassis.pid_turn_relative_set(-135_deg, TURN_SPEED);//turns twards corner 
     chassis.pid_wait();
-    intake_speed_high = -50;
+    set_intake_high(-50);
     pros::delay(100);
-    intake_speed_high = 0;
+    set_intake_high(0);
     chassis.pid_drive_set(-10_in, DRIVE_SPEED); // puts in corner
     chassis.pid_wait();
     mogoclamp.set(false);
@@ -674,7 +897,7 @@ void old_skills_auton() {
 
 
     // lbPID.target_set(1900);
-    // intake_speed_high = 0;
+    // set_intake_high(0);
     // pros::delay(2000);
 
 
@@ -692,12 +915,12 @@ void new_negative_blue() {
   mogoclamp.set(true);
   
   pros::delay(50);
-  intake_speed_high = 127;
+  set_intake_high(127);
   pros::delay(300);
   
   chassis.pid_turn_set(-110_deg, TURN_SPEED);
   chassis.pid_wait();
-  intake_speed_low = 127;
+  set_intake_low(127);
   chassis.pid_odom_set(21_in, DRIVE_SPEED);
   chassis.pid_wait();
   pros::delay(400);
@@ -717,12 +940,12 @@ void new_negative_blue() {
   chassis.pid_turn_set(27_deg, TURN_SPEED);
   chassis.pid_wait();
 
-  intake_speed_low = -127; 
+  set_intake_low(-127); 
 
   chassis.pid_drive_set(16_in, DRIVE_SPEED);
   chassis.pid_wait();
 
-  intake_speed_low = 127;
+  set_intake_low(127);
 
   chassis.pid_drive_set(10_in, DRIVE_SPEED);
   chassis.pid_wait();
@@ -742,7 +965,7 @@ void new_negative_blue() {
 
   pros::delay(400);
 
-  lbPID.target_set(450);
+  lb_arm.go_to(450);
 
   chassis.pid_turn_set(6_deg, DRIVE_SPEED);
   chassis.pid_wait();
@@ -750,7 +973,7 @@ void new_negative_blue() {
   chassis.pid_drive_set(4_in, DRIVE_SPEED);
   chassis.pid_wait();
 
-  lbPID.target_set(2600);
+  lb_arm.go_to(2600);
   // chassis.pid_drive_set(30_in, DRIVE_SPEED);
   // chassis.pid_wait();
 
@@ -772,8 +995,8 @@ void new_negative_blue() {
 
   
   // then touch ladder
-  intake_speed_high = 0;
-  intake_speed_low = 0;
+  set_intake_high(0);
+  set_intake_low(0);
 
 }
 
@@ -786,12 +1009,12 @@ void new_negative_red() {
   mogoclamp.set(true);
   
   pros::delay(50);
-  intake_speed_high = 127;
+  set_intake_high(127);
   pros::delay(300);
   
   chassis.pid_turn_set(110_deg, TURN_SPEED);
   chassis.pid_wait();
-  intake_speed_low = 127;
+  set_intake_low(127);
   chassis.pid_odom_set(21_in, DRIVE_SPEED);
   chassis.pid_wait();
   pros::delay(400);
@@ -811,12 +1034,12 @@ void new_negative_red() {
   chassis.pid_turn_set(-27_deg, TURN_SPEED);
   chassis.pid_wait();
 
-  intake_speed_low = -127; 
+  set_intake_low(-127); 
 
   chassis.pid_drive_set(16_in, DRIVE_SPEED);
   chassis.pid_wait();
 
-  intake_speed_low = 127;
+  set_intake_low(127);
 
   chassis.pid_drive_set(10_in, DRIVE_SPEED);
   chassis.pid_wait();
@@ -836,7 +1059,7 @@ void new_negative_red() {
 
   pros::delay(400);
 
-  lbPID.target_set(450);
+  lb_arm.go_to(450);
 
   chassis.pid_turn_set(-6_deg, DRIVE_SPEED);
   chassis.pid_wait();
@@ -844,7 +1067,7 @@ void new_negative_red() {
   chassis.pid_drive_set(4_in, DRIVE_SPEED);
   chassis.pid_wait();
 
-  lbPID.target_set(2600);
+  lb_arm.go_to(2600);
   // chassis.pid_drive_set(30_in, DRIVE_SPEED);
   // chassis.pid_wait();
 
@@ -866,8 +1089,8 @@ void new_negative_red() {
 
   
   // then touch ladder
-  intake_speed_high = 0;
-  intake_speed_low = 0;
+  set_intake_high(0);
+  set_intake_low(0);
 
 }
 
@@ -917,13 +1140,13 @@ void goal_rush_positive_blue() {
 
   mogoclamp.set(true);
   pros::delay(300);
-  intake_speed_high = 127;
-  intake_speed_low = 127;
+  set_intake_high(127);
+  set_intake_low(127);
 
   chassis.pid_turn_relative_set(64_deg, TURN_SPEED);
   chassis.pid_wait();
 
-  intake_speed_high = 0;
+  set_intake_high(0);
 
 
   chassis.pid_drive_set(27_in, DRIVE_SPEED);
@@ -943,7 +1166,7 @@ void goal_rush_positive_blue() {
   chassis.pid_wait();
 
   mogoclamp.set(true);
-  intake_speed_high = 127;
+  set_intake_high(127);
   pros::delay(600);
 
   chassis.pid_odom_set({{39.87_in, -24.58_in, -145.38_deg}, fwd, DRIVE_SPEED}, true);
@@ -978,13 +1201,13 @@ void goal_rush_positive_red() {
 
   mogoclamp.set(true);
   pros::delay(300);
-  intake_speed_high = 127;
-  intake_speed_low = 127;
+  set_intake_high(127);
+  set_intake_low(127);
 
   chassis.pid_turn_relative_set(-64_deg, TURN_SPEED);
   chassis.pid_wait();
 
-  intake_speed_high = 0;
+  set_intake_high(0);
 
 
   chassis.pid_drive_set(27_in, DRIVE_SPEED);
@@ -1004,7 +1227,7 @@ void goal_rush_positive_red() {
   chassis.pid_wait();
 
   mogoclamp.set(true);
-  intake_speed_high = 127;
+  set_intake_high(127);
   pros::delay(600);
 
   chassis.pid_odom_set({{39.87_in, -24.58_in, 145.38_deg}, fwd, DRIVE_SPEED}, true);
@@ -1038,6 +1261,7 @@ void carry_positive_red() {
 //Skills
 void fiftyone_skills() {
   selectSkills();
+  wall_relocalization.enabled = true;
 }
 
 
@@ -0,0 +1,165 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "color_sorter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void ColorSorter::keep_set(ring_color color) {
+  keep = color;
+  ring_count = 0;
+}
+
+ColorSorter::ring_color ColorSorter::keep_get() const { return keep; }
+
+ColorSorter::ring_color ColorSorter::classify(double hue) const {
+  if (hue < red_hue_max) return RED;
+  if (hue > blue_hue_min && hue < blue_hue_max) return BLUE;
+  return NONE;
+}
+
+bool ColorSorter::proximity_check(int proximity) {
+  if (!present && proximity > proximity_seen) {
+    present = true;
+    return true;
+  }
+  if (present && proximity < proximity_clear) present = false;
+  return false;
+}
+
+void ColorSorter::ring_seen(std::uint32_t time, double hue, double hook_position) {
+  seen++;
+  ring_color color = classify(hue);
+  if (keep == NONE || color == NONE || color == keep) return;
+  if (ring_count == MAX_RINGS) {
+    dropped++;
+    return;
+  }
+  rings[ring_count++] = {time, hook_position};
+}
+
+int ColorSorter::output(std::uint32_t time, double hook_position, int commanded) {
+  // Start an eject once the oldest ring has gone far enough, even if another is still holding
+  if (ring_count > 0 && hook_position - rings[0].position >= eject_travel) {
+    last_travel_ms = time - rings[0].time;
+    for (int i = 1; i < ring_count; i++) rings[i - 1] = rings[i];
+    ring_count--;
+    ejected++;
+    holding = true;
+    hold_until = time + eject_ms;
+  }
+  // A ring carried back down past the sensor isn't coming off the top
+  while (ring_count > 0 && hook_position < rings[0].position) {
+    for (int i = 1; i < ring_count; i++) rings[i - 1] = rings[i];
+    ring_count--;
+  }
+  if (holding && (std::int32_t)(time - hold_until) >= 0) holding = false;
+  return holding ? eject_speed : commanded;
+}
+
+std::uint32_t ColorSorter::wait_ms(std::uint32_t time, double hook_position, double hook_rpm,
+                                   std::uint32_t most_ms) const {
+  std::uint32_t wait = most_ms;
+  if (holding) {
+    std::uint32_t left = (std::int32_t)(hold_until - time) > 0 ? hold_until - time : 0;
+    if (left < wait) wait = left;
+  }
+  // rpm * 6 is degrees per second
+  if (ring_count > 0 && hook_rpm > 0) {
+    double left = (eject_travel - (hook_position - rings[0].position)) / (hook_rpm * 6.0) * 1000.0;
+    if (left < wait) wait = left > 0 ? (std::uint32_t)std::ceil(left) : 0;
+  }
+  // a 0 ms wait wouldn't block, and the intake task would starve everything below it
+  return wait > 0 ? wait : 1;
+}
+
+bool ColorSorter::ejecting() const { return holding; }
+
+SortingIntake::SortingIntake(pros::Motor& hooks, pros::Motor& low, pros::Optical& sensor)
+    : hooks(hooks), low(low), sensor(sensor) {}
+
+void SortingIntake::start(const int* p_team) {
+  attach(p_team);
+  intake_task = (pros::task_t)pros::Task([this] { service(); }, "intake");
+  pros::Task([this] { watch(); }, "color watch");
+}
+
+void SortingIntake::attach(const int* p_team) {
+  team = p_team;
+  sensor.set_led_pwm(100);
+  sensor.set_integration_time(watch_period);
+}
+
+void SortingIntake::request(source from, int hooks_speed, int low_speed) {
+  hooks_speeds[from].store(hooks_speed);
+  low_speeds[from].store(low_speed);
+  asking[from].store(true);
+}
+
+void SortingIntake::hooks_request(source from, int speed) {
+  hooks_speeds[from].store(speed);
+  asking[from].store(true);
+}
+
+void SortingIntake::low_request(source from, int speed) {
+  low_speeds[from].store(speed);
+  asking[from].store(true);
+}
+
+void SortingIntake::release(source from) {
+  asking[from].store(false);
+  hooks_speeds[from].store(0);
+  low_speeds[from].store(0);
+}
+
+SortingIntake::source SortingIntake::owner() const {
+  for (int i = SOURCES - 1; i >= 0; i--)
+    if (asking[i].load()) return (source)i;
+  return SOURCES;
+}
+
+void SortingIntake::update() { serve(sorter.proximity_check(sensor.get_proximity()) ? pros::millis() : 0); }
+
+void SortingIntake::watch() {
+  std::uint32_t now = pros::millis();
+  while (true) {
+    if (sorter.proximity_check(sensor.get_proximity()))
+      pros::c::task_notify_ext(intake_task, pros::millis(), pros::E_NOTIFY_ACTION_OWRITE, nullptr);
+    pros::Task::delay_until(&now, watch_period);
+  }
+}
+
+void SortingIntake::service() {
+  std::uint32_t wait = 0;
+  while (true) {
+    // the watch task sends the time it saw a ring
+    std::uint32_t seen_at = pros::Task::notify_take(true, wait);
+    wait = serve(seen_at);
+  }
+}
+
+std::uint32_t SortingIntake::serve(std::uint32_t seen_at) {
+  std::uint32_t now = pros::millis();
+  double position = hooks.get_position();
+  double rpm = hooks.get_actual_velocity();
+
+  ColorSorter::ring_color keep = *team == 1 ? ColorSorter::RED : *team == 0 ? ColorSorter::BLUE : ColorSorter::NONE;
+  if (keep != sorter.keep_get()) sorter.keep_set(keep);
+  // where the hooks were when the ring was seen
+  if (seen_at != 0) sorter.ring_seen(seen_at, sensor.get_hue(), position - rpm * 6.0 * (now - seen_at) / 1000.0);
+
+  const source from = owner();
+  const int hooks_speed = from == SOURCES ? 0 : hooks_speeds[from].load();
+  const int low_speed = from == SOURCES ? 0 : low_speeds[from].load();
+  // a jam reversal takes over from the request, and an eject from both
+  const int unjammed = jam.output(now, hooks_speed, hooks_sent, rpm, hooks.get_current_draw());
+  hooks_sent = sorter.output(now, position, unjammed);
+  hooks.move(hooks_sent);
+  low.move(low_speed);
+  const std::uint32_t wait = sorter.wait_ms(now, position, rpm, period);
+  return std::min(wait, jam.wait_ms(now, period));
+}
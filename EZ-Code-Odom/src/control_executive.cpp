@@ -0,0 +1,59 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "control_executive.hpp"
+
+void ControlExecutive::add(const std::string& name, std::function<void()> update, std::uint32_t every, std::uint32_t budget_us) {
+  updates.push_back(update);
+  times.push_back({name, every > 0 ? every : 1, budget_us});
+}
+
+void ControlExecutive::tick() {
+  const std::uint64_t start = pros::micros();
+  std::uint64_t before = start;
+  for (std::size_t i = 0; i < updates.size(); i++) {
+    timing& t = times[i];
+    if (ticks % t.every != 0) continue;
+    updates[i]();
+    const std::uint64_t after = pros::micros();
+    const std::uint32_t took = after - before;
+    before = after;
+
+    t.runs++;
+    t.last_us = took;
+    t.total_us += took;
+    if (took > t.worst_us) t.worst_us = took;
+    if (took > (t.budget_us > 0 ? t.budget_us : period * 1000)) t.overruns++;
+  }
+  ticks++;
+  const std::uint32_t took = before - start;
+  if (took > worst_tick_us) worst_tick_us = took;
+  if (took > period * 1000) overruns++;
+}
+
+void ControlExecutive::start() { pros::Task([this] { service(); }, priority, TASK_STACK_DEPTH_DEFAULT, "executive"); }
+
+void ControlExecutive::service() {
+  std::uint32_t next = pros::millis();
+  while (true) {
+    tick();
+    // after an overrun start the next tick now and keep the period from there, instead of
+    // running the missed ones back to back
+    const std::uint32_t now = pros::millis();
+    if (now - next >= period) {
+      skipped += (now - next) / period - 1;
+      next = now - period;
+    }
+    pros::Task::delay_until(&next, period);
+  }
+}
+
+const std::vector<ControlExecutive::timing>& ControlExecutive::timings() const { return times; }
+
+void ControlExecutive::timings_reset() {
+  for (timing& t : times) t = {t.name, t.every, t.budget_us};
+  ticks = overruns = skipped = worst_tick_us = 0;
+}
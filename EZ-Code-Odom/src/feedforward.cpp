@@ -0,0 +1,248 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "feedforward.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include "pros/rtos.hpp"
+
+namespace {
+
+// Samples slower than this are left out of the fit, in/s
+const double MOVING = 1;
+// Characterization
+const std::uint32_t SAMPLE_PERIOD = 10;   // ms
+const double RAMP = 1500;                 // mV per second for the quasistatic tests
+const std::uint32_t RAMP_TIME = 4000;     // ms, so it ramps to 6 V
+const double STEP = 6000;                 // mV for the step tests
+const std::uint32_t STEP_TIME = 1000;     // ms
+const std::uint32_t STOP_TIMEOUT = 2000;  // ms to wait for the robot to stop between tests
+
+double sign(double x) { return x > 0 ? 1 : x < 0 ? -1 : 0; }
+
+double clamp_mv(double mv) { return std::fmax(-12000, std::fmin(12000, mv)); }
+
+}  // namespace
+
+double Feedforward::voltage(double velocity, double acceleration) const {
+  return ks * sign(velocity) + kv * velocity + ka * acceleration;
+}
+
+void FeedforwardFit::sample_add(double mv, double velocity, double acceleration) {
+  if (std::fabs(velocity) < MOVING) return;
+  const double x[3] = {sign(velocity), velocity, acceleration};
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) xtx[i][j] += x[i] * x[j];
+    xty[i] += x[i] * mv;
+  }
+  yy += mv * mv;
+  y += mv;
+  n++;
+}
+
+bool FeedforwardFit::solve(Feedforward& out) const {
+  if (n < 3) return false;
+  // the normal equations, by Gaussian elimination with partial pivoting
+  double a[3][4];
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) a[i][j] = xtx[i][j];
+    a[i][3] = xty[i];
+  }
+  for (int col = 0; col < 3; col++) {
+    int pivot = col;
+    for (int row = col + 1; row < 3; row++)
+      if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) pivot = row;
+    // nothing to tell this constant apart from the others
+    if (std::fabs(a[pivot][col]) < 1e-9 * (xtx[col][col] + 1)) return false;
+    for (int j = 0; j < 4; j++) std::swap(a[col][j], a[pivot][j]);
+    for (int row = 0; row < 3; row++) {
+      if (row == col) continue;
+      double f = a[row][col] / a[col][col];
+      for (int j = col; j < 4; j++) a[row][j] -= f * a[col][j];
+    }
+  }
+  out.ks = a[0][3] / a[0][0];
+  out.kv = a[1][3] / a[1][1];
+  out.ka = a[2][3] / a[2][2];
+  return true;
+}
+
+double FeedforwardFit::r_squared(const Feedforward& ff) const {
+  if (n < 2) return 0;
+  const double beta[3] = {ff.ks, ff.kv, ff.ka};
+  // sum of squared residuals, expanded so it only needs the sums
+  double residuals = yy;
+  for (int i = 0; i < 3; i++) {
+    residuals -= 2 * beta[i] * xty[i];
+    for (int j = 0; j < 3; j++) residuals += beta[i] * xtx[i][j] * beta[j];
+  }
+  const double total = yy - y * y / n;
+  return total > 0 ? 1 - std::fmax(0, residuals) / total : 0;
+}
+
+int FeedforwardFit::samples() const { return n; }
+
+void FeedforwardFit::clear() { *this = FeedforwardFit(); }
+
+bool FeedforwardFit::save(const Feedforward& ff, const char* path) {
+  FILE* f = fopen(path, "w");
+  if (f == nullptr) return false;
+  fprintf(f, "ks %.4f\n", ff.ks);
+  fprintf(f, "kv %.4f\n", ff.kv);
+  fprintf(f, "ka %.4f\n", ff.ka);
+  fclose(f);
+  return true;
+}
+
+bool FeedforwardFit::load(Feedforward& ff, const char* path) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) return false;
+  Feedforward loaded;
+  int found = 0;
+  char name[8];
+  double value;
+  while (fscanf(f, "%7s %lf", name, &value) == 2) {
+    if (std::strcmp(name, "ks") == 0) loaded.ks = value, found |= 1;
+    if (std::strcmp(name, "kv") == 0) loaded.kv = value, found |= 2;
+    if (std::strcmp(name, "ka") == 0) loaded.ka = value, found |= 4;
+  }
+  fclose(f);
+  if (found != 7) return false;
+  ff = loaded;
+  return true;
+}
+
+Feedforward feedforward_characterize(std::vector<pros::Motor>& left, std::vector<pros::Motor>& right, double inches_per_rev,
+                                     FeedforwardFit* fit) {
+  FeedforwardFit own;
+  if (fit == nullptr) fit = &own;
+  fit->clear();
+
+  auto set = [&](double mv) {
+    for (pros::Motor& m : left) m.move_voltage(mv);
+    for (pros::Motor& m : right) m.move_voltage(mv);
+  };
+  // what the motors really had, averaged over both sides
+  auto voltage = [&] {
+    double total = 0;
+    for (pros::Motor& m : left) total += m.get_voltage();
+    for (pros::Motor& m : right) total += m.get_voltage();
+    return total / (left.size() + right.size());
+  };
+  auto velocity = [&] {
+    double total = 0;
+    for (pros::Motor& m : left) total += m.get_actual_velocity();
+    for (pros::Motor& m : right) total += m.get_actual_velocity();
+    return total / (left.size() + right.size()) * inches_per_rev / 60.0;
+  };
+  auto stop = [&] {
+    set(0);
+    const std::uint32_t start = pros::millis();
+    while (std::fabs(velocity()) > MOVING / 2 && pros::millis() - start < STOP_TIMEOUT) pros::delay(SAMPLE_PERIOD);
+    pros::delay(250);
+  };
+  // runs one test, mv_at gives the voltage ms into it.  Acceleration is a central difference, so
+  // each sample is the middle of three reads
+  auto test = [&](std::function<double(std::uint32_t)> mv_at, std::uint32_t length) {
+    const double dt = SAMPLE_PERIOD / 1000.0;
+    double mv[3] = {}, v[3] = {};
+    std::uint32_t now = pros::millis();
+    const std::uint32_t start = now;
+    for (int i = 0; now - start < length; i++) {
+      set(mv_at(now - start));
+      pros::Task::delay_until(&now, SAMPLE_PERIOD);
+      mv[0] = mv[1], mv[1] = mv[2], mv[2] = voltage();
+      v[0] = v[1], v[1] = v[2], v[2] = velocity();
+      if (i >= 2) fit->sample_add(mv[1], v[1], (v[2] - v[0]) / (2 * dt));
+    }
+    stop();
+  };
+
+  stop();
+  for (double direction : {1.0, -1.0}) test([=](std::uint32_t ms) { return direction * RAMP * ms / 1000.0; }, RAMP_TIME);
+  for (double direction : {1.0, -1.0}) test([=](std::uint32_t) { return direction * STEP; }, STEP_TIME);
+
+  Feedforward ff;
+  fit->solve(ff);
+  return ff;
+}
+
+Trapezoid::Trapezoid(double distance, double max_velocity, double max_acceleration) {
+  const double d = std::fabs(distance);
+  direction = distance < 0 ? -1 : 1;
+  accel = max_acceleration;
+  // a triangle if it can't get up to max_velocity and back down in the distance
+  cruise = std::fmin(max_velocity, std::sqrt(d * accel));
+  accel_time = cruise > 0 ? cruise / accel : 0;
+  cruise_time = cruise > 0 ? (d - cruise * accel_time) / cruise : 0;
+}
+
+Trapezoid::state Trapezoid::at(double t) const {
+  const double ramp = cruise * accel_time / 2;  // inches speeding up, and again slowing down
+  state s = {0, 0, 0};
+  if (t <= 0) return s;
+  if (t < accel_time) {
+    s = {accel * t * t / 2, accel * t, accel};
+  } else if (t < accel_time + cruise_time) {
+    s = {ramp + cruise * (t - accel_time), cruise, 0};
+  } else if (t < 2 * accel_time + cruise_time) {
+    const double slowing = t - accel_time - cruise_time;
+    s = {ramp + cruise * cruise_time + cruise * slowing - accel * slowing * slowing / 2, cruise - accel * slowing, -accel};
+  } else {
+    s = {2 * ramp + cruise * cruise_time, 0, 0};
+  }
+  return {direction * s.position, direction * s.velocity, direction * s.acceleration};
+}
+
+double Trapezoid::duration() const { return 2 * accel_time + cruise_time; }
+
+ProfiledDrive::ProfiledDrive(std::function<double()> distance_get, std::function<double()> heading_get,
+                             std::function<void(double, double)> voltage_set)
+    : distance_get(distance_get), heading_get(heading_get), voltage_set(voltage_set) {}
+
+bool ProfiledDrive::drive(double inches, std::uint32_t timeout) {
+  const Trapezoid profile(inches, max_velocity, max_acceleration);
+  const double start = distance_get();
+  const double heading = heading_get();
+  const double dt = period / 1000.0;
+  worst_error = 0;
+
+  std::uint32_t now = pros::millis();
+  const std::uint32_t begin = now;
+  std::uint32_t settled = 0;
+  double last_error = 0;
+  bool first = true;
+  while (true) {
+    const double t = (now - begin) / 1000.0;
+    const Trapezoid::state s = profile.at(t);
+    const double travelled = distance_get() - start;
+    const double error = s.position - travelled;
+    const double derivative = first ? 0 : (error - last_error) / dt;
+    first = false;
+    last_error = error;
+    worst_error = std::fmax(worst_error, std::fabs(error));
+
+    const double mv = feedforward.voltage(s.velocity, s.acceleration) + kp * error + kd * derivative;
+    const double turn = heading_kp * (heading - heading_get());
+    voltage_set(clamp_mv(mv + turn), clamp_mv(mv - turn));
+
+    if (t >= profile.duration()) {
+      settled = std::fabs(inches - travelled) < exit_error ? settled + period : 0;
+      if (settled >= settle_time) break;
+    }
+    if (timeout != 0 && now - begin >= timeout) {
+      voltage_set(0, 0);
+      return false;
+    }
+    pros::Task::delay_until(&now, period);
+  }
+  voltage_set(0, 0);
+  return true;
+}
@@ -0,0 +1,66 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "intake_jam.hpp"
+
+#include <cstdlib>
+
+namespace {
+int sgn(int x) { return (x > 0) - (x < 0); }
+}  // namespace
+
+int JamDetector::output(std::uint32_t time, int commanded, int sent, double rpm, int current_ma) {
+  const int direction = std::abs(sent) >= min_speed ? sgn(sent) : 0;
+  if (direction != driving) {
+    driving = direction;
+    driving_since = time;
+    stalled = 0;
+  }
+  if (!enabled) return commanded;
+
+  if (holding) {
+    // until whoever is driving the intake asks for something else
+    if (commanded == holding_command) return 0;
+    holding = false;
+    retries = 0;
+  }
+  if (backing) {
+    if ((std::int32_t)(reverse_until - time) > 0) return -jam_direction * reverse_speed;
+    backing = false;
+  }
+
+  const bool spun_up = time - driving_since >= spin_up_ms;
+  if (driving != 0 && spun_up && driving * rpm < stall_rpm && current_ma >= stall_current) stalled++;
+  else stalled = 0;
+  if (retries > 0 && time - last_jam >= clear_ms) retries = 0;
+  if (stalled < stall_ticks) return commanded;
+
+  jams++;
+  stalled = 0;
+  last_jam = time;
+  if (retries >= max_retries) {
+    holding = true;
+    holding_command = commanded;
+    give_ups++;
+    return 0;
+  }
+  retries++;
+  reversals++;
+  backing = true;
+  jam_direction = driving;
+  reverse_until = time + reverse_ms;
+  return -jam_direction * reverse_speed;
+}
+
+std::uint32_t JamDetector::wait_ms(std::uint32_t time, std::uint32_t most_ms) const {
+  if (!backing) return most_ms;
+  const std::int32_t left = reverse_until - time;
+  return left < 1 ? 1 : (std::uint32_t)left < most_ms ? left : most_ms;
+}
+
+bool JamDetector::reversing() const { return backing; }
+
+bool JamDetector::stuck() const { return holding; }
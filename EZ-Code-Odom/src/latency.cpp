@@ -0,0 +1,82 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "latency.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+#include "pros/rtos.hpp"
+
+namespace {
+
+// Motors count as moving past this, rpm
+const double MOVING = 5;
+// and stopped under this
+const double STOPPED = 1;
+// Give up on a trial after this long, ms
+const std::uint32_t TIMEOUT = 250;
+// How long to watch the imu after the motors start, ms
+const std::uint32_t WATCH = 200;
+
+void drive_set(std::vector<pros::Motor>& left, std::vector<pros::Motor>& right, int power) {
+  for (pros::Motor& m : left) m.move(power);
+  for (pros::Motor& m : right) m.move(-power);
+}
+
+}  // namespace
+
+latency_model latency_measure(std::vector<pros::Motor>& left, std::vector<pros::Motor>& right, pros::Imu& imu, int trials) {
+  double actuation = 0;
+  double update_period = 0;
+  int measured = 0, periods = 0;
+  for (int i = 0; i < trials; i++) {
+    // start from a standstill, or the last trial's coasting looks like moving
+    const std::uint32_t wait = pros::millis();
+    while (std::fabs(left.front().get_actual_velocity()) > STOPPED && pros::millis() - wait < 2000) pros::delay(10);
+
+    const int power = i % 2 == 0 ? 127 : -127;
+    const std::uint32_t start = pros::millis();
+    drive_set(left, right, power);
+
+    // first ms the motors report moving
+    std::uint32_t moving = 0;
+    while (moving == 0 && pros::millis() - start < TIMEOUT) {
+      pros::delay(1);
+      if (left.front().get_actual_velocity() * power > MOVING * 127) moving = pros::millis();
+    }
+
+    // the imu only reads something new every so often, time between changes
+    double last = imu.get_rotation();
+    std::uint32_t changed = 0, first_change = 0;
+    int changes = 0;
+    while (moving != 0 && pros::millis() - moving < WATCH) {
+      pros::delay(1);
+      double now = imu.get_rotation();
+      if (now != last) {
+        if (changes == 0) first_change = pros::millis();
+        changed = pros::millis();
+        changes++;
+        last = now;
+      }
+    }
+    drive_set(left, right, 0);
+
+    if (moving == 0) continue;
+    actuation += moving - start;
+    measured++;
+    if (changes > 1) {
+      update_period += (double)(changed - first_change) / (changes - 1);
+      periods++;
+    }
+  }
+
+  latency_model model;
+  if (measured > 0) model.actuation_ms = actuation / measured;
+  // a reading is anywhere from brand new to a whole update old
+  if (periods > 0) model.sensor_age_ms = update_period / periods / 2;
+  return model;
+}
@@ -0,0 +1,121 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "loop_timer.hpp"
+
+#include <cstring>
+
+#include "liblvgl/llemu.hpp"
+#include "pros/llemu.hpp"
+
+namespace {
+
+const int SCREEN_LINES = 8;
+
+LoopTimer* timers[LoopTimer::MAX_TIMERS] = {};
+std::atomic<int> timer_count = 0;
+
+// only the loop's task writes these, so the largest doesn't need a compare exchange
+void raise(std::atomic<std::uint32_t>& largest, std::uint32_t value) {
+  if (value > largest.load(std::memory_order_relaxed)) largest.store(value, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+LoopTimer::LoopTimer(const char* name, std::uint32_t period, std::uint32_t deadline)
+    : period(period), deadline(deadline > 0 ? deadline : (period + 1) / 2) {
+  std::strncpy(this->name, name, MAX_NAME);
+  this->name[MAX_NAME] = '\0';
+}
+
+void LoopTimer::start() {
+  if (!started.exchange(true)) {
+    const int index = timer_count.fetch_add(1);
+    if (index < MAX_TIMERS)
+      timers[index] = this;
+    else
+      timer_count.store(MAX_TIMERS);
+  }
+  reset();
+}
+
+void LoopTimer::begin() {
+  const std::uint64_t now = pros::micros();
+  if (!fresh.load(std::memory_order_relaxed)) {
+    const std::uint32_t took = now - last_begin;
+    passes.fetch_add(1, std::memory_order_relaxed);
+    period_total.fetch_add(took, std::memory_order_relaxed);
+    raise(period_max, took);
+    const std::uint32_t late = took > period * 1000 ? took - period * 1000 : 0;
+    raise(late_max, late);
+    if (late > deadline * 1000) misses.fetch_add(1, std::memory_order_relaxed);
+  }
+  fresh.store(false, std::memory_order_relaxed);
+  last_begin = now;
+}
+
+void LoopTimer::end() {
+  const std::uint32_t took = pros::micros() - last_begin;
+  busy_total.fetch_add(took, std::memory_order_relaxed);
+  raise(busy_max, took);
+}
+
+void LoopTimer::delay(std::uint32_t ms) {
+  end();
+  pros::delay(ms);
+}
+
+void LoopTimer::reset() {
+  passes.store(0);
+  period_total.store(0);
+  period_max.store(0);
+  late_max.store(0);
+  misses.store(0);
+  busy_total.store(0);
+  busy_max.store(0);
+  since.store(pros::micros());
+  fresh.store(true);
+}
+
+LoopTimer::stats LoopTimer::stats_get() const {
+  stats s;
+  s.passes = passes.load();
+  s.period_mean = s.passes > 0 ? period_total.load() / 1000.0 / s.passes : 0;
+  s.period_max = period_max.load() / 1000;
+  s.late_max = late_max.load() / 1000;
+  s.misses = misses.load();
+  const std::uint64_t elapsed = pros::micros() - since.load();
+  s.busy_percent = elapsed > 0 ? 100.0 * busy_total.load() / elapsed : 0;
+  s.busy_max = busy_max.load();
+  return s;
+}
+
+const char* LoopTimer::name_get() const { return name; }
+
+std::uint32_t LoopTimer::period_get() const { return period; }
+
+int LoopTimer::count() { return timer_count.load(); }
+
+LoopTimer* LoopTimer::get(int index) { return index >= 0 && index < count() ? timers[index] : nullptr; }
+
+void loop_timers_print(int first_line, int page) {
+  const int lines = SCREEN_LINES - first_line;
+  if (lines <= 0 || LoopTimer::count() == 0) return;
+  const int pages = (LoopTimer::count() + lines - 1) / lines;
+  const int first = (page % pages + pages) % pages * lines;
+  for (int line = 0; line < lines; line++) {
+    const LoopTimer* timer = LoopTimer::get(first + line);
+    // a short last page shouldn't leave the one before it showing underneath
+    if (timer == nullptr) {
+      pros::lcd::clear_line(first_line + line);
+      continue;
+    }
+    const LoopTimer::stats s = timer->stats_get();
+    pros::lcd::print(first_line + line, "%-10s %4.1f/%-2lu max %3lu miss %-4lu %3.0f%%", timer->name_get(), s.period_mean,
+                     (unsigned long)timer->period_get(), (unsigned long)s.period_max, (unsigned long)s.misses,
+                     s.busy_percent);
+  }
+}
@@ -3,6 +3,10 @@
 #include "autons.hpp"
 #include "liblvgl/misc/lv_area.h"
 #include "subsystems.hpp"
+#include "color_sorter.hpp"
+#include "control_executive.hpp"
+#include "arc_odometry.hpp"
+#include "loop_timer.hpp"
 #include "filesystem.h"
 // after comp testing
 /////
@@ -28,55 +32,34 @@ ez::Drive chassis(
 ez::tracking_wheel horiz_tracker(5, 2, 6.0);  // This tracking wheel is perpendicular to the drive wheels
 ez::tracking_wheel vert_tracker(4, 2, 0.0);   // This tracking wheel is parallel to the drive wheels
 
-void sorting_task() {
-    pros::delay(2000);  // Set EZ-Template calibrate before this function starts running
-    colorsort.set_led_pwm(100);
-    while (true) {
-      
-      int threshold = 200; //check with proximity values printed
-      if (isRedTeam != 2) {
-        int hue = colorsort.get_hue();
-        if (colorsort.get_proximity() > threshold) {
-          if (hue > 180 && hue < 240 && (isRedTeam == 1)) { //blue is 240, red is 0, but our hooks are purple which is ~300
-            pros::delay(180);
-            intakeHigh.move(0);
-            pros::delay(400);
-            intakeHigh.move(0);
-            printf("Hue: %d\n", hue);
-            printf("Proximity: %d\n", colorsort.get_proximity());
-          }
-          else if (hue < 50 && (isRedTeam == 0)) { //blue is 240, red is 0
-            pros::delay(180); 
-            intakeHigh.move(0);
-            pros::delay(400);
-            intakeHigh.move(0);
-            printf("Hue: %d\n", hue);
-            printf("Proximity: %d\n", colorsort.get_proximity());
-          }
-        }
-      }
-      intakeHigh.move(intake_speed_high);
-      intakeLow.move(intake_speed_low);
-      
-      pros::delay(ez::util::DELAY_TIME);
-    }
+// Runs odometry in its own faster task with arc integration instead of EZ's tracking task
+const bool ARC_ODOM_ENABLED = false;
+OdometryService arc_odom;
+// How far ahead follower_pose_get() predicts, so followers act on where the robot will be when
+// their commands land, ms.  Run the Measure Latency auton to find it.  EZ's own motions still act
+// on the pose as it is, the prediction is never written into odometry
+const double ARC_ODOM_LEAD = 25;
+
+ez::pose follower_pose_get() {
+  if (!ARC_ODOM_ENABLED) return chassis.odom_pose_get();
+  const ArcOdometry::pose p = arc_odom.predicted();
+  return {p.x, p.y, p.theta};
 }
-pros::Task SORTING_TASK(sorting_task);
-
-
 
+// Runs the intake at whatever the driver or auton asks for, frees jams and throws off rings that
+// aren't isRedTeam's color
+SortingIntake intake(intakeHigh, intakeLow, colorsort);
 
+// Runs odometry, relocalization, the intake, the lady brown and the screen from one fixed rate
+// task, in that order, instead of a task each.  Started in initialize() once the imu is calibrated
+ControlExecutive executive;
+void ez_screen_update();
 
-void lb_task() {
-  pros::delay(2000);  // Set EZ-Template calibrate before this function starts running
-  while (true) {
-    set_lb(lbPID.compute(ladybrown.get_position()));
-
-    pros::delay(ez::util::DELAY_TIME);
-  }
-}
-
-pros::Task LB_TASK(lb_task);
+// When the intake and lady brown updates actually run, and how opcontrol keeps up, shown on the
+// second blank page.  The executive's timings only say how long each update took
+LoopTimer intake_loop("intake", 10);
+LoopTimer lb_loop("lady brown", 10);
+LoopTimer driver_loop("opcontrol", ez::util::DELAY_TIME);
 
 void lv_image(void) {
     lv_obj_t * img1 = lv_img_create(lv_scr_act());
@@ -106,6 +89,13 @@ void initialize() {
   //  - ignore this if you aren't using a vertical tracker
   chassis.odom_tracker_left_set(&vert_tracker);
 
+  // Use calibrate_odom()'s offsets, diameters and imu scale instead of the ones above if it's been run
+  OdomCalibration::result calibration;
+  if (OdomCalibration::load(calibration, ODOM_CALIBRATION_PATH)) odom_calibration_apply(calibration);
+  // and characterize_drive()'s feedforward constants
+  FeedforwardFit::load(profiled_drive.feedforward, FEEDFORWARD_PATH);
+  ramsete.feedforward = profiled_drive.feedforward;
+
   // Configure your chassis controls
   chassis.opcontrol_curve_buttons_toggle(true);   // Enables modifying the controller curve with buttons on the joysticks
   chassis.opcontrol_drive_activebrake_set(0.0);   // Sets the active brake kP. We recommend ~2.  0 will disable.
@@ -115,7 +105,19 @@ void initialize() {
   default_constants();
   
   ladybrown.tare_position();
-  lbPID.exit_condition_set(80, 50, 300, 150, 500, 500);
+  // Lady brown feedforward, from Sim's model of it (sim::arm_feedforward) until it's characterized
+  lb_arm.kg = 1009;
+  lb_arm.ks = 600;
+  lb_arm.kv = 10;
+  lb_arm.ka = 0.534;
+  // kp is the field tuned lbPID's 0.45, from move() units to mV.  kd and the acceleration are
+  // tuned on Sim's arm_check so no move overshoots where lbPID doesn't and the load, score, down
+  // sequence takes no longer than lbPID's
+  lb_arm.kp = 0.45 * 12000 / 127;
+  lb_arm.kd = 23;
+  lb_arm.max_acceleration = 20000;
+  lb_arm.level = 900;
+  lb_arm.ratio = 12;
   
   _init_fs();
   
@@ -160,16 +162,77 @@ void initialize() {
       {"Interference\n\nAfter driving forward, robot performs differently if interfered or not", interfered_example},
       {"Simple Odom\n\nThis is the same as the drive example, but it uses odom instead!", odom_drive_example},
       {"Pure Pursuit\n\nGo to (0, 30) and pass through (6, 10) on the way.  Come back to (0, 0)", odom_pure_pursuit_example},
+      {"Profiled Pure Pursuit\n\nFollow /usd/paths/example.path at the speeds its time profile gives", odom_profiled_path_example},
+      {"Feedforward Drive\n\nDrive forward and come back on profiled_drive.  Run Characterize Drive first", feedforward_drive_example},
+      {"Ramsete\n\nFollow /usd/paths/example.path where its time profile says the robot should be.  Run Characterize Drive first", odom_ramsete_example},
+      {"Motion Queue\n\nThe start of the negative blue auton as one motion, clamping on the way without stopping.  Run Characterize Drive first", motion_queue_example},
       {"Pure Pursuit Wait Until\n\nGo to (24, 24) but start running an intake once the robot passes (12, 24)", odom_pure_pursuit_wait_until_example},
       {"Boomerang\n\nGo to (0, 24, 45) then come back to (0, 0, 0)", odom_boomerang_example},
       {"Boomerang Pure Pursuit\n\nGo to (0, 24, 45) on the way to (24, 24) then come back to (0, 0, 0)", odom_boomerang_injected_pure_pursuit_example},
       {"Measure Offsets\n\nThis will turn the robot a bunch of times and calculate your offsets for your tracking wheels.", measure_offsets},
+      {"Measure Latency\n\nSpins in place a few times to time how long motor commands and the imu take.  Set arc_odom's lead to what it shows.", measure_latency},
+      {"Characterize Drive\n\nRamps and steps the drive forwards and backwards to find its feedforward constants and saves them to the SD card.  Needs 5 feet clear in front.", characterize_drive},
+      {"Calibrate Odom\n\nStart square against a wall.  Drives out, spins and squares back up to solve for tracker offsets, diameters and imu scale, and saves them to the SD card.", calibrate_odom},
 
   });
 
   // Initialize chassis and auton selector
   chassis.initialize();
   ez::as::initialize();
+
+  // Odometry keeps its own 5 ms period by running every tick, everything else runs every
+  // CONTROL_EVERY ticks, the 10 ms it was tuned at
+  const std::uint32_t CONTROL_EVERY = 2;
+  executive.period = arc_odom.period;
+  if (ARC_ODOM_ENABLED) {
+    chassis.odom_enable(false);  // otherwise EZ's tracking task integrates on top of this one
+    arc_odom.odometry.horizontal_offset = horiz_tracker.distance_to_center_get();
+    arc_odom.lead_ms = ARC_ODOM_LEAD;
+    arc_odom.attach([] { return ArcOdometry::reading{vert_tracker.get(), horiz_tracker.get(), chassis.drive_imu_get()}; },
+                    [] { return ArcOdometry::pose{chassis.odom_x_get(), chassis.odom_y_get(), chassis.odom_theta_get()}; },
+                    [](double x, double y) { chassis.odom_xy_set(x, y); });
+    executive.add("arc odom", [] { arc_odom.update(); });
+  }
+
+  // Wall relocalization for skills.  Walls are in odom's frame, which starts with the robot
+  // centered against the back wall, SKILLS_START_Y in from it.  It runs right after odometry
+  // so its corrections never land in the middle of an odometry update
+  const double SKILLS_START_Y = 8.0;
+  wall_relocalization.relocalizer.field_set(-72, 72, -SKILLS_START_Y, 144 - SKILLS_START_Y);
+  wall_relocalization.sensor_add(12, {-6.5, 0, -90});  // left, change ports
+  wall_relocalization.sensor_add(13, {6.5, 0, 90});    // right
+  wall_relocalization.sensor_add(14, {0, -7, 180});    // back
+  wall_relocalization.attach([] { return WallRelocalizer::pose{chassis.odom_x_get(), chassis.odom_y_get(), chassis.odom_theta_get()}; },
+                             [](double x, double y) { chassis.odom_xy_set(x, y); });
+  executive.add("relocalize", [] { wall_relocalization.update(); }, wall_relocalization.period / executive.period);
+
+  // The particle filter's map is centered on the field, so odom's origin is SKILLS_START_Y off
+  // the red wall.  The filter is too slow for a tick so it keeps its own task, and the executive
+  // only makes the corrections it posts
+  particle_localization.origin_y = -72 + SKILLS_START_Y;
+  particle_localization.sensor_add(12, {-6.5, 0, -90});
+  particle_localization.sensor_add(13, {6.5, 0, 90});
+  particle_localization.sensor_add(14, {0, -7, 180});
+  particle_localization.attach([] { return ParticleLocalizer::pose{chassis.odom_x_get(), chassis.odom_y_get(), chassis.odom_theta_get()}; },
+                               [](double x, double y) { chassis.odom_xy_set(x, y); });
+  executive.add("localize", [] { particle_localization.update(); }, CONTROL_EVERY);
+
+  intake.period = executive.period * CONTROL_EVERY;
+  intake.attach(&isRedTeam);
+  intake_loop.start();
+  executive.add("intake", [] {
+    intake_loop.begin();
+    intake.update();
+    intake_loop.end();
+  }, CONTROL_EVERY);
+  lb_loop.start();
+  executive.add("lady brown", [] {
+    lb_loop.begin();
+    lb_arm.update();
+    lb_loop.end();
+  }, CONTROL_EVERY);
+  executive.add("screen", ez_screen_update, 10);
+  executive.start();
   master.rumble(chassis.drive_imu_calibrated() ? "." : "---");
 }
 
@@ -230,7 +293,12 @@ void autonomous() {
   to be consistent
   */
 
+  wall_relocalization.enabled = false;  // only skills starts where the walls are
+  particle_localization.enabled = false;
   ez::as::auton_selector.selected_auton_call();  // Calls selected auton from autonomous selector
+  if (wall_relocalization.enabled) wall_relocalization.stats_print();
+  wall_relocalization.enabled = false;
+  particle_localization.enabled = false;
 
   lv_image();
   ez::as::shutdown(); //ez template green turns off and team image comes on
@@ -250,43 +318,61 @@ void screen_print_tracker(ez::tracking_wheel *tracker, std::string name, int lin
 }
 
 /**
- * Ez screen task
+ * Prints how the executive's ticks and each of its updates are keeping up, from line on down
+ */
+void screen_print_executive(int line) {
+  ez::screen_print("ticks " + std::to_string(executive.ticks) + "  over " + std::to_string(executive.overruns) +
+                       "  skip " + std::to_string(executive.skipped) + "  worst " + std::to_string(executive.worst_tick_us) + "us",
+                   line++);
+  for (const ControlExecutive::timing& t : executive.timings()) {
+    if (line > 7) break;
+    ez::screen_print(t.name + ": " + std::to_string((int)t.mean_us()) + "/" + std::to_string(t.worst_us) + "us  over " +
+                         std::to_string(t.overruns),
+                     line++);
+  }
+}
+
+/**
+ * Ez screen update, run by the executive
  * Adding new pages here will let you view them during user control or autonomous
  * and will help you debug problems you're having
  */
-void ez_screen_task() {
-  while (true) {
-    // Only run this when not connected to a competition switch
-    if (!pros::competition::is_connected()) {
-      // Blank page for odom debugging
-      if (chassis.odom_enabled() && !chassis.pid_tuner_enabled()) {
-        // If we're on the first blank page...
-        if (ez::as::page_blank_is_on(0)) {
-          // Display X, Y, and Theta
-          ez::screen_print("x: " + util::to_string_with_precision(chassis.odom_x_get()) +
-                               "\ny: " + util::to_string_with_precision(chassis.odom_y_get()) +
-                               "\na: " + util::to_string_with_precision(chassis.odom_theta_get()),
-                           1);  // Don't override the top Page line
-
-          // Display all trackers that are being used
-          screen_print_tracker(chassis.odom_tracker_left, "l", 4);
-          screen_print_tracker(chassis.odom_tracker_right, "r", 5);
-          screen_print_tracker(chassis.odom_tracker_back, "b", 6);
-          screen_print_tracker(chassis.odom_tracker_front, "f", 7);
-        }
+void ez_screen_update() {
+  // Only run this when not connected to a competition switch
+  if (!pros::competition::is_connected()) {
+    // Blank page for odom debugging
+    if (chassis.odom_enabled() && !chassis.pid_tuner_enabled()) {
+      // If we're on the first blank page...
+      if (ez::as::page_blank_is_on(0)) {
+        // Display X, Y, and Theta
+        ez::screen_print("x: " + util::to_string_with_precision(chassis.odom_x_get()) +
+                             "\ny: " + util::to_string_with_precision(chassis.odom_y_get()) +
+                             "\na: " + util::to_string_with_precision(chassis.odom_theta_get()),
+                         1);  // Don't override the top Page line
+
+        // Display all trackers that are being used
+        screen_print_tracker(chassis.odom_tracker_left, "l", 4);
+        screen_print_tracker(chassis.odom_tracker_right, "r", 5);
+        screen_print_tracker(chassis.odom_tracker_back, "b", 6);
+        screen_print_tracker(chassis.odom_tracker_front, "f", 7);
       }
     }
-
-    // Remove all blank pages when connected to a comp switch
-    else {
-      if (ez::as::page_blank_amount() > 0)
-        ez::as::page_blank_remove_all();
+    // How the intake, lady brown and opcontrol loops are keeping up
+    if (ez::as::page_blank_is_on(1)) {
+      loop_timers_print(1);
     }
+    // And the executive running them, mean/worst time per update
+    if (ez::as::page_blank_is_on(2)) {
+      screen_print_executive(1);
+    }
+  }
 
-    pros::delay(ez::util::DELAY_TIME);
+  // Remove all blank pages when connected to a comp switch
+  else {
+    if (ez::as::page_blank_amount() > 0)
+      ez::as::page_blank_remove_all();
   }
 }
-pros::Task ezScreenTask(ez_screen_task);
 
 /**
  * Gives you some extras to run in your opcontrol:
@@ -312,6 +398,7 @@ void ez_template_extras() {
     if (master.get_digital(DIGITAL_B) && master.get_digital(DIGITAL_DOWN)) {
       pros::motor_brake_mode_e_t preference = chassis.drive_brake_get();
       autonomous();
+      intake.release(SortingIntake::AUTON);  // or the auton's last request keeps the driver off the intake
       chassis.drive_brake_set(preference);
     }
 
@@ -346,11 +433,14 @@ void opcontrol() {
     // This is preference to what you like to drive on
     chassis.drive_brake_set(MOTOR_BRAKE_COAST);
     ladybrown.set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
-    lbPID.target_set(0);
+    lb_arm.go_to(0);
+    intake.release(SortingIntake::AUTON);  // the driver's buttons have the intake from here
     isRedTeam = 2; //TURN OFF COLOR SORT FOR DRIVER 
     doinker.set(false);
     // intakePiston.set(false);
+    driver_loop.start();
     while (true) {
+      driver_loop.begin();
       // Gives you some extras to make EZ-Template ezier
       ez_template_extras();
       
@@ -368,16 +458,13 @@ void opcontrol() {
 
 
       if (master.get_digital(DIGITAL_R1)) {
-          intake_speed_high = 127;
-          intake_speed_low = 127;
+          intake.request(SortingIntake::DRIVER, 127, 127);
       } 
       else if (master.get_digital(DIGITAL_R2)) {
-          intake_speed_high = -127;
-          intake_speed_low = -127;
+          intake.request(SortingIntake::DRIVER, -127, -127);
       } 
       else {
-          intake_speed_high = 0;
-          intake_speed_low = 0;
+          intake.request(SortingIntake::DRIVER, 0, 0);
       }
 
       mogoclamp.button_toggle(master.get_digital(DIGITAL_L2)); 
@@ -385,24 +472,24 @@ void opcontrol() {
       // intakePiston.button_toggle(master.get_digital(DIGITAL_B));
 
 
-      if (master.get_digital(DIGITAL_DOWN)) {
-          lbPID.target_set(0);
+      if (master.get_digital_new_press(DIGITAL_DOWN)) {
+          lb_arm.go_to(0);
       }
 
-      if (master.get_digital(DIGITAL_UP)) {
-          lbPID.target_set(2000);
+      if (master.get_digital_new_press(DIGITAL_UP)) {
+          lb_arm.go_to(2000);
       }
 
-      if (master.get_digital(DIGITAL_RIGHT)) {
-          lbPID.target_set(450);
+      if (master.get_digital_new_press(DIGITAL_RIGHT)) {
+          lb_arm.go_to(450);
       }
 
-      if (master.get_digital(DIGITAL_LEFT)) {
-          lbPID.target_set(2600);
+      if (master.get_digital_new_press(DIGITAL_LEFT)) {
+          lb_arm.go_to(2600);
       }
 
 
 
-      pros::delay(ez::util::DELAY_TIME);  // This is used for timer calculations!  Keep this ez::util::DELAY_TIME
+      driver_loop.delay(ez::util::DELAY_TIME);  // This is used for timer calculations!  Keep this ez::util::DELAY_TIME
     }
 }
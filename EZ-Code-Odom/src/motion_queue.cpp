@@ -0,0 +1,328 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "motion_queue.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "pros/rtos.hpp"
+
+namespace {
+
+// Turns smaller than this are left out, radians
+const double STRAIGHT = 1e-4;
+// Heading the robot has to be within at the end, on top of the follower's exit_error, radians
+const double EXIT_HEADING = 3 * M_PI / 180;
+
+double wrap(double angle) { return std::remainder(angle, 2 * M_PI); }
+
+// EZ's headings are clockwise from +y in degrees
+double direction_of(double theta) { return M_PI / 2 - theta * M_PI / 180; }
+
+}  // namespace
+
+MotionQueue::MotionQueue(RamseteFollower& follower, std::function<ez::pose()> pose_get)
+    : follower(follower), pose_get(pose_get) {}
+
+MotionQueue& MotionQueue::drive(double inches) {
+  queue.push_back({motion::DRIVE, inches, ez::LEFT_SWING, {}, ez::fwd});
+  return *this;
+}
+
+MotionQueue& MotionQueue::turn(double heading) {
+  queue.push_back({motion::TURN, heading, ez::LEFT_SWING, {}, ez::fwd});
+  return *this;
+}
+
+MotionQueue& MotionQueue::swing(double heading, ez::e_swing side) {
+  queue.push_back({motion::SWING, heading, side, {}, ez::fwd});
+  return *this;
+}
+
+MotionQueue& MotionQueue::path(const std::vector<trajectory_point>& points, ez::drive_directions direction) {
+  queue.push_back({motion::PATH, 0, ez::LEFT_SWING, points, direction});
+  return *this;
+}
+
+MotionQueue& MotionQueue::within(double inches, std::function<void()> action) {
+  triggers.push_back({(int)queue.size() - 1, inches, action});
+  return *this;
+}
+
+std::vector<MotionQueue::piece> MotionQueue::pieces_build(const ez::pose& start, std::vector<int>& motion_ends) const {
+  const double half_track = follower.track_width_get() / 2;
+
+  // Lines, arcs and turns in place, before any blending.  A corner's blend is the most radius it
+  // may be rounded to, 0 to turn it in place
+  struct leg {
+    piece p;
+    double blend;
+  };
+  std::vector<leg> legs;
+  motion_ends.clear();
+  double facing = direction_of(start.theta);
+  double x = start.x, y = start.y;
+  auto line = [&](double length, int direction) {
+    legs.push_back({{LINE, length, 0, direction}, 0});
+    x += direction * length * std::cos(facing);
+    y += direction * length * std::sin(facing);
+  };
+  auto corner = [&](double angle, double blend) {
+    if (std::fabs(angle) < STRAIGHT) return;
+    legs.push_back({{SPIN, 0, angle, 1}, blend});
+    facing += angle;
+  };
+
+  for (const motion& m : queue) {
+    switch (m.kind) {
+      case motion::DRIVE:
+        if (m.value != 0) line(std::fabs(m.value), m.value < 0 ? -1 : 1);
+        break;
+      case motion::TURN:
+        corner(wrap(direction_of(m.value) - facing), blend_radius);
+        break;
+      case motion::SWING: {
+        const double angle = wrap(direction_of(m.value) - facing);
+        if (std::fabs(angle) < STRAIGHT) break;
+        // the left side going forwards turns the robot clockwise
+        const int direction = (m.side == ez::LEFT_SWING) == (angle < 0) ? 1 : -1;
+        // the center goes round the still wheel, half a track width away
+        const double chord = 2 * half_track * std::sin(std::fabs(angle) / 2);
+        x += direction * chord * std::cos(facing + angle / 2);
+        y += direction * chord * std::sin(facing + angle / 2);
+        legs.push_back({{ARC, half_track * std::fabs(angle), angle, direction}, 0});
+        facing += angle;
+        break;
+      }
+      case motion::PATH: {
+        // a line to each point, with the corners between them rounded as wide as they fit
+        const int direction = m.path_direction == ez::rev ? -1 : 1;
+        bool first = true;
+        for (const trajectory_point& p : m.points) {
+          const double length = std::hypot(p.x - x, p.y - y);
+          if (length < 0.01) continue;
+          const double heading = std::atan2(p.y - y, p.x - x) + (direction < 0 ? M_PI : 0);
+          // the turn onto the path is like any other turn, later ones can be as wide as fits
+          corner(wrap(heading - facing), first ? blend_radius : INFINITY);
+          first = false;
+          line(length, direction);
+        }
+        break;
+      }
+    }
+    motion_ends.push_back(legs.size());
+  }
+
+  // Round every corner between two lines going the same way into an arc, taking up to half of
+  // each line
+  std::vector<piece> pieces;
+  std::vector<int> leg_to_piece(legs.size() + 1);
+  for (int i = 0; i < (int)legs.size(); i++) {
+    leg_to_piece[i] = pieces.size();
+    leg& l = legs[i];
+    if (l.p.kind == SPIN && l.blend > 0 && i > 0 && i + 1 < (int)legs.size()) {
+      leg& before = legs[i - 1];
+      leg& after = legs[i + 1];
+      if (before.p.kind == LINE && after.p.kind == LINE && before.p.direction == after.p.direction) {
+        const double tangent = std::tan(std::fabs(l.p.angle) / 2);
+        // before is already trimmed at its start if it had a corner there, so it has less left
+        const double room = std::fmin(before.p.length, after.p.length / 2);
+        const double radius = std::fmin(l.blend, room / tangent);
+        const double trim = radius * tangent;
+        if (radius > 0.1) {
+          pieces.back().length -= trim;
+          after.p.length -= trim;
+          pieces.push_back({ARC, radius * std::fabs(l.p.angle), l.p.angle, before.p.direction});
+          continue;
+        }
+      }
+    }
+    pieces.push_back(l.p);
+  }
+  leg_to_piece[legs.size()] = pieces.size();
+  for (int& end : motion_ends) end = leg_to_piece[end];
+  return pieces;
+}
+
+std::vector<MotionQueue::sample> MotionQueue::samples_build(const ez::pose& start, const std::vector<piece>& pieces,
+                                                            const std::vector<int>& piece_ends,
+                                                            std::vector<int>& motion_samples) const {
+  const double half_track = follower.track_width_get() / 2;
+  std::vector<sample> samples;
+  std::vector<double> limit;  // fastest the faster wheel can go at each sample, in/s
+  std::vector<int> first_sample(pieces.size() + 1);
+  double x = start.x, y = start.y, facing = direction_of(start.theta), progress = 0;
+
+  for (int i = 0; i < (int)pieces.size(); i++) {
+    const piece& p = pieces[i];
+    first_sample[i] = samples.size();
+    // inches of the faster wheel, the center's length plus what turning adds to the outside
+    const double travel = p.length + std::fabs(p.angle) * half_track;
+    if (travel <= 0) continue;
+    const double forward = p.direction * p.length / travel;
+    const double turn = p.angle / travel;
+    double fastest = max_velocity;
+    if (forward != 0 && turn != 0) fastest = std::fmin(fastest, std::sqrt(max_lateral / std::fabs(forward * turn)));
+
+    const int steps = std::max(1, (int)std::ceil(travel / spacing));
+    const double dp = travel / steps;
+    for (int s = 0; s < steps; s++) {
+      samples.push_back({progress, x, y, facing, forward, turn, 0, 0, 0});
+      limit.push_back(fastest);
+      // exactly along the arc, so every point is on the plan however coarse the spacing
+      const double ds = forward * dp, dphi = turn * dp;
+      if (std::fabs(dphi) < 1e-9) {
+        x += ds * std::cos(facing);
+        y += ds * std::sin(facing);
+      } else {
+        x += ds * (std::sin(facing + dphi) - std::sin(facing)) / dphi;
+        y += ds * (std::cos(facing) - std::cos(facing + dphi)) / dphi;
+      }
+      facing += dphi;
+      progress += dp;
+    }
+  }
+  first_sample[pieces.size()] = samples.size();
+  samples.push_back({progress, x, y, facing, 0, 0, 0, 0, 0});
+  limit.push_back(0);
+
+  // Where the robot has to stop: the start, turns in place and changes of direction.  Every
+  // other boundary it goes straight through
+  limit[0] = 0;
+  for (int i = 0; i < (int)pieces.size(); i++) {
+    const bool spin = pieces[i].kind == SPIN;
+    const bool reverses = i > 0 && pieces[i - 1].kind != SPIN && !spin && pieces[i - 1].direction != pieces[i].direction;
+    if (spin || reverses) {
+      limit[first_sample[i]] = 0;
+      if (spin) limit[first_sample[i + 1]] = 0;
+    }
+    // the sample at a boundary belongs to the piece after it, but has to suit the one before too
+    if (i > 0 && first_sample[i] > 0) {
+      const int at = first_sample[i];
+      limit[at] = std::fmin(limit[at], limit[at - 1]);
+      // where a line meets an arc the inside wheel changes speed all at once, slow down so it
+      // changes by no more than max_jump
+      const double forward = samples[at].forward - samples[at - 1].forward;
+      const double turn = (samples[at].turn - samples[at - 1].turn) * half_track;
+      const double jump = std::fmax(std::fabs(forward - turn), std::fabs(forward + turn));
+      if (jump > 1e-6) limit[at] = std::fmin(limit[at], max_jump / jump);
+    }
+  }
+
+  // Fastest it can go at each sample, speeding up from the last stop and slowing for the next,
+  // the same passes as the LemLib project's packedpath::timeProfile
+  const int n = samples.size();
+  samples[0].velocity = 0;
+  for (int i = 1; i < n; i++) {
+    const double dp = samples[i].progress - samples[i - 1].progress;
+    samples[i].velocity = std::fmin(limit[i], std::sqrt(samples[i - 1].velocity * samples[i - 1].velocity + 2 * max_acceleration * dp));
+  }
+  for (int i = n - 2; i >= 0; i--) {
+    const double dp = samples[i + 1].progress - samples[i].progress;
+    samples[i].velocity = std::fmin(samples[i].velocity, std::sqrt(samples[i + 1].velocity * samples[i + 1].velocity + 2 * max_acceleration * dp));
+  }
+  for (int i = 0; i + 1 < n; i++) {
+    sample& s = samples[i];
+    const double dp = samples[i + 1].progress - s.progress;
+    const double sum = s.velocity + samples[i + 1].velocity;
+    s.acceleration = dp > 0 ? (samples[i + 1].velocity * samples[i + 1].velocity - s.velocity * s.velocity) / (2 * dp) : 0;
+    samples[i + 1].time = s.time + (sum > 0 ? 2 * dp / sum : 0);
+  }
+
+  motion_samples.clear();
+  for (int end : piece_ends) motion_samples.push_back(first_sample[end]);
+  return samples;
+}
+
+std::vector<MotionQueue::sample> MotionQueue::plan(const ez::pose& start) const {
+  std::vector<int> piece_ends, motion_samples;
+  std::vector<piece> pieces = pieces_build(start, piece_ends);
+  return samples_build(start, pieces, piece_ends, motion_samples);
+}
+
+bool MotionQueue::run(std::uint32_t timeout) {
+  const ez::pose start = pose_get();
+  std::vector<int> piece_ends, motion_samples;
+  const std::vector<piece> pieces = pieces_build(start, piece_ends);
+  const std::vector<sample> samples = samples_build(start, pieces, piece_ends, motion_samples);
+  std::vector<trigger> pending = triggers;
+  queue.clear();
+  triggers.clear();
+  planned = samples.back().time;
+
+  // triggers queued before any motion go off straight away
+  auto trigger_at = [&](const trigger& t) -> const sample& { return samples[t.motion < 0 ? 0 : motion_samples[t.motion]]; };
+
+  std::uint32_t now = pros::millis();
+  const std::uint32_t begin = now;
+  int segment = 0;
+  bool finished = false;
+  while (timeout == 0 || now - begin < timeout) {
+    const double t = (now - begin) / 1000.0;
+    while (segment < (int)samples.size() - 2 && samples[segment + 1].time <= t) segment++;
+
+    RamseteFollower::reference ref;
+    if (t >= planned || samples.size() < 2) {
+      const sample& end = samples.back();
+      ref = {end.x, end.y, end.direction, 0, 0, 0, 0};
+    } else {
+      // constant acceleration of the faster wheel between samples
+      const sample& from = samples[segment];
+      const sample& to = samples[segment + 1];
+      const double dt = t - from.time;
+      const double dp = to.progress - from.progress;
+      const double wheel = std::fmax(from.velocity + from.acceleration * dt, 0);
+      const double f = dp > 0 ? std::clamp((from.velocity * dt + from.acceleration * dt * dt / 2) / dp, 0.0, 1.0) : 0;
+      ref = {from.x + (to.x - from.x) * f,
+             from.y + (to.y - from.y) * f,
+             from.direction + (to.direction - from.direction) * f,
+             from.forward * wheel,
+             from.forward * from.acceleration,
+             from.turn * wheel,
+             from.turn * from.acceleration};
+    }
+    const RamseteFollower::error e = follower.track(ref);
+
+    const ez::pose pose = pose_get();
+    for (auto it = pending.begin(); it != pending.end();) {
+      const sample& at = trigger_at(*it);
+      if (t >= at.time || std::hypot(at.x - pose.x, at.y - pose.y) <= it->inches) {
+        it->action();
+        it = pending.erase(it);
+      } else {
+        it++;
+      }
+    }
+
+    if (t >= planned &&
+        ((std::fabs(e.along) < follower.exit_error && std::fabs(e.heading) < EXIT_HEADING) || t >= planned + follower.settle_time / 1000.0)) {
+      finished = true;
+      break;
+    }
+    pros::Task::delay_until(&now, follower.period);
+  }
+  follower.stop();
+  for (const trigger& t : pending) t.action();
+  return finished;
+}
+
+void MotionQueue::start(std::uint32_t timeout) {
+  busy = true;
+  pros::Task([this, timeout] {
+    last_result = run(timeout);
+    busy = false;
+  });
+}
+
+bool MotionQueue::wait() {
+  while (busy) pros::delay(10);
+  return last_result;
+}
+
+bool MotionQueue::running() const { return busy; }
+
+double MotionQueue::duration() const { return planned; }
@@ -0,0 +1,145 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "odom_calibration.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const double DEGREES = M_PI / 180.0;
+
+// Two sided 95% Student's t for 1 - 30 degrees of freedom, after that it's close enough to normal
+const double T95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                      2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                      2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+double t95(int dof) {
+  if (dof < 1) return INFINITY;
+  if (dof <= 30) return T95[dof - 1];
+  return 1.96;
+}
+
+// Least squares line through the origin, y = slope * x
+struct fit {
+  double sum_xy = 0, sum_xx = 0, sum_yy = 0;
+  int n = 0;
+
+  void add(double x, double y) {
+    sum_xy += x * y;
+    sum_xx += x * x;
+    sum_yy += y * y;
+    n++;
+  }
+  double slope() const { return sum_xx > 0 ? sum_xy / sum_xx : 0; }
+  // standard error of the slope, from the residuals
+  double error() const {
+    if (n < 2 || sum_xx <= 0) return INFINITY;
+    double residuals = std::fmax(0, sum_yy - slope() * sum_xy);
+    return std::sqrt(residuals / (n - 1) / sum_xx);
+  }
+  double plus_minus() const { return t95(n - 1) * error(); }
+};
+
+}  // namespace
+
+OdomCalibration::OdomCalibration(double vertical_diameter, double horizontal_diameter)
+    : vertical_diameter(vertical_diameter), horizontal_diameter(horizontal_diameter) {}
+
+void OdomCalibration::spin_add(double vertical, double horizontal, double imu) {
+  if (spin_count < MAX_SPINS) spins[spin_count++] = {(float)vertical, (float)horizontal, (float)imu};
+}
+
+void OdomCalibration::leg_add(double vertical, double imu, double forward) {
+  if (leg_count < MAX_LEGS) legs[leg_count++] = {(float)vertical, (float)imu, (float)forward};
+}
+
+void OdomCalibration::heading_add(double imu) {
+  if (heading_count < MAX_HEADINGS) headings[heading_count++] = imu;
+}
+
+void OdomCalibration::clear() { spin_count = leg_count = heading_count = 0; }
+
+OdomCalibration::result OdomCalibration::solve() const {
+  result r;
+  r.spins = spin_count;
+  r.legs = leg_count;
+  r.headings = heading_count;
+  if (spin_count < 2 || leg_count < 2 || heading_count < 2) return r;
+
+  // The real turn is the closest whole number of revolutions, as long as the imu is within 180
+  fit scale;
+  for (int i = 0; i < heading_count; i++) scale.add(headings[i], std::round(headings[i] / 360.0) * 360.0);
+  const double s = scale.slope();
+  if (s <= 0) return r;
+
+  // Turning in place, a tracker rolls its offset times the turn in radians
+  fit vertical_spin, horizontal_spin;
+  for (int i = 0; i < spin_count; i++) {
+    double turn = s * spins[i].imu * DEGREES;
+    vertical_spin.add(turn, spins[i].vertical);
+    horizontal_spin.add(turn, spins[i].horizontal);
+  }
+
+  // Driving, the vertical tracker reads k * forward once the little bit of turning is taken out
+  fit vertical_leg;
+  for (int i = 0; i < leg_count; i++)
+    vertical_leg.add(legs[i].forward, legs[i].vertical - vertical_spin.slope() * s * legs[i].imu * DEGREES);
+  const double k = vertical_leg.slope();
+  if (k <= 0) return r;
+  const double k_relative = vertical_leg.plus_minus() / k;
+
+  r.imu_scale = {s, scale.plus_minus()};
+  // vertical reads k * (forward - offset * turn), horizontal reads k * (sideways + offset * turn)
+  const double x = -vertical_spin.slope() / k;
+  const double y = horizontal_spin.slope() / k;
+  r.vertical_offset = {x, std::fabs(x) * std::hypot(vertical_spin.plus_minus() / vertical_spin.slope(), k_relative)};
+  r.horizontal_offset = {y, std::fabs(y) * std::hypot(horizontal_spin.plus_minus() / horizontal_spin.slope(), k_relative)};
+  // when the slope is ~0 the relative error blows up, fall back to the absolute one
+  if (!std::isfinite(r.vertical_offset.plus_minus)) r.vertical_offset.plus_minus = vertical_spin.plus_minus() / k;
+  if (!std::isfinite(r.horizontal_offset.plus_minus)) r.horizontal_offset.plus_minus = horizontal_spin.plus_minus() / k;
+  // readings assume the nominal diameter, so a wheel that's really bigger reads short
+  r.vertical_diameter = {vertical_diameter / k, vertical_diameter / k * k_relative};
+  r.horizontal_diameter = {horizontal_diameter / k, horizontal_diameter / k * k_relative};
+  r.valid = true;
+  return r;
+}
+
+bool OdomCalibration::save(const result& r, const char* path) {
+  FILE* f = fopen(path, "w");
+  if (f == nullptr) return false;
+  fprintf(f, "imu_scale %.6f %.6f\n", r.imu_scale.value, r.imu_scale.plus_minus);
+  fprintf(f, "vertical_offset %.4f %.4f\n", r.vertical_offset.value, r.vertical_offset.plus_minus);
+  fprintf(f, "horizontal_offset %.4f %.4f\n", r.horizontal_offset.value, r.horizontal_offset.plus_minus);
+  fprintf(f, "vertical_diameter %.4f %.4f\n", r.vertical_diameter.value, r.vertical_diameter.plus_minus);
+  fprintf(f, "horizontal_diameter %.4f %.4f\n", r.horizontal_diameter.value, r.horizontal_diameter.plus_minus);
+  fclose(f);
+  return true;
+}
+
+bool OdomCalibration::load(result& r, const char* path) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) return false;
+  result loaded;
+  int found = 0;
+  char name[32];
+  double value, plus_minus;
+  while (fscanf(f, "%31s %lf %lf", name, &value, &plus_minus) == 3) {
+    estimate e = {value, plus_minus};
+    if (std::strcmp(name, "imu_scale") == 0) loaded.imu_scale = e, found |= 1;
+    if (std::strcmp(name, "vertical_offset") == 0) loaded.vertical_offset = e, found |= 2;
+    if (std::strcmp(name, "horizontal_offset") == 0) loaded.horizontal_offset = e, found |= 4;
+    if (std::strcmp(name, "vertical_diameter") == 0) loaded.vertical_diameter = e, found |= 8;
+    if (std::strcmp(name, "horizontal_diameter") == 0) loaded.horizontal_diameter = e, found |= 16;
+  }
+  fclose(f);
+  if (found != 31) return false;
+  loaded.valid = true;
+  r = loaded;
+  return true;
+}
@@ -0,0 +1,292 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "particle_localizer.hpp"
+
+#include <cmath>
+
+namespace {
+
+const float MM_PER_INCH = 25.4f;
+const float INCHES_PER_METER = 39.37f;
+const float DEGREES = (float)(M_PI / 180.0);
+const float NOTHING = 1e9f;  // a beam that hits nothing on the map
+
+const field_segment HIGH_STAKES_SEGMENTS[] = {
+    // perimeter
+    {-72, -72, 72, -72},
+    {72, -72, 72, 72},
+    {72, 72, -72, 72},
+    {-72, 72, -72, -72},
+    // ladder base, corners on the tile corners around the middle
+    {24, 0, 0, 24},
+    {0, 24, -24, 0},
+    {-24, 0, 0, -24},
+    {0, -24, 24, 0},
+};
+
+}  // namespace
+
+const field_map HIGH_STAKES_FIELD = {HIGH_STAKES_SEGMENTS, sizeof(HIGH_STAKES_SEGMENTS) / sizeof(field_segment)};
+
+ParticleLocalizer::ParticleLocalizer(const field_map& map, std::uint32_t seed) : map(map), rng(seed ? seed : 1) {}
+
+float ParticleLocalizer::uniform() {
+  // xorshift32, the top 24 bits fill a float's mantissa
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (rng >> 8) * (1.0f / 16777216.0f);
+}
+
+float ParticleLocalizer::gaussian() {
+  // sum of four uniforms, close enough to normal for noise and much cheaper than logs
+  return (uniform() + uniform() + uniform() + uniform() - 2.0f) * 1.7320508f;
+}
+
+int ParticleLocalizer::beam_add(const beam& b) {
+  if (beam_count == MAX_BEAMS) return -1;
+  beams[beam_count] = b;
+  return beam_count++;
+}
+
+void ParticleLocalizer::reset(int count, const pose& start, double spread, double theta_spread) {
+  n = count < 1 ? 1 : count > MAX_PARTICLES ? MAX_PARTICLES : count;
+  current = 0;
+  for (int i = 0; i < n; i++) {
+    xs[0][i] = start.x + gaussian() * spread;
+    ys[0][i] = start.y + gaussian() * spread;
+    thetas[0][i] = start.theta + gaussian() * theta_spread;
+    weights[i] = 1.0f / n;
+  }
+}
+
+void ParticleLocalizer::move(double forward, double sideways, double turn) {
+  float* x = xs[current];
+  float* y = ys[current];
+  float* theta = thetas[current];
+  const float forward_std = std::fabs(forward) * move_noise + move_floor;
+  const float sideways_std = std::fabs(sideways) * move_noise + move_floor;
+  const float turn_std = std::fabs(turn) * turn_noise + turn_floor;
+  for (int i = 0; i < n; i++) {
+    float f = forward + gaussian() * forward_std;
+    float s = sideways + gaussian() * sideways_std;
+    float t = turn + gaussian() * turn_std;
+    float heading = (theta[i] + t / 2) * DEGREES;
+    float sine = std::sin(heading);
+    float cosine = std::cos(heading);
+    x[i] += f * sine + s * cosine;
+    y[i] += f * cosine - s * sine;
+    theta[i] += t;
+  }
+}
+
+void ParticleLocalizer::ray_cast(const beam& b) {
+  const float* x = xs[current];
+  const float* y = ys[current];
+  const float beam_sine = std::sin(b.angle * DEGREES);
+  const float beam_cosine = std::cos(b.angle * DEGREES);
+  for (int i = 0; i < n; i++) {
+    origin_x[i] = x[i] + b.x * cosines[i] + b.y * sines[i];
+    origin_y[i] = y[i] - b.x * sines[i] + b.y * cosines[i];
+    direction_x[i] = sines[i] * beam_cosine + cosines[i] * beam_sine;
+    direction_y[i] = cosines[i] * beam_cosine - sines[i] * beam_sine;
+    expected[i] = NOTHING;
+  }
+  for (int k = 0; k < map.count; k++) {
+    const field_segment& s = map.segments[k];
+    const float ex = s.x2 - s.x1;
+    const float ey = s.y2 - s.y1;
+    // start + t * direction = s1 + u * (s2 - s1), without branches so it vectorizes
+    for (int i = 0; i < n; i++) {
+      float denom = direction_x[i] * ey - direction_y[i] * ex;
+      float wx = s.x1 - origin_x[i];
+      float wy = s.y1 - origin_y[i];
+      float t = (wx * ey - wy * ex) / denom;
+      float u = (wx * direction_y[i] - wy * direction_x[i]) / denom;
+      bool hit = t > 0 && u >= 0 && u <= 1 && t < expected[i];
+      expected[i] = hit ? t : expected[i];
+    }
+  }
+}
+
+void ParticleLocalizer::normalize() {
+  float total = 0;
+  for (int i = 0; i < n; i++) total += weights[i];
+  // every particle disagreed with the sensors, start the weights over instead of dividing by 0
+  if (!(total > 1e-30f)) {
+    for (int i = 0; i < n; i++) weights[i] = 1.0f / n;
+    return;
+  }
+  const float scale = 1 / total;
+  for (int i = 0; i < n; i++) weights[i] *= scale;
+}
+
+void ParticleLocalizer::ranges_update(const int* ranges_mm) {
+  const float* theta = thetas[current];
+  for (int i = 0; i < n; i++) {
+    sines[i] = std::sin(theta[i] * DEGREES);
+    cosines[i] = std::cos(theta[i] * DEGREES);
+  }
+  bool used = false;
+  for (int b = 0; b < beam_count; b++) {
+    if (ranges_mm[b] <= 0 || ranges_mm[b] > max_range) continue;
+    used = true;
+    ray_cast(beams[b]);
+    const float measured = ranges_mm[b] / MM_PER_INCH;
+    const float sigma = range_floor + range_noise * measured;
+    const float scale = -0.5f / (sigma * sigma);
+    for (int i = 0; i < n; i++) {
+      float error = measured - expected[i];
+      weights[i] *= (1 - random_hit) * std::exp(error * error * scale) + random_hit;
+    }
+  }
+  if (used) normalize();
+}
+
+void ParticleLocalizer::gps_update(double x, double y, double error) {
+  const float* px = xs[current];
+  const float* py = ys[current];
+  const float scale = -0.5f / (error * error);
+  for (int i = 0; i < n; i++) {
+    float dx = px[i] - x;
+    float dy = py[i] - y;
+    weights[i] *= std::exp((dx * dx + dy * dy) * scale) + 1e-3f;
+  }
+  normalize();
+}
+
+bool ParticleLocalizer::resample() {
+  float squares = 0;
+  for (int i = 0; i < n; i++) squares += weights[i] * weights[i];
+  if (1 / squares >= resample_below * n) return false;
+
+  // systematic: one random offset, then evenly spaced picks through the cumulative weights
+  const int next = 1 - current;
+  const float step = 1.0f / n;
+  float target = uniform() * step;
+  float cumulative = weights[0];
+  int j = 0;
+  for (int i = 0; i < n; i++) {
+    while (target > cumulative && j < n - 1) cumulative += weights[++j];
+    xs[next][i] = xs[current][j];
+    ys[next][i] = ys[current][j];
+    thetas[next][i] = thetas[current][j];
+    target += step;
+  }
+  current = next;
+  for (int i = 0; i < n; i++) weights[i] = step;
+  resamples++;
+  return true;
+}
+
+ParticleLocalizer::pose ParticleLocalizer::estimate() const {
+  const float* x = xs[current];
+  const float* y = ys[current];
+  const float* theta = thetas[current];
+  // headings aren't wrapped, so average them relative to one particle
+  double mx = 0, my = 0, turn = 0;
+  for (int i = 0; i < n; i++) {
+    mx += weights[i] * x[i];
+    my += weights[i] * y[i];
+    turn += weights[i] * std::remainder(theta[i] - theta[0], 360.0f);
+  }
+  return {mx, my, theta[0] + turn};
+}
+
+double ParticleLocalizer::spread() const {
+  const pose mean = estimate();
+  const float* x = xs[current];
+  const float* y = ys[current];
+  double total = 0;
+  for (int i = 0; i < n; i++) total += weights[i] * ((x[i] - mean.x) * (x[i] - mean.x) + (y[i] - mean.y) * (y[i] - mean.y));
+  return std::sqrt(total);
+}
+
+int ParticleLocalizer::count() const { return n; }
+
+LocalizerService::LocalizerService(const field_map& map) : localizer(map) {}
+
+bool LocalizerService::sensor_add(int port, const ParticleLocalizer::beam& where) {
+  int index = localizer.beam_add(where);
+  if (index < 0) return false;
+  distances[index] = new pros::Distance(port);
+  return true;
+}
+
+void LocalizerService::gps_set(int port) { gps = new pros::Gps(port); }
+
+void LocalizerService::start(std::function<ParticleLocalizer::pose()> pose_get,
+                             std::function<void(double, double)> xy_set) {
+  get = pose_get;
+  set = xy_set;
+  pros::Task([this] { service(true); }, "localize");
+}
+
+void LocalizerService::attach(std::function<ParticleLocalizer::pose()> pose_get,
+                              std::function<void(double, double)> xy_set) {
+  get = pose_get;
+  set = xy_set;
+  pros::Task([this] { service(false); }, "localize");
+}
+
+void LocalizerService::update() {
+  if (!correcting.take(0)) return;
+  if (posted) {
+    ParticleLocalizer::pose p = get();
+    set(p.x + posted_dx, p.y + posted_dy);
+    shift_x += posted_dx;
+    shift_y += posted_dy;
+    posted = false;
+  }
+  correcting.give();
+}
+
+void LocalizerService::service(bool correct) {
+  ParticleLocalizer::pose last = get();
+  localizer.reset(particles, {last.x + origin_x, last.y + origin_y, last.theta}, 1.0, 1.0);
+  double seen_x = 0, seen_y = 0;
+  std::uint32_t now = pros::millis();
+  while (true) {
+    pros::Task::delay_until(&now, period);
+    correcting.take();
+    ParticleLocalizer::pose p = get();
+    const double shifted_x = shift_x, shifted_y = shift_y;
+    correcting.give();
+    // odometry's move this tick, in the robot's frame, less the corrections made since the last
+    double dx = p.x - last.x - (shifted_x - seen_x);
+    double dy = p.y - last.y - (shifted_y - seen_y);
+    double heading = (last.theta + p.theta) / 2 * M_PI / 180.0;
+    localizer.move(dx * std::sin(heading) + dy * std::cos(heading), dx * std::cos(heading) - dy * std::sin(heading),
+                   p.theta - last.theta);
+    last = p;
+    seen_x = shifted_x;
+    seen_y = shifted_y;
+
+    int ranges[ParticleLocalizer::MAX_BEAMS] = {};
+    for (int i = 0; i < ParticleLocalizer::MAX_BEAMS; i++)
+      if (distances[i] != nullptr) ranges[i] = distances[i]->get();
+    localizer.ranges_update(ranges);
+    // the gps reads in meters from the middle of the field, same frame as the map
+    if (gps != nullptr && gps->get_error() < 0.1) {
+      pros::gps_position_s_t fix = gps->get_position();
+      localizer.gps_update(fix.x * INCHES_PER_METER, fix.y * INCHES_PER_METER,
+                           std::fmax(0.5, gps->get_error() * INCHES_PER_METER));
+    }
+    localizer.resample();
+
+    if (enabled && localizer.spread() < correct_below) {
+      // posted as a move from where odometry was this tick, so it still holds once odometry has moved on
+      ParticleLocalizer::pose estimate = localizer.estimate();
+      correcting.take();
+      posted = true;
+      posted_dx = estimate.x - origin_x - p.x;
+      posted_dy = estimate.y - origin_y - p.y;
+      correcting.give();
+      if (correct) update();
+    }
+  }
+}
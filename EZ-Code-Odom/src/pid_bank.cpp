@@ -0,0 +1,94 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "pid_bank.hpp"
+
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Same as ez::util::DELAY_TIME, gains are per tick of this many ms
+static const float PID_TICK = 10.0f;
+
+int PIDBank::add(float p, float i, float d, float p_start_i) {
+  if (count >= MAX) return -1;
+  int slot = count++;
+  constants_set(slot, p, i, d, p_start_i);
+  active[slot] = 1.0f;
+  return slot;
+}
+
+void PIDBank::constants_set(int slot, float p, float i, float d, float p_start_i) {
+  kp[slot] = p;
+  ki[slot] = i;
+  kd[slot] = d;
+  start_i[slot] = p_start_i;
+}
+
+void PIDBank::variables_reset(int slot) {
+  output[slot] = 0.0f;
+  error[slot] = 0.0f;
+  integral[slot] = 0.0f;
+  derivative[slot] = 0.0f;
+}
+
+void PIDBank::active_set(int slot, bool toggle) { active[slot] = toggle ? 1.0f : 0.0f; }
+bool PIDBank::active_get(int slot) { return active[slot] != 0.0f; }
+float PIDBank::output_get(int slot) { return output[slot]; }
+int PIDBank::size() { return count; }
+
+void PIDBank::update_all(const float* errors, float dt) {
+  const float grow_scale = dt / PID_TICK;
+  const float rate = dt > 0.0f ? PID_TICK / dt : 0.0f;
+  int n = 0;
+
+#if defined(__ARM_NEON)
+  // GCC won't vectorize float math for NEON without -ffast-math, so spell it out
+  const float32x4_t v_grow_scale = vdupq_n_f32(grow_scale);
+  const float32x4_t v_rate = vdupq_n_f32(rate);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  for (; n + 4 <= count; n += 4) {
+    float32x4_t e = vld1q_f32(errors + n);
+    float32x4_t prev = vld1q_f32(error + n);
+    float32x4_t k_i = vld1q_f32(ki + n);
+
+    uint32x4_t builds = vandq_u32(vcltq_f32(vabsq_f32(e), vld1q_f32(start_i + n)), vmvnq_u32(vceqq_f32(k_i, zero)));
+    float32x4_t grow = vbslq_f32(builds, vmulq_f32(e, v_grow_scale), zero);
+    uint32x4_t same_sign = vcgtq_f32(vmulq_f32(e, prev), zero);
+    float32x4_t in = vbslq_f32(same_sign, vaddq_f32(vld1q_f32(integral + n), grow), zero);
+    float32x4_t d = vmulq_f32(vsubq_f32(e, prev), v_rate);
+
+    float32x4_t out = vmulq_f32(vld1q_f32(kp + n), e);
+    out = vmlaq_f32(out, k_i, in);
+    out = vmlaq_f32(out, vld1q_f32(kd + n), d);
+
+    uint32x4_t on = vcgtq_f32(vld1q_f32(active + n), zero);
+    vst1q_f32(output + n, vbslq_f32(on, out, zero));
+    vst1q_f32(integral + n, vbslq_f32(on, in, zero));
+    vst1q_f32(derivative + n, vbslq_f32(on, d, zero));
+    vst1q_f32(error + n, vbslq_f32(on, e, zero));
+  }
+#endif
+
+  // Conditions are 0 or 1 multipliers instead of branches so this vectorizes on its own everywhere else
+  for (int i = n; i < count; i++) {
+    float e = errors[i];
+    float prev = error[i];
+    float builds = (float)(std::fabs(e) < start_i[i]) * (float)(ki[i] != 0.0f);
+    float same_sign = (float)(e * prev > 0.0f);  // i resets when the sign of error changes
+    float in = (integral[i] + e * grow_scale * builds) * same_sign;
+    float d = (e - prev) * rate;
+    float out = kp[i] * e + ki[i] * in + kd[i] * d;
+
+    float on = active[i];
+    output[i] = out * on;
+    integral[i] = in * on;
+    derivative[i] = d * on;
+    error[i] = e * on;
+  }
+}
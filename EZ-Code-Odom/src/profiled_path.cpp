@@ -0,0 +1,97 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "profiled_path.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Layout of a packed path, from the LemLib project's include/packedPath.hpp.  Little endian
+// floats, the header then one point after another
+const char MAGIC[4] = {'P', 'P', 'T', 'H'};
+const std::uint16_t VERSION = 2;
+
+struct header {
+  char magic[4];
+  std::uint16_t version;
+  std::uint16_t point_size;
+  std::uint32_t count;
+  float length;
+  float duration;
+};
+
+struct point {
+  float x, y, speed, distance, curvature, velocity, acceleration, time;
+};
+
+// Reads the header if data holds a packed path this can read
+bool header_read(const void* data, std::size_t size, header& h) {
+  if (data == nullptr || size < sizeof(h)) return false;
+  std::memcpy(&h, data, sizeof(h));
+  return std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 && h.version == VERSION && h.point_size == sizeof(point) &&
+         h.count <= (size - sizeof(h)) / sizeof(point);
+}
+
+std::vector<std::uint8_t> file_read(const char* path) {
+  std::vector<std::uint8_t> bytes;
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) return bytes;
+  std::uint8_t buffer[512];
+  std::size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), f)) > 0) bytes.insert(bytes.end(), buffer, buffer + read);
+  fclose(f);
+  return bytes;
+}
+
+}  // namespace
+
+std::vector<ez::odom> profiled_path_movements(const void* data, std::size_t size, ez::drive_directions direction) {
+  std::vector<ez::odom> movements;
+  header h;
+  if (!header_read(data, size, h)) return movements;
+
+  const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data) + sizeof(h);
+  movements.reserve(h.count);
+  for (std::uint32_t i = 0; i < h.count; i++) {
+    point p;
+    std::memcpy(&p, bytes + i * sizeof(p), sizeof(p));
+    // the last point is 0 to mark the end, EZ slows down into it by itself
+    int speed = (int)std::lround(p.speed);
+    if (speed < 1) speed = movements.empty() ? 1 : movements.back().max_xy_speed;
+    if (speed > 127) speed = 127;
+    movements.push_back({{p.x, p.y}, direction, speed});
+  }
+  return movements;
+}
+
+std::vector<ez::odom> profiled_path_movements(const char* path, ez::drive_directions direction) {
+  std::vector<std::uint8_t> bytes = file_read(path);
+  return profiled_path_movements(bytes.data(), bytes.size(), direction);
+}
+
+std::vector<trajectory_point> profiled_path_trajectory(const void* data, std::size_t size) {
+  std::vector<trajectory_point> trajectory;
+  header h;
+  if (!header_read(data, size, h) || h.duration <= 0) return trajectory;
+
+  const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data) + sizeof(h);
+  trajectory.reserve(h.count);
+  for (std::uint32_t i = 0; i < h.count; i++) {
+    point p;
+    std::memcpy(&p, bytes + i * sizeof(p), sizeof(p));
+    trajectory.push_back({p.x, p.y, p.distance, p.curvature, p.velocity, p.acceleration, p.time});
+  }
+  return trajectory;
+}
+
+std::vector<trajectory_point> profiled_path_trajectory(const char* path) {
+  std::vector<std::uint8_t> bytes = file_read(path);
+  return profiled_path_trajectory(bytes.data(), bytes.size());
+}
@@ -0,0 +1,124 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "ramsete_follower.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "pros/rtos.hpp"
+
+namespace {
+
+// angle in (-pi, pi]
+double wrap(double angle) { return std::remainder(angle, 2 * M_PI); }
+
+// direction the path runs at a point, counterclockwise from +x, from the points either side of it
+double point_direction(const std::vector<trajectory_point>& t, int i) {
+  const trajectory_point& before = t[std::max(i - 1, 0)];
+  const trajectory_point& after = t[std::min<int>(i + 1, t.size() - 1)];
+  return std::atan2(after.y - before.y, after.x - before.x);
+}
+
+// where the profile has the robot, seconds in.  segment is where the last lookup was, time only
+// goes forwards so the search starts there
+RamseteFollower::reference reference_at(const std::vector<trajectory_point>& t, double seconds, int& segment) {
+  const int last = t.size() - 1;
+  if (last < 1 || seconds >= t[last].time) return {t[last].x, t[last].y, point_direction(t, last), 0, 0, 0, 0};
+  seconds = std::fmax(seconds, 0);
+  while (segment < last - 1 && t[segment + 1].time <= seconds) segment++;
+
+  // constant acceleration along each segment
+  const trajectory_point& from = t[segment];
+  const trajectory_point& to = t[segment + 1];
+  const double dt = seconds - from.time;
+  const double ds = to.distance - from.distance;
+  const double f = ds > 0 ? std::clamp((from.velocity * dt + from.acceleration * dt * dt / 2) / ds, 0.0, 1.0) : 0;
+  const double start = point_direction(t, segment);
+  const double velocity = std::fmax(from.velocity + from.acceleration * dt, 0);
+  const double curvature = from.curvature + (to.curvature - from.curvature) * f;
+  return {from.x + (to.x - from.x) * f,
+          from.y + (to.y - from.y) * f,
+          start + wrap(point_direction(t, segment + 1) - start) * f,
+          velocity,
+          from.acceleration,
+          velocity * curvature,
+          from.acceleration * curvature};
+}
+
+}  // namespace
+
+RamseteFollower::RamseteFollower(double track_width, std::function<ez::pose()> pose_get,
+                                 std::function<void(double, double)> voltage_set)
+    : track_width(track_width), pose_get(pose_get), voltage_set(voltage_set) {}
+
+RamseteFollower::error RamseteFollower::track(const reference& ref) {
+  // EZ's theta is clockwise from +y in degrees
+  const ez::pose pose = pose_get();
+  const double heading = M_PI / 2 - pose.theta * M_PI / 180;
+  const double dx = ref.x - pose.x, dy = ref.y - pose.y;
+  const error e = {std::cos(heading) * dx + std::sin(heading) * dy, -std::sin(heading) * dx + std::cos(heading) * dy,
+                   wrap(ref.direction - heading)};
+
+  const double k = std::fmax(2 * zeta * std::sqrt(ref.angular * ref.angular + b * ref.velocity * ref.velocity), min_gain);
+  const double sinc = std::fabs(e.heading) < 1e-6 ? 1 : std::sin(e.heading) / e.heading;
+  const double velocity = ref.velocity * std::cos(e.heading) + k * e.along;
+  const double angular = ref.angular + k * e.heading + b * ref.velocity * sinc * e.across;
+
+  const double spin = angular * track_width / 2, spin_acceleration = ref.angular_acceleration * track_width / 2;
+  double left = feedforward.voltage(velocity - spin, ref.acceleration - spin_acceleration);
+  double right = feedforward.voltage(velocity + spin, ref.acceleration + spin_acceleration);
+  // scale both down together so the robot still turns as much when one side is saturated
+  const double ratio = std::fmax(std::fabs(left), std::fabs(right)) / 12000;
+  if (ratio > 1) left /= ratio, right /= ratio;
+  voltage_set(left, right);
+  return e;
+}
+
+void RamseteFollower::stop() { voltage_set(0, 0); }
+
+double RamseteFollower::track_width_get() const { return track_width; }
+
+bool RamseteFollower::follow(const std::vector<trajectory_point>& trajectory, ez::drive_directions direction,
+                             std::uint32_t timeout) {
+  rms_error = worst_error = 0;
+  if (trajectory.empty()) return false;
+  const bool reversed = direction == ez::rev;
+  const double duration = trajectory.back().time;
+
+  std::uint32_t now = pros::millis();
+  const std::uint32_t begin = now;
+  int segment = 0, steps = 0;
+  double squares = 0;
+  bool finished = false;
+  while (timeout == 0 || now - begin < timeout) {
+    const double t = (now - begin) / 1000.0;
+    if (t >= duration + settle_time / 1000.0) {
+      finished = true;
+      break;
+    }
+    reference ref = reference_at(trajectory, t, segment);
+    // backwards, the robot faces the other way and its velocity is negative
+    if (reversed) {
+      ref.direction += M_PI;
+      ref.velocity = -ref.velocity;
+      ref.acceleration = -ref.acceleration;
+    }
+    const error e = track(ref);
+    // stopped, any error left is across the end, which only driving away and back could fix
+    if (t >= duration && std::fabs(e.along) < exit_error) {
+      finished = true;
+      break;
+    }
+    squares += e.across * e.across;
+    steps++;
+    worst_error = std::fmax(worst_error, std::fabs(e.across));
+    pros::Task::delay_until(&now, period);
+  }
+  stop();
+  rms_error = steps > 0 ? std::sqrt(squares / steps) : 0;
+  return finished;
+}
@@ -0,0 +1,172 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "wall_relocalizer.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const double MM_PER_INCH = 25.4;
+
+double radians(double degrees) { return degrees * M_PI / 180.0; }
+
+}  // namespace
+
+double WallRelocalizer::residual_stats::mean() const { return samples > rejected ? sum / (samples - rejected) : 0; }
+
+double WallRelocalizer::residual_stats::rms() const {
+  return samples > rejected ? std::sqrt(sum_squares / (samples - rejected)) : 0;
+}
+
+bool WallRelocalizer::wall_add(const wall& w) {
+  if (wall_count == MAX_WALLS) return false;
+  walls[wall_count++] = w;
+  return true;
+}
+
+void WallRelocalizer::field_set(double left, double right, double bottom, double top) {
+  wall_add({true, left, bottom, top});
+  wall_add({true, right, bottom, top});
+  wall_add({false, bottom, left, right});
+  wall_add({false, top, left, right});
+}
+
+int WallRelocalizer::sensor_add(const sensor& s) {
+  if (count == MAX_SENSORS) return -1;
+  sensors[count] = s;
+  return count++;
+}
+
+const WallRelocalizer::wall* WallRelocalizer::wall_hit(double x, double y, double beam, double& distance) const {
+  const double dx = std::sin(beam);
+  const double dy = std::cos(beam);
+  const wall* hit = nullptr;
+  for (int i = 0; i < wall_count; i++) {
+    const wall& w = walls[i];
+    double along = w.vertical ? dx : dy;
+    if (std::fabs(along) < 1e-6) continue;
+    double t = (w.at - (w.vertical ? x : y)) / along;
+    double across = w.vertical ? y + t * dy : x + t * dx;
+    if (t <= 0 || across < std::fmin(w.from, w.to) || across > std::fmax(w.from, w.to)) continue;
+    if (hit == nullptr || t < distance) {
+      hit = &w;
+      distance = t;
+    }
+  }
+  return hit;
+}
+
+WallRelocalizer::correction WallRelocalizer::check(int index, const pose& odom, int distance_mm, int confidence) {
+  correction out;
+  if (index < 0 || index >= count) return out;
+  // the sensor reads 9999 when it sees nothing, and its confidence only means something past 200 mm
+  if (distance_mm <= 0 || distance_mm > max_range) return out;
+  if (distance_mm > 200 && confidence < min_confidence) return out;
+
+  const sensor& s = sensors[index];
+  double beam = odom.theta + s.angle;
+  double misalign = beam - 90.0 * std::round(beam / 90.0);
+  if (std::fabs(misalign) > square_tolerance) return out;
+
+  double theta = radians(odom.theta);
+  double right = s.x * std::cos(theta) + s.y * std::sin(theta);
+  double up = -s.x * std::sin(theta) + s.y * std::cos(theta);
+  double expected;
+  const wall* w = wall_hit(odom.x + right, odom.y + up, radians(beam), expected);
+  if (w == nullptr) return out;
+
+  // where the reading puts the robot along the wall's normal
+  double measured = distance_mm / MM_PER_INCH;
+  double residual;
+  if (w->vertical) residual = w->at - measured * std::sin(radians(beam)) - right - odom.x;
+  else residual = w->at - measured * std::cos(radians(beam)) - up - odom.y;
+
+  residual_stats& st = sensor_stats[index];
+  st.samples++;
+  st.last = residual;
+  if (std::fabs(residual) > max_residual) {
+    st.rejected++;
+    return out;
+  }
+  st.sum += residual;
+  st.sum_squares += residual * residual;
+  if (std::fabs(residual) > std::fabs(st.worst)) st.worst = residual;
+  out.valid = true;
+  out.x_axis = w->vertical;
+  out.delta = residual * gain;
+  st.corrected += std::fabs(out.delta);
+  return out;
+}
+
+const WallRelocalizer::residual_stats& WallRelocalizer::stats(int index) const { return sensor_stats[index]; }
+
+void WallRelocalizer::stats_reset() {
+  for (residual_stats& st : sensor_stats) st = residual_stats();
+}
+
+int WallRelocalizer::sensor_count() const { return count; }
+
+bool RelocalizationService::sensor_add(int port, const WallRelocalizer::sensor& where) {
+  int index = relocalizer.sensor_add(where);
+  if (index < 0) return false;
+  distances[index] = new pros::Distance(port);
+  return true;
+}
+
+void RelocalizationService::start(std::function<WallRelocalizer::pose()> pose_get,
+                                  std::function<void(double, double)> xy_set) {
+  attach(pose_get, xy_set);
+  pros::Task([this] { service(); }, "relocalize");
+}
+
+void RelocalizationService::attach(std::function<WallRelocalizer::pose()> pose_get,
+                                   std::function<void(double, double)> xy_set) {
+  get = pose_get;
+  set = xy_set;
+  last = get();
+  still_ms = 0;
+}
+
+void RelocalizationService::service() {
+  std::uint32_t now = pros::millis();
+  while (true) {
+    pros::Task::delay_until(&now, period);
+    update();
+  }
+}
+
+void RelocalizationService::update() {
+  WallRelocalizer::pose p = get();
+  double seconds = period / 1000.0;
+  bool still = std::hypot(p.x - last.x, p.y - last.y) < settle_speed * seconds &&
+               std::fabs(p.theta - last.theta) < settle_turn * seconds;
+  still_ms = still ? still_ms + period : 0;
+  last = p;
+  if (!enabled || still_ms < settle_ms) return;
+
+  double dx = 0, dy = 0;
+  for (int i = 0; i < relocalizer.sensor_count(); i++) {
+    WallRelocalizer::correction c = relocalizer.check(i, p, distances[i]->get(), distances[i]->get_confidence());
+    if (!c.valid) continue;
+    if (c.x_axis) dx += c.delta;
+    else dy += c.delta;
+  }
+  if (dx != 0 || dy != 0) {
+    set(p.x + dx, p.y + dy);
+    last.x += dx;
+    last.y += dy;
+  }
+}
+
+void RelocalizationService::stats_print() const {
+  for (int i = 0; i < relocalizer.sensor_count(); i++) {
+    const WallRelocalizer::residual_stats& st = relocalizer.stats(i);
+    std::printf("wall sensor %d: %u readings, %u rejected, residual mean %.2f rms %.2f worst %.2f last %.2f, corrected %.2f in\n",
+                i, (unsigned)st.samples, (unsigned)st.rejected, st.mean(), st.rms(), st.worst, st.last, st.corrected);
+  }
+}
@@ -0,0 +1,358 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Drives the LemLib robot's intake, lady brown and pistons through 10 s of scripted driver
+// control while its sorting task flings three wrong rings, first writing the devices from both
+// tasks like main.cpp used to, then through Actuators and the actuators task.  Counts every
+// smart port and adi write each way.  The arbitrated one has to send a small fraction of them,
+// end with the devices in the same state, let every eject run its full travel, which the
+// driver's move(0) every loop used to cut short, and stop the hooks dead after it even while the
+// driver is holding intake.  Then checks which source wins, and hammers
+// the slots from real threads to make sure a command is never applied half written.
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#include "actuatorArbiter.hpp"
+#include "pros/adi.hpp"
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// Ports from Comp3-24-25-LemLib-Odom/src/main.cpp
+const int LOW_PORT = -4, HOOKS_PORT = -5, LADYBROWN_PORT = 16;
+const char PISTON_PORT = 'B', CLAMP_PORT = 'C';
+// the sorting task's, same as main.cpp
+const double EJECT_TRAVEL = 240;
+const std::uint32_t EJECT_TIMEOUT = 400;
+const std::uint32_t EJECT_STOP = 100;
+const std::uint32_t RUN_MS = 10000;
+// ms into the run the sorting task sees a wrong ring, one while intaking and two while idle
+const std::uint32_t EJECTS[] = {1200, 4200, 8200};
+const int EJECT_COUNT = sizeof(EJECTS) / sizeof(EJECTS[0]);
+
+// What the driver is holding t ms into the run
+struct buttons {
+  bool r1, r2, l1, l2, up;
+};
+
+buttons script(std::uint32_t t) {
+  buttons b{};
+  b.r1 = t < 3000;
+  b.r2 = t >= 5000 && t < 6000;
+  b.l2 = t >= 2000 && t < 2100;  // clamp
+  b.l1 = t >= 7000 && t < 7100;  // intake piston
+  b.up = t >= 8000 && t < 8300;  // lady brown up
+  return b;
+}
+
+struct result {
+  std::uint32_t motor_writes = 0;
+  std::uint32_t adi_writes = 0;
+  std::uint32_t requests = 0, redundant = 0;  // arbitrated only
+  double travel[EJECT_COUNT] = {};             // hook degrees each eject got
+  int driven[EJECT_COUNT] = {};                // ticks the hooks were sent power while each eject held them stopped
+  double slowed[EJECT_COUNT] = {};             // hook rpm lost over each hold
+  int clamp = 0, piston = 0;
+  double ladybrown_target = 0;
+};
+
+// Every device write, motors and three wire ports, made during the run
+std::uint32_t motor_writes() {
+  std::uint32_t n = 0;
+  for (int port : {LOW_PORT, HOOKS_PORT, LADYBROWN_PORT}) n += sim::world().motors[sim::port_index(port)].commands;
+  return n;
+}
+
+std::uint32_t adi_writes() {
+  std::uint32_t n = 0;
+  for (const sim::adi_state& a : sim::world().adi[0]) n += a.writes;
+  return n;
+}
+
+// main.cpp's sorting() with the color read replaced by the EJECTS times.  fling, stop and done
+// are what it does to the hooks
+template <typename Fling, typename Stop, typename Done>
+void sort_loop(std::uint32_t start, pros::Motor& hooks, result& r, Fling fling, Stop stop, Done done) {
+  bool ejecting = false, stopping = false;
+  int next = 0, current = 0;
+  double ejectStart = 0;
+  std::uint32_t ejectStartTime = 0, stopStartTime = 0;
+  while (pros::millis() - start < RUN_MS) {
+    const std::uint32_t now = pros::millis();
+    if (!ejecting && !stopping && next < EJECT_COUNT && now - start >= EJECTS[next]) {
+      fling();
+      ejecting = true;
+      current = next++;
+      ejectStart = hooks.get_position();
+      ejectStartTime = now;
+    }
+    if (ejecting && (hooks.get_position() - ejectStart >= EJECT_TRAVEL || now - ejectStartTime >= EJECT_TIMEOUT)) {
+      r.travel[current] = hooks.get_position() - ejectStart;
+      stop();
+      ejecting = false;
+      stopping = true;
+      stopStartTime = now;
+      r.slowed[current] = hooks.get_actual_velocity();
+    }
+    // from the tick after, once the actuators task has had a chance to write the stop
+    if (stopping && now > stopStartTime && sim::world().motors[sim::port_index(HOOKS_PORT)].command_mv != 0) r.driven[current]++;
+    if (stopping && now - stopStartTime >= EJECT_STOP) {
+      r.slowed[current] -= hooks.get_actual_velocity();
+      done();
+      stopping = false;
+    }
+    pros::delay(10);
+  }
+}
+
+// opcontrol()'s intake, piston and lady brown code.  The callbacks are what it does to each
+template <typename Intake, typename Clamp, typename Piston, typename Ladybrown>
+void driver_loop(std::uint32_t start, Intake intake, Clamp clamp, Piston piston, Ladybrown ladybrown) {
+  bool isClamp = false, clampLatch = false;
+  bool isIntakePiston = false, intakePistonLatch = false;
+  while (pros::millis() - start < RUN_MS) {
+    const buttons b = script(pros::millis() - start);
+    intake(b.r1 ? 127 : b.r2 ? -127 : 0);
+    clamp(isClamp);
+    if (b.l2) {
+      if (!clampLatch) isClamp = !isClamp;
+      clampLatch = true;
+    } else {
+      clampLatch = false;
+    }
+    piston(isIntakePiston);
+    if (b.l1) {
+      if (!intakePistonLatch) isIntakePiston = !isIntakePiston;
+      intakePistonLatch = true;
+    } else {
+      intakePistonLatch = false;
+    }
+    if (b.up) ladybrown(1850);
+    pros::delay(10);
+  }
+}
+
+void finish(result& r) {
+  r.motor_writes = motor_writes();
+  r.adi_writes = adi_writes();
+  r.piston = sim::world().adi[0][PISTON_PORT - 'A'].value;
+  r.clamp = sim::world().adi[0][CLAMP_PORT - 'A'].value;
+  r.ladybrown_target = pros::Motor(LADYBROWN_PORT).get_target_position();
+}
+
+// Both tasks write the devices, like main.cpp did
+result direct() {
+  sim::world().reset();
+  result r;
+  sim::run(
+      [&] {
+        pros::Motor intakeLow(LOW_PORT), intakeHigh(HOOKS_PORT), ladybrown(LADYBROWN_PORT);
+        pros::adi::DigitalOut intakePiston(PISTON_PORT), mogoclamp(CLAMP_PORT);
+        const std::uint32_t start = pros::millis();
+        pros::Task sorting([&] {
+          sort_loop(start, intakeHigh, r, [&] { intakeHigh.move(127); }, [&] { intakeHigh.move(0); }, [] {});
+        });
+        driver_loop(
+            start,
+            [&](int speed) {
+              intakeLow.move(speed);
+              intakeHigh.move(speed);
+            },
+            [&](bool on) { mogoclamp.set_value(on); }, [&](bool on) { intakePiston.set_value(on); },
+            [&](double position) { ladybrown.move_absolute(position, 127); });
+        pros::delay(50);
+        finish(r);
+      },
+      RUN_MS + 1000);
+  sim::step_hooks_clear();
+  return r;
+}
+
+// Both tasks post to Actuators and a third writes them
+result arbitrated() {
+  sim::world().reset();
+  result r;
+  sim::run(
+      [&] {
+        pros::Motor intakeLow(LOW_PORT), intakeHigh(HOOKS_PORT), ladybrown(LADYBROWN_PORT);
+        pros::adi::DigitalOut intakePiston(PISTON_PORT), mogoclamp(CLAMP_PORT);
+        Actuator low("intakeLow", intakeLow), hooks("intakeHigh", intakeHigh), lb("ladybrown", ladybrown);
+        Actuator piston("intakePiston", intakePiston), clamp("mogoclamp", mogoclamp);
+        ActuatorArbiter actuators;
+        for (Actuator* a : {&low, &hooks, &lb, &piston, &clamp}) actuators.add(a);
+        const std::uint32_t start = pros::millis();
+        pros::Task resolver(
+            [&] {
+              std::uint32_t now = pros::millis();
+              while (true) {
+                actuators.resolve();
+                pros::Task::delay_until(&now, 10);
+              }
+            },
+            TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT, "actuators");
+        pros::Task sorting([&] {
+          sort_loop(start, intakeHigh, r, [&] { hooks.move(CommandSource::Sort, 127); },
+                    [&] { hooks.move(CommandSource::Sort, 0); }, [&] { hooks.release(CommandSource::Sort); });
+        });
+        driver_loop(
+            start,
+            [&](int speed) {
+              low.move(CommandSource::Driver, speed);
+              hooks.move(CommandSource::Driver, speed);
+            },
+            [&](bool on) { clamp.set(CommandSource::Driver, on); },
+            [&](bool on) { piston.set(CommandSource::Driver, on); },
+            [&](double position) { lb.moveAbsolute(CommandSource::Driver, position, 127); });
+        pros::delay(50);
+        finish(r);
+        for (int i = 0; i < actuators.count(); i++) {
+          const Actuator::Stats stats = actuators.get(i)->getStats();
+          std::printf("  %-12s requests %5u redundant %5u writes %3u\n", actuators.get(i)->getName(), stats.requests,
+                      stats.redundant, stats.writes);
+          r.requests += stats.requests;
+          r.redundant += stats.redundant;
+        }
+      },
+      RUN_MS + 1000);
+  sim::step_hooks_clear();
+  return r;
+}
+
+void print(const char* name, const result& r) {
+  std::printf("%-11s %12u %10u %8u %9u", name, r.motor_writes, r.adi_writes, r.requests, r.redundant);
+  for (int i = 0; i < EJECT_COUNT; i++) std::printf(" %3.0f %2d %3.0f", r.travel[i], r.driven[i], r.slowed[i]);
+  std::printf("\n");
+}
+
+// Which source wins, going by what the devices are sent
+int priorities() {
+  int failures = 0;
+  sim::world().reset();
+  pros::Motor motor(HOOKS_PORT);
+  pros::adi::DigitalOut out(PISTON_PORT);
+  Actuator hooks("hooks", motor), piston("piston", out);
+  auto sent = [&] { return std::lround(-sim::world().motors[sim::port_index(HOOKS_PORT)].command_mv * 127 / 12000); };
+  auto expect = [&](int owner, long speed) {
+    hooks.apply();
+    if (hooks.getOwner() != owner || sent() != speed) failures++;
+  };
+
+  expect(-1, 0);
+  hooks.move(CommandSource::Driver, 60);
+  expect(0, 60);
+  hooks.move(CommandSource::Auton, 100);
+  hooks.move(CommandSource::Driver, 127);
+  expect(1, 100);
+  hooks.move(CommandSource::Sort, 127);
+  expect(2, 127);
+  hooks.release(CommandSource::Sort);
+  expect(1, 100);
+  hooks.release(CommandSource::Auton);
+  expect(0, 127);
+  // nothing new, nothing written
+  const std::uint32_t writes = hooks.getStats().writes;
+  hooks.move(CommandSource::Driver, 127);
+  expect(0, 127);
+  if (hooks.getStats().writes != writes || hooks.getStats().redundant != 1) failures++;
+  hooks.release(CommandSource::Driver);
+  expect(-1, 0);
+  // a relative move is only made once, however many times it's posted before the motor moves
+  hooks.moveRelative(CommandSource::Driver, 200, -127);
+  hooks.apply();
+  hooks.moveRelative(CommandSource::Driver, 200, -127);
+  hooks.apply();
+  if (motor.get_target_position() != motor.get_position() + 200 || hooks.getStats().writes != writes + 2) failures++;
+
+  // a piston nobody commands stays where it was left
+  const sim::adi_state& adi = sim::world().adi[0][PISTON_PORT - 'A'];
+  piston.set(CommandSource::Driver, true);
+  piston.apply();
+  piston.release(CommandSource::Driver);
+  piston.apply();
+  if (adi.value != 1 || piston.getOwner() != -1 || piston.getStats().writes != 1) failures++;
+
+  std::printf("priorities %s\n", failures ? "wrong" : "right");
+  return failures;
+}
+
+// Two threads post as fast as they can while a third resolves.  Every position command is posted
+// with a velocity a tenth of it, so one applied half from one post and half from another shows up
+int torn() {
+  sim::world().reset();
+  const int PORT = 1;
+  pros::Motor motor(PORT);
+  Actuator actuator("torn", motor);
+  const sim::motor_state& m = sim::world().motors[sim::port_index(PORT)];
+  std::atomic<bool> stop = false;
+  std::atomic<std::uint32_t> driver_posts = 0, auton_posts = 0;
+  std::thread driver([&] {
+    for (int i = 0; !stop; i++, driver_posts++) {
+      actuator.move(CommandSource::Driver, i % 255 - 127);
+      if (i % 16 == 0) std::this_thread::yield();
+    }
+  });
+  std::thread auton([&] {
+    for (int i = 0; !stop; i++, auton_posts++) {
+      if (i % 7 == 0) actuator.release(CommandSource::Auton);
+      else actuator.moveAbsolute(CommandSource::Auton, (i % 600 + 1) * 10, i % 600 + 1);
+      if (i % 16 == 0) std::this_thread::yield();
+    }
+  });
+  int bad = 0;
+  // until both have posted plenty, however the host schedules the threads
+  const std::uint32_t POSTS = 200000;
+  int resolves = 0;
+  for (; driver_posts < POSTS || auton_posts < POSTS; resolves++) {
+    actuator.apply();
+    if (m.mode == sim::POSITION && std::fabs(m.target_deg - m.target_rpm * 10) > 1e-6) bad++;
+    if (m.mode == sim::VOLTAGE && std::fabs(m.command_mv) > 12000) bad++;
+    // on a single core the threads only take turns where they give way
+    std::this_thread::yield();
+  }
+  stop = true;
+  driver.join();
+  auton.join();
+  const Actuator::Stats stats = actuator.getStats();
+  const std::uint32_t posts = driver_posts + auton_posts;
+  std::printf("threads: %u posts, %d resolves, %u writes, %d torn, %u counted\n", posts, resolves, stats.writes, bad,
+              stats.requests);
+  return bad != 0 || stats.requests != posts || stats.writes < 1000;
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  std::printf("%-11s %12s %10s %8s %9s", "", "motor writes", "adi writes", "requests", "redundant");
+  for (int i = 0; i < EJECT_COUNT; i++) std::printf(" %10u ms", EJECTS[i]);
+  std::printf("\n");
+  const result old = direct();
+  print("direct", old);
+  const result arbiter = arbitrated();
+  print("arbitrated", arbiter);
+
+  // one post a loop per device is what direct() writes
+  const std::uint32_t old_writes = old.motor_writes + old.adi_writes;
+  const std::uint32_t new_writes = arbiter.motor_writes + arbiter.adi_writes;
+  std::printf("device writes %u -> %u, %.1f%%\n", old_writes, new_writes, 100.0 * new_writes / old_writes);
+  if (new_writes * 20 > old_writes) failures++;
+  if (arbiter.clamp != old.clamp || arbiter.piston != old.piston || arbiter.ladybrown_target != old.ladybrown_target)
+    failures++;
+  // the first eject is while the driver holds intake, which must not power the hooks through the stop
+  for (int i = 0; i < EJECT_COUNT; i++)
+    if (arbiter.travel[i] < EJECT_TRAVEL || arbiter.driven[i] > 0 || arbiter.slowed[i] < 50) failures++;
+  failures += priorities();
+  failures += torn();
+
+  std::printf(failures ? "arbiter check FAILED\n" : "arbiter check passed\n");
+  return failures ? 1 : 0;
+}
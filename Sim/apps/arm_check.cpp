@@ -0,0 +1,247 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Swings the EZ robot's lady brown from rest to the loading position, up to score, and back
+// down, first with the old lbPID{0.45, 0, 1.5} and its exit conditions, then with ArmController
+// as a trapezoid and as an S-curve.  Without gravity feedforward the old one sags off the
+// loading position and stops short of the others.  The controller has to end every move within
+// its settle error, overshoot no more than lbPID does, the trapezoid no slower than the old exits,
+// and its completions have to say which moves got there, including ones cut off by the next go_to().
+
+#include <cmath>
+#include <cstdio>
+
+#include "arm_controller.hpp"
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+#include "sim/arm.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/tuner.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// From EZ-Code-Odom: the load, score and down buttons
+const double TARGETS[] = {450, 2000, 0};
+const int MOVES = 3;
+// Feedback on top of the model's feedforward and the acceleration, same as EZ-Code-Odom's main.cpp
+const double KP = 0.45 * 12000 / 127, KD = 23;
+const double MAX_ACCELERATION = 20000;
+// degrees a move can overshoot past what lbPID's does
+const double OVERSHOOT_SLACK = 1;
+// Keeps watching after a move is over, for where the arm ends up
+const std::uint32_t SETTLE_WINDOW = 300;
+
+struct move_result {
+  double ms = 0;         // until the move said it was over
+  double overshoot = 0;  // past the target, in motor degrees
+  double error = 0;      // off the target at the end of the settle window
+  bool reached = false;
+};
+
+// Tracks the worst overshoot of one move
+struct watcher {
+  double from, to, overshoot = 0;
+  void sample(double position) {
+    const double past = (to >= from ? 1 : -1) * (position - to);
+    if (past > overshoot) overshoot = past;
+  }
+};
+
+void print(const char* name, const move_result* r) {
+  double total = 0;
+  std::printf("%-18s", name);
+  for (int i = 0; i < MOVES; i++) {
+    std::printf(" %6.0f %6.1f %6.1f %-3s", r[i].ms, r[i].overshoot, r[i].error, r[i].reached ? "yes" : "no");
+    total += r[i].ms;
+  }
+  std::printf(" %7.0f\n", total);
+}
+
+double total_ms(const move_result* r) {
+  double total = 0;
+  for (int i = 0; i < MOVES; i++) total += r[i].ms;
+  return total;
+}
+
+// The old lady brown: ez::PID stepped every 10 ms into ladybrown.move(), done on an exit
+void legacy(move_result* results) {
+  sim::world().reset();
+  sim::ArmModel arm(sim::ez_arm_config());
+  arm.attach();
+  sim::run(
+      [&] {
+        pros::Motor ladybrown(3);
+        ladybrown.tare_position();
+        sim::BatchPID pid(1);
+        pid.gains_set(0, {0.45, 0, 1.5, 0});
+        const sim::pid_exit_conditions exit{80, 50, 300, 150, 500};
+        double from = 0;
+        for (int i = 0; i < MOVES; i++) {
+          const double target = TARGETS[i];
+          watcher w{from, target};
+          pid.exit[0] = sim::EXIT_RUNNING;
+          pid.small_timer[0] = pid.big_timer[0] = pid.velocity_timer[0] = 0;
+          const std::uint32_t start = pros::millis();
+          std::uint32_t done = 0;
+          while (pros::millis() - done < SETTLE_WINDOW || done == 0) {
+            const double position = ladybrown.get_position();
+            pid.compute(&target, &position);
+            ladybrown.move(pid.output[0]);
+            w.sample(position);
+            if (done == 0) {
+              pid.exit_update(exit);
+              if (pid.exit[0] != sim::EXIT_RUNNING) {
+                done = pros::millis();
+                results[i].ms = done - start;
+                results[i].reached = pid.exit[0] == sim::EXIT_SMALL || pid.exit[0] == sim::EXIT_BIG;
+              }
+            }
+            pros::delay(10);
+          }
+          results[i].overshoot = w.overshoot;
+          results[i].error = std::fabs(ladybrown.get_position() - target);
+          from = target;
+        }
+      },
+      20000);
+  sim::step_hooks_clear();
+}
+
+void setup(ArmController& lb, double max_jerk) {
+  const sim::arm_config config = sim::ez_arm_config();
+  const sim::arm_feedforward_constants ff = sim::arm_feedforward(config);
+  lb.kg = ff.kg;
+  lb.ks = ff.ks;
+  lb.kv = ff.kv;
+  lb.ka = ff.ka;
+  lb.level = config.level;
+  lb.ratio = config.ratio;
+  lb.kp = KP;
+  lb.kd = KD;
+  lb.max_acceleration = MAX_ACCELERATION;
+  lb.max_jerk = max_jerk;
+}
+
+// The same moves with ArmController, one go_to() after another
+void profiled(double max_jerk, move_result* results) {
+  sim::world().reset();
+  sim::ArmModel arm(sim::ez_arm_config());
+  arm.attach();
+  sim::run(
+      [&] {
+        pros::Motor ladybrown(3);
+        ladybrown.tare_position();
+        ArmController lb(ladybrown);
+        setup(lb, max_jerk);
+        watcher w{0, 0};
+        pros::Task control([&] {
+          std::uint32_t now = pros::millis();
+          while (true) {
+            lb.update();
+            w.sample(ladybrown.get_position());
+            pros::Task::delay_until(&now, 10);
+          }
+        });
+        for (int i = 0; i < MOVES; i++) {
+          w = {w.to, TARGETS[i]};
+          const std::uint32_t start = pros::millis();
+          ArmController::completion move = lb.go_to(TARGETS[i]);
+          results[i].reached = move.wait();
+          results[i].ms = pros::millis() - start;
+          pros::delay(SETTLE_WINDOW);
+          results[i].overshoot = w.overshoot;
+          results[i].error = std::fabs(ladybrown.get_position() - TARGETS[i]);
+        }
+      },
+      20000);
+  sim::step_hooks_clear();
+}
+
+// go_to()s that replace each other, the cut off ones have to finish not reached, and a wait with
+// a timeout on a move that can't finish has to return
+int completions() {
+  int failures = 0;
+  sim::world().reset();
+  sim::ArmModel arm(sim::ez_arm_config());
+  arm.attach();
+  sim::run(
+      [&] {
+        pros::Motor ladybrown(3);
+        ladybrown.tare_position();
+        ArmController lb(ladybrown);
+        setup(lb, 0);
+        pros::Task control([&] {
+          std::uint32_t now = pros::millis();
+          while (true) {
+            lb.update();
+            pros::Task::delay_until(&now, 10);
+          }
+        });
+        // up to score, changed to loading halfway
+        ArmController::completion score = lb.go_to(2000);
+        pros::delay(600);
+        if (score.done()) failures++;
+        ArmController::completion load = lb.go_to(450);
+        if (!load.wait() || !score.done() || score.reached()) failures++;
+        if (std::fabs(ladybrown.get_position() - 450) > lb.settle_error) failures++;
+        // two in the same tick, only the second runs
+        ArmController::completion skipped = lb.go_to(2600);
+        ArmController::completion down = lb.go_to(0);
+        if (!down.wait() || skipped.reached() || !skipped.done()) failures++;
+        if (arm.position() > 2 * lb.settle_error) failures++;
+        // a finished move stays reached
+        if (!load.reached()) failures++;
+        // with nothing running update() a move never ends, so wait has to give up on time
+        control.suspend();
+        ArmController::completion stuck = lb.go_to(2000);
+        const std::uint32_t waited = pros::millis();
+        const bool stuck_reached = stuck.wait(200);
+        const std::uint32_t waited_ms = pros::millis() - waited;
+        if (stuck_reached || waited_ms > 210 || stuck.done()) failures++;
+        control.resume();
+        if (!stuck.wait()) failures++;
+        std::printf("completions: cut off %s, skipped %s, load %s, down %s, stalled wait gave up after %u ms\n",
+                    score.reached() ? "reached" : "not reached", skipped.reached() ? "reached" : "not reached",
+                    load.reached() ? "reached" : "not reached", down.reached() ? "reached" : "not reached", waited_ms);
+      },
+      10000);
+  sim::step_hooks_clear();
+  return failures;
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  std::printf("%-18s", "");
+  for (int i = 0; i < MOVES; i++) std::printf("    to %-4.0f %12s", TARGETS[i], "");
+  std::printf("\n%-18s", "");
+  for (int i = 0; i < MOVES; i++) std::printf(" %6s %6s %6s %-3s", "ms", "over", "error", "ok");
+  std::printf(" %7s\n", "total");
+
+  move_result old[MOVES], trapezoid[MOVES], s_curve[MOVES];
+  legacy(old);
+  print("lbPID", old);
+  profiled(0, trapezoid);
+  print("trapezoid", trapezoid);
+  profiled(100000, s_curve);
+  print("s-curve", s_curve);
+
+  pros::Motor unused(3);
+  const ArmController defaults(unused);
+  for (const move_result* r : {trapezoid, s_curve}) {
+    for (int i = 0; i < MOVES; i++)
+      if (!r[i].reached || r[i].overshoot > old[i].overshoot + OVERSHOOT_SLACK || r[i].error > defaults.settle_error) failures++;
+  }
+  // main.cpp runs the trapezoid, so it has to be at least as quick as lbPID, even though lbPID's
+  // exits call it done 50 degrees off
+  if (total_ms(trapezoid) > total_ms(old)) failures++;
+  failures += completions();
+
+  std::printf(failures ? "arm check FAILED\n" : "arm check passed\n");
+  return failures ? 1 : 0;
+}
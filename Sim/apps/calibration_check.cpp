@@ -0,0 +1,182 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Runs calibrate_odom()'s drive and spin pattern on the EZ robot's drive model, built with
+// trackers and an imu that don't match what the code assumes, and checks OdomCalibration finds
+// what they really are.  The model has no walls to square against, so squaring up is stood in
+// for by turning to the model's real heading and backing up to where the leg started.
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+#include "odom_calibration.hpp"
+#include "pros/distance.hpp"
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/field.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// What the code thinks, from EZ-Code-Odom/src/main.cpp
+const double NOMINAL_DIAMETER = 2.0;
+
+// What the robot really has
+const double VERTICAL_OFFSET = 0.5;
+const double HORIZONTAL_OFFSET = 5.6;
+const double DIAMETER = 2.04;
+const double IMU_SCALE = 1.015;  // the imu reads this much too far
+
+const double START_Y = 8;
+const int REPEATS = 4;
+const int TURNS = 2;
+const double LEG = 24;
+
+double wrap(double degrees) { return std::remainder(degrees, 360.0); }
+
+struct check {
+  const char* name;
+  OdomCalibration::estimate found;
+  double truth;
+  double tolerance;  // on top of the confidence interval
+};
+
+}  // namespace
+
+int main() {
+  sim::world().reset();
+  sim::world().sd_card_installed = true;
+  sim::drive_config config = sim::ez_drive_config();
+  for (sim::tracker_config& t : config.trackers) {
+    t.diameter = DIAMETER;
+    if (t.horizontal)
+      t.y_offset = HORIZONTAL_OFFSET;
+    else
+      t.x_offset = VERTICAL_OFFSET;
+  }
+  sim::DriveModel model(config);
+  model.attach();
+  sim::world().imus[sim::port_index(6)].scale = IMU_SCALE;
+  sim::field_map field = sim::skills_field(START_Y);
+  sim::RangeModel ranges(model, field);
+  ranges.sensor_add(14, 0, -7, 180);  // back
+  ranges.attach();
+
+  auto calibration = std::make_unique<OdomCalibration>(NOMINAL_DIAMETER, NOMINAL_DIAMETER);
+  sim::run(
+      [&] {
+        pros::MotorGroup left({18, -19, -20}, pros::MotorGearset::blue);
+        pros::MotorGroup right({-8, 9, 10}, pros::MotorGearset::blue);
+        pros::Imu imu(6);
+        pros::Rotation vertical(4);
+        pros::Rotation horizontal(5);
+        pros::Distance back(14);
+        const double inches = M_PI * NOMINAL_DIAMETER / 36000.0;
+        auto range = [&] {
+          double total = 0;
+          for (int i = 0; i < 10; i++) {
+            total += back.get();
+            pros::delay(40);
+          }
+          return total / 10 / 25.4;
+        };
+        auto stop = [&] {
+          left.move_voltage(0);
+          right.move_voltage(0);
+          while (std::fabs(model.forward_velocity()) > 0.001 || std::fabs(model.angular_velocity()) > 0.01) pros::delay(10);
+          pros::delay(100);
+        };
+        auto turn_to = [&](double theta) {
+          std::uint32_t settled = 0;
+          while (settled < 200) {
+            double error = theta - model.theta();
+            double mv = std::fmax(-6000, std::fmin(6000, error * 300));
+            left.move_voltage(mv);
+            right.move_voltage(-mv);
+            settled = std::fabs(error) < 0.02 ? settled + 10 : 0;
+            pros::delay(10);
+          }
+          stop();
+        };
+
+        pros::delay(100);  // let the distance sensor read something
+        double squared = imu.get_rotation();
+        for (int i = 0; i < REPEATS; i++) {
+          // drive out from the wall
+          double y = model.y();
+          double r0 = range(), v0 = vertical.get_position() * inches, t0 = imu.get_rotation();
+          while (model.y() < y + LEG) {
+            left.move_voltage(6000);
+            right.move_voltage(6000);
+            pros::delay(10);
+          }
+          stop();
+          calibration->leg_add(vertical.get_position() * inches - v0, imu.get_rotation() - t0, range() - r0);
+
+          // spin, alternating directions
+          int direction = i % 2 ? -1 : 1;
+          double target = imu.get_rotation() + direction * 360.0 * TURNS;
+          double v = vertical.get_position() * inches, h = horizontal.get_position() * inches, t = imu.get_rotation();
+          while ((target - t) * direction > 20) {
+            left.move_voltage(6000 * direction);
+            right.move_voltage(-6000 * direction);
+            pros::delay(10);
+            double v1 = vertical.get_position() * inches, h1 = horizontal.get_position() * inches, t1 = imu.get_rotation();
+            calibration->spin_add(v1 - v, h1 - h, t1 - t);
+            v = v1, h = h1, t = t1;
+          }
+          stop();
+
+          // square back up on the wall
+          turn_to(model.theta() - wrap(model.theta()));
+          std::uint32_t settled = 0;
+          while (settled < 200) {
+            double mv = std::fmax(-6000, std::fmin(6000, (y - model.y()) * 800));
+            left.move_voltage(mv);
+            right.move_voltage(mv);
+            settled = std::fabs(y - model.y()) < 0.1 ? settled + 10 : 0;
+            pros::delay(10);
+          }
+          stop();
+          turn_to(model.theta() - wrap(model.theta()));
+          calibration->heading_add(imu.get_rotation() - squared);
+          squared = imu.get_rotation();
+        }
+      },
+      120000);
+  sim::step_hooks_clear();
+
+  OdomCalibration::result r = calibration->solve();
+  std::printf("%d spin samples, %d legs, %d headings\n", r.spins, r.legs, r.headings);
+  const check checks[] = {
+      {"imu scale", r.imu_scale, 1.0 / IMU_SCALE, 0.002},
+      {"vertical offset", r.vertical_offset, VERTICAL_OFFSET, 0.05},
+      {"horizontal offset", r.horizontal_offset, HORIZONTAL_OFFSET, 0.05},
+      {"vertical diameter", r.vertical_diameter, DIAMETER, 0.01},
+      {"horizontal diameter", r.horizontal_diameter, DIAMETER, 0.01},
+  };
+  int failures = r.valid ? 0 : 1;
+  std::printf("%-20s %10s %10s %10s\n", "", "found", "+/-", "truth");
+  for (const check& c : checks) {
+    bool ok = std::fabs(c.found.value - c.truth) <= c.found.plus_minus + c.tolerance;
+    std::printf("%-20s %10.4f %10.4f %10.4f%s\n", c.name, c.found.value, c.found.plus_minus, c.truth, ok ? "" : "  <-- off");
+    if (!ok) failures++;
+  }
+
+  OdomCalibration::result loaded;
+  if (!OdomCalibration::save(r, "/usd/calibration_check.txt") || !OdomCalibration::load(loaded, "/usd/calibration_check.txt") ||
+      std::fabs(loaded.vertical_diameter.value - r.vertical_diameter.value) > 1e-3) {
+    std::printf("save and load didn't round trip\n");
+    failures++;
+  }
+  std::printf(failures ? "calibration check FAILED\n" : "calibration check passed\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Runs a 15 second autonomous against the simulated devices and checks that every device
+// answered the way the real one would.  Prints virtual time next to wall time.
+
+#include <cmath>
+#include <atomic>
+#include <cstdio>
+
+#include "api.h"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+  if (!ok) failures++;
+  std::printf("  %-48s %s\n", what, ok ? "ok" : "FAILED");
+}
+
+// Same devices the EZ robot uses
+pros::MotorGroup left_drive({18, -19, -20}, pros::MotorGearset::blue);
+pros::MotorGroup right_drive({-8, 9, 10}, pros::MotorGearset::blue);
+pros::Motor intake(-11);
+pros::Imu imu(6);
+pros::Rotation tracker(-5);
+pros::Optical colorsort(1);
+pros::adi::DigitalOut clamp('B');
+
+std::atomic<int> intake_ticks = 0;
+
+void intake_task() {
+  while (true) {
+    intake.move(127);
+    intake_ticks++;
+    pros::delay(10);
+  }
+}
+
+void auton() {
+  imu.reset(true);
+  check(!imu.is_calibrating() && pros::millis() >= 2000, "imu calibrates for 2 seconds");
+
+  pros::Task intake_runner(intake_task);
+
+  // Drive forward for a second
+  left_drive.move_velocity(600);
+  right_drive.move_velocity(600);
+  pros::delay(1000);
+  check(std::fabs(left_drive.get_actual_velocity() - 600) < 5, "drive reaches commanded velocity");
+  check(left_drive.get_position() > 0 && right_drive.get_position() > 0, "reversed motors read forward");
+  check(std::fabs(intake.get_actual_velocity() - 200) < 5, "intake task runs alongside auton");
+
+  // Turn in place while the imu follows
+  sim::world().imus[5].rotation_deg = 90.0;
+  check(std::fabs(imu.get_heading() - 90.0) < 1e-9, "imu heading follows world");
+  imu.set_heading(0);
+  check(std::fabs(imu.get_heading()) < 1e-9, "imu set_heading offsets");
+
+  // Tracker on a negative port reads backwards
+  sim::world().rotations[4].position_cdeg = 3600.0;
+  check(tracker.get_position() == -3600, "reversed rotation sensor");
+
+  // A red ring in front of the optical sensor
+  sim::world().opticals[0].hue = 10.0;
+  sim::world().opticals[0].proximity = 200;
+  check(colorsort.get_hue() == 10.0 && colorsort.get_proximity() == 200, "optical sensor sees ring");
+
+  clamp.set_value(true);
+  check(sim::world().adi[0][1].value == 1, "piston on port B fires");
+
+  // Hold position then sit out the rest of the 15 seconds
+  left_drive.move_absolute(0, 600);
+  right_drive.move_absolute(0, 600);
+  pros::Mutex lock;
+  lock.take();
+  check(!lock.take(50), "mutex times out while held");
+  lock.give();
+  pros::delay(15000 - pros::millis());
+  check(std::fabs(left_drive.get_position()) < 5, "motors return to target");
+  intake_runner.remove();
+}
+
+}  // namespace
+
+int main() {
+  std::printf("device_check\n");
+  sim::run_result result = sim::run(auton, 15000);
+  check(result.finished, "auton finished before the limit");
+  check(intake_ticks >= 1000, "intake task ran every 10ms");
+  std::printf("virtual %u ms in %.1f ms wall time, %llu context switches\n", result.virtual_ms, result.wall_ms,
+              (unsigned long long)sim::context_switches());
+  return failures == 0 ? 0 : 1;
+}
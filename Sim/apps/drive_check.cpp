@@ -0,0 +1,154 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Drives both robot models through the same open loop test so the physics can be compared
+// against the real robots, and checks that two identical runs end in the identical place.
+
+#include <cmath>
+#include <cstdio>
+
+#include "api.h"
+#include "sim/drive.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/tuner.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// Same tick EZ-Template runs its drive at
+const int DELAY_TIME = 10;
+
+struct drive_result {
+  double top_speed = 0;      // in/s
+  int time_to_90 = 0;        // ms
+  double stop_distance = 0;  // in, after switching to brake
+  double turn_rate = 0;      // deg/s
+  double tracker_error = 0;  // in, vertical tracker against distance driven
+  double x = 0, y = 0, theta = 0;
+};
+
+void set_drive(const sim::drive_config& c, int left, int right) {
+  for (int port : c.left_ports) pros::Motor(port).move(left);
+  for (int port : c.right_ports) pros::Motor(port).move(right);
+}
+
+drive_result test(const sim::drive_config& config) {
+  sim::world().reset();
+  sim::DriveModel drive(config);
+  drive.attach();
+  drive_result r;
+
+  sim::run(
+      [&] {
+        for (int port : config.left_ports) pros::Motor(port).set_brake_mode(pros::E_MOTOR_BRAKE_BRAKE);
+        for (int port : config.right_ports) pros::Motor(port).set_brake_mode(pros::E_MOTOR_BRAKE_BRAKE);
+
+        // Full power forward
+        double free_speed = config.wheel_rpm * M_PI * config.wheel_diameter / 60.0;
+        for (int t = 0; t < 1500; t += DELAY_TIME) {
+          set_drive(config, 127, 127);
+          if (r.time_to_90 == 0 && drive.forward_velocity() > 0.9 * free_speed) r.time_to_90 = t;
+          pros::delay(DELAY_TIME);
+        }
+        r.top_speed = drive.forward_velocity();
+
+        // Brake to a stop
+        double start = drive.y();
+        set_drive(config, 0, 0);
+        pros::delay(1500);
+        r.stop_distance = drive.y() - start;
+
+        // Vertical tracker, read through pros::Rotation the way the robot code does
+        for (const sim::tracker_config& t : config.trackers) {
+          if (t.horizontal) continue;
+          double travel = pros::Rotation(t.port).get_position() / 36000.0 * M_PI * t.diameter;
+          r.tracker_error = travel - drive.y();
+        }
+
+        // Spin in place
+        for (int t = 0; t < 1500; t += DELAY_TIME) {
+          set_drive(config, 127, -127);
+          pros::delay(DELAY_TIME);
+        }
+        r.turn_rate = drive.angular_velocity();
+
+        // A gentle arc
+        for (int t = 0; t < 2000; t += DELAY_TIME) {
+          set_drive(config, 127, 60);
+          pros::delay(DELAY_TIME);
+        }
+        set_drive(config, 0, 0);
+        pros::delay(1000);
+      },
+      15000);
+
+  r.x = drive.x();
+  r.y = drive.y();
+  r.theta = drive.theta();
+  sim::step_hooks_clear();
+  return r;
+}
+
+// Runs the same open loop commands through DriveModel and the tuner's DriveBatch, and returns
+// the largest difference in wheel travel (inches) and heading (degrees)
+double batch_difference(const sim::drive_config& config) {
+  const int phases[][3] = {{1000, 12000, 12000}, {800, 12000, -12000}, {600, 6000, 12000}, {600, 0, 0}};
+
+  sim::world().reset();
+  sim::DriveModel drive(config);
+  drive.attach();
+  sim::DriveBatch batch(config, 1);
+  double worst = 0.0;
+
+  sim::run(
+      [&] {
+        for (int port : config.left_ports) pros::Motor(port).set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
+        for (int port : config.right_ports) pros::Motor(port).set_brake_mode(pros::E_MOTOR_BRAKE_HOLD);
+        pros::Motor left(config.left_ports[0]);
+        double in_per_deg = config.wheel_rpm / sim::gearset_free_rpm(config.gearset) * M_PI * config.wheel_diameter / 360.0;
+        for (const auto& phase : phases) {
+          for (int t = 0; t < phase[0]; t += DELAY_TIME) {
+            for (int port : config.left_ports) pros::Motor(port).move_voltage(phase[1]);
+            for (int port : config.right_ports) pros::Motor(port).move_voltage(phase[2]);
+            double l = phase[1], r = phase[2];
+            for (int i = 0; i < DELAY_TIME; i++) batch.step(&l, &r, sim::STEP_TIME);
+            pros::delay(DELAY_TIME);
+            double travel = left.get_position() * (config.left_ports[0] < 0 ? -1 : 1) * in_per_deg;
+            worst = std::max(worst, std::fabs(travel - batch.left_in[0]));
+            worst = std::max(worst, std::fabs(drive.theta() - batch.heading[0]));
+          }
+        }
+      },
+      15000);
+  sim::step_hooks_clear();
+  return worst;
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  struct {
+    const char* name;
+    sim::drive_config config;
+  } robots[] = {{"ez", sim::ez_drive_config()}, {"lemlib", sim::lemlib_drive_config()}};
+
+  std::printf("%-8s %10s %10s %10s %10s %10s %24s\n", "robot", "top in/s", "90% ms", "stop in", "turn dps", "tracker in",
+              "final pose");
+  for (auto& robot : robots) {
+    drive_result a = test(robot.config);
+    drive_result b = test(robot.config);
+    bool same = a.x == b.x && a.y == b.y && a.theta == b.theta;
+    if (!same || std::fabs(a.tracker_error) > 0.05) failures++;
+    std::printf("%-8s %10.1f %10d %10.2f %10.1f %10.3f %8.2f %7.2f %7.1f %s\n", robot.name, a.top_speed, a.time_to_90,
+                a.stop_distance, a.turn_rate, a.tracker_error, a.x, a.y, a.theta, same ? "deterministic" : "NOT DETERMINISTIC");
+  }
+
+  double difference = batch_difference(sim::ez_drive_config());
+  if (difference > 0.5) failures++;
+  std::printf("tuner batch model differs by at most %.3f in / deg\n", difference);
+  return failures == 0 ? 0 : 1;
+}
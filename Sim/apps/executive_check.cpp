@@ -0,0 +1,172 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Runs a sensor read, a controller and a screen update, each taking a little time, the way
+// EZ-Code-Odom's main.cpp used to, as a task each sleeping pros::delay(10), and then from one
+// ControlExecutive.  Measures how far apart the reads are and how long after a read the
+// controller acts on it.  The executive has to keep both fixed, run the updates in order, and
+// count and recover from an update that runs long, and a LoopTimer around the controller has to
+// see the same gap the reads do.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "control_executive.hpp"
+#include "loop_timer.hpp"
+#include "pros/rtos.hpp"
+#include "sim/scheduler.hpp"
+
+namespace {
+
+const std::uint32_t RUN_MS = 5000;
+// virtual ms each update takes, with pros::delay standing in for the work
+const std::uint32_t READ_MS = 1, CONTROL_MS = 2, SCREEN_MS = 3;
+
+struct result {
+  double period_min = 1e9, period_max = 0;  // ms between reads
+  double phase_min = 1e9, phase_max = 0;    // ms from a read to the controller acting on it
+  int irregular = 0;                        // reads that weren't 10 ms after the last
+  bool in_order = true;
+};
+
+struct recorder {
+  std::vector<std::uint32_t> reads, controls;
+  std::uint32_t last_read = 0;
+  bool in_order = true;
+  int expected = 0;  // 0 read, 1 control, for the executive
+
+  void read() {
+    pros::delay(READ_MS);
+    last_read = pros::millis();
+    reads.push_back(last_read);
+  }
+  void control() {
+    pros::delay(CONTROL_MS);
+    controls.push_back(pros::millis() - last_read);
+  }
+
+  result summarize() const {
+    result r;
+    for (std::size_t i = 1; i < reads.size(); i++) {
+      const double p = reads[i] - reads[i - 1];
+      r.period_min = std::fmin(r.period_min, p);
+      r.period_max = std::fmax(r.period_max, p);
+      if (p != 10) r.irregular++;
+    }
+    for (std::uint32_t phase : controls) {
+      r.phase_min = std::fmin(r.phase_min, phase);
+      r.phase_max = std::fmax(r.phase_max, phase);
+    }
+    r.in_order = in_order;
+    return r;
+  }
+};
+
+result tasks() {
+  recorder rec;
+  sim::run(
+      [&] {
+        pros::Task read([&] {
+          while (true) {
+            rec.read();
+            pros::delay(10);
+          }
+        });
+        pros::Task control([&] {
+          while (true) {
+            rec.control();
+            pros::delay(10);
+          }
+        });
+        pros::Task screen([&] {
+          while (true) {
+            pros::delay(SCREEN_MS);
+            pros::delay(10);
+          }
+        });
+        pros::delay(RUN_MS);
+      },
+      RUN_MS + 100);
+  return rec.summarize();
+}
+
+result executive(ControlExecutive& exec, LoopTimer& timer, std::uint32_t overrun_tick) {
+  recorder rec;
+  sim::run(
+      [&] {
+        exec.add("read", [&] {
+          rec.in_order &= rec.expected == 0;
+          rec.expected = 1;
+          rec.read();
+        });
+        timer.start();
+        exec.add("control", [&] {
+          timer.begin();
+          rec.in_order &= rec.expected == 1;
+          rec.expected = 0;
+          rec.control();
+          // one tick where the controller gets stuck
+          if (exec.ticks == overrun_tick) pros::delay(25);
+          timer.end();
+        }, 1, CONTROL_MS * 1000 + 500);
+        exec.add("screen", [&] { pros::delay(SCREEN_MS); }, 5);
+        exec.start();
+        pros::delay(RUN_MS);
+      },
+      RUN_MS + 100);
+  return rec.summarize();
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  std::printf("%-24s %16s %22s\n", "", "read period ms", "read to control ms");
+  auto print = [](const char* name, const result& r) {
+    std::printf("%-24s %7.0f to %-5.0f %12.0f to %-5.0f\n", name, r.period_min, r.period_max, r.phase_min, r.phase_max);
+  };
+
+  const result legacy = tasks();
+  print("a task each", legacy);
+
+  ControlExecutive steady;
+  LoopTimer steady_timer("steady", 10);
+  const result fixed = executive(steady, steady_timer, 0xffffffff);
+  print("executive", fixed);
+  if (fixed.period_min != 10 || fixed.period_max != 10 || fixed.phase_min != fixed.phase_max || !fixed.in_order) failures++;
+  if (steady.overruns != 0 || steady.skipped != 0) failures++;
+
+  ControlExecutive stuck;
+  LoopTimer stuck_timer("stuck", 10);
+  const result late = executive(stuck, stuck_timer, 100);
+  print("executive, one overrun", late);
+  std::printf("\n%-10s %6s %8s %8s %8s %9s\n", "update", "runs", "mean us", "worst us", "last us", "overruns");
+  for (const ControlExecutive::timing& t : stuck.timings())
+    std::printf("%-10s %6u %8.0f %8u %8u %9u\n", t.name.c_str(), t.runs, t.mean_us(), t.worst_us, t.last_us, t.overruns);
+  std::printf("%u ticks, %u overran, %u skipped, worst %u us\n", stuck.ticks, stuck.overruns, stuck.skipped, stuck.worst_tick_us);
+  const std::vector<ControlExecutive::timing>& times = stuck.timings();
+  // stuck 31 ms from the start of the tick, the starts 10 and 20 ms in are dropped and the 30 ms
+  // one runs late
+  if (times[1].overruns != 1 || times[0].overruns != 0 || stuck.overruns != 1 || stuck.skipped != 2) failures++;
+  if (times[2].runs * 5 < stuck.ticks || times[2].runs * 5 > stuck.ticks + 5) failures++;
+  // one long gap, and back to the period after it
+  if (late.irregular != 1 || late.period_max > 31 || !late.in_order) failures++;
+
+  std::printf("\n%-10s %6s %6s %6s %6s %7s %7s\n", "timer", "passes", "mean", "max", "late", "misses", "busy");
+  for (const LoopTimer* timer : {&steady_timer, &stuck_timer}) {
+    const LoopTimer::stats s = timer->stats_get();
+    std::printf("%-10s %6u %6.2f %6u %6u %7u %6.1f%%\n", timer->name_get(), s.passes, s.period_mean, s.period_max, s.late_max,
+                s.misses, s.busy_percent);
+  }
+  // the controller's timer sees the executive's 10 ms, and the stuck tick as its only miss
+  const LoopTimer::stats even = steady_timer.stats_get(), gap = stuck_timer.stats_get();
+  if (even.misses != 0 || even.period_max != 10 || even.passes + 1 != steady.timings()[1].runs) failures++;
+  if (gap.misses != 1 || gap.period_max != (std::uint32_t)late.period_max) failures++;
+
+  std::printf(failures ? "executive check FAILED\n" : "executive check passed\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Characterizes the EZ robot's drive model with feedforward_characterize() and checks the
+// constants against what the model's physics say they are, then drives the same distances with
+// ProfiledDrive on those constants and with EZ's own drive PID from default_constants(), run
+// through the PID tuner's copy of ez::PID, and compares how long each takes to settle.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "feedforward.hpp"
+#include "pros/imu.hpp"
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/tuner.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const double TARGETS[] = {6, 12, 24, 48, -24};
+// EZ's ez::Drive chassis(..., 2.75, 450) on blue motors
+const double INCHES_PER_REV = M_PI * 2.75 * 450.0 / 600.0;
+
+std::vector<pros::Motor> motors(std::initializer_list<int> ports) {
+  std::vector<pros::Motor> out;
+  for (int port : ports) out.emplace_back(port, pros::MotorGearset::blue);
+  return out;
+}
+
+double average_position(std::vector<pros::Motor>& side) {
+  double total = 0;
+  for (pros::Motor& m : side) total += m.get_position();
+  return total / side.size();
+}
+
+struct check {
+  const char* name;
+  double found, truth, tolerance;  // tolerance as a fraction of truth
+};
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  const sim::drive_config config = sim::ez_drive_config();
+
+  // Characterize
+  sim::world().reset();
+  sim::DriveModel model(config);
+  model.attach();
+  Feedforward ff;
+  FeedforwardFit fit;
+  std::uint32_t took = 0;
+  sim::run(
+      [&] {
+        std::vector<pros::Motor> left = motors({18, -19, -20});
+        std::vector<pros::Motor> right = motors({-8, 9, 10});
+        ff = feedforward_characterize(left, right, INCHES_PER_REV, &fit);
+        took = pros::millis();
+      },
+      60000);
+  sim::step_hooks_clear();
+
+  const sim::feedforward_constants truth = sim::drive_feedforward(config);
+  std::printf("characterized in %.1f s, %d samples, r^2 %.5f, ended %.1f in from the start\n", took / 1000.0, fit.samples(),
+              fit.r_squared(ff), model.y());
+  const check checks[] = {{"ks mV", ff.ks, truth.ks, 0.05}, {"kv mV per in/s", ff.kv, truth.kv, 0.02}, {"ka mV per in/s^2", ff.ka, truth.ka, 0.05}};
+  std::printf("%-18s %10s %10s\n", "", "found", "model");
+  for (const check& c : checks) {
+    bool ok = std::fabs(c.found - c.truth) <= c.tolerance * std::fabs(c.truth);
+    std::printf("%-18s %10.3f %10.3f%s\n", c.name, c.found, c.truth, ok ? "" : "  <-- off");
+    if (!ok) failures++;
+  }
+  if (fit.r_squared(ff) < 0.99) failures++;
+
+  // Drive with the constants it found
+  std::printf("\n%-8s %24s %24s\n", "", "EZ drive PID", "ProfiledDrive");
+  std::printf("%-8s %12s %11s %12s %11s %12s\n", "target", "settle", "overshoot", "settle", "overshoot", "off profile");
+  double profiled_total = 0, pid_total = 0;
+  for (double target : TARGETS) {
+    sim::world().reset();
+    sim::DriveModel drive(config);
+    drive.attach();
+    double settle = 0, overshoot = 0, worst = 0;
+    bool done = false;
+    sim::run(
+        [&] {
+          std::vector<pros::Motor> left = motors({18, -19, -20});
+          std::vector<pros::Motor> right = motors({-8, 9, 10});
+          pros::Imu imu(6);
+          ProfiledDrive profiled([&] { return (average_position(left) + average_position(right)) / 2 / 360.0 * INCHES_PER_REV; },
+                                 [&] { return imu.get_rotation(); },
+                                 [&](double left_mv, double right_mv) {
+                                   for (pros::Motor& m : left) m.move_voltage(left_mv);
+                                   for (pros::Motor& m : right) m.move_voltage(right_mv);
+                                 });
+          profiled.feedforward = ff;
+          pros::Task watch([&] {
+            while (!done) {
+              double past = (drive.y() - target) * (target < 0 ? -1 : 1);
+              overshoot = std::fmax(overshoot, past);
+              pros::delay(1);
+            }
+          });
+          const std::uint32_t start = pros::millis();
+          if (!profiled.drive(target, 4000)) failures++;
+          settle = pros::millis() - start;
+          worst = profiled.worst_error;
+          pros::delay(300);  // anything after it says it's done counts as overshoot too
+          done = true;
+          pros::delay(10);
+        },
+        10000);
+    sim::step_hooks_clear();
+
+    sim::tune_setup setup;
+    setup.motion = sim::MOTION_DRIVE;
+    setup.drive = config;
+    setup.targets = {target};
+    setup.max_speed = 110;  // DRIVE_SPEED
+    setup.exit = {90, 1, 250, 3, 500};
+    setup.heading = {14, 0, 20};
+    sim::tune_result ez = sim::tune(setup, {{24, 0.05, 220}}, 1)[0];
+
+    std::printf("%5.0f in %9.0f ms %8.2f in %9.0f ms %8.2f in %9.2f in\n", target, ez.settle_ms, ez.overshoot, settle, overshoot,
+                worst);
+    profiled_total += settle;
+    pid_total += ez.settle_ms;
+  }
+  std::printf("%-8s %9.0f ms %21.0f ms\n", "total", pid_total, profiled_total);
+  if (profiled_total >= pid_total) failures++;
+
+  std::printf(failures ? "feedforward check FAILED\n" : "feedforward check passed\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,309 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Compares LemLib style dead reckoning with PoseFilter on a sensor log.
+//
+// With no arguments, records a goal rush on the LemLib robot's drive model with
+// sensorlog::Recorder, then breaks the log the way a rush does: the vertical tracker bounces
+// off the field at full speed, and the drive wheels spin as the robot launches.  Both
+// estimators run on the damaged log and are scored against where the model really went.
+// PoseFilter also runs with a simulated GPS fix every 100 ms.
+//
+//   bin/filter_bench [match.slog]
+//
+// Given a log from the robot's SD card there is no truth to score against, so it prints how
+// far the two estimates ended up apart and how many readings the filter threw out.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "poseFilter.hpp"
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "sensorLog.hpp"
+#include "sim/drive.hpp"
+#include "sim/replay.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const char* LOG_PATH = "/usd/filter_bench.slog";
+const std::uint32_t RUN_MS = 4000;
+
+// From Comp3-24-25-LemLib-Odom/src/main.cpp
+const double TRACKER_DIAMETER = 2.125;
+const double VERTICAL_OFFSET = -1;
+const double HORIZONTAL_OFFSET = -6;
+const double WHEEL_DIAMETER = 2.75;
+const double WHEEL_RPM = 450;
+const double TRACK_WIDTH = 13.5;
+
+// What PoseFilter is told about each sensor, same as the robot
+const float TRACKER_STD = 1;
+const float DRIVE_STD = 3;
+const float HEADING_STD = 0.003;
+const float GPS_STD = 1;
+
+struct pose {
+  double x = 0, y = 0, theta = 0;  // inches, radians
+};
+
+// One log frame turned into distances
+struct reading {
+  std::uint32_t time;
+  double heading;                // radians
+  double horizontal, vertical;   // inches
+  double left, right;            // inches, average of each side
+};
+
+std::vector<reading> readings_from(const sim::sensor_log& log) {
+  std::vector<reading> out;
+  const sensorlog::Header& h = log.header;
+  if (h.channelCount != 9 || h.channels[0].kind != sensorlog::ChannelKind::IMU_ROTATION) {
+    std::printf("expected the channels odomRecorder logs: imu, two rotation sensors, two sides of three motors\n");
+    return out;
+  }
+  for (int i = 3; i < 9; i++) {
+    if (h.channels[i].units != 0) {
+      std::printf("drive motors have to be logged in degrees\n");
+      return out;
+    }
+  }
+  const double tracker = M_PI * TRACKER_DIAMETER / 36000.0;
+  const double wheel = M_PI * WHEEL_DIAMETER / 360.0 * WHEEL_RPM / 600.0;
+  for (int f = 0; f < log.frames(); f++) {
+    const sensorlog::Value* v = log.frame(f);
+    reading r;
+    r.time = log.times[f];
+    r.heading = v[0].f * M_PI / 180.0;
+    r.horizontal = v[1].i * tracker;
+    r.vertical = v[2].i * tracker;
+    r.left = (v[3].f + v[4].f + v[5].f) / 3.0 * wheel;
+    r.right = (v[6].f + v[7].f + v[8].f) / 3.0 * wheel;
+    out.push_back(r);
+  }
+  return out;
+}
+
+// What lemlib::update() does with a vertical and a horizontal tracker and an imu: each tick's
+// tracker travel is an arc about the heading change, turned into a chord at the average heading
+std::vector<pose> dead_reckon(const std::vector<reading>& in) {
+  std::vector<pose> out(in.size());
+  for (std::size_t i = 1; i < in.size(); i++) {
+    const reading& a = in[i - 1];
+    const reading& b = in[i];
+    double turn = b.heading - a.heading;
+    double forward = b.vertical - a.vertical + turn * VERTICAL_OFFSET;
+    double sideways = b.horizontal - a.horizontal - turn * HORIZONTAL_OFFSET;
+    double chord = std::fabs(turn) < 1e-9 ? 1.0 : 2.0 * std::sin(turn / 2.0) / turn;
+    double heading = a.heading + turn / 2.0;
+    pose p = out[i - 1];
+    p.x += chord * (forward * std::sin(heading) + sideways * std::cos(heading));
+    p.y += chord * (forward * std::cos(heading) - sideways * std::sin(heading));
+    p.theta = b.heading;
+    out[i] = p;
+  }
+  return out;
+}
+
+struct filtered {
+  std::vector<pose> poses;
+  std::uint32_t rejected = 0;
+  double tick_us = 0;
+};
+
+// The robot's fused odometry task, one tick per log frame
+filtered filter(const std::vector<reading>& in, const std::vector<pose>* gps) {
+  filtered out;
+  out.poses.resize(in.size());
+  PoseFilter f;
+  f.reset(0, 0, in.empty() ? 0 : in[0].heading);
+  std::mt19937 rng(7);
+  std::normal_distribution<double> gps_noise(0.0, GPS_STD);
+  double seconds = 0;
+  for (std::size_t i = 1; i < in.size(); i++) {
+    const reading& a = in[i - 1];
+    const reading& b = in[i];
+    float dt = (b.time - a.time) / 1000.0f;
+    auto start = std::chrono::steady_clock::now();
+    f.predict(dt);
+    f.updateVerticalWheel((b.vertical - a.vertical) / dt, VERTICAL_OFFSET, TRACKER_STD);
+    f.updateHorizontalWheel((b.horizontal - a.horizontal) / dt, HORIZONTAL_OFFSET, TRACKER_STD);
+    f.updateVerticalWheel((b.left - a.left) / dt, -TRACK_WIDTH / 2, DRIVE_STD);
+    f.updateVerticalWheel((b.right - a.right) / dt, TRACK_WIDTH / 2, DRIVE_STD);
+    f.updateHeading(b.heading, HEADING_STD);
+    if (gps && b.time / 100 != a.time / 100)
+      f.updatePosition((*gps)[i].x + gps_noise(rng), (*gps)[i].y + gps_noise(rng), GPS_STD);
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    out.poses[i] = {f.getX(), f.getY(), f.getTheta()};
+  }
+  out.rejected = f.getRejected();
+  out.tick_us = in.size() > 1 ? seconds / (in.size() - 1) * 1e6 : 0;
+  return out;
+}
+
+// Goal rush, back out with the goal, turn and arc to the next ring
+void drive(pros::MotorGroup& left, pros::MotorGroup& right) {
+  pros::delay(5);
+  left.move_voltage(12000);
+  right.move_voltage(12000);
+  pros::delay(800);
+  left.move_voltage(-12000);
+  right.move_voltage(-12000);
+  pros::delay(600);
+  left.move_voltage(8000);
+  right.move_voltage(-8000);
+  pros::delay(400);
+  left.move_voltage(11000);
+  right.move_voltage(6000);
+  pros::delay(1200);
+  left.move_voltage(0);
+  right.move_voltage(0);
+}
+
+// Records the rush, returns where the model was at each log frame
+bool record(sim::sensor_log& log, std::vector<pose>& truth) {
+  sim::world().reset();
+  sim::world().sd_card_installed = true;
+  sim::DriveModel model(sim::lemlib_drive_config());
+  model.attach();
+  std::vector<pose> by_ms;
+  std::uint32_t base = sim::now_ms();
+  sim::step_hook_add([&](double) {
+    by_ms.resize(sim::now_ms() - base + 1);
+    by_ms.back() = {model.x(), model.y(), model.theta() * M_PI / 180.0};
+  });
+  sim::run(
+      [&] {
+        pros::Imu imu(15);
+        pros::Rotation horizontalEnc(1);
+        pros::Rotation verticalEnc(-13);
+        pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+        pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+        sensorlog::Recorder recorder(LOG_PATH);
+        recorder.addImu(&imu);
+        recorder.addRotation(&horizontalEnc);
+        recorder.addRotation(&verticalEnc);
+        recorder.addMotors(&leftMotors);
+        recorder.addMotors(&rightMotors);
+        std::uint32_t start = pros::millis();
+        recorder.start();
+        drive(leftMotors, rightMotors);
+        pros::delay(RUN_MS - (pros::millis() - start));
+        recorder.stop();
+      },
+      RUN_MS + 1000);
+  sim::step_hooks_clear();
+  if (!sim::sensor_log_read("usd/filter_bench.slog", log)) return false;
+  truth.clear();
+  for (std::uint32_t time : log.times) truth.push_back(by_ms[std::min<std::size_t>(time - base, by_ms.size() - 1)]);
+  return true;
+}
+
+// Freezes the vertical tracker for 150 ms at full speed, it picks up counting where it left off
+void tracker_bounce(std::vector<reading>& in) {
+  std::vector<reading> original = in;
+  for (std::size_t i = 1; i < in.size(); i++) {
+    std::uint32_t t = in[i].time - in[0].time;
+    bool off_field = t >= 600 && t < 750;
+    in[i].vertical = in[i - 1].vertical + (off_field ? 0.0 : original[i].vertical - original[i - 1].vertical);
+  }
+}
+
+// Drive encoders read 30% fast for the first 300 ms, the wheels are spinning on the tiles
+void wheel_spin(std::vector<reading>& in) {
+  double extra_left = 0, extra_right = 0;
+  std::vector<reading> original = in;
+  for (std::size_t i = 1; i < in.size(); i++) {
+    if (in[i].time - in[0].time < 300) {
+      extra_left += 0.3 * (original[i].left - original[i - 1].left);
+      extra_right += 0.3 * (original[i].right - original[i - 1].right);
+    }
+    in[i].left = original[i].left + extra_left;
+    in[i].right = original[i].right + extra_right;
+  }
+}
+
+struct score {
+  double rms = 0, final = 0;
+};
+
+score score_of(const std::vector<pose>& estimate, const std::vector<pose>& truth) {
+  score s;
+  for (std::size_t i = 0; i < estimate.size(); i++) {
+    double e = std::hypot(estimate[i].x - truth[i].x, estimate[i].y - truth[i].y);
+    s.rms += e * e;
+    s.final = e;
+  }
+  s.rms = std::sqrt(s.rms / std::max<std::size_t>(estimate.size(), 1));
+  return s;
+}
+
+int bench_log(const char* path) {
+  sim::sensor_log log;
+  if (!sim::sensor_log_read(path, log)) {
+    std::printf("couldn't read %s\n", path);
+    return 1;
+  }
+  std::vector<reading> in = readings_from(log);
+  if (in.empty()) return 1;
+  std::vector<pose> reckoned = dead_reckon(in);
+  filtered fused = filter(in, nullptr);
+  const pose& a = reckoned.back();
+  const pose& b = fused.poses.back();
+  std::printf("%d frames over %.1f s\n", log.frames(), (in.back().time - in.front().time) / 1000.0);
+  std::printf("dead reckoning ended at (%.2f, %.2f, %.1f)\n", a.x, a.y, a.theta * 180 / M_PI);
+  std::printf("pose filter ended at    (%.2f, %.2f, %.1f), %u readings rejected, %.2f us per tick\n", b.x, b.y,
+              b.theta * 180 / M_PI, fused.rejected, fused.tick_us);
+  std::printf("%.2f in apart\n", std::hypot(a.x - b.x, a.y - b.y));
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 1) return bench_log(argv[1]);
+
+  sim::sensor_log log;
+  std::vector<pose> truth;
+  if (!record(log, truth)) {
+    std::printf("couldn't record the goal rush\n");
+    return 1;
+  }
+  std::vector<reading> clean = readings_from(log);
+  if (clean.empty()) return 1;
+  std::vector<reading> bounced = clean;
+  tracker_bounce(bounced);
+  std::vector<reading> both = bounced;
+  wheel_spin(both);
+
+  struct {
+    const char* name;
+    const std::vector<reading>& in;
+  } logs[] = {{"clean", clean}, {"tracker bounce", bounced}, {"bounce + spin", both}};
+
+  std::printf("goal rush, %zu frames, position error in inches against the drive model\n\n", clean.size());
+  std::printf("%-16s %-18s %8s %8s %9s %8s\n", "log", "estimator", "rms", "final", "rejected", "us/tick");
+  for (const auto& l : logs) {
+    score reckoned = score_of(dead_reckon(l.in), truth);
+    filtered fused = filter(l.in, nullptr);
+    filtered fixed = filter(l.in, &truth);
+    score f = score_of(fused.poses, truth);
+    score g = score_of(fixed.poses, truth);
+    std::printf("%-16s %-18s %8.2f %8.2f %9s %8s\n", l.name, "dead reckoning", reckoned.rms, reckoned.final, "-", "-");
+    std::printf("%-16s %-18s %8.2f %8.2f %9u %8.2f\n", "", "pose filter", f.rms, f.final, fused.rejected, fused.tick_us);
+    std::printf("%-16s %-18s %8.2f %8.2f %9u %8.2f\n", "", "pose filter + gps", g.rms, g.final, fixed.rejected,
+                fixed.tick_us);
+  }
+  return 0;
+}
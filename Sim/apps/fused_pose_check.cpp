@@ -0,0 +1,243 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Runs the LemLib robot's fused odometry task, FusedPose every 10 ms on its sensors, on the drive
+// model.  Spinning in place at full power turns far more than the 2 degrees a tick that used to
+// count as an auton setting the pose, and the filter must never start over or lose the heading.
+// Then an auton sets the pose partway through a spin, and the filter has to move there exactly
+// once and keep tracking the spin from it.
+//
+// Last it closes the loop the way the robot does: lemlib's odometry moves the chassis pose every
+// tick, the fused task overwrites it with the filter's pose POSE_LEAD ahead, and a controller
+// steers on that pose at a constant speed, straight and round an arc.  The lead must stay what
+// the speed says it should be and never compound into the filter, which has to keep up with the
+// model for the whole run.
+
+#include <cmath>
+#include <cstdio>
+
+#include "fusedPose.hpp"
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// From Comp3-24-25-LemLib-Odom/src/main.cpp
+const FusedPose::Sensors SENSORS = {-1, -6, -6.75, 6.75, 1, 3, 0.003, 0.05};
+const double TRACKER_DIAMETER = 2.125;
+const double WHEEL_DIAMETER = 2.75;
+const double WHEEL_RPM = 450;
+
+// the filter has to stay this close to where the model really is
+const double HEADING_TOLERANCE = 1;  // degrees
+const double POSITION_TOLERANCE = 1; // inches
+// Same as POSE_LEAD in Comp3-24-25-LemLib-Odom/src/main.cpp
+const float POSE_LEAD = 0.025;
+// how much further off the filter can get from the first second of a constant speed run to the last
+const double DRIFT_TOLERANCE = 0.5;  // inches
+// how far the written pose can be from where the lead says it should be
+const double LEAD_TOLERANCE = 0.5;   // inches
+
+double average(const std::vector<double>& values) {
+  double sum = 0;
+  for (double v : values) sum += v;
+  return sum / values.size();
+}
+
+struct spin_result {
+  std::uint32_t resets = 0;
+  double fastest = 0;       // degrees a tick
+  double worst_heading = 0; // degrees off
+  double worst_position = 0;
+};
+
+// Spins for spin_ms, with an auton setting the pose at set_ms if it's set
+spin_result spin(std::uint32_t spin_ms, std::uint32_t set_ms, float set_x, float set_y, float set_theta) {
+  spin_result r;
+  sim::world().reset();
+  sim::DriveModel model(sim::lemlib_drive_config());
+  model.attach();
+  FusedPose fused(SENSORS);
+  // what the model's pose is measured from, moved when the auton sets the pose
+  double offset_x = 0, offset_y = 0, offset_theta = 0;
+  sim::run(
+      [&] {
+        pros::Imu imu(15);
+        pros::Rotation horizontalEnc(1);
+        pros::Rotation verticalEnc(-13);
+        pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+        pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+        const double tracker = M_PI * TRACKER_DIAMETER / 36000.0;
+        const double wheel = M_PI * WHEEL_DIAMETER / 360.0 * WHEEL_RPM / 600.0;
+        const double degrees = 180 / M_PI;
+        fused.setPose(0, 0, 0);
+        leftMotors.move(127);
+        rightMotors.move(-127);
+        std::uint32_t start = pros::millis();
+        std::uint32_t now = start;
+        double last_theta = 0;
+        bool set = false;
+        while (pros::millis() - start < spin_ms) {
+          pros::Task::delay_until(&now, 10);
+          if (!set && set_ms > 0 && now - start >= set_ms) {
+            set = true;
+            fused.setPose(set_x, set_y, set_theta);
+            // the model is where the auton says it is now, same as the robot
+            const double heading = set_theta * degrees - model.theta();
+            offset_theta = heading;
+            offset_x = set_x - (model.x() * std::cos(heading / degrees) + model.y() * std::sin(heading / degrees));
+            offset_y = set_y - (-model.x() * std::sin(heading / degrees) + model.y() * std::cos(heading / degrees));
+          }
+          fused.update({float(verticalEnc.get_position() * tracker), float(horizontalEnc.get_position() * tracker),
+                        float(average(leftMotors.get_position_all()) * wheel), float(average(rightMotors.get_position_all()) * wheel),
+                        float(imu.get_rotation() / degrees), float(imu.get_gyro_rate().z / degrees)},
+                       0.01f);
+          const double theta = model.theta() + offset_theta;
+          const double c = std::cos(offset_theta / degrees), s = std::sin(offset_theta / degrees);
+          const double x = model.x() * c + model.y() * s + offset_x;
+          const double y = -model.x() * s + model.y() * c + offset_y;
+          float fx, fy, ftheta;
+          fused.getPose(fx, fy, ftheta);
+          r.fastest = std::fmax(r.fastest, std::fabs(theta - last_theta));
+          r.worst_heading = std::fmax(r.worst_heading, std::fabs(std::remainder(ftheta * degrees - theta, 360.0)));
+          r.worst_position = std::fmax(r.worst_position, std::hypot(fx - x, fy - y));
+          last_theta = theta;
+        }
+        leftMotors.move(0);
+        rightMotors.move(0);
+      },
+      spin_ms + 1000);
+  sim::step_hooks_clear();
+  r.resets = fused.getResets();
+  return r;
+}
+
+struct steady_result {
+  double speed = 0;      // in/s
+  double early_off = 0;  // inches the filter is off at the end of the first second
+  double late_off = 0;   // and at the end of the run
+  double worst_lead = 0; // inches the written pose is off from the truth POSE_LEAD ahead
+  double worst_lead_heading = 0; // degrees
+  std::uint32_t resets = 0;
+};
+
+// Drives at voltage mV for run_ms, steering on the written pose to turn at rate degrees a second
+steady_result steady(double voltage, double rate, std::uint32_t run_ms) {
+  steady_result r;
+  sim::world().reset();
+  sim::DriveModel model(sim::lemlib_drive_config());
+  model.attach();
+  FusedPose fused(SENSORS);
+  sim::run(
+      [&] {
+        pros::Imu imu(15);
+        pros::Rotation horizontalEnc(1);
+        pros::Rotation verticalEnc(-13);
+        pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+        pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+        const double tracker = M_PI * TRACKER_DIAMETER / 36000.0;
+        const double wheel = M_PI * WHEEL_DIAMETER / 360.0 * WHEEL_RPM / 600.0;
+        const double degrees = 180 / M_PI;
+        // the chassis pose everything else reads, radians
+        double x = 0, y = 0, theta = 0;
+        double last_vertical = 0, last_horizontal = 0, last_heading = 0;
+        fused.setPose(0, 0, 0);
+        std::uint32_t start = pros::millis();
+        std::uint32_t now = start;
+        while (pros::millis() - start < run_ms) {
+          pros::Task::delay_until(&now, 10);
+          const double t = (now - start) / 1000.0;
+          const double vertical = verticalEnc.get_position() * tracker;
+          const double horizontal = horizontalEnc.get_position() * tracker;
+          const double heading = imu.get_rotation() / degrees;
+          // lemlib::update(), a tick of dead reckoning onto whatever the pose was
+          const double turn = heading - last_heading;
+          const double forward = vertical - last_vertical + turn * SENSORS.verticalOffset;
+          const double sideways = horizontal - last_horizontal - turn * SENSORS.horizontalOffset;
+          const double mid = theta + turn / 2;
+          x += forward * std::sin(mid) + sideways * std::cos(mid);
+          y += forward * std::cos(mid) - sideways * std::sin(mid);
+          theta += turn;
+          last_vertical = vertical;
+          last_horizontal = horizontal;
+          last_heading = heading;
+          // fusedOdom(), writing the lead pose over it
+          fused.update({float(vertical), float(horizontal), float(average(leftMotors.get_position_all()) * wheel),
+                        float(average(rightMotors.get_position_all()) * wheel), float(heading), float(imu.get_gyro_rate().z / degrees)},
+                       0.01f);
+          float fx, fy, ftheta;
+          fused.getAhead(POSE_LEAD, fx, fy, ftheta);
+          x = fx;
+          y = fy;
+          theta = ftheta;
+          // steer on the written pose, like a motion would
+          const double steer = 400 * (rate * t - theta * degrees);
+          leftMotors.move_voltage(voltage + steer);
+          rightMotors.move_voltage(voltage - steer);
+
+          // where the model will be POSE_LEAD from now at its current speed, against what was written
+          const double v = model.forward_velocity();
+          const double ahead_theta = (model.theta() + model.angular_velocity() * POSE_LEAD) / degrees;
+          const double chord_theta = (model.theta() + model.angular_velocity() * POSE_LEAD / 2) / degrees;
+          const double ahead_x = model.x() + v * POSE_LEAD * std::sin(chord_theta);
+          const double ahead_y = model.y() + v * POSE_LEAD * std::cos(chord_theta);
+          fused.getPose(fx, fy, ftheta);
+          const double off = std::hypot(fx - model.x(), fy - model.y());
+          if (t <= 1) r.early_off = off;
+          r.late_off = off;
+          if (t > 1) {
+            r.speed = v;
+            r.worst_lead = std::fmax(r.worst_lead, std::hypot(x - ahead_x, y - ahead_y));
+            r.worst_lead_heading = std::fmax(r.worst_lead_heading, std::fabs(theta - ahead_theta) * degrees);
+          }
+        }
+        leftMotors.move_voltage(0);
+        rightMotors.move_voltage(0);
+      },
+      run_ms + 1000);
+  sim::step_hooks_clear();
+  r.resets = fused.getResets();
+  return r;
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+
+  // one reset, the pose set before the spin
+  spin_result full = spin(3000, 0, 0, 0, 0);
+  std::printf("spinning at full power for 3 s: up to %.1f deg a tick, %u resets, heading off by %.2f deg, position by %.2f in\n",
+              full.fastest, full.resets, full.worst_heading, full.worst_position);
+  if (full.fastest <= 2 || full.resets != 1 || full.worst_heading > HEADING_TOLERANCE || full.worst_position > POSITION_TOLERANCE)
+    failures++;
+
+  spin_result set = spin(3000, 1500, 24, -36, M_PI / 2);
+  std::printf("auton sets the pose mid spin: %u resets, heading off by %.2f deg, position by %.2f in\n", set.resets,
+              set.worst_heading, set.worst_position);
+  if (set.resets != 2 || set.worst_heading > HEADING_TOLERANCE || set.worst_position > POSITION_TOLERANCE) failures++;
+
+  const struct {
+    const char* name;
+    double voltage, rate;
+  } runs[] = {{"straight", 10000, 0}, {"arc at 60 deg/s", 9000, 60}, {"arc at 300 deg/s", 8000, 300}};
+  for (const auto& run : runs) {
+    steady_result s = steady(run.voltage, run.rate, 4000);
+    std::printf("%-16s at %4.1f in/s: filter off by %.2f in after 1 s and %.2f in after 4 s, lead off by %.2f in %.2f deg, %u resets\n",
+                run.name, s.speed, s.early_off, s.late_off, s.worst_lead, s.worst_lead_heading, s.resets);
+    if (s.resets != 1 || s.late_off - s.early_off > DRIFT_TOLERANCE || s.late_off > POSITION_TOLERANCE ||
+        s.worst_lead > LEAD_TOLERANCE || s.worst_lead_heading > HEADING_TOLERANCE)
+      failures++;
+  }
+
+  std::printf(failures ? "fused pose check FAILED\n" : "fused pose check passed\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Runs red rings up the EZ robot's hooks with SortingIntake and jams them partway through: once,
+// once with a ring that takes two run backs, twice, and with a ring that never comes free.
+// Without jam detection the hooks sit stalled for the rest of the run.  With it every jam has to
+// be caught within a couple of ticks and reversed until it's free, and every ring scored after
+// all but the one a reversal can fling off the top.  A ring that won't come free has to leave the
+// hooks stopped instead of stalled.  Then checks the driver, auton and jam priorities.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "color_sorter.hpp"
+#include "pros/motors.hpp"
+#include "pros/optical.hpp"
+#include "pros/rtos.hpp"
+#include "sim/intake.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// Ports from EZ-Code-Odom/include/subsystems.hpp
+const int HOOKS_PORT = -7;
+const int LOW_PORT = -11;
+const int OPTICAL_PORT = 1;
+const double RED = 10;
+const int RINGS = 10;
+const std::uint32_t RING_EVERY = 500, JAM_AT = 1530;
+const std::uint32_t RUN_MS = 300 + RINGS * RING_EVERY + 1500;
+
+struct scenario {
+  const char* name;
+  std::vector<std::uint32_t> jams;  // ms into the run
+  int clears;                       // run backs each one takes
+};
+
+struct result {
+  int scored = 0;
+  int lost = 0;            // flung or dropped, a ring at the top when the hooks reverse flies off
+  double detect_ms = -1;   // worst, from a jam stalling the hooks to them being sent backwards
+  double stalled_ms = 0;   // driven up into a jam, all jams
+  int freed = 0;
+  std::uint32_t reversals = 0, give_ups = 0;
+  bool stopped = false;    // hooks unpowered at the end
+};
+
+result run(const scenario& s, bool guard) {
+  sim::world().reset();
+  sim::IntakeModel model(HOOKS_PORT, OPTICAL_PORT);
+  for (int i = 0; i < RINGS; i++) model.feed(RED, 300 + i * RING_EVERY);
+  for (std::uint32_t at : s.jams) model.jam(at, s.clears);
+  model.attach();
+
+  pros::Motor hooks(HOOKS_PORT);
+  pros::Motor low(LOW_PORT);
+  pros::Optical optical(OPTICAL_PORT);
+  SortingIntake intake(hooks, low, optical);
+  intake.jam.enabled = guard;
+  int team = 1;
+
+  // when each jam first stalls the hooks, and when they're first sent back after that
+  result r;
+  std::vector<double> stalled_at(s.jams.size(), -1), reversed_at(s.jams.size(), -1);
+  sim::step_hook_add([&](double) {
+    const sim::motor_state& m = sim::world().motors[sim::port_index(HOOKS_PORT)];
+    const std::vector<sim::jam_record>& jams = model.jams();
+    for (std::size_t i = 0; i < jams.size(); i++) {
+      if (stalled_at[i] < 0 && jams[i].stalled_ms > 0) stalled_at[i] = sim::now_ms();
+      if (stalled_at[i] >= 0 && reversed_at[i] < 0 && -m.command_mv < 0) reversed_at[i] = sim::now_ms();
+    }
+  });
+
+  sim::run(
+      [&] {
+        intake.attach(&team);
+        intake.request(SortingIntake::AUTON, 127, 127);
+        const std::uint32_t start = pros::millis();
+        std::uint32_t now = start;
+        while (pros::millis() - start < RUN_MS) {
+          intake.update();
+          pros::Task::delay_until(&now, 10);
+        }
+      },
+      RUN_MS + 100);
+  sim::step_hooks_clear();
+
+  for (const sim::ring_record& ring : model.rings()) {
+    if (ring.outcome == sim::SCORED) r.scored++;
+    else if (ring.outcome != sim::ON_HOOKS) r.lost++;
+  }
+  for (std::size_t i = 0; i < model.jams().size(); i++) {
+    const sim::jam_record& j = model.jams()[i];
+    r.stalled_ms += j.stalled_ms;
+    if (j.cleared_ms != 0) r.freed++;
+    if (stalled_at[i] >= 0 && reversed_at[i] >= 0) r.detect_ms = std::fmax(r.detect_ms, reversed_at[i] - stalled_at[i]);
+  }
+  r.reversals = intake.jam.reversals;
+  r.give_ups = intake.jam.give_ups;
+  r.stopped = sim::world().motors[sim::port_index(HOOKS_PORT)].applied_mv == 0;
+  return r;
+}
+
+// Who gets the hooks, going by the voltage they're sent
+int priorities() {
+  int failures = 0;
+  sim::world().reset();
+  sim::IntakeModel model(HOOKS_PORT, OPTICAL_PORT);
+  model.jam(400, 1);
+  model.attach();
+  pros::Motor hooks(HOOKS_PORT);
+  pros::Motor low(LOW_PORT);
+  pros::Optical optical(OPTICAL_PORT);
+  SortingIntake intake(hooks, low, optical);
+  int team = 1;
+  auto sent = [&] { return std::lround(-sim::world().motors[sim::port_index(HOOKS_PORT)].command_mv * 127 / 12000); };
+  auto tick = [&](std::uint32_t ms) {
+    for (std::uint32_t end = pros::millis() + ms; pros::millis() < end;) {
+      intake.update();
+      pros::delay(10);
+    }
+  };
+
+  sim::run(
+      [&] {
+        intake.attach(&team);
+        tick(20);
+        if (intake.owner() != SortingIntake::SOURCES || sent() != 0) failures++;
+        intake.request(SortingIntake::DRIVER, 60, 60);
+        tick(100);
+        if (intake.owner() != SortingIntake::DRIVER || sent() != 60) failures++;
+        intake.request(SortingIntake::AUTON, 100, 100);
+        intake.request(SortingIntake::DRIVER, 127, 127);
+        tick(100);
+        if (intake.owner() != SortingIntake::AUTON || sent() != 100) failures++;
+        // the jam at 400 ms, run back against the auton's request
+        for (int i = 0; i < 100 && !intake.jam.reversing(); i++) tick(10);
+        if (sent() != -intake.jam.reverse_speed) failures++;
+        tick(300);
+        intake.release(SortingIntake::AUTON);
+        tick(20);
+        if (intake.owner() != SortingIntake::DRIVER || sent() != 127) failures++;
+        intake.release(SortingIntake::DRIVER);
+        tick(20);
+        if (intake.owner() != SortingIntake::SOURCES || sent() != 0) failures++;
+      },
+      3000);
+  sim::step_hooks_clear();
+  std::printf("priorities %s\n", failures ? "wrong" : "right");
+  return failures;
+}
+
+}  // namespace
+
+int main() {
+  const scenario SCENARIOS[] = {
+      {"no jams", {}, 1},
+      {"one jam", {JAM_AT}, 1},
+      {"stubborn jam", {JAM_AT}, 2},
+      {"two jams", {JAM_AT, JAM_AT + 2000}, 1},
+      {"stuck ring", {JAM_AT}, 1000},
+  };
+  int failures = 0;
+  std::printf("%-13s %-6s %6s %5s %6s %9s %10s %9s %8s %7s\n", "", "guard", "scored", "lost", "freed", "detect ms",
+              "stalled ms", "reversals", "give ups", "hooks");
+  for (const scenario& s : SCENARIOS) {
+    for (bool guard : {false, true}) {
+      const result r = run(s, guard);
+      char detect[16] = "-";
+      if (r.detect_ms >= 0) std::snprintf(detect, sizeof(detect), "%.0f", r.detect_ms);
+      std::printf("%-13s %-6s %6d %5d %4d/%-1zu %9s %10.0f %9u %8u %7s\n", guard ? "" : s.name, guard ? "on" : "off",
+                  r.scored, r.lost, r.freed, s.jams.size(), detect, r.stalled_ms, r.reversals, r.give_ups,
+                  r.stopped ? "stopped" : "driven");
+      if (!guard) continue;
+      const bool stuck = s.clears > 3;
+      const JamDetector defaults;
+      // caught within stall_ticks ticks, plus the one it takes to act on it
+      if (!s.jams.empty() && (r.detect_ms < 0 || r.detect_ms > (defaults.stall_ticks + 1) * 10)) failures++;
+      // every ring goes over the top, except one at the top for each reversal
+      if (!stuck && (r.scored + r.lost != RINGS || r.lost > (int)r.reversals || r.freed != (int)s.jams.size() || r.give_ups != 0))
+        failures++;
+      // every time the hooks come back up into the jam they stall for a few ticks at most
+      if (!stuck && r.stalled_ms > (defaults.stall_ticks + 2) * 10.0 * s.clears * s.jams.size()) failures++;
+      if (stuck && (r.give_ups != 1 || !r.stopped || r.reversals != (std::uint32_t)defaults.max_retries)) failures++;
+    }
+  }
+  failures += priorities();
+  std::printf(failures ? "jam check FAILED\n" : "jam check passed\n");
+  return failures ? 1 : 0;
+}
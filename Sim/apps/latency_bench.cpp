@@ -0,0 +1,186 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Shows what latency compensation buys on the EZ robot's drive model.
+//
+// Motor commands take COMMAND_LATENCY_MS to land and the imu updates every IMU_PERIOD_MS, like
+// the real robot.  latency_measure() finds both, then the same turns and drives run twice with
+// PD controllers acting on OdometryService::predicted(): once with no lead, the pose as it is,
+// and once lead_ms ahead.  Settle time and overshoot are measured on where the model really is.
+//
+//   bin/latency_bench
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "arc_odometry.hpp"
+#include "latency.hpp"
+#include "pros/imu.hpp"
+#include "pros/motors.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const std::uint32_t COMMAND_LATENCY_MS = 20;
+const std::uint32_t IMU_PERIOD_MS = 10;
+
+// From EZ-Code-Odom/src/main.cpp
+const double TRACKER_DIAMETER = 2.0;
+const double HORIZONTAL_OFFSET = 6.0;
+
+// Settled once the real pose is this close
+const double TURN_TOLERANCE = 1.0;   // degrees
+const double DRIVE_TOLERANCE = 0.5;  // inches
+
+struct move {
+  bool turn;
+  double target;  // degrees to face, or inches to drive
+};
+const move MOVES[] = {{true, 90}, {false, 36}, {true, -45}, {false, 24}, {true, 180}, {false, -30}, {true, 0}};
+
+struct result {
+  double settle_ms[sizeof(MOVES) / sizeof(move)] = {};
+  double overshoot[sizeof(MOVES) / sizeof(move)] = {};
+};
+
+double wrap(double degrees) { return std::remainder(degrees, 360.0); }
+
+void world_reset() {
+  sim::world().reset();
+  sim::world().command_latency_ms = COMMAND_LATENCY_MS;
+  sim::world().imus[sim::port_index(6)].data_period_ms = IMU_PERIOD_MS;
+}
+
+std::vector<pros::Motor> motors(std::initializer_list<int> ports) {
+  std::vector<pros::Motor> out;
+  for (int port : ports) out.emplace_back(port, pros::MotorGearset::blue);
+  return out;
+}
+
+void drive_set(std::vector<pros::Motor>& left, std::vector<pros::Motor>& right, double left_mv, double right_mv) {
+  for (pros::Motor& m : left) m.move_voltage(left_mv);
+  for (pros::Motor& m : right) m.move_voltage(right_mv);
+}
+
+latency_model measure() {
+  world_reset();
+  sim::DriveModel model(sim::ez_drive_config());
+  model.attach();
+  latency_model found;
+  sim::run(
+      [&] {
+        std::vector<pros::Motor> left = motors({18, -19, -20});
+        std::vector<pros::Motor> right = motors({-8, 9, 10});
+        pros::Imu imu(6);
+        found = latency_measure(left, right, imu);
+      },
+      20000);
+  sim::step_hooks_clear();
+  return found;
+}
+
+result run(double lead_ms) {
+  world_reset();
+  sim::DriveModel model(sim::ez_drive_config());
+  model.attach();
+  result r;
+  ArcOdometry::pose odom = {0, 0, 0};
+  OdometryService service;
+  service.odometry.horizontal_offset = HORIZONTAL_OFFSET;
+  service.lead_ms = lead_ms;
+
+  sim::run(
+      [&] {
+        std::vector<pros::Motor> left = motors({18, -19, -20});
+        std::vector<pros::Motor> right = motors({-8, 9, 10});
+        pros::Imu imu(6);
+        pros::Rotation vertical(4);
+        pros::Rotation horizontal(5);
+        const double inches = M_PI * TRACKER_DIAMETER / 36000.0;
+        service.start([&] { return ArcOdometry::reading{vertical.get_position() * inches, horizontal.get_position() * inches, imu.get_rotation()}; },
+                      [&] { return ArcOdometry::pose{odom.x, odom.y, imu.get_rotation()}; },
+                      [&](double x, double y) {
+                        odom.x = x;
+                        odom.y = y;
+                      });
+        pros::delay(50);
+
+        double heading = 0;
+        for (std::size_t i = 0; i < sizeof(MOVES) / sizeof(move); i++) {
+          const move& m = MOVES[i];
+          const double start_x = model.x(), start_y = model.y();
+          const double odom_x = odom.x, odom_y = odom.y;
+          if (m.turn) heading = m.target;
+          // how far off the real pose is, and the controller's view of it
+          auto truth_error = [&] {
+            if (m.turn) return wrap(m.target - model.theta());
+            double h = heading * M_PI / 180.0;
+            return m.target - ((model.x() - start_x) * std::sin(h) + (model.y() - start_y) * std::cos(h));
+          };
+          const double first_error = truth_error();
+
+          std::uint32_t start = pros::millis(), settled = 0, last_out = start;
+          double last_error = 0;
+          bool first = true;
+          while (settled < 100 && pros::millis() - start < 4000) {
+            // the controllers act on the prediction, odometry itself is never moved ahead
+            const ArcOdometry::pose view = service.predicted();
+            double turn_error = wrap(heading - view.theta);
+            double h = heading * M_PI / 180.0;
+            double drive_error = m.target - ((view.x - odom_x) * std::sin(h) + (view.y - odom_y) * std::cos(h));
+            double error = m.turn ? turn_error : drive_error;
+            double derivative = first ? 0 : (error - last_error) / 0.01;
+            first = false;
+            last_error = error;
+            double out = m.turn ? 400 * error + 20 * derivative : 1200 * error + 60 * derivative;
+            out = std::fmax(-12000, std::fmin(12000, out));
+            double correction = m.turn ? 0 : 300 * turn_error;
+            drive_set(left, right, out + correction, -(m.turn ? out : -out) - correction);
+            settled = std::fabs(error) < (m.turn ? TURN_TOLERANCE : DRIVE_TOLERANCE) ? settled + 10 : 0;
+
+            double e = truth_error();
+            if (std::fabs(e) > (m.turn ? TURN_TOLERANCE : DRIVE_TOLERANCE)) last_out = pros::millis();
+            if (e * first_error < 0) r.overshoot[i] = std::fmax(r.overshoot[i], std::fabs(e));
+            pros::delay(10);
+          }
+          r.settle_ms[i] = last_out - start;
+        }
+        drive_set(left, right, 0, 0);
+      },
+      60000);
+  sim::step_hooks_clear();
+  return r;
+}
+
+}  // namespace
+
+int main() {
+  latency_model latency = measure();
+  std::printf("measured actuation %.1f ms, sensor age %.1f ms, lead %.1f ms (set %u ms command latency, %u ms imu)\n\n",
+              latency.actuation_ms, latency.sensor_age_ms, latency.lead_ms(), (unsigned)COMMAND_LATENCY_MS,
+              (unsigned)IMU_PERIOD_MS);
+
+  result plain = run(0);
+  result led = run(latency.lead_ms());
+  std::printf("%-14s %22s %22s\n", "", "current pose", "predicted pose");
+  std::printf("%-14s %11s %10s %11s %10s\n", "move", "settle", "overshoot", "settle", "overshoot");
+  double plain_total = 0, led_total = 0;
+  for (std::size_t i = 0; i < sizeof(MOVES) / sizeof(move); i++) {
+    char name[32];
+    std::snprintf(name, sizeof(name), MOVES[i].turn ? "turn to %.0f" : "drive %.0f", MOVES[i].target);
+    std::printf("%-14s %8.0f ms %10.2f %8.0f ms %10.2f\n", name, plain.settle_ms[i], plain.overshoot[i], led.settle_ms[i],
+                led.overshoot[i]);
+    plain_total += plain.settle_ms[i];
+    led_total += led.settle_ms[i];
+  }
+  std::printf("%-14s %8.0f ms %10s %8.0f ms\n", "total", plain_total, "", led_total);
+  return 0;
+}
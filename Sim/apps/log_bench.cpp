@@ -0,0 +1,157 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Times logging a pose through RingLogger against the lemlib::Buffer path it replaces.
+//
+//   log_bench [--messages n]
+//
+// The burst run logs as fast as the producer can go, the paced run logs every 5 us, which is
+// still far more than a robot does.  Dropped counts depend on how often the OS lets the writer
+// thread run; on a single core host it only gets the CPU between producer time slices, so the
+// 4 KB ring overflows where the unbounded deque just grows.
+// The lemlib side copies BufferedStdout::print and Buffer: fmt::format into a std::string,
+// then push it onto a std::deque behind a mutex that the writer task also takes.  Both run
+// with a real writer thread draining to /dev/null, and every heap allocation made while
+// logging is counted.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ringLogger.hpp"
+
+namespace {
+
+thread_local std::uint64_t allocations = 0;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  allocations++;
+  if (void* p = std::malloc(size)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+// lemlib::Buffer with a host mutex standing in for pros::Mutex
+class DequeBuffer {
+ public:
+  explicit DequeBuffer(std::FILE* out) : out(out) {}
+
+  template <typename... T> void print(fmt::format_string<T...> format, T&&... args) {
+    std::string message = fmt::format(format, std::forward<T>(args)...);
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.push_back(message);
+  }
+
+  // One message per pass, like Buffer::taskLoop
+  bool write_one() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (buffer.empty()) return false;
+    std::fputs(buffer.front().c_str(), out);
+    buffer.pop_front();
+    return true;
+  }
+
+ private:
+  std::FILE* out;
+  std::deque<std::string> buffer;
+  std::mutex mutex;
+};
+
+struct result {
+  double seconds = 0.0;
+  std::vector<double> latency_ns;
+  std::uint64_t allocations = 0;
+  std::uint32_t dropped = 0;
+};
+
+double percentile(std::vector<double> v, double p) {
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (std::size_t)(p * v.size()))];
+}
+
+template <typename Log, typename Drain> result run(Log& log, Drain drain, long messages, long pace_ns) {
+  std::atomic<bool> done = false;
+  std::thread writer([&] {
+    while (!done) drain();
+    drain();
+  });
+
+  result r;
+  r.latency_ns.resize(messages);
+  allocations = 0;
+  auto start = bench_clock::now();
+  for (long i = 0; i < messages; i++) {
+    if (pace_ns > 0)
+      while (bench_clock::now() - start < std::chrono::nanoseconds(i * pace_ns)) std::this_thread::yield();
+    float x = 0.01f * i, y = -0.02f * i, theta = 0.1f * (i % 3600);
+    auto before = bench_clock::now();
+    log.print("Chassis pose: x: {:.3f}, y: {:.3f}, theta: {:.3f}\n", x, y, theta);
+    r.latency_ns[i] = std::chrono::duration<double, std::nano>(bench_clock::now() - before).count();
+  }
+  r.seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+  r.allocations = allocations;
+  done = true;
+  writer.join();
+  return r;
+}
+
+void print_result(const char* name, const result& r, long messages) {
+  std::printf("%-20s %10.0f %8.0f %8.0f %8.0f %10.0f %12.2f %10llu\n", name, messages / r.seconds,
+              percentile(r.latency_ns, 0.5), percentile(r.latency_ns, 0.99), percentile(r.latency_ns, 0.999),
+              *std::max_element(r.latency_ns.begin(), r.latency_ns.end()), (double)r.allocations / messages,
+              (unsigned long long)r.dropped);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  long messages = 1000000;
+  for (int i = 1; i < argc - 1; i++)
+    if (!std::strcmp(argv[i], "--messages")) messages = std::atol(argv[++i]);
+
+  std::FILE* null = std::fopen("/dev/null", "w");
+  if (null == nullptr) return 1;
+
+  std::printf("%-20s %10s %8s %8s %8s %10s %12s %10s\n", "", "msgs/s", "p50 ns", "p99 ns", "p99.9 ns", "max ns",
+              "allocs/msg", "dropped");
+
+  for (long pace_ns : {0L, 5000L}) {
+    const char* mode = pace_ns == 0 ? "burst" : "paced";
+    long count = pace_ns == 0 ? messages : messages / 10;
+    char name[32];
+
+    DequeBuffer deque(null);
+    result a = run(deque, [&] { deque.write_one(); }, count, pace_ns);
+    std::snprintf(name, sizeof(name), "deque+mutex %s", mode);
+    print_result(name, a, count);
+
+    RingLogger ring(null);
+    result b = run(ring, [&] { ring.flush(); }, count, pace_ns);
+    b.dropped = ring.getDropped();
+    std::snprintf(name, sizeof(name), "RingLogger %s", mode);
+    print_result(name, b, count);
+    std::printf("%-20s ring high water %u of %zu bytes\n", "", ring.getHighWater(), RingLogger::CAPACITY);
+  }
+
+  std::fclose(null);
+  return 0;
+}
@@ -0,0 +1,173 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Watches four loops with LoopMonitor for 5 s of virtual time, each taking 2 ms a pass: one
+// sleeping pros::delay(10) like sorting() and opcontrol(), one on delay_until like fusedOdom(),
+// one that shares a mutex with a logger that holds it for 30 ms every half second, and one that
+// goes deep into its stack once.  Each has to show up as what it is: 12 ms periods, 10 ms ones,
+// a miss for every time the logger starved it, and the stack it used.  The first one starts
+// again halfway like opcontrol() does, which only resets it.  A loop in a task spawn() didn't make
+// mustn't paint its stack.  Then prints the LLEMU page and checks the telemetry channels decode.
+
+#include <cstdio>
+#include <cstring>
+
+#include "liblvgl/llemu.hpp"
+#include "loopMonitor.hpp"
+#include "pros/rtos.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/telemetry.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const std::uint32_t RUN_MS = 5000;
+const std::uint32_t WORK_MS = 2;
+const std::uint32_t HOLD_MS = 30, HOLD_EVERY = 500;
+const char* CAPTURE = "/usd/loop_monitor_check.bin";
+// the delayed loop starts again after this many passes, about halfway
+const int RESTART_PASS = 200;
+
+// uses about 8 KB of stack
+int deep(int depth) {
+  volatile char frame[1024];
+  std::memset((char*)frame, depth, sizeof(frame));
+  return depth > 0 ? deep(depth - 1) + frame[depth] : frame[0];
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  sim::world().reset();
+  sim::world().sd_card_installed = true;
+
+  LoopMonitor delayed("delayed", 10);
+  LoopMonitor fixed("fixed", 10);
+  LoopMonitor starved("starved", 10);
+  LoopMonitor stacked("stacked", 10);
+  LoopMonitor* const monitors[] = {&delayed, &fixed, &starved, &stacked};
+  int channels[4];
+  std::int32_t stack_before = -1, stack_after = -1;
+  int starvations = 0;
+  // taken before the run ends, the stacks the monitors look at go with their tasks
+  LoopMonitor::Stats stats[4];
+
+  sim::run(
+      [&] {
+        pros::lcd::initialize();
+        pros::Mutex log_mutex;
+        std::FILE* out = std::fopen(CAPTURE, "wb");
+        telemetry::BinarySink sink(out, 10, 1000);
+        addLoopChannels(sink, monitors, 4, channels);
+        sink.start();
+
+        delayed.spawn([&] {
+          delayed.start();
+          for (int pass = 0;; pass++) {
+            // opcontrol() starts again every time driver control does
+            if (pass == RESTART_PASS) delayed.start();
+            delayed.begin();
+            pros::delay(WORK_MS);
+            delayed.delay(10);
+          }
+        });
+        // not spawn()'s, so nothing tells it where the stack is
+        pros::Task fixed_task([&] {
+          std::uint32_t now = pros::millis();
+          fixed.start();
+          while (true) {
+            fixed.begin();
+            pros::delay(WORK_MS);
+            fixed.delayUntil(&now, 10);
+          }
+        });
+        starved.spawn([&] {
+          std::uint32_t now = pros::millis();
+          starved.start();
+          while (true) {
+            starved.begin();
+            log_mutex.take();
+            pros::delay(WORK_MS);
+            log_mutex.give();
+            starved.delayUntil(&now, 10);
+          }
+        });
+        pros::Task logger([&] {
+          while (true) {
+            pros::delay(HOLD_EVERY);
+            log_mutex.take();
+            starvations++;
+            pros::delay(HOLD_MS);
+            log_mutex.give();
+          }
+        });
+        stacked.spawn([&] {
+          std::uint32_t now = pros::millis();
+          stacked.start();
+          for (int pass = 0;; pass++) {
+            stacked.begin();
+            if (pass == 200) stack_before = stacked.getStackFree();
+            if (pass == 250) deep(7);
+            if (pass == 300) stack_after = stacked.getStackFree();
+            pros::delay(WORK_MS);
+            stacked.delayUntil(&now, 10);
+          }
+        });
+
+        for (std::uint32_t now = pros::millis(); pros::millis() < RUN_MS;) {
+          logLoopStats(sink, monitors, 4, channels);
+          pros::Task::delay_until(&now, 1000);
+        }
+        for (int i = 0; i < 4; i++) stats[i] = monitors[i]->getStats();
+        sim::world().echo_screen = true;
+        printLoopStats(0);
+        // three lines from line 5 take two pages, the second one only the last monitor
+        printLoopStats(5, 1);
+        sim::world().echo_screen = false;
+        sink.flush();
+        std::fclose(out);
+      },
+      RUN_MS + 100);
+
+  std::printf("\n%-9s %6s %6s %6s %6s %7s %7s   periods ms\n", "loop", "passes", "mean", "max", "late", "misses", "busy");
+  for (int i = 0; i < 4; i++) {
+    const LoopMonitor* m = monitors[i];
+    const LoopMonitor::Stats& s = stats[i];
+    std::printf("%-9s %6u %6.2f %6u %6u %7u %6.1f%%  ", m->getName(), s.passes, s.periodMean, s.periodMax, s.lateMax, s.misses,
+                s.busyPercent);
+    for (int b = 0; b < LoopMonitor::BUCKETS; b++)
+      if (m->getBucket(b) > 0) std::printf(" %d:%u", b, m->getBucket(b));
+    std::printf("\n");
+  }
+  std::printf("stacked loop: %d bytes free before going deep, %d after\n", stack_before, stack_after);
+
+  const LoopMonitor::Stats &d = stats[0], &f = stats[1], &s = stats[2];
+  // sleeping 10 ms after 2 ms of work is a 12 ms loop, late but never by a miss
+  if (delayed.getBucket(10 + WORK_MS) != d.passes || d.lateMax != WORK_MS || d.misses != 0) failures++;
+  // starting again registers nothing new and only measures from there
+  std::printf("%d monitors registered, delayed measured %u passes after starting again at pass %d\n", LoopMonitor::count(),
+              d.passes, RESTART_PASS);
+  if (LoopMonitor::count() != 4 || d.passes + RESTART_PASS > RUN_MS / (10 + WORK_MS) + 1) failures++;
+  if (f.stackFree != -1 || d.stackFree <= 0 || s.stackFree <= 0) failures++;
+  if (d.busyPercent < 15 || d.busyPercent > 18) failures++;
+  if (fixed.getBucket(10) != f.passes || f.misses != 0) failures++;
+  // every hold of the mutex costs the starved loop one miss, and it catches up after
+  if (s.misses != (std::uint32_t)starvations || s.lateMax + 10 < HOLD_MS || s.lateMax > HOLD_MS) failures++;
+  if (stack_before <= 0 || stack_before - stack_after < 7 * 1024) failures++;
+
+  sim::telemetry_capture capture;
+  int logged = 0;
+  if (sim::telemetry_read(CAPTURE, capture)) {
+    for (const sim::telemetry_channel& channel : capture.channels)
+      if (channel.name.rfind("loop ", 0) == 0 && channel.fields.size() == 6) logged += channel.samples();
+  }
+  std::printf("telemetry: %d loop samples in %zu channels\n", logged, capture.channels.size());
+  if (capture.channels.size() != 4 || logged != 4 * (int)(RUN_MS / 1000)) failures++;
+
+  std::printf(failures ? "loop monitor check FAILED\n" : "loop monitor check passed\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Runs the drive and turn moves of EZ's new_negative_blue on the EZ drive model three ways: as
+// EZ's drive and turn PIDs one after another, through the PID tuner's copy of ez::PID, as one
+// MotionQueue per move so the robot stops between them, and as a single MotionQueue.  Checks the
+// queue lands where the moves end, that its clamp trigger fires within an inch of the first
+// drive's end, and that queueing is faster than both.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "feedforward.hpp"
+#include "motion_queue.hpp"
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/tuner.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// new_negative_blue up to the ladybrown score, leaving out its waits for the intake
+struct move {
+  bool turn;
+  double value;  // inches, or degrees to face
+};
+const move MOVES[] = {{false, -23}, {true, -110}, {false, 21}, {false, -6},  {true, -87}, {false, 15}, {true, 27},
+                      {false, 16},  {false, 10},  {true, 103}, {false, 50}, {false, 15}, {true, 6},   {false, 4}};
+
+const sim::drive_config CONFIG = sim::ez_drive_config();
+
+struct run_result {
+  double ms = 0;
+  double miss = 0;            // inches from where the moves end
+  double heading_miss = 0;    // degrees
+  double trigger_off = -1;    // inches from the first drive's end when the clamp fired, -1 if it didn't
+  bool finished = true;
+};
+
+// where the robot would be after every move, exactly
+void moves_end(double& x, double& y, double& theta, double& first_x, double& first_y) {
+  x = y = theta = 0;
+  for (const move& m : MOVES) {
+    if (m.turn) {
+      theta = m.value;
+    } else {
+      x += m.value * std::sin(theta * M_PI / 180);
+      y += m.value * std::cos(theta * M_PI / 180);
+    }
+    if (&m == &MOVES[0]) first_x = x, first_y = y;
+  }
+}
+
+// queue_each: one MotionQueue run per move, so it stops between them
+run_result queued(bool queue_each) {
+  run_result r;
+  sim::world().reset();
+  sim::DriveModel model(CONFIG);
+  model.attach();
+  double end_x, end_y, end_theta, clamp_x, clamp_y;
+  moves_end(end_x, end_y, end_theta, clamp_x, clamp_y);
+  const sim::feedforward_constants truth = sim::drive_feedforward(CONFIG);
+  sim::run(
+      [&] {
+        std::vector<pros::Motor> left, right;
+        for (int port : CONFIG.left_ports) left.emplace_back(port, pros::MotorGearset::blue);
+        for (int port : CONFIG.right_ports) right.emplace_back(port, pros::MotorGearset::blue);
+        auto pose = [&] { return ez::pose{model.x(), model.y(), model.theta()}; };
+        RamseteFollower follower(CONFIG.track_width, pose, [&](double l, double r) {
+          for (pros::Motor& m : left) m.move_voltage(l);
+          for (pros::Motor& m : right) m.move_voltage(r);
+        });
+        follower.feedforward = {truth.ks, truth.kv, truth.ka};
+        MotionQueue queue(follower, pose);
+        auto clamp = [&] { r.trigger_off = std::hypot(model.x() - clamp_x, model.y() - clamp_y); };
+
+        const std::uint32_t start = pros::millis();
+        for (const move& m : MOVES) {
+          m.turn ? queue.turn(m.value) : queue.drive(m.value);
+          if (&m == &MOVES[0]) queue.within(1, clamp);
+          if (queue_each) r.finished &= queue.run(4000);
+        }
+        if (!queue_each) {
+          queue.start(20000);
+          r.finished = queue.wait();
+        }
+        r.ms = pros::millis() - start;
+        pros::delay(300);
+      },
+      30000);
+  sim::step_hooks_clear();
+  r.miss = std::hypot(model.x() - end_x, model.y() - end_y);
+  r.heading_miss = std::fabs(std::remainder(model.theta() - end_theta, 360));
+  return r;
+}
+
+// EZ's own PIDs with default_constants(), each move timed until its exit condition
+double ez_pid_ms() {
+  double total = 0, theta = 0;
+  for (const move& m : MOVES) {
+    sim::tune_setup setup;
+    setup.drive = CONFIG;
+    sim::pid_gains gains;
+    if (m.turn) {
+      setup.motion = sim::MOTION_TURN;
+      setup.targets = {std::remainder(m.value - theta, 360)};
+      setup.max_speed = 90;  // TURN_SPEED
+      setup.exit = {90, 3, 250, 7, 500};
+      gains = {4, 0.05, 15, 10};
+      theta = m.value;
+    } else {
+      setup.motion = sim::MOTION_DRIVE;
+      setup.targets = {m.value};
+      setup.max_speed = 110;  // DRIVE_SPEED
+      setup.exit = {90, 1, 250, 3, 500};
+      setup.heading = {14, 0, 20};
+      gains = m.value > 0 ? sim::pid_gains{24, 0.05, 220} : sim::pid_gains{16, 0.05, 220};
+    }
+    total += sim::tune(setup, {gains}, 1)[0].settle_ms;
+  }
+  return total;
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+
+  // the plan itself
+  double end_x, end_y, end_theta, clamp_x, clamp_y;
+  moves_end(end_x, end_y, end_theta, clamp_x, clamp_y);
+  RamseteFollower follower(CONFIG.track_width, [] { return ez::pose{0, 0, 0}; }, [](double, double) {});
+  MotionQueue queue(follower, [] { return ez::pose{0, 0, 0}; });
+  for (const move& m : MOVES) m.turn ? queue.turn(m.value) : queue.drive(m.value);
+  const std::vector<MotionQueue::sample> plan = queue.plan({0, 0, 0});
+  const MotionQueue::sample& last = plan.back();
+  const double plan_miss = std::hypot(last.x - end_x, last.y - end_y);
+  const double plan_turn = std::fabs(std::remainder(M_PI / 2 - last.direction - end_theta * M_PI / 180, 2 * M_PI));
+  int stops = 0;
+  double fastest = 0;
+  for (std::size_t i = 1; i + 1 < plan.size(); i++) {
+    if (plan[i].velocity == 0 && plan[i - 1].velocity > 0) stops++;
+    fastest = std::fmax(fastest, plan[i].velocity);
+  }
+  std::printf("plan: %zu samples, %.0f ms, stops %d times on the way, top wheel speed %.1f in/s, ends %.3f in and %.3f deg off\n",
+              plan.size(), last.time * 1000, stops, fastest, plan_miss, plan_turn * 180 / M_PI);
+  if (plan_miss > 0.01 || plan_turn > 1e-3 || fastest > queue.max_velocity + 1e-6) failures++;
+
+  const double ez = ez_pid_ms();
+  const run_result each = queued(true);
+  const run_result all = queued(false);
+  std::printf("\n%-30s %10s %10s %10s %14s\n", "new_negative_blue moves", "time", "end miss", "heading", "clamp fired");
+  std::printf("%-30s %7.0f ms %10s %10s %14s\n", "EZ PIDs, pid_wait each", ez, "", "", "");
+  std::printf("%-30s %7.0f ms %7.2f in %6.2f deg %8.2f in off\n", "queue, stopping between", each.ms, each.miss, each.heading_miss,
+              each.trigger_off);
+  std::printf("%-30s %7.0f ms %7.2f in %6.2f deg %8.2f in off\n", "queue, blended", all.ms, all.miss, all.heading_miss, all.trigger_off);
+  if (!each.finished || !all.finished) failures++;
+  if (all.ms >= each.ms || all.ms >= ez) failures++;
+  if (all.miss > 2 || all.heading_miss > 5) failures++;
+  if (all.trigger_off < 0 || all.trigger_off > 1.05) failures++;
+
+  std::printf(failures ? "motion queue check FAILED\n" : "motion queue check passed\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,127 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Compares ArcOdometry's integration modes and update periods against the drive model.
+//
+// Throws the EZ robot's drive model through full speed arcs, spins and S-curves while one
+// task per mode and period runs its own ArcOdometry off the same tracking wheels and imu.
+// Each task scores itself against where the model really is every time it updates.
+//
+//   bin/odom_bench
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "arc_odometry.hpp"
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// From EZ-Code-Odom/src/main.cpp
+const double TRACKER_DIAMETER = 2.0;
+const double HORIZONTAL_OFFSET = 6.0;
+
+const ArcOdometry::integration MODES[] = {ArcOdometry::EULER, ArcOdometry::MIDPOINT, ArcOdometry::EXACT_ARC,
+                                          ArcOdometry::RUNGE_KUTTA};
+const char* MODE_NAMES[] = {"euler", "midpoint", "exact arc", "runge kutta"};
+const std::uint32_t PERIODS[] = {10, 5, 2};
+
+// Left and right voltage for a while
+struct leg {
+  int left, right;
+  std::uint32_t ms;
+};
+const leg ROUTINE[] = {
+    {12000, 4000, 1500},    // wide arc at speed
+    {12000, -12000, 800},   // spin
+    {-12000, 12000, 500},   // spin back hard
+    {12000, 12000, 600},    // straight
+    {12000, 2000, 600},     // S-curve
+    {2000, 12000, 600},
+    {12000, 2000, 600},
+    {-12000, -6000, 1000},  // backwards arc
+    {0, 0, 500},
+};
+
+struct tracker {
+  ArcOdometry odometry;
+  std::uint32_t period;
+  double squares = 0, error = 0;
+  int updates = 0;
+};
+
+}  // namespace
+
+int main() {
+  sim::world().reset();
+  sim::DriveModel model(sim::ez_drive_config());
+  model.attach();
+
+  std::vector<std::unique_ptr<tracker>> trackers;
+  for (std::uint32_t period : PERIODS) {
+    for (ArcOdometry::integration mode : MODES) {
+      auto t = std::make_unique<tracker>();
+      t->odometry.mode = mode;
+      t->odometry.horizontal_offset = HORIZONTAL_OFFSET;
+      t->period = period;
+      trackers.push_back(std::move(t));
+    }
+  }
+
+  bool done = false;
+  sim::run(
+      [&] {
+        for (auto& t : trackers) {
+          tracker* self = t.get();
+          pros::Task([&, self] {
+            pros::Imu imu(6);
+            pros::Rotation vertical(4);
+            pros::Rotation horizontal(5);
+            const double inches = M_PI * TRACKER_DIAMETER / 36000.0;
+            auto read = [&] {
+              return ArcOdometry::reading{vertical.get_position() * inches, horizontal.get_position() * inches, imu.get_rotation()};
+            };
+            self->odometry.reset({0, 0, 0}, read());
+            std::uint32_t now = pros::millis();
+            while (!done) {
+              pros::Task::delay_until(&now, self->period);
+              const ArcOdometry::pose& p = self->odometry.update(read());
+              self->error = std::hypot(p.x - model.x(), p.y - model.y());
+              self->squares += self->error * self->error;
+              self->updates++;
+            }
+          });
+        }
+        pros::MotorGroup left({18, -19, -20}, pros::MotorGearset::blue);
+        pros::MotorGroup right({-8, 9, 10}, pros::MotorGearset::blue);
+        for (const leg& l : ROUTINE) {
+          left.move_voltage(l.left);
+          right.move_voltage(l.right);
+          pros::delay(l.ms);
+        }
+        done = true;
+        pros::delay(20);
+      },
+      60000);
+  sim::step_hooks_clear();
+
+  std::printf("truth ends at (%.1f, %.1f, %.0f)\n\n", model.x(), model.y(), model.theta());
+  std::printf("%-8s %-12s %10s %10s\n", "period", "mode", "rms", "final");
+  int i = 0;
+  for (const auto& t : trackers) {
+    std::printf("%3u ms   %-12s %7.3f in %7.3f in\n", (unsigned)t->period, MODE_NAMES[i++ % 4],
+                std::sqrt(t->squares / std::fmax(1, t->updates)), t->error);
+  }
+  return 0;
+}
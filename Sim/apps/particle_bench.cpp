@@ -0,0 +1,222 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Scores ParticleLocalizer against where the drive model really went, and times it.
+//
+// Drives a lap around the ladder on the EZ robot's drive model, starting against the red wall
+// like skills, with tracking wheels a few percent off so odometry drifts.  Every 10 ms the
+// drifting odometry step, the three distance sensors and the truth are recorded.  The filter
+// then runs on the recording at a few particle counts, with and without a GPS fix every
+// 100 ms, and reports its error next to odometry's and how many updates a second it manages.
+//
+//   bin/particle_bench
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "particle_localizer.hpp"
+#include "pros/distance.hpp"
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/field.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// Skills start, centered against the red wall
+const double START_X = 0, START_Y = -64;
+
+// Tracking wheels measure this much more than they roll, a worn wheel or a wrong diameter
+const double VERTICAL_SCALE = 1.04;
+const double HORIZONTAL_SCALE = 0.97;
+
+// Same sensors as the EZ robot's wall relocalization
+struct mounted {
+  int port;
+  ParticleLocalizer::beam where;
+};
+const mounted SENSORS[] = {
+    {12, {-6.5, 0, -90}},  // left
+    {13, {6.5, 0, 90}},    // right
+    {14, {0, -7, 180}},    // back
+};
+const int SENSOR_COUNT = sizeof(SENSORS) / sizeof(mounted);
+
+// Around the ladder, in the map's frame
+struct point {
+  double x, y;
+};
+const point ROUTE[] = {{0, -40}, {-48, -40}, {-48, 40}, {48, 40}, {48, -40}, {0, -40}};
+
+struct sample {
+  double forward, sideways, turn;  // odometry's step, robot frame
+  double x, y, theta;              // truth, map frame
+  int ranges[ParticleLocalizer::MAX_BEAMS];
+};
+
+double wrap(double degrees) { return std::remainder(degrees, 360.0); }
+
+// Turn in place and drive to points on the model's pose, so every run follows the same lap
+void turn_to(pros::MotorGroup& left, pros::MotorGroup& right, const sim::DriveModel& model, double theta) {
+  std::uint32_t settled = 0;
+  while (settled < 100) {
+    double error = wrap(theta - model.theta());
+    double mv = std::fmax(-8000, std::fmin(8000, error * 250));
+    left.move_voltage(mv);
+    right.move_voltage(-mv);
+    settled = std::fabs(error) < 1.0 ? settled + 10 : 0;
+    pros::delay(10);
+  }
+}
+
+void drive_to(pros::MotorGroup& left, pros::MotorGroup& right, const sim::DriveModel& model, double x, double y) {
+  turn_to(left, right, model, std::atan2(x - model.x(), y - model.y()) * 180.0 / M_PI);
+  std::uint32_t settled = 0;
+  while (settled < 100) {
+    double dx = x - model.x();
+    double dy = y - model.y();
+    double heading = model.theta() * M_PI / 180.0;
+    double along = dx * std::sin(heading) + dy * std::cos(heading);
+    double steer = std::hypot(dx, dy) > 3.0 ? wrap(std::atan2(dx, dy) * 180.0 / M_PI - model.theta()) : 0.0;
+    double mv = std::fmax(-9000, std::fmin(9000, along * 600));
+    left.move_voltage(mv + steer * 100);
+    right.move_voltage(mv - steer * 100);
+    settled = std::fabs(along) < 0.3 ? settled + 10 : 0;
+    pros::delay(10);
+  }
+  left.move_voltage(0);
+  right.move_voltage(0);
+}
+
+std::vector<sample> record() {
+  sim::world().reset();
+  sim::DriveModel model(sim::ez_drive_config());
+  model.pose_set(START_X, START_Y, 0);
+  model.attach();
+  sim::field_map field;
+  for (int i = 0; i < HIGH_STAKES_FIELD.count; i++) {
+    const field_segment& s = HIGH_STAKES_FIELD.segments[i];
+    field.segments.push_back({s.x1, s.y1, s.x2, s.y2});
+  }
+  sim::RangeModel ranges(model, field);
+  for (const mounted& s : SENSORS) ranges.sensor_add(s.port, s.where.x, s.where.y, s.where.angle);
+  ranges.attach();
+
+  std::vector<sample> samples;
+  bool done = false;
+  sim::run(
+      [&] {
+        pros::Task recorder([&] {
+          pros::Imu imu(6);
+          pros::Rotation vertical(4);
+          pros::Rotation horizontal(5);
+          std::vector<pros::Distance> distances;
+          for (const mounted& m : SENSORS) distances.emplace_back(m.port);
+          const double inches = M_PI * 2.0 / 36000.0;
+          double last_v = vertical.get_position() * inches * VERTICAL_SCALE;
+          double last_h = horizontal.get_position() * inches * HORIZONTAL_SCALE;
+          double last_theta = imu.get_rotation();
+          std::uint32_t now = pros::millis();
+          while (!done) {
+            pros::Task::delay_until(&now, 10);
+            double v = vertical.get_position() * inches * VERTICAL_SCALE;
+            double h = horizontal.get_position() * inches * HORIZONTAL_SCALE;
+            double theta = imu.get_rotation();
+            double turn = theta - last_theta;
+            sample s = {v - last_v, h - last_h - turn * M_PI / 180.0 * 6.0, turn, model.x(), model.y(), model.theta(), {}};
+            for (int i = 0; i < SENSOR_COUNT; i++) s.ranges[i] = distances[i].get();
+            samples.push_back(s);
+            last_v = v;
+            last_h = h;
+            last_theta = theta;
+          }
+        });
+        pros::MotorGroup left({18, -19, -20}, pros::MotorGearset::blue);
+        pros::MotorGroup right({-8, 9, 10}, pros::MotorGearset::blue);
+        for (const point& p : ROUTE) drive_to(left, right, model, p.x, p.y);
+        done = true;
+        pros::delay(20);
+      },
+      60000);
+  sim::step_hooks_clear();
+  return samples;
+}
+
+struct score {
+  double rms = 0, final = 0, us = 0;
+};
+
+// Odometry on its own, from the same start
+score odometry(const std::vector<sample>& samples) {
+  double x = START_X, y = START_Y, theta = 0, squares = 0, error = 0;
+  for (const sample& s : samples) {
+    double heading = (theta + s.turn / 2) * M_PI / 180.0;
+    x += s.forward * std::sin(heading) + s.sideways * std::cos(heading);
+    y += s.forward * std::cos(heading) - s.sideways * std::sin(heading);
+    theta += s.turn;
+    error = std::hypot(x - s.x, y - s.y);
+    squares += error * error;
+  }
+  return {std::sqrt(squares / samples.size()), error, 0};
+}
+
+score localize(const std::vector<sample>& samples, int particles, bool gps) {
+  auto owned = std::make_unique<ParticleLocalizer>(HIGH_STAKES_FIELD);  // too big for the stack
+  ParticleLocalizer& filter = *owned;
+  for (const mounted& s : SENSORS) filter.beam_add(s.where);
+  filter.reset(particles, {START_X, START_Y, 0}, 1.0, 1.0);
+  std::mt19937 rng(2);
+  std::normal_distribution<double> gps_noise(0.0, 0.8);
+
+  double squares = 0, error = 0, seconds = 0;
+  for (std::size_t i = 0; i < samples.size(); i++) {
+    const sample& s = samples[i];
+    double gps_x = s.x + gps_noise(rng);
+    double gps_y = s.y + gps_noise(rng);
+    auto start = std::chrono::steady_clock::now();
+    filter.move(s.forward, s.sideways, s.turn);
+    filter.ranges_update(s.ranges);
+    if (gps && i % 10 == 0) filter.gps_update(gps_x, gps_y, 1.0);
+    filter.resample();
+    ParticleLocalizer::pose estimate = filter.estimate();
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    error = std::hypot(estimate.x - s.x, estimate.y - s.y);
+    squares += error * error;
+  }
+  return {std::sqrt(squares / samples.size()), error, seconds * 1e6 / samples.size()};
+}
+
+}  // namespace
+
+int main() {
+  std::vector<sample> samples = record();
+  if (samples.empty()) {
+    std::printf("nothing recorded\n");
+    return 1;
+  }
+  std::printf("%zu updates, %.1f s of driving\n\n", samples.size(), samples.size() / 100.0);
+
+  score odom = odometry(samples);
+  std::printf("%-22s %9s %9s %12s %12s\n", "", "rms", "final", "us/update", "updates/s");
+  std::printf("%-22s %6.2f in %6.2f in\n", "odometry only", odom.rms, odom.final);
+  for (bool gps : {false, true}) {
+    for (int particles : {200, 500, 1000}) {
+      score s = localize(samples, particles, gps);
+      char name[32];
+      std::snprintf(name, sizeof(name), "%4d particles%s", particles, gps ? " + gps" : "");
+      std::printf("%-22s %6.2f in %6.2f in %12.1f %12.0f\n", name, s.rms, s.final, s.us, 1e6 / s.us);
+    }
+  }
+  return 0;
+}
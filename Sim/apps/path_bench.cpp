@@ -0,0 +1,222 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Times the per tick search in packedpath::PurePursuit against LemLib's, which checks every path
+// point for the closest one, on red_negative and on made up skills paths of up to 10000 points.
+//
+//   path_bench [--points n]
+//
+// The made up paths have a point every half inch and sweep the field in rows and then in columns,
+// lap after lap, so they cross themselves every few inches and get longer with more points. The
+// robot is walked along each path slightly off to the side, the same poses go to both searches,
+// and a tick where the full scan's closest point lands somewhere else on the path counts as a jump.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "packedPath.hpp"
+#include "sim/path.hpp"
+
+namespace {
+
+const float LOOKAHEAD = 15;
+const float TRACK_WIDTH = 12.5;
+
+// rows across the field, then columns, over and over a couple of inches further in each lap, as
+// n points 0.5 in apart
+std::vector<sim::text_point> skills_path(int n) {
+  std::vector<sim::text_point> corners;
+  float needed = 0.5f * (n - 1);
+  for (int lap = 0; needed > 0; lap++) {
+    float shift = 2.0f * (lap % 5);
+    for (int row = 0; row < 7; row++) {
+      float y = 12 + shift + row * 20;
+      corners.push_back({row % 2 ? 132.0f : 12.0f, y, 100});
+      corners.push_back({row % 2 ? 12.0f : 132.0f, y, 100});
+    }
+    for (int column = 0; column < 7; column++) {
+      float x = 132 - shift - column * 20;
+      corners.push_back({x, column % 2 ? 12.0f : 132.0f, 100});
+      corners.push_back({x, column % 2 ? 132.0f : 12.0f, 100});
+    }
+    needed -= 14 * 120 + 13 * 20 + 7 * 120 + 6 * 20;  // roughly one lap
+  }
+  std::vector<float> along(1, 0.0f);
+  for (std::size_t i = 1; i < corners.size(); i++)
+    along.push_back(along.back() + std::hypot(corners[i].x - corners[i - 1].x, corners[i].y - corners[i - 1].y));
+
+  std::vector<sim::text_point> points;
+  std::size_t leg = 1;
+  for (int i = 0; i < n; i++) {
+    float s = 0.5f * i;
+    while (leg + 1 < corners.size() && along[leg] < s) leg++;
+    float t = (s - along[leg - 1]) / (along[leg] - along[leg - 1]);
+    const sim::text_point& a = corners[leg - 1];
+    const sim::text_point& b = corners[leg];
+    points.push_back({a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, i == n - 1 ? 0.0f : 100.0f});
+  }
+  return points;
+}
+
+// what LemLib's follow does each iteration to find the closest and lookahead points
+struct linear_search {
+  const packedpath::Path& path;
+  int closest = 0;
+  int lookahead_index = 0;
+
+  void update(float x, float y, float& lookahead_x, float& lookahead_y) {
+    float closest_dist = INFINITY;
+    for (int i = 0; i < path.size(); i++) {
+      float dist = std::hypot(path[i].x - x, path[i].y - y);
+      if (dist < closest_dist) {
+        closest_dist = dist;
+        closest = i;
+      }
+    }
+    for (int i = std::max(closest, lookahead_index); i < path.size() - 1; i++) {
+      const packedpath::Point& p1 = path[i];
+      const packedpath::Point& p2 = path[i + 1];
+      float dx = p2.x - p1.x, dy = p2.y - p1.y, fx = p1.x - x, fy = p1.y - y;
+      float a = dx * dx + dy * dy, b = 2 * (fx * dx + fy * dy), c = fx * fx + fy * fy - LOOKAHEAD * LOOKAHEAD;
+      float discriminant = b * b - 4 * a * c;
+      if (discriminant < 0) continue;
+      float t = (-b + std::sqrt(discriminant)) / (2 * a);
+      if (t < 0 || t > 1) t = (-b - std::sqrt(discriminant)) / (2 * a);
+      if (t >= 0 && t <= 1) {
+        lookahead_x = p1.x + dx * t;
+        lookahead_y = p1.y + dy * t;
+        lookahead_index = i;
+        return;
+      }
+    }
+  }
+};
+
+struct pose {
+  float x, y, theta;
+};
+
+// along the path 0.8 in per tick, weaving up to 1.5 in either side of it
+std::vector<pose> walk(const packedpath::Path& path) {
+  std::vector<pose> poses;
+  int segment = 0;
+  for (float s = 0; s < path.length(); s += 0.8f) {
+    while (segment + 2 < path.size() && path[segment + 1].distance < s) segment++;
+    const packedpath::Point& a = path[segment];
+    const packedpath::Point& b = path[segment + 1];
+    float length = b.distance - a.distance;
+    float t = length > 0 ? (s - a.distance) / length : 0;
+    float dx = length > 0 ? (b.x - a.x) / length : 0, dy = length > 0 ? (b.y - a.y) / length : 1;
+    float offset = 1.5f * std::sin(s / 7);
+    poses.push_back({a.x + (b.x - a.x) * t - dy * offset, a.y + (b.y - a.y) * t + dx * offset, std::atan2(dx, dy)});
+  }
+  return poses;
+}
+
+double elapsed_ns(std::chrono::steady_clock::time_point start, std::size_t count) {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+struct packed {
+  std::vector<std::uint32_t> storage;
+  packedpath::Path path;
+};
+
+void pack(const std::vector<sim::text_point>& points, packed& out) {
+  std::vector<std::uint8_t> bytes = sim::path_pack(points);
+  out.storage.assign((bytes.size() + 3) / 4, 0);
+  std::memcpy(out.storage.data(), bytes.data(), bytes.size());
+  out.path = packedpath::Path(out.storage.data(), bytes.size());
+}
+
+// returns false if the index disagreed with checking every point
+bool run(const char* name, const packedpath::Path& path) {
+  std::vector<pose> poses = walk(path);
+
+  volatile float sink = 0.0f;
+  linear_search linear{path};
+  std::vector<float> linear_progress;
+  auto start = std::chrono::steady_clock::now();
+  for (const pose& p : poses) {
+    float lx = 0, ly = 0;
+    linear.update(p.x, p.y, lx, ly);
+    sink = lx;
+    linear_progress.push_back(path[linear.closest].distance);
+  }
+  double linear_ns = elapsed_ns(start, poses.size());
+
+  packedpath::PurePursuit pursuit(path, LOOKAHEAD, TRACK_WIDTH);
+  std::vector<float> progress;
+  start = std::chrono::steady_clock::now();
+  for (const pose& p : poses) {
+    float left = 0, right = 0;
+    if (!pursuit.update(p.x, p.y, p.theta, left, right)) break;
+    sink = left;
+    progress.push_back(pursuit.getProgress());
+  }
+  double pursuit_ns = elapsed_ns(start, progress.size());
+
+  int jumps = 0;
+  for (std::size_t i = 0; i < progress.size(); i++) {
+    if (std::fabs(linear_progress[i] - progress[i]) > 2 * LOOKAHEAD) jumps++;
+  }
+
+  // the index on its own, from anywhere on the field, has to match checking every point
+  packedpath::PathIndex index(path);
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> field(-12, 156);
+  std::vector<pose> queries(2000);
+  for (pose& q : queries) q = {field(random), field(random), 0};
+  int wrong = 0;
+  start = std::chrono::steady_clock::now();
+  for (const pose& q : queries) sink = index.closest(q.x, q.y);
+  double index_ns = elapsed_ns(start, queries.size());
+  for (const pose& q : queries) {
+    int best = 0;
+    float best_dist = INFINITY;
+    for (int i = 0; i < path.size(); i++) {
+      float dx = path[i].x - q.x, dy = path[i].y - q.y;
+      if (dx * dx + dy * dy < best_dist) {
+        best_dist = dx * dx + dy * dy;
+        best = i;
+      }
+    }
+    if (index.closest(q.x, q.y) != best) wrong++;
+  }
+
+  (void)sink;
+
+  std::printf("%-18s %6d %7zu %12.0f %12.0f %8d %10.0f %6d %8d\n", name, path.size(), poses.size(), linear_ns,
+              pursuit_ns, jumps, index_ns, wrong, pursuit.getRelocalizations());
+  return wrong == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int max_points = 10000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!std::strcmp(argv[i], "--points")) max_points = std::atoi(argv[i + 1]);
+  }
+
+  std::printf("%-18s %6s %7s %12s %12s %8s %10s %6s %8s\n", "path", "points", "ticks", "full scan ns",
+              "windowed ns", "jumps", "index ns", "wrong", "relocal.");
+  bool ok = true;
+  sim::packed_path_file red;
+  if (sim::path_load("../Comp3-24-25-LemLib-Odom/static/red_negative.txt", red)) ok = run("red_negative", red.path) && ok;
+  for (int n : {1000, 3000, max_points}) {
+    packed skills;
+    pack(skills_path(n), skills);
+    ok = run(("skills " + std::to_string(n)).c_str(), skills.path) && ok;
+  }
+  return ok ? 0 : 1;
+}
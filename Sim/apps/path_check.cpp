@@ -0,0 +1,147 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Packs the LemLib project's paths and checks the packed points, distances and curvature, times
+// getting a path ready from text against from a packed asset, then drives red_negative with
+// packedpath::PurePursuit on the LemLib drive model and checks it stops at the end.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "packedPath.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/path.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const char* PATHS[] = {"../Comp3-24-25-LemLib-Odom/static/example.txt",
+                       "../Comp3-24-25-LemLib-Odom/static/red_negative.txt"};
+
+// inches from the end of the path the robot has to stop within
+const double END_TOLERANCE = 3;
+
+std::string read_file(const char* path) {
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream text;
+  text << in.rdbuf();
+  return text.str();
+}
+
+double elapsed_ns(std::chrono::steady_clock::time_point start, int repeats) {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / repeats;
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+
+  // Packed points have to match the text, with distances adding up to the length
+  for (const char* file : PATHS) {
+    std::string text = read_file(file);
+    std::vector<sim::text_point> points = sim::path_parse_text(text);
+    std::vector<std::uint8_t> bytes = sim::path_pack(points);
+    std::vector<std::uint32_t> aligned((bytes.size() + 3) / 4);
+    std::memcpy(aligned.data(), bytes.data(), bytes.size());
+    packedpath::Path path(aligned.data(), bytes.size());
+    bool ok = path.isValid() && path.size() == (int)points.size();
+    for (int i = 0; ok && i < path.size(); i++) {
+      ok = path[i].x == points[i].x && path[i].y == points[i].y && path[i].speed == points[i].speed &&
+           (i == 0 || path[i].distance >= path[i - 1].distance);
+    }
+    ok = ok && path[path.size() - 1].distance == path.length();
+    std::printf("%-50s %3d points, %6.1f in, %zu bytes packed from %zu\n", file, path.size(), path.length(),
+                bytes.size(), text.size());
+    if (!ok) failures++;
+  }
+
+  // A quarter circle turning left has curvature 1 / radius everywhere inside it
+  std::vector<sim::text_point> arc;
+  for (int i = 0; i <= 40; i++) {
+    float angle = M_PI / 2 * i / 40;
+    arc.push_back({24 * std::cos(angle), 24 * std::sin(angle), 100});
+  }
+  sim::packed_path_file circle;
+  std::vector<std::uint8_t> bytes = sim::path_pack(arc);
+  circle.storage.resize((bytes.size() + 3) / 4);
+  std::memcpy(circle.storage.data(), bytes.data(), bytes.size());
+  circle.path = packedpath::Path(circle.storage.data(), bytes.size());
+  double worst = 0.0;
+  for (int i = 1; i + 1 < circle.path.size(); i++) worst = std::fmax(worst, std::fabs(circle.path[i].curvature - 1.0 / 24));
+  std::printf("quarter circle of radius 24: curvature off by at most %.1e, length %.3f of %.3f\n", worst,
+              circle.path.length(), M_PI / 2 * 24);
+  if (worst > 1e-4 || std::fabs(circle.path.length() - M_PI / 2 * 24) > 0.02) failures++;
+
+  // Getting a path ready to follow, parsing the text every call against viewing the packed asset
+  std::string text = read_file(PATHS[1]);
+  std::vector<std::uint8_t> packed = sim::path_pack(sim::path_parse_text(text));
+  std::vector<std::uint32_t> asset_storage((packed.size() + 3) / 4);
+  std::memcpy(asset_storage.data(), packed.data(), packed.size());
+  const int REPEATS = 20000;
+  std::size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < REPEATS; i++) sink += sim::path_parse_text(text).size();
+  double text_ns = elapsed_ns(start, REPEATS);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < REPEATS; i++) sink += packedpath::Path(asset_storage.data(), packed.size()).size();
+  double packed_ns = elapsed_ns(start, REPEATS);
+  std::printf("red_negative ready to follow: text %.0f ns, packed %.0f ns (%zu)\n", text_ns, packed_ns,
+              sink / (2 * REPEATS));
+
+  // Follow red_negative on the drive model, using its true pose like perfect odometry
+  sim::packed_path_file red;
+  if (!sim::path_load(PATHS[1], red)) {
+    std::printf("couldn't load %s\n", PATHS[1]);
+    return 1;
+  }
+  sim::world().reset();
+  sim::DriveModel model(sim::lemlib_drive_config());
+  model.pose_set(red.path[0].x, red.path[0].y, -90);
+  model.attach();
+  int steps = 0;
+  bool finished = false;
+  sim::run(
+      [&] {
+        pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+        pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+        packedpath::PurePursuit pursuit(red.path, 15, model.config().track_width, 5);
+        std::uint32_t now = pros::millis();
+        for (; steps < 1000; steps++) {
+          float left, right;
+          if (!pursuit.update(model.x(), model.y(), model.theta() * M_PI / 180, left, right)) {
+            finished = true;
+            break;
+          }
+          leftMotors.move(left);
+          rightMotors.move(right);
+          pros::Task::delay_until(&now, 10);
+        }
+        leftMotors.move(0);
+        rightMotors.move(0);
+        pros::delay(500);
+      },
+      12000);
+  sim::step_hooks_clear();
+  // against where follow() stops, not the ghost point path.jerryio puts 20 in past it
+  const packedpath::Point& end = red.path[sim::path_end(red.path)];
+  double miss = std::hypot(model.x() - end.x, model.y() - end.y);
+  std::printf("followed red_negative in %d ms, stopped %.1f in from its end at (%.1f, %.1f)\n", steps * 10, miss,
+              end.x, end.y);
+  if (!finished || miss > END_TOLERANCE) failures++;
+
+  std::printf(failures ? "path check FAILED\n" : "path check passed\n");
+  return failures ? 1 : 0;
+}
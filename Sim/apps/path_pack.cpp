@@ -0,0 +1,68 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Packs a path.jerryio LemLib path into the binary format packedpath::Path reads.  The LemLib
+// project's path-asset.mk runs this for every static/*.txt when the robot is built.
+//
+//   path_pack static/example.txt bin/static/example.path
+//
+// With --profile the text's speeds are replaced by a time-optimal profile for a drivetrain with
+// those limits, in inches and seconds, see pathProfile.hpp
+//
+//   path_pack --profile max_velocity max_acceleration max_deceleration max_lateral_acceleration track_width max_curvature in.txt out.path
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "sim/path.hpp"
+
+int main(int argc, char** argv) {
+  packedpath::Limits limits = {};
+  bool profile = argc == 10 && std::strcmp(argv[1], "--profile") == 0;
+  if (profile) {
+    limits.maxVelocity = std::atof(argv[2]);
+    limits.maxAcceleration = std::atof(argv[3]);
+    limits.maxDeceleration = std::atof(argv[4]);
+    limits.maxLateralAcceleration = std::atof(argv[5]);
+    limits.trackWidth = std::atof(argv[6]);
+    limits.maxCurvature = std::atof(argv[7]);
+    argv += 7;
+    argc -= 7;
+  }
+  if (argc != 3 || (profile && (limits.maxVelocity <= 0 || limits.maxAcceleration <= 0 || limits.maxDeceleration <= 0))) {
+    std::fprintf(stderr, "usage: path_pack [--profile max_velocity max_acceleration max_deceleration max_lateral_acceleration track_width max_curvature] path.txt path.path\n");
+    return 2;
+  }
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    std::fprintf(stderr, "couldn't read %s\n", argv[1]);
+    return 1;
+  }
+  std::stringstream text;
+  text << in.rdbuf();
+  std::vector<std::uint8_t> packed = sim::path_pack(sim::path_parse_text(text.str()), profile ? &limits : nullptr);
+  if (packed.empty()) {
+    std::fprintf(stderr, "%s has no path points\n", argv[1]);
+    return 1;
+  }
+  // read it back the way the robot will, so a broken packer fails the build instead of the auton
+  std::vector<std::uint32_t> aligned((packed.size() + 3) / 4);
+  std::memcpy(aligned.data(), packed.data(), packed.size());
+  if (!packedpath::Path(aligned.data(), packed.size()).isValid()) {
+    std::fprintf(stderr, "%s packed into a path packedpath::Path can't read\n", argv[1]);
+    return 1;
+  }
+  std::FILE* out = std::fopen(argv[2], "wb");
+  if (out == nullptr || std::fwrite(packed.data(), 1, packed.size(), out) != packed.size() || std::fclose(out) != 0) {
+    std::fprintf(stderr, "couldn't write %s\n", argv[2]);
+    return 1;
+  }
+  return 0;
+}
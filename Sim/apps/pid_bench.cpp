@@ -0,0 +1,155 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Times PIDBank::update_all against stepping the same controllers one ez::PID at a time.
+//
+//   pid_bench [--ticks n]
+//
+// The per object side copies ez::PID's members and compute_error so the objects are the same
+// size and shape as the ones ez::Drive owns, and calls it out of line like the EZ-Template
+// archive does.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "pid_bank.hpp"
+
+namespace {
+
+// ez::PID's members in declaration order
+struct object_pid {
+  struct {
+    double kp, ki, kd, start_i;
+  } constants = {};
+  struct {
+    int small_exit_time = 0;
+    double small_error = 0;
+    int big_exit_time = 0;
+    double big_error = 0;
+    int velocity_exit_time = 0;
+    int mA_timeout = 0;
+  } exit;
+  double output = 0.0, cur = 0.0, error = 0.0, target = 0.0, prev_error = 0.0, prev_current = 0.0;
+  double integral = 0.0, derivative = 0.0;
+  long time = 0, prev_time = 0;
+  double velocity_zero_main = 0.05, velocity_zero_secondary = 0.075;
+  int i = 0, j = 0, k = 0, l = 0, m = 0;
+  bool is_mA = false;
+  double second_sensor = 0.0;
+  std::string name;
+  bool name_active = false;
+  bool reset_i_sgn = true;
+  bool use_second_sensor = false;
+
+  __attribute__((noinline)) double compute_error(double err, double current);
+};
+
+int sgn(double x) { return (x > 0.0) - (x < 0.0); }
+
+double object_pid::compute_error(double err, double current) {
+  error = err;
+  cur = current;
+  derivative = prev_current - cur;
+  if (constants.ki != 0) {
+    if (std::fabs(error) < constants.start_i) integral += error;
+    if (sgn(error) != sgn(prev_error) && reset_i_sgn) integral = 0;
+  }
+  output = (error * constants.kp) + (integral * constants.ki) + (derivative * constants.kd);
+  prev_current = cur;
+  prev_error = error;
+  return output;
+}
+
+// Same order ez::Drive declares them in
+const char* DRIVE_PIDS[] = {"headingPID", "turnPID", "leftPID", "rightPID", "forward_drivePID", "backward_drivePID",
+                            "fwd_rev_drivePID", "swingPID", "forward_swingPID", "backward_swingPID", "fwd_rev_swingPID",
+                            "xyPID", "current_a_odomPID", "boomerangPID", "odom_angularPID", "internal_leftPID",
+                            "internal_rightPID", "left_activebrakePID", "right_activebrakePID"};
+
+// Error of every controller for a stretch of ticks, read in a loop so both sides see the same input
+const int TABLE_TICKS = 1024;
+
+std::vector<float> error_table(int controllers) {
+  std::vector<float> table(TABLE_TICKS * PIDBank::MAX);
+  for (int t = 0; t < TABLE_TICKS; t++)
+    for (int c = 0; c < controllers; c++) table[t * PIDBank::MAX + c] = 20.0f * std::sin(0.013f * t * (c + 1) + c);
+  return table;
+}
+
+struct timing {
+  double bank_ns;
+  double object_ns;
+  double worst_difference;
+};
+
+timing run(int controllers, long ticks) {
+  std::vector<float> table = error_table(controllers);
+
+  PIDBank bank;
+  std::vector<object_pid> objects(controllers);
+  for (int c = 0; c < controllers; c++) {
+    float kp = 1.0f + c, ki = c % 3 == 0 ? 0.1f : 0.0f, kd = 5.0f * c, start_i = 4.0f;
+    bank.add(kp, ki, kd, start_i);
+    objects[c].constants = {kp, ki, kd, start_i};
+    objects[c].name = c < 19 ? DRIVE_PIDS[c] : "extra";
+  }
+
+  // Same inputs through both, checked before timing.  ez::PID takes derivative on the
+  // measurement, which for a fixed target of 0 is current = -error.
+  double worst = 0.0;
+  for (int t = 0; t < TABLE_TICKS; t++) {
+    const float* errors = &table[t * PIDBank::MAX];
+    bank.update_all(errors, 10.0f);
+    for (int c = 0; c < controllers; c++) {
+      double expected = objects[c].compute_error(errors[c], -errors[c]);
+      worst = std::max(worst, std::fabs(expected - bank.output[c]) / std::max(1.0, std::fabs(expected)));
+    }
+  }
+
+  volatile float bank_sink = 0.0f;
+  auto start = std::chrono::steady_clock::now();
+  for (long t = 0; t < ticks; t++) {
+    bank.update_all(&table[(t % TABLE_TICKS) * PIDBank::MAX], 10.0f);
+    bank_sink = bank.output[0];
+  }
+  double bank_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  volatile double object_sink = 0.0;
+  start = std::chrono::steady_clock::now();
+  for (long t = 0; t < ticks; t++) {
+    const float* errors = &table[(t % TABLE_TICKS) * PIDBank::MAX];
+    for (int c = 0; c < controllers; c++) objects[c].compute_error(errors[c], -errors[c]);
+    object_sink = objects[0].output;
+  }
+  double object_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  (void)bank_sink;
+  (void)object_sink;
+
+  return {bank_s / ticks * 1e9, object_s / ticks * 1e9, worst};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  long ticks = 2000000;
+  for (int i = 1; i < argc - 1; i++)
+    if (!std::strcmp(argv[i], "--ticks")) ticks = std::atol(argv[++i]);
+
+  std::printf("sizeof(ez::PID) copy %zu bytes, PIDBank %zu bytes for %d controllers\n", sizeof(object_pid), sizeof(PIDBank),
+              PIDBank::MAX);
+  std::printf("%-12s %14s %14s %9s %12s\n", "controllers", "bank ns/tick", "objects ns/tick", "speedup", "worst diff");
+  for (int controllers : {4, 8, 19, 32}) {
+    timing t = run(controllers, ticks);
+    std::printf("%-12d %14.1f %14.1f %8.1fx %12.2e\n", controllers, t.bank_ns, t.object_ns, t.object_ns / t.bank_ns,
+                t.worst_difference);
+  }
+  return 0;
+}
@@ -0,0 +1,226 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Searches for drive, turn and swing constants for the EZ robot in simulation, then prints a
+// default_constants() body that can be pasted over the one in EZ-Code-Odom/src/autons.cpp.
+//
+//   pid_tuner [--autons path/to/autons.cpp] [--threads n] [--motion drive|turn|swing|all]
+//
+// Exit conditions, speeds and the constants that aren't tuned are read from autons.cpp, so the
+// tuner always matches what the robot runs.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sim/drive.hpp"
+#include "sim/tuner.hpp"
+
+namespace {
+
+struct call {
+  std::string line;               // the whole line, comment included
+  std::string name;               // chassis function
+  std::vector<double> args;       // numbers with units stripped
+};
+
+struct autons_file {
+  std::vector<call> body;         // every line of default_constants()
+  std::map<std::string, double> speeds;
+};
+
+// Reads default_constants() and the speed constants out of autons.cpp
+bool read_autons(const std::string& path, autons_file& out) {
+  std::ifstream file(path);
+  if (!file) return false;
+  std::regex speed_re(R"(const int (\w+_SPEED) = (\d+);)");
+  std::regex call_re(R"(^\s*chassis\.(\w+)\(([^)]*)\);)");
+  std::string line;
+  bool inside = false;
+  while (std::getline(file, line)) {
+    std::smatch m;
+    if (std::regex_search(line, m, speed_re)) out.speeds[m[1]] = std::stod(m[2]);
+    if (!inside) {
+      inside = line.find("void default_constants()") != std::string::npos;
+      continue;
+    }
+    if (line == "}") break;
+    call c;
+    c.line = line;
+    if (std::regex_search(line, m, call_re)) {
+      c.name = m[1];
+      std::stringstream args(m[2]);
+      std::string arg;
+      while (std::getline(args, arg, ',')) c.args.push_back(std::atof(arg.c_str()));
+    }
+    out.body.push_back(c);
+  }
+  return !out.body.empty();
+}
+
+const call* find(const autons_file& f, const std::string& name) {
+  for (const call& c : f.body)
+    if (c.name == name) return &c;
+  return nullptr;
+}
+
+sim::pid_gains gains_from(const autons_file& f, const std::string& name, sim::pid_gains fallback) {
+  const call* c = find(f, name);
+  if (c == nullptr) return fallback;
+  sim::pid_gains g;
+  if (c->args.size() > 0) g.kp = c->args[0];
+  if (c->args.size() > 1) g.ki = c->args[1];
+  if (c->args.size() > 2) g.kd = c->args[2];
+  if (c->args.size() > 3) g.start_i = c->args[3];
+  return g;
+}
+
+sim::pid_exit_conditions exit_from(const autons_file& f, const std::string& name, sim::pid_exit_conditions fallback) {
+  const call* c = find(f, name);
+  if (c == nullptr || c->args.size() < 5) return fallback;
+  return {(int)c->args[0], c->args[1], (int)c->args[2], c->args[3], (int)c->args[4]};
+}
+
+// 24 -> "24.0", 0.05 -> "0.05"
+std::string number(double x) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.3f", x);
+  std::string s = text;
+  while (s.back() == '0' && s[s.size() - 2] != '.') s.pop_back();
+  return s;
+}
+
+std::string gains_text(const sim::pid_gains& g) {
+  std::string s = number(g.kp) + ", " + number(g.ki) + ", " + number(g.kd);
+  if (g.start_i != 0.0) s += ", " + number(g.start_i);
+  return s;
+}
+
+std::vector<double> range(double start, double end, double step) {
+  std::vector<double> out;
+  for (double x = start; x <= end + step / 2; x += step) out.push_back(x);
+  return out;
+}
+
+// Every combination of kp and kd, with and without the current integral
+std::vector<sim::pid_gains> grid(const sim::pid_gains& current, std::vector<double> kps, std::vector<double> kds) {
+  std::vector<sim::pid_gains> out = {current};
+  for (double ki : {current.ki, 0.0}) {
+    for (double kp : kps)
+      for (double kd : kds) out.push_back({kp, ki, kd, current.start_i});
+    if (current.ki == 0.0) break;
+  }
+  return out;
+}
+
+struct job {
+  const char* label;
+  const char* setter;             // chassis function the winner is written to
+  sim::tune_setup setup;
+  std::vector<sim::pid_gains> candidates;
+  sim::pid_gains best;
+};
+
+void print_result(const char* tag, const sim::tune_result& r) {
+  std::printf("  %-9s %-26s %8.0f %9.2f %9.2f   small %d  big %d  velocity %d  timeout %d\n", tag, gains_text(r.gains).c_str(),
+              r.settle_ms, r.overshoot, r.final_error, r.exits[sim::EXIT_SMALL], r.exits[sim::EXIT_BIG],
+              r.exits[sim::EXIT_VELOCITY], r.exits[sim::EXIT_TIMEOUT]);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string autons_path = "../EZ-Code-Odom/src/autons.cpp";
+  std::string motion = "all";
+  int threads = 0;
+  for (int i = 1; i < argc - 1; i++) {
+    if (!std::strcmp(argv[i], "--autons")) autons_path = argv[++i];
+    else if (!std::strcmp(argv[i], "--threads")) threads = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--motion")) motion = argv[++i];
+  }
+
+  autons_file autons;
+  if (!read_autons(autons_path, autons)) {
+    std::fprintf(stderr, "couldn't read default_constants() from %s\n", autons_path.c_str());
+    return 1;
+  }
+  auto speed = [&](const char* name) { return autons.speeds.count(name) ? (int)autons.speeds[name] : 110; };
+
+  sim::pid_exit_conditions drive_exit = exit_from(autons, "pid_drive_exit_condition_set", {90, 1, 250, 3, 500});
+  sim::pid_exit_conditions turn_exit = exit_from(autons, "pid_turn_exit_condition_set", {90, 3, 250, 7, 500});
+  sim::pid_exit_conditions swing_exit = exit_from(autons, "pid_swing_exit_condition_set", {90, 3, 250, 7, 500});
+  sim::pid_gains heading = gains_from(autons, "pid_heading_constants_set", {14, 0, 20, 0});
+
+  std::vector<job> jobs;
+  auto add = [&](const char* label, const char* setter, sim::pid_motion type, std::vector<double> targets, int max_speed,
+                 sim::pid_exit_conditions exit, double overshoot_weight, sim::pid_gains current, std::vector<double> kps,
+                 std::vector<double> kds) {
+    job j;
+    j.label = label;
+    j.setter = setter;
+    j.setup.motion = type;
+    j.setup.drive = sim::ez_drive_config();
+    j.setup.targets = targets;
+    j.setup.max_speed = max_speed;
+    j.setup.exit = exit;
+    j.setup.heading = heading;
+    j.setup.overshoot_weight = overshoot_weight;
+    j.candidates = grid(current, kps, kds);
+    jobs.push_back(j);
+  };
+
+  if (motion == "all" || motion == "drive") {
+    add("drive forward", "pid_drive_constants_forward_set", sim::MOTION_DRIVE, {6, 12, 24, 48}, speed("DRIVE_SPEED"), drive_exit, 200,
+        gains_from(autons, "pid_drive_constants_forward_set", {20, 0, 100, 0}), range(8, 60, 2), range(0, 500, 20));
+    add("drive backward", "pid_drive_constants_backward_set", sim::MOTION_DRIVE, {-6, -12, -24, -48}, speed("DRIVE_SPEED"), drive_exit, 200,
+        gains_from(autons, "pid_drive_constants_backward_set", {20, 0, 100, 0}), range(8, 60, 2), range(0, 500, 20));
+  }
+  if (motion == "all" || motion == "turn")
+    add("turn", "pid_turn_constants_set", sim::MOTION_TURN, {15, 45, 90, 180, -90}, speed("TURN_SPEED"), turn_exit, 20,
+        gains_from(autons, "pid_turn_constants_set", {3, 0, 20, 0}), range(1, 12, 0.5), range(0, 60, 2.5));
+  if (motion == "all" || motion == "swing")
+    add("swing", "pid_swing_constants_set", sim::MOTION_SWING, {30, 90, -45}, speed("SWING_SPEED"), swing_exit, 20,
+        gains_from(autons, "pid_swing_constants_set", {6, 0, 65, 0}), range(2, 20, 1), range(0, 120, 5));
+
+  std::printf("%-11s %-26s %8s %9s %9s\n", "", "kp, ki, kd, start_i", "settle", "overshoot", "final err");
+  for (job& j : jobs) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<sim::tune_result> results = sim::tune(j.setup, j.candidates, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<std::size_t> order(results.size());
+    for (std::size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return results[a].score < results[b].score; });
+
+    std::size_t motions = results.size() * j.setup.targets.size();
+    std::printf("%s: %zu motions in %.2f s (%.0f motions/s)\n", j.label, motions, seconds, motions / seconds);
+    print_result("current", results[0]);
+    for (std::size_t i = 0; i < std::min<std::size_t>(5, order.size()); i++) print_result(i == 0 ? "best" : "", results[order[i]]);
+    j.best = results[order[0]].gains;
+  }
+
+  // The current body with the tuned lines swapped out
+  std::printf("\nvoid default_constants() {\n");
+  for (const call& c : autons.body) {
+    std::string line = c.line;
+    for (const job& j : jobs) {
+      if (c.name != j.setter) continue;
+      std::size_t open = line.find('('), close = line.find(");");
+      line = line.substr(0, open + 1) + gains_text(j.best) + line.substr(close);
+    }
+    std::printf("%s\n", line.c_str());
+  }
+  std::printf("}\n");
+  return 0;
+}
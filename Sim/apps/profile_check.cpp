@@ -0,0 +1,181 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Gives the LemLib project's paths a time profile for the LemLib drive and checks no point goes
+// over the limits, then drives red_negative with packedpath::PurePursuit on the drive model at
+// the text's speeds and at the profile's, and compares how long each takes and how far off the
+// path the robot gets.  The profile has to be faster, and if path-asset.mk profiles red_negative
+// by default it also has to stay as close to the path and stop as close to the end.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "packedPath.hpp"
+#include "pathProfile.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/path.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const char* PATHS[] = {"../Comp3-24-25-LemLib-Odom/static/example.txt",
+                       "../Comp3-24-25-LemLib-Odom/static/red_negative.txt"};
+
+const char* PATH_ASSET_MK = "../Comp3-24-25-LemLib-Odom/path-asset.mk";
+// Same as PATH_PROFILE in path-asset.mk
+const packedpath::Limits LIMITS = {60, 150, 80, 150, 13.5, 0.13};
+// inches from the end of the path the robot has to stop within, profiled or not
+const double END_TOLERANCE = 3;
+// inches a default profile can be further off the path or the end than the text's speeds
+const double TRACKING_SLACK = 0.5;
+// rounding in the float passes
+const float SLACK = 1.001f;
+
+std::string read_file(const char* path) {
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream text;
+  text << in.rdbuf();
+  return text.str();
+}
+
+// whether path-asset.mk's PATH_PROFILED names a path out of the box
+bool profiled_by_default(const std::string& name) {
+  std::istringstream lines(read_file(PATH_ASSET_MK));
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.rfind("PATH_PROFILED?=", 0) != 0) continue;
+    std::istringstream names(line.substr(std::strlen("PATH_PROFILED?=")));
+    std::string n;
+    while (names >> n)
+      if (n == name) return true;
+  }
+  return false;
+}
+
+void pack(const char* file, const packedpath::Limits* limits, sim::packed_path_file& out) {
+  std::vector<std::uint8_t> bytes = sim::path_pack(sim::path_parse_text(read_file(file)), limits);
+  out.storage.assign((bytes.size() + 3) / 4, 0);
+  std::memcpy(out.storage.data(), bytes.data(), bytes.size());
+  out.path = packedpath::Path(out.storage.data(), bytes.size());
+}
+
+// what went wrong with a profile, nullptr if nothing
+const char* limits_broken(const packedpath::Path& path) {
+  const int last = path.size() - 1;
+  const int end = sim::path_end(path);
+  if (path[0].velocity > LIMITS.minVelocity || path[end].velocity != 0 || path[end].speed != 0) return "doesn't start slow and end at rest";
+  for (int i = end; i <= last; i++)
+    if (path[i].velocity != 0 || path[i].speed != 0 || path[i].time != path[end].time) return "moves past the end";
+  if (std::fabs(path[last].time - path.duration()) > 1e-4) return "duration isn't the last point's time";
+  // turns sharper than maxCurvature get rounded off by pure pursuit
+  const auto curvature = [](const packedpath::Point& p) { return std::fmin(std::fabs(p.curvature), LIMITS.maxCurvature); };
+  for (int i = 0; i <= last; i++) {
+    const packedpath::Point& p = path[i];
+    const float outside = 1 + curvature(p) * LIMITS.trackWidth / 2;
+    if (p.velocity * outside > LIMITS.maxVelocity * SLACK) return "a wheel goes over top speed";
+    if (p.velocity * p.velocity * curvature(p) > LIMITS.maxLateralAcceleration * SLACK) return "slides in a turn";
+    if (i == last) break;
+    const packedpath::Point& next = path[i + 1];
+    const float ds = next.distance - p.distance;
+    if (next.time < p.time) return "time goes backwards";
+    if (std::fabs(next.velocity * next.velocity - p.velocity * p.velocity - 2 * p.acceleration * ds) > 1e-2) return "acceleration doesn't match velocity";
+    // checked against the curvature at the end of the step it's limited by
+    const float limit = p.acceleration > 0 ? LIMITS.maxAcceleration / outside : LIMITS.maxDeceleration / (1 + curvature(next) * LIMITS.trackWidth / 2);
+    if (std::fabs(p.acceleration) > limit * SLACK) return "a wheel accelerates too hard";
+    if (i < end && p.speed < 127 * LIMITS.minVelocity / LIMITS.maxVelocity * 0.999f) return "a point's speed would stop pure pursuit";
+  }
+  return nullptr;
+}
+
+struct run_result {
+  bool finished = false;
+  int ms = 0;
+  double worst_off = 0;  // inches from the nearest path point
+  double miss = 0;       // inches from the end of the path when stopped, not the ghost point past it
+};
+
+run_result drive(const packedpath::Path& path, float slew) {
+  run_result r;
+  sim::world().reset();
+  sim::DriveModel model(sim::lemlib_drive_config());
+  model.pose_set(path[0].x, path[0].y, -90);
+  model.attach();
+  sim::run(
+      [&] {
+        pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+        pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+        packedpath::PurePursuit pursuit(path, 15, model.config().track_width, slew);
+        std::uint32_t now = pros::millis();
+        for (int steps = 0; steps < 1000; steps++) {
+          float left, right;
+          if (!pursuit.update(model.x(), model.y(), model.theta() * M_PI / 180, left, right)) {
+            r.finished = true;
+            r.ms = steps * 10;
+            break;
+          }
+          leftMotors.move(left);
+          rightMotors.move(right);
+          double off = INFINITY;
+          for (const packedpath::Point& p : path) off = std::fmin(off, std::hypot(p.x - model.x(), p.y - model.y()));
+          r.worst_off = std::fmax(r.worst_off, off);
+          pros::Task::delay_until(&now, 10);
+        }
+        leftMotors.move(0);
+        rightMotors.move(0);
+        pros::delay(500);
+      },
+      12000);
+  sim::step_hooks_clear();
+  const packedpath::Point& end = path[sim::path_end(path)];
+  r.miss = std::hypot(model.x() - end.x, model.y() - end.y);
+  return r;
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+
+  for (const char* file : PATHS) {
+    sim::packed_path_file profiled;
+    pack(file, &LIMITS, profiled);
+    const char* broken = profiled.path.isValid() ? limits_broken(profiled.path) : "didn't pack";
+    float top = 0;
+    for (const packedpath::Point& p : profiled.path) top = std::fmax(top, p.velocity);
+    std::printf("%-50s %6.1f in in %.2f s, top speed %.1f in/s%s%s\n", file, profiled.path.length(), profiled.path.duration(),
+                top, broken ? "  <-- " : "", broken ? broken : "");
+    if (broken) failures++;
+  }
+
+  sim::packed_path_file text, profiled;
+  pack(PATHS[1], nullptr, text);
+  pack(PATHS[1], &LIMITS, profiled);
+  // path_check follows the text path with a slew of 5, the profile does its own ramping
+  run_result slow = drive(text.path, 5);
+  run_result fast = drive(profiled.path, 0);
+  std::printf("\nred_negative on the drive model   %10s %14s %10s\n", "time", "worst off path", "end miss");
+  std::printf("%-33s %7d ms %11.1f in %7.1f in\n", "text speeds", slow.ms, slow.worst_off, slow.miss);
+  std::printf("%-33s %7d ms %11.1f in %7.1f in  (profile says %.0f ms)\n", "time profile", fast.ms, fast.worst_off, fast.miss,
+              profiled.path.duration() * 1000);
+  if (!slow.finished || !fast.finished || fast.ms >= slow.ms || slow.miss > END_TOLERANCE || fast.miss > END_TOLERANCE) failures++;
+  const bool by_default = profiled_by_default("red_negative");
+  std::printf("path-asset.mk %s red_negative\n", by_default ? "profiles" : "keeps the text's speeds for");
+  if (by_default && (fast.worst_off > slow.worst_off + TRACKING_SLACK || fast.miss > slow.miss + TRACKING_SLACK)) {
+    std::printf("  but the profile tracks worse than the text's speeds\n");
+    failures++;
+  }
+
+  std::printf(failures ? "profile check FAILED\n" : "profile check passed\n");
+  return failures ? 1 : 0;
+}
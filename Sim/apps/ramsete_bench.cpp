@@ -0,0 +1,202 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Follows red_negative on the LemLib drive model with pure pursuit, at the text's speeds and on
+// its time profile, and with the LemLib project's Ramsete and EZ's RamseteFollower on the same
+// profile, and reports how far off the path each one gets and how long it takes.  Both also run
+// on the profile without its curvature cap.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "packedPath.hpp"
+#include "pathProfile.hpp"
+#include "profiled_path.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rtos.hpp"
+#include "ramsete.hpp"
+#include "ramsete_follower.hpp"
+#include "sim/drive.hpp"
+#include "sim/path.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const char* PATH = "../Comp3-24-25-LemLib-Odom/static/red_negative.txt";
+// Same as PATH_PROFILE in Comp3-24-25-LemLib-Odom/path-asset.mk
+const packedpath::Limits LIMITS = {60, 150, 150, 150, 13.5, 0.13};
+
+std::vector<std::uint8_t> pack(const packedpath::Limits* limits, sim::packed_path_file& out) {
+  std::ifstream in(PATH, std::ios::binary);
+  std::stringstream text;
+  text << in.rdbuf();
+  std::vector<std::uint8_t> bytes = sim::path_pack(sim::path_parse_text(text.str()), limits);
+  out.storage.assign((bytes.size() + 3) / 4, 0);
+  std::memcpy(out.storage.data(), bytes.data(), bytes.size());
+  out.path = packedpath::Path(out.storage.data(), bytes.size());
+  return bytes;
+}
+
+// inches from the robot to the nearest point on the path's segments
+double off_path(const packedpath::Path& path, double x, double y) {
+  double best = INFINITY;
+  for (int i = 0; i + 1 < path.size(); i++) {
+    const double ax = path[i].x, ay = path[i].y;
+    const double dx = path[i + 1].x - ax, dy = path[i + 1].y - ay;
+    const double length = dx * dx + dy * dy;
+    const double t = length > 0 ? std::fmax(0, std::fmin(1, ((x - ax) * dx + (y - ay) * dy) / length)) : 0;
+    best = std::fmin(best, std::hypot(ax + t * dx - x, ay + t * dy - y));
+  }
+  return best;
+}
+
+struct run_result {
+  bool finished = false;
+  int ms = 0;
+  double rms = 0;    // inches off the path, every 10 ms while moving
+  double worst = 0;  // inches off the path
+  double miss = 0;   // inches from the last point once stopped
+};
+
+// runs motion on the LemLib drive model starting at the path's first point facing along it, and
+// watches how far off the path the robot is until motion returns
+run_result drive(const packedpath::Path& path, const std::function<bool(sim::DriveModel&)>& motion) {
+  run_result r;
+  sim::world().reset();
+  sim::DriveModel model(sim::lemlib_drive_config());
+  model.pose_set(path[0].x, path[0].y, std::atan2(path[1].x - path[0].x, path[1].y - path[0].y) * 180 / M_PI);
+  model.attach();
+  sim::run(
+      [&] {
+        bool done = false;
+        double squares = 0;
+        int samples = 0;
+        pros::Task watch([&] {
+          std::uint32_t now = pros::millis();
+          while (!done) {
+            const double off = off_path(path, model.x(), model.y());
+            squares += off * off;
+            samples++;
+            r.worst = std::fmax(r.worst, off);
+            pros::Task::delay_until(&now, 10);
+          }
+        });
+        const std::uint32_t start = pros::millis();
+        r.finished = motion(model);
+        r.ms = pros::millis() - start;
+        done = true;
+        r.rms = samples > 0 ? std::sqrt(squares / samples) : 0;
+        pros::delay(500);
+      },
+      15000);
+  sim::step_hooks_clear();
+  const packedpath::Point& last = path[path.size() - 1];
+  r.miss = std::hypot(model.x() - last.x, model.y() - last.y);
+  return r;
+}
+
+// packedpath::PurePursuit or packedpath::Ramsete, the way PathChassis runs them: power for each
+// side every 10 ms from the pose until it says it's done
+template <typename step_fn>
+bool follow(sim::DriveModel& model, step_fn step) {
+  pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+  pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+  bool finished = false;
+  const std::uint32_t start = pros::millis();
+  std::uint32_t now = start;
+  while (now - start < 10000) {
+    float left, right;
+    if (!step(model.x(), model.y(), model.theta() * M_PI / 180, (now - start) / 1000.0f, left, right)) {
+      finished = true;
+      break;
+    }
+    leftMotors.move(left);
+    rightMotors.move(right);
+    pros::Task::delay_until(&now, 10);
+  }
+  leftMotors.move(0);
+  rightMotors.move(0);
+  return finished;
+}
+
+run_result pure_pursuit(const packedpath::Path& path, float slew) {
+  return drive(path, [&](sim::DriveModel& model) {
+    packedpath::PurePursuit pursuit(path, 15, model.config().track_width, slew);
+    return follow(model, [&](float x, float y, float theta, float, float& left, float& right) {
+      return pursuit.update(x, y, theta, left, right);
+    });
+  });
+}
+
+run_result ramsete(const packedpath::Path& path, const packedpath::WheelFeedforward& ff) {
+  return drive(path, [&](sim::DriveModel& model) {
+    packedpath::Ramsete controller(path, model.config().track_width);
+    return follow(model, [&](float x, float y, float theta, float seconds, float& left, float& right) {
+      float leftVelocity, rightVelocity, leftAccel, rightAccel;
+      if (!controller.update(x, y, theta, seconds, leftVelocity, rightVelocity, leftAccel, rightAccel)) return false;
+      left = ff.power(leftVelocity, leftAccel);
+      right = ff.power(rightVelocity, rightAccel);
+      const float ratio = std::fmax(std::fabs(left), std::fabs(right)) / 127;
+      if (ratio > 1) left /= ratio, right /= ratio;
+      return true;
+    });
+  });
+}
+
+run_result ramsete_follower(const packedpath::Path& path, const std::vector<trajectory_point>& trajectory, const Feedforward& ff) {
+  return drive(path, [&](sim::DriveModel& model) {
+    pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+    pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+    RamseteFollower follower(
+        model.config().track_width, [&] { return ez::pose{model.x(), model.y(), model.theta()}; },
+        [&](double left, double right) {
+          leftMotors.move_voltage(left);
+          rightMotors.move_voltage(right);
+        });
+    follower.feedforward = ff;
+    return follower.follow(trajectory, ez::fwd, 10000);
+  });
+}
+
+void print(const char* name, const run_result& r) {
+  std::printf("%-36s %7d ms %9.2f in %9.2f in %8.2f in%s\n", name, r.ms, r.rms, r.worst, r.miss, r.finished ? "" : "  (timed out)");
+}
+
+}  // namespace
+
+int main() {
+  // the text's speeds, the profile path-asset.mk packs, and the same without its curvature cap
+  sim::packed_path_file text, profiled, uncapped;
+  pack(nullptr, text);
+  const std::vector<std::uint8_t> bytes = pack(&LIMITS, profiled);
+  packedpath::Limits no_cap = LIMITS;
+  no_cap.maxCurvature = 0;
+  pack(&no_cap, uncapped);
+
+  // what a characterization of the drive would find
+  const sim::feedforward_constants truth = sim::drive_feedforward(sim::lemlib_drive_config());
+  const Feedforward mv = {truth.ks, truth.kv, truth.ka};
+  const packedpath::WheelFeedforward power = {float(truth.ks * 127 / 12000), float(truth.kv * 127 / 12000), float(truth.ka * 127 / 12000)};
+  std::printf("red_negative, %.1f in on the LemLib drive model, profile %.0f ms, uncapped %.0f ms\n", profiled.path.length(),
+              profiled.path.duration() * 1000, uncapped.path.duration() * 1000);
+  std::printf("feedforward kS %.2f kV %.3f kA %.4f in motor power\n\n", power.kS, power.kV, power.kA);
+
+  std::printf("%-36s %10s %12s %12s %11s\n", "", "time", "rms off", "worst off", "end miss");
+  print("pure pursuit, text speeds", pure_pursuit(text.path, 5));
+  print("pure pursuit, profile", pure_pursuit(profiled.path, 0));
+  print("pure pursuit, uncapped profile", pure_pursuit(uncapped.path, 0));
+  print("Ramsete, profile", ramsete(profiled.path, power));
+  print("Ramsete, uncapped profile", ramsete(uncapped.path, power));
+  print("EZ RamseteFollower, profile", ramsete_follower(profiled.path, profiled_path_trajectory(bytes.data(), bytes.size()), mv));
+  return 0;
+}
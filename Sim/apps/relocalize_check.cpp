@@ -0,0 +1,231 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Drives most of a lap of the skills field on the EZ robot's drive model with odometry that
+// drifts, from tracking wheels a few percent off, first on odometry alone and then with
+// RelocalizationService correcting it off the walls.  A mobile goal sits where one of the
+// stops puts a sensor on it, and has to be rejected instead of pulling odometry toward it.
+// Last it runs the lap the way EZ-Code-Odom's main.cpp does, odometry every 5 ms from a
+// ControlExecutive and the relocalizer as a step after it, which has to correct just as well.
+
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+#include "control_executive.hpp"
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "sim/drive.hpp"
+#include "sim/field.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+#include "wall_relocalizer.hpp"
+
+namespace {
+
+// Robot starts centered on the back wall like skills, odometry at the origin
+const double START_Y = 8;
+const double FIELD_LEFT = -72, FIELD_RIGHT = 72, FIELD_BOTTOM = -START_Y, FIELD_TOP = 144 - START_Y;
+
+// Tracking wheels measure this much more than they roll, a worn wheel or a wrong diameter
+const double VERTICAL_SCALE = 1.04;
+const double HORIZONTAL_SCALE = 0.97;
+
+// Distance sensors, ports are free ones on the EZ robot
+struct mounted {
+  int port;
+  WallRelocalizer::sensor where;
+};
+const mounted SENSORS[] = {
+    {12, {-6.5, 0, -90}},  // left
+    {13, {6.5, 0, 90}},    // right
+    {14, {0, -7, 180}},    // back
+};
+
+struct stop {
+  double x, y, theta;
+};
+
+// Most of a lap, stopping square to a wall at every corner
+const stop ROUTE[] = {
+    {0, 24, 0}, {-48, 24, 0}, {-48, 100, 0}, {-48, 110, 180}, {48, 110, 180}, {48, 24, 0},
+};
+
+// Shared by the odometry task, the route and the relocalizer
+struct odometry {
+  double x = 0, y = 0, theta = 0;
+};
+
+// Integrates the tracking wheels and the imu into odometry, once an update
+struct tracker {
+  pros::Imu imu{6};
+  pros::Rotation vertical{4};
+  pros::Rotation horizontal{5};
+  const double inches = M_PI * 2.0 / 36000.0;
+  double last_v = vertical.get_position() * inches * VERTICAL_SCALE;
+  double last_h = horizontal.get_position() * inches * HORIZONTAL_SCALE;
+  double last_theta = imu.get_rotation();
+
+  void update(odometry& odom) {
+    double v = vertical.get_position() * inches * VERTICAL_SCALE;
+    double h = horizontal.get_position() * inches * HORIZONTAL_SCALE;
+    double theta = imu.get_rotation();
+    double turn = (theta - last_theta) * M_PI / 180.0;
+    double forward = v - last_v;
+    double sideways = h - last_h - turn * 6.0;  // horizontal tracker 6 in in front
+    double heading = (last_theta * M_PI / 180.0) + turn / 2.0;
+    odom.x += forward * std::sin(heading) + sideways * std::cos(heading);
+    odom.y += forward * std::cos(heading) - sideways * std::sin(heading);
+    odom.theta = theta;
+    last_v = v;
+    last_h = h;
+    last_theta = theta;
+  }
+};
+
+void odometry_task(odometry& odom) {
+  tracker t;
+  std::uint32_t now = pros::millis();
+  while (true) {
+    pros::Task::delay_until(&now, 10);
+    t.update(odom);
+  }
+}
+
+double wrap(double degrees) { return std::remainder(degrees, 360.0); }
+
+// Turn in place to a heading on the imu
+void turn_to(pros::MotorGroup& left, pros::MotorGroup& right, const odometry& odom, double theta) {
+  std::uint32_t settled = 0;
+  while (settled < 100) {
+    double error = wrap(theta - odom.theta);
+    double mv = std::fmax(-8000, std::fmin(8000, error * 250));
+    left.move_voltage(mv);
+    right.move_voltage(-mv);
+    settled = std::fabs(error) < 1.0 ? settled + 10 : 0;
+    pros::delay(10);
+  }
+  left.move_voltage(0);
+  right.move_voltage(0);
+}
+
+// Face a point on odometry and drive to it
+void drive_to(pros::MotorGroup& left, pros::MotorGroup& right, const odometry& odom, double x, double y) {
+  if (std::hypot(x - odom.x, y - odom.y) > 1.0)
+    turn_to(left, right, odom, std::atan2(x - odom.x, y - odom.y) * 180.0 / M_PI);
+  std::uint32_t settled = 0;
+  while (settled < 100) {
+    double dx = x - odom.x;
+    double dy = y - odom.y;
+    double heading = odom.theta * M_PI / 180.0;
+    double along = dx * std::sin(heading) + dy * std::cos(heading);
+    double steer = std::hypot(dx, dy) > 3.0 ? wrap(std::atan2(dx, dy) * 180.0 / M_PI - odom.theta) : 0.0;
+    double mv = std::fmax(-9000, std::fmin(9000, along * 600));
+    left.move_voltage(mv + steer * 100);
+    right.move_voltage(mv - steer * 100);
+    settled = std::fabs(along) < 0.3 ? settled + 10 : 0;
+    pros::delay(10);
+  }
+  left.move_voltage(0);
+  right.move_voltage(0);
+}
+
+struct result {
+  std::vector<double> errors;  // odometry error at each stop, inches
+  WallRelocalizer::residual_stats stats[3];
+};
+
+// Relocalizes in its own task beside an odometry task, or with from_executive as a step after
+// odometry in one 5 ms ControlExecutive
+result lap(bool relocalize, bool from_executive = false) {
+  sim::world().reset();
+  sim::DriveModel model(sim::ez_drive_config());
+  model.attach();
+  sim::field_map field = sim::skills_field(START_Y);
+  field.box_add(-66, 95, -60, 105);  // a mobile goal next to the left wall
+  sim::RangeModel ranges(model, field);
+  for (const mounted& s : SENSORS) ranges.sensor_add(s.port, s.where.x, s.where.y, s.where.angle);
+  ranges.attach();
+
+  result r;
+  odometry odom;
+  RelocalizationService service;
+  ControlExecutive executive;
+  service.relocalizer.field_set(FIELD_LEFT, FIELD_RIGHT, FIELD_BOTTOM, FIELD_TOP);
+  for (const mounted& s : SENSORS) service.sensor_add(s.port, s.where);
+  service.enabled = relocalize;
+
+  sim::run(
+      [&] {
+        pros::MotorGroup left({18, -19, -20}, pros::MotorGearset::blue);
+        pros::MotorGroup right({-8, 9, 10}, pros::MotorGearset::blue);
+        const auto pose_get = [&] { return WallRelocalizer::pose{odom.x, odom.y, odom.theta}; };
+        const auto xy_set = [&](double x, double y) {
+          odom.x = x;
+          odom.y = y;
+        };
+        tracker t;
+        if (from_executive) {
+          executive.period = 5;
+          executive.add("odom", [&] { t.update(odom); });
+          service.attach(pose_get, xy_set);
+          executive.add("relocalize", [&] { service.update(); }, service.period / executive.period);
+          executive.start();
+        } else {
+          pros::Task odom_task([&] { odometry_task(odom); });
+          service.start(pose_get, xy_set);
+        }
+        for (const stop& s : ROUTE) {
+          drive_to(left, right, odom, s.x, s.y);
+          turn_to(left, right, odom, s.theta);
+          pros::delay(400);
+          r.errors.push_back(std::hypot(odom.x - model.x(), odom.y - model.y()));
+        }
+      },
+      60000);
+  sim::step_hooks_clear();
+  for (int i = 0; i < 3; i++) r.stats[i] = service.relocalizer.stats(i);
+  return r;
+}
+
+}  // namespace
+
+int main() {
+  result drift = lap(false);
+  result fixed = lap(true);
+  result stepped = lap(true, true);
+  int failures = 0;
+
+  std::printf("%-20s %12s %12s %12s\n", "stop", "odom only", "relocalized", "executive");
+  for (std::size_t i = 0; i < drift.errors.size() && i < fixed.errors.size() && i < stepped.errors.size(); i++) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "(%.0f, %.0f, %.0f)", ROUTE[i].x, ROUTE[i].y, ROUTE[i].theta);
+    std::printf("%-20s %10.2f in %10.2f in %10.2f in\n", name, drift.errors[i], fixed.errors[i], stepped.errors[i]);
+  }
+  const char* names[] = {"left", "right", "back"};
+  for (int i = 0; i < 3; i++) {
+    const WallRelocalizer::residual_stats& st = fixed.stats[i];
+    std::printf("%-5s sensor: %4u readings, %3u rejected, residual mean %5.2f rms %5.2f worst %5.2f, corrected %.2f in\n",
+                names[i], (unsigned)st.samples, (unsigned)st.rejected, st.mean(), st.rms(), st.worst, st.corrected);
+  }
+
+  if (drift.errors.size() != std::size(ROUTE) || fixed.errors.size() != std::size(ROUTE) ||
+      stepped.errors.size() != std::size(ROUTE)) {
+    std::printf("the lap didn't finish\n");
+    failures++;
+  } else {
+    for (const result* r : {&fixed, &stepped}) {
+      if (r->errors.back() > 1.0 || r->errors.back() * 3 > drift.errors.back()) failures++;
+      // the left sensor sees the goal at (-48, 100)
+      if (r->stats[0].rejected == 0) failures++;
+    }
+  }
+  std::printf(failures ? "relocalize check FAILED\n" : "relocalize check passed\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Records the LemLib robot's odometry sensors with sensorlog::Recorder while the drive model
+// runs, then replays the log with no drive model and checks the sensors read back the same.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "sensorLog.hpp"
+#include "sim/drive.hpp"
+#include "sim/replay.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const char* LOG_PATH = "/usd/replay_check.slog";
+const std::uint32_t RUN_MS = 6000;
+
+// What odometry sees at one instant
+struct reading {
+  std::uint32_t time;
+  double rotation;
+  std::int32_t horizontal, vertical;
+  std::vector<double> left, right;
+};
+
+// Reads every odometry sensor each 10 ms until the run ends, like lemlib::update() would
+std::vector<reading> watch(std::uint32_t until) {
+  pros::Imu imu(15);
+  pros::Rotation horizontalEnc(1);
+  pros::Rotation verticalEnc(-13);
+  pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+  pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+  std::vector<reading> out;
+  std::uint32_t now = pros::millis();
+  std::uint32_t start = now;
+  while (now - start < until) {
+    out.push_back({now - start, imu.get_rotation(), horizontalEnc.get_position(), verticalEnc.get_position(),
+                   leftMotors.get_position_all(), rightMotors.get_position_all()});
+    pros::Task::delay_until(&now, 10);
+  }
+  return out;
+}
+
+// Open loop drive, arc and turn, with a tare partway through.  Commands land between samples
+// so the recorder and the watcher agree on which side of a tare each reading is.
+void drive(pros::MotorGroup& left, pros::MotorGroup& right) {
+  pros::delay(5);
+  left.move_voltage(9000);
+  right.move_voltage(9000);
+  pros::delay(1200);
+  left.move_voltage(11000);
+  right.move_voltage(5000);
+  pros::delay(1500);
+  left.tare_position();
+  left.move_voltage(-6000);
+  right.move_voltage(6000);
+  pros::delay(1000);
+  left.move_voltage(0);
+  right.move_voltage(0);
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+
+  // Record
+  sim::world().reset();
+  sim::world().sd_card_installed = true;
+  sim::DriveModel model(sim::lemlib_drive_config());
+  model.attach();
+  std::vector<reading> live;
+  std::uint32_t written = 0, dropped = 0;
+  sim::run(
+      [&] {
+        pros::Imu imu(15);
+        pros::Rotation horizontalEnc(1);
+        pros::Rotation verticalEnc(-13);
+        pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+        pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+        sensorlog::Recorder recorder(LOG_PATH);
+        recorder.addImu(&imu);
+        recorder.addRotation(&horizontalEnc);
+        recorder.addRotation(&verticalEnc);
+        recorder.addMotors(&leftMotors);
+        recorder.addMotors(&rightMotors);
+        recorder.start();
+        pros::Task driver([&] { drive(leftMotors, rightMotors); });
+        live = watch(RUN_MS);
+        recorder.stop();
+        written = recorder.getFramesWritten();
+        dropped = recorder.getFramesDropped();
+      },
+      RUN_MS + 1000);
+  sim::step_hooks_clear();
+  std::printf("recorded %u frames, %u dropped, robot ended at (%.2f, %.2f, %.1f)\n", written, dropped, model.x(),
+              model.y(), model.theta());
+  if (written < RUN_MS / 10 || dropped != 0) failures++;
+
+  // Replay
+  sim::world().reset();
+  sim::world().sd_card_installed = true;
+  sim::sensor_log log;
+  if (!sim::sensor_log_read("usd/replay_check.slog", log)) {
+    std::printf("couldn't read the log back\n");
+    return 1;
+  }
+  sim::SensorReplay replay(log);
+  replay.attach();
+  std::vector<reading> replayed;
+  sim::run([&] { replayed = watch(RUN_MS); }, RUN_MS + 1000);
+  sim::step_hooks_clear();
+
+  // Recorded values are floats, so anything past float precision doesn't count
+  double worst = 0.0;
+  int compared = 0;
+  for (std::size_t i = 0; i < live.size() && i < replayed.size(); i++) {
+    const reading& a = live[i];
+    const reading& b = replayed[i];
+    if (a.time != b.time || a.horizontal != b.horizontal || a.vertical != b.vertical) {
+      std::printf("rotation sensors differ at %u ms\n", a.time);
+      failures++;
+      break;
+    }
+    auto check = [&](double x, double y) { worst = std::fmax(worst, std::fabs(x - y) / std::fmax(1.0, std::fabs(x))); };
+    check(a.rotation, b.rotation);
+    for (std::size_t m = 0; m < a.left.size(); m++) check(a.left[m], b.left[m]);
+    for (std::size_t m = 0; m < a.right.size(); m++) check(a.right[m], b.right[m]);
+    compared++;
+  }
+  std::printf("replayed %d of %zu readings, worst relative difference %.1e\n", compared, live.size(), worst);
+  if (compared != (int)live.size() || worst > 1e-6) failures++;
+
+  std::printf(failures ? "replay check FAILED\n" : "replay check passed\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,178 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Feeds red and blue rings up the EZ robot's hooks past a simulated optical sensor and sorts
+// them with SortingIntake, on its own tasks and from a ControlExecutive, then with the old
+// sorting_task() that waited 180 ms and held the hooks for 400 ms.  The new sorter has to keep
+// every red ring and throw every blue one at each hook speed, including when the speed drops
+// halfway through.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "color_sorter.hpp"
+#include "control_executive.hpp"
+#include "pros/motors.hpp"
+#include "pros/optical.hpp"
+#include "pros/rtos.hpp"
+#include "sim/intake.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+// Ports from EZ-Code-Odom/include/subsystems.hpp
+const int HOOKS_PORT = -7;
+const int LOW_PORT = -11;
+const int OPTICAL_PORT = 1;
+const double RED = 10;
+const double BLUE = 230;
+
+struct scenario {
+  const char* name;
+  int speed;           // hook speed for the first half
+  int later_speed;     // and the second half
+  int spacing_ms;      // between rings
+};
+
+struct result {
+  int kept = 0, thrown = 0, wrong = 0;     // red scored, blue flung, anything else
+  int missed = 0;                          // rings the sorter never saw, only blue ones for the old sorter
+  double worst_reaction = -1;              // ms from a ring coming into view to the sorter seeing it
+  double worst_gap = 0;                    // longest ms without a new hook command
+};
+
+// Old sorting_task() from EZ-Code-Odom/src/main.cpp, with its globals
+int intake_speed_high = 0;
+int intake_speed_low = 0;
+int isRedTeam = 1;
+
+void legacy_sorting_task(pros::Motor& intakeHigh, pros::Motor& intakeLow, pros::Optical& colorsort,
+                         std::uint32_t& seen_count) {
+  colorsort.set_led_pwm(100);
+  while (true) {
+    int threshold = 200;
+    if (isRedTeam != 2) {
+      int hue = colorsort.get_hue();
+      if (colorsort.get_proximity() > threshold) {
+        if ((hue > 180 && hue < 240 && (isRedTeam == 1)) || (hue < 50 && (isRedTeam == 0))) {
+          seen_count++;
+          pros::delay(180);
+          intakeHigh.move(0);
+          pros::delay(400);
+          intakeHigh.move(0);
+        }
+      }
+    }
+    intakeHigh.move(intake_speed_high);
+    intakeLow.move(intake_speed_low);
+    pros::delay(10);
+  }
+}
+
+enum sorter_mode { OLD, TASKS, EXECUTIVE };
+const char* MODE_NAMES[] = {"old", "tasks", "exec"};
+
+result run(const scenario& s, sorter_mode mode) {
+  const bool legacy = mode == OLD;
+  sim::world().reset();
+  sim::IntakeModel model(HOOKS_PORT, OPTICAL_PORT);
+  const int RINGS = 12;
+  for (int i = 0; i < RINGS; i++) model.feed(i % 2 ? BLUE : RED, 300 + i * s.spacing_ms);
+  model.attach();
+  int end_ms = 300 + RINGS * s.spacing_ms + 1000;
+
+  pros::Motor hooks(HOOKS_PORT);
+  pros::Motor low(LOW_PORT);
+  pros::Optical optical(OPTICAL_PORT);
+  SortingIntake intake(hooks, low, optical);
+  ControlExecutive executive;
+  std::uint32_t legacy_seen = 0;
+
+  // reaction and command gaps, watched every step
+  result r;
+  std::uint32_t last_command_ms = 0, last_commands = 0, reacted = 0;
+  sim::step_hook_add([&](double) {
+    std::uint32_t now = sim::now_ms();
+    const sim::motor_state& m = sim::world().motors[sim::port_index(HOOKS_PORT)];
+    if (m.commands != last_commands) {
+      if (last_commands != 0) r.worst_gap = std::fmax(r.worst_gap, now - last_command_ms);
+      last_commands = m.commands;
+      last_command_ms = now;
+    }
+    std::uint32_t seen = legacy ? legacy_seen : intake.sorter.seen;
+    while (reacted < seen) {
+      // the new sorter counts every ring, the old one only blue ones
+      int ring = legacy ? 2 * reacted + 1 : reacted;
+      if (ring < (int)model.rings().size() && model.rings()[ring].seen_ms != 0)
+        r.worst_reaction = std::fmax(r.worst_reaction, (double)now - model.rings()[ring].seen_ms);
+      reacted++;
+    }
+  });
+
+  intake_speed_high = s.speed;
+  intake_speed_low = 127;
+  intake.request(SortingIntake::AUTON, s.speed, 127);
+  isRedTeam = 1;
+  sim::run(
+      [&] {
+        if (legacy) {
+          pros::Task task([&] { legacy_sorting_task(hooks, low, optical, legacy_seen); });
+        } else if (mode == TASKS) {
+          intake.start(&isRedTeam);
+        } else {
+          intake.attach(&isRedTeam);
+          executive.add("intake", [&] { intake.update(); });
+          executive.start();
+        }
+        pros::delay(300 + RINGS / 2 * s.spacing_ms);
+        intake_speed_high = s.later_speed;
+        intake.hooks_request(SortingIntake::AUTON, s.later_speed);
+        pros::delay(end_ms - pros::millis());
+      },
+      end_ms + 100);
+  sim::step_hooks_clear();
+
+  for (const sim::ring_record& ring : model.rings()) {
+    bool red = ring.hue == RED;
+    if (red && ring.outcome == sim::SCORED) r.kept++;
+    else if (!red && ring.outcome == sim::FLUNG) r.thrown++;
+    else r.wrong++;
+  }
+  r.missed = (legacy ? RINGS / 2 : RINGS) - (legacy ? legacy_seen : intake.sorter.seen);
+  return r;
+}
+
+}  // namespace
+
+int main() {
+  const scenario SCENARIOS[] = {
+      {"full speed", 127, 127, 400},
+      {"auton speed", 106, 106, 400},
+      {"slow hooks", 70, 70, 500},
+      {"slows halfway", 127, 70, 500},
+      {"close rings", 127, 127, 250},
+  };
+  int failures = 0;
+  std::printf("%-15s %-8s %5s %7s %6s %7s %9s %8s\n", "", "sorter", "kept", "thrown", "wrong", "missed",
+              "react ms", "gap ms");
+  for (const scenario& s : SCENARIOS) {
+    for (sorter_mode mode : {OLD, TASKS, EXECUTIVE}) {
+      const bool legacy = mode == OLD;
+      result r = run(s, mode);
+      char reaction[16] = "-";
+      if (r.worst_reaction >= 0) std::snprintf(reaction, sizeof(reaction), "%.0f", r.worst_reaction);
+      std::printf("%-15s %-8s %5d %7d %6d %7d %9s %8.0f\n", legacy ? s.name : "", MODE_NAMES[mode], r.kept,
+                  r.thrown, r.wrong, r.missed, reaction, r.worst_gap);
+      // from the executive a ring is only looked for once a tick, on top of the optical's integration
+      const double react_limit = mode == EXECUTIVE ? 15 : 10;
+      if (!legacy && (r.wrong != 0 || r.missed != 0 || r.worst_reaction > react_limit || r.worst_gap > 10)) failures++;
+    }
+  }
+  std::printf(failures ? "sorter check FAILED\n" : "sorter check passed\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Logs many channels through telemetry::BinarySink with text printed into the same stream,
+// decodes the capture from the start and from partway in, and checks every sample comes back
+// exactly.  Then times a sample through BinarySink against lemlib::TelemetrySink's text path.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define FMT_HEADER_ONLY
+#include "fmt/args.h"
+#include "fmt/core.h"
+
+#include "binaryTelemetry.hpp"
+#include "pros/rtos.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/telemetry.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const char* CAPTURE = "/usd/telemetry_check.bin";
+const int CHANNELS = 20;
+const int FIELDS = 4;
+const std::uint32_t RUN_MS = 5000;
+
+float value(int channel, int sample, int field) { return std::sin(0.01f * sample + channel) * (field + 1) * 100.0f; }
+
+// lemlib::BaseSink::log and TelemetrySink::sendMessage, without the stdout buffer behind them
+std::string lemlib_telemetry(float a, float b, float c, float d) {
+  std::string message = fmt::format("{},{},{},{}", a, b, c, d);
+  fmt::dynamic_format_arg_store<fmt::format_context> args;
+  args.push_back(fmt::arg("time", pros::millis()));
+  args.push_back(fmt::arg("level", "INFO"));
+  args.push_back(fmt::arg("message", message));
+  std::string formatted = fmt::vformat("TELE_START{message}TELE_END", std::move(args));
+  return fmt::format("\033[s{}\033[u\033[0J", formatted);
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+
+  // Log every channel at 100 Hz for a while, with a text print now and then
+  sim::world().reset();
+  sim::world().sd_card_installed = true;
+  int logged = 0;
+  std::uint32_t dropped = 0;
+  sim::run(
+      [&] {
+        std::FILE* out = std::fopen(CAPTURE, "wb");
+        telemetry::BinarySink sink(out, 10, 1000);
+        for (int c = 0; c < CHANNELS; c++)
+          sink.addChannel(("channel" + std::to_string(c)).c_str(), {"a", "b", "c", "d"});
+        sink.start();
+        std::uint32_t now = pros::millis();
+        const std::uint32_t end = now + RUN_MS;
+        for (int sample = 0; now < end; sample++) {
+          for (int c = 0; c < CHANNELS; c++) {
+            float values[FIELDS];
+            for (int f = 0; f < FIELDS; f++) values[f] = value(c, sample, f);
+            sink.log(c, sample, values, FIELDS);
+            logged++;
+          }
+          if (sample % 37 == 0) std::fprintf(out, "[INFO] text from somewhere else %d\n", sample);
+          pros::Task::delay_until(&now, 10);
+        }
+        sink.flush();
+        dropped = sink.getDropped();
+        std::fclose(out);
+      },
+      RUN_MS + 1000);
+
+  // Decode and compare.  The sample number doubles as the time, so it says what each value was
+  sim::telemetry_capture capture;
+  if (!sim::telemetry_read("usd/telemetry_check.bin", capture)) {
+    std::printf("couldn't read the capture back\n");
+    return 1;
+  }
+  int decoded = 0, wrong = 0;
+  for (int c = 0; c < (int)capture.channels.size(); c++) {
+    const sim::telemetry_channel& channel = capture.channels[c];
+    if (channel.name != "channel" + std::to_string(c) || channel.fields.size() != FIELDS) wrong++;
+    for (int i = 0; i < channel.samples(); i++) {
+      for (int f = 0; f < FIELDS; f++)
+        if (channel.sample(i)[f] != value(c, channel.times[i], f)) wrong++;
+      decoded++;
+    }
+  }
+  std::printf("logged %d samples over %zu channels, %d decoded, %u dropped, %d wrong, %zu bytes of text skipped\n",
+              logged, capture.channels.size(), decoded, dropped, wrong, capture.skipped_bytes);
+  if (capture.channels.size() != CHANNELS || decoded + (int)dropped != logged || wrong != 0) failures++;
+
+  // A capture that starts partway through picks the names up from the next schema
+  std::FILE* file = std::fopen("usd/telemetry_check.bin", "rb");
+  std::vector<std::uint8_t> bytes;
+  int ch;
+  while ((ch = std::fgetc(file)) != EOF) bytes.push_back(ch);
+  std::fclose(file);
+  sim::telemetry_capture late;
+  late.feed(bytes.data() + bytes.size() / 3, bytes.size() - bytes.size() / 3);
+  int named = 0;
+  for (const sim::telemetry_channel& channel : late.channels) named += channel.name.rfind("channel", 0) == 0;
+  std::printf("capture joined a third of the way in: %d of %d channels named\n", named, CHANNELS);
+  if (named != CHANNELS) failures++;
+
+  // Cost of one 4 float sample, on this computer
+  const int REPEATS = 64 * 4000;
+  std::FILE* null = std::fopen("/dev/null", "wb");
+  telemetry::BinarySink sink(null, 10, 0);
+  int id = sink.addChannel("bench", {"a", "b", "c", "d"});
+  float values[FIELDS] = {12.345f, -67.891f, 179.5f, 0.25f};
+  // writing out isn't timed on either side, the text path has its own buffer task behind it
+  double binary_ns = 0.0;
+  for (int i = 0; i < REPEATS; i += 64) {
+    auto start = std::chrono::steady_clock::now();
+    for (int j = i; j < i + 64; j++) {
+      values[0] += 0.001f;
+      sink.log(id, j, values, FIELDS);
+    }
+    binary_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    sink.flush();
+  }
+  binary_ns /= REPEATS;
+  double binary_bytes = (double)sink.getWritten() / REPEATS;
+
+  std::size_t text_bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < REPEATS; i++) {
+    values[0] += 0.001f;
+    text_bytes += lemlib_telemetry(values[0], values[1], values[2], values[3]).size();
+  }
+  double text_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / REPEATS;
+  std::fclose(null);
+
+  std::printf("%-18s %8s %12s\n", "per sample", "ns", "bytes");
+  std::printf("%-18s %8.0f %12.1f\n", "lemlib text", text_ns, (double)text_bytes / REPEATS);
+  std::printf("%-18s %8.0f %12.1f\n", "BinarySink", binary_ns, binary_bytes);
+
+  std::printf(failures ? "telemetry check FAILED\n" : "telemetry check passed\n");
+  return failures ? 1 : 0;
+}
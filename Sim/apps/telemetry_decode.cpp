@@ -0,0 +1,63 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Turns a captured telemetry::BinarySink stream back into files, one CSV per channel or one
+// raw column file per field.
+//
+//   telemetry_decode capture.bin [--columns] [--prefix out/match1_]
+//
+// Reads stdin when the capture is "-", so a serial port can be piped straight in:
+//
+//   cat /dev/ttyACM1 | telemetry_decode - --prefix live_
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "sim/telemetry.hpp"
+
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  std::string prefix;
+  bool columns = false;
+  for (int i = 1; i < argc; i++) {
+    if (!std::strcmp(argv[i], "--columns"))
+      columns = true;
+    else if (!std::strcmp(argv[i], "--prefix") && i + 1 < argc)
+      prefix = argv[++i];
+    else
+      path = argv[i];
+  }
+  if (path == nullptr) {
+    std::fprintf(stderr, "usage: telemetry_decode capture.bin [--columns] [--prefix out/name_]\n");
+    return 2;
+  }
+
+  sim::telemetry_capture capture;
+  if (!std::strcmp(path, "-")) {
+    std::uint8_t buffer[4096];
+    std::size_t size;
+    while ((size = std::fread(buffer, 1, sizeof(buffer), stdin)) > 0) capture.feed(buffer, size);
+  } else if (!sim::telemetry_read(path, capture)) {
+    std::fprintf(stderr, "couldn't read %s\n", path);
+    return 1;
+  }
+
+  if (!(columns ? sim::telemetry_write_columns(capture, prefix) : sim::telemetry_write_csv(capture, prefix))) {
+    std::fprintf(stderr, "couldn't write the output files\n");
+    return 1;
+  }
+
+  for (std::size_t id = 0; id < capture.channels.size(); id++) {
+    const sim::telemetry_channel& c = capture.channels[id];
+    if (c.times.empty()) continue;
+    std::printf("%2zu %-24s %zu fields %8d samples  %u - %u ms\n", id, c.name.empty() ? "(no schema)" : c.name.c_str(),
+                c.fields.size(), c.samples(), c.times.front(), c.times.back());
+  }
+  std::printf("%zu records, %zu bad, %zu bytes skipped\n", capture.records, capture.bad_records,
+              capture.skipped_bytes);
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+namespace sim {
+
+/**
+ * Physical description of an arm on one motor.  Positions are motor degrees from where the arm
+ * rests, what the robot code reads off the motor after taring it there.
+ */
+struct arm_config {
+  int port = 3;                   // same port and reversal as the robot code
+  int gearset = 1;                // 0 red, 1 green, 2 blue
+  double ratio = 12.0;            // motor turns per arm turn
+  double mass = 0.6;              // kg, arm and whatever it's carrying
+  double center = 0.18;           // m from the pivot to the center of mass
+  double inertia = 0.025;         // kg m^2 about the pivot
+  double level = 900.0;           // motor degrees where the arm sticks straight out
+  double rest = 0.0;              // motor degrees where it sits on its hard stop
+};
+
+/**
+ * The EZ robot's lady brown: pros::Motor ladybrown(3), green, resting below level and scoring
+ * at 2000 just past vertical.
+ */
+arm_config ez_arm_config();
+
+/**
+ * Feedforward constants for an arm, mV = kg * cos(angle) + ks * sign(v) + kv * v + ka * a with
+ * v in motor deg/s and a in deg/s^2.  Apart from friction the model is linear, so these are what
+ * a perfect characterization of it would find.
+ */
+struct arm_feedforward_constants {
+  double kg, ks, kv, ka;
+};
+arm_feedforward_constants arm_feedforward(const arm_config& config);
+
+/**
+ * An arm swinging on one motor against gravity.
+ *
+ * The motor applies torque along its cartridge's torque/speed curve, limited by its current
+ * limit, and turns the arm through the gear ratio.  Gravity pulls the arm toward hanging
+ * straight down with mass * g * center * cos(angle), and it can't go below its hard stop at
+ * rest.  The result is written back to the motor.
+ */
+class ArmModel {
+ public:
+  explicit ArmModel(const arm_config& config);
+
+  /**
+   * Installs the motor and steps the model every sim::STEP_TIME.  The model has to outlive
+   * every following sim::run.
+   */
+  void attach();
+
+  /**
+   * Advances the arm.  attach() calls this for you.
+   *
+   * \param dt
+   *        step size in seconds
+   */
+  void step(double dt);
+
+  /**
+   * Motor degrees from rest.
+   */
+  double position() const;
+
+  /**
+   * Degrees above level.
+   */
+  double angle() const;
+
+  /**
+   * Motor deg/s.
+   */
+  double velocity() const;
+
+ private:
+  arm_config cfg;
+  double pos;
+  double vel = 0.0;
+};
+
+}  // namespace sim
@@ -0,0 +1,188 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <vector>
+
+namespace sim {
+
+const double GRAVITY = 9.81;
+const double INCH = 0.0254;
+
+/**
+ * Speeds below these count as stopped in the friction models.  Friction grows linearly up to
+ * these instead of switching sign, which keeps it from chattering around zero.
+ */
+const double STOPPED_SPEED = 0.02;  // m/s
+const double STOPPED_TURN = 0.1;    // rad/s
+const double STOPPED_RPM = 5.0;
+
+/**
+ * Gearbox friction inside each motor as a fraction of stall torque.  This is most of what
+ * stops a coasting drive.
+ */
+const double GEARBOX_FRICTION = 0.05;
+
+/**
+ * Direction friction acts in, -1 to 1.
+ *
+ * \param speed
+ *        current speed
+ * \param stopped
+ *        speed that counts as stopped
+ */
+inline double friction_sign(double speed, double stopped) {
+  double s = speed / stopped;
+  return s > 1.0 ? 1.0 : s < -1.0 ? -1.0 : s;
+}
+
+/**
+ * Stall torque of a cartridge's output shaft in newton meters at 12 volts.
+ *
+ * \param gearset
+ *        0 red, 1 green, 2 blue
+ */
+double gearset_stall_torque(int gearset);
+
+/**
+ * A tracking wheel on a rotation sensor.
+ *
+ * Offsets are where the wheel touches the field relative to the center of the robot, in
+ * inches, with x to the right and y forward.
+ */
+struct tracker_config {
+  int port = 0;                   // rotation sensor port, negative if the sensor reads backwards when mounted
+  bool horizontal = false;        // true if the wheel rolls sideways
+  double diameter = 2.0;          // inches
+  double x_offset = 0.0;
+  double y_offset = 0.0;
+};
+
+/**
+ * Physical description of a tank drive.  Distances are inches, everything else is SI.
+ */
+struct drive_config {
+  std::vector<int> left_ports;    // same ports and reversals as the robot code
+  std::vector<int> right_ports;
+  int gearset = 2;                // 0 red, 1 green, 2 blue
+  double wheel_diameter = 2.75;
+  double wheel_rpm = 450.0;       // wheel speed at cartridge free speed
+  double track_width = 13.5;
+
+  double mass = 6.8;              // kg
+  double inertia = 0.15;          // kg m^2 about the center
+  double rolling_friction = 0.03; // fraction of weight resisting forward motion
+  double scrub = 0.1;             // fraction of weight resisting turning, 0 for all omnis
+  double lateral_friction = 0.6;  // fraction of weight resisting sideways slide, low for all omnis
+
+  int imu_port = 0;               // 0 if there is no imu
+  std::vector<tracker_config> trackers;
+};
+
+/**
+ * The EZ robot: ez::Drive chassis({18, -19, -20}, {-8, 9, 10}, 6, 2.75, 450) with the
+ * rotation sensor trackers from EZ-Code-Odom/src/main.cpp.
+ */
+drive_config ez_drive_config();
+
+/**
+ * The LemLib robot: lemlib::Drivetrain(&leftMotors, &rightMotors, 13.5, NEW_275, 450, 2)
+ * with the rotation sensor trackers from Comp3-24-25-LemLib-Odom/src/main.cpp.
+ */
+drive_config lemlib_drive_config();
+
+/**
+ * Feedforward constants for driving straight, mV = ks * sign(v) + kv * v + ka * a with v in
+ * in/s and a in in/s^2.  Apart from friction the model is linear, so these are exactly what a
+ * perfect characterization of it would find while both sides get the same voltage.
+ */
+struct feedforward_constants {
+  double ks, kv, ka;
+};
+feedforward_constants drive_feedforward(const drive_config& config);
+
+/**
+ * Tank drive dynamics.
+ *
+ * Each motor applies torque along a linear torque/speed curve for its cartridge, limited by
+ * its current limit.  Wheel forces drive the robot's mass and moment of inertia against
+ * rolling friction, turning scrub and sideways slip, and the result is written back to the
+ * drive motors, the imu and the tracking wheels.
+ *
+ * Pose is in inches and degrees, with theta clockwise from +y to match EZ-Template and LemLib.
+ */
+class DriveModel {
+ public:
+  /**
+   * Creates a drive at the origin facing forward.
+   *
+   * \param config
+   *        physical description of the drive
+   */
+  explicit DriveModel(const drive_config& config);
+
+  /**
+   * Takes over the drive motors and installs the imu and trackers, then steps the model every
+   * sim::STEP_TIME of virtual time.  The model has to outlive every following sim::run.
+   */
+  void attach();
+
+  /**
+   * Advances the drive.  attach() calls this for you.
+   *
+   * \param dt
+   *        step size in seconds
+   */
+  void step(double dt);
+
+  /**
+   * Moves the robot without changing any sensors, like picking it up and setting it down.
+   *
+   * \param x
+   *        inches
+   * \param y
+   *        inches
+   * \param theta
+   *        degrees
+   */
+  void pose_set(double x, double y, double theta);
+
+  double x() const;
+  double y() const;
+  double theta() const;
+
+  /**
+   * Forward velocity of the center of the robot in inches per second.
+   */
+  double forward_velocity() const;
+
+  /**
+   * Sideways velocity of the center of the robot in inches per second, positive right.
+   */
+  double lateral_velocity() const;
+
+  /**
+   * Turning velocity in degrees per second, clockwise positive.
+   */
+  double angular_velocity() const;
+
+  const drive_config& config() const;
+
+ private:
+  drive_config cfg;
+  double pos_x = 0.0;             // meters
+  double pos_y = 0.0;
+  double heading = 0.0;           // radians, clockwise
+  double vel_forward = 0.0;       // meters per second
+  double vel_lateral = 0.0;
+  double vel_angular = 0.0;       // radians per second, clockwise
+  std::vector<double> tracker_travel;  // meters
+
+  double side_force(const std::vector<int>& ports, double wheel_velocity, double dt);
+};
+
+}  // namespace sim
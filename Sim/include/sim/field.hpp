@@ -0,0 +1,120 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace sim {
+
+class DriveModel;
+
+/**
+ * A straight edge a distance sensor can see, in inches.
+ */
+struct segment {
+  double x1, y1, x2, y2;
+};
+
+/**
+ * Everything on the field a distance sensor can hit, in the drive model's frame.
+ */
+struct field_map {
+  std::vector<segment> segments;
+
+  /**
+   * Adds the four sides of a rectangle.
+   */
+  void box_add(double left, double bottom, double right, double top);
+
+  /**
+   * Distance along a ray to the nearest segment, or -1 if it hits nothing.
+   *
+   * \param x
+   *        ray start, inches
+   * \param y
+   *        ray start, inches
+   * \param heading
+   *        radians clockwise from +y
+   */
+  double ray_cast(double x, double y, double heading) const;
+};
+
+/**
+ * The 12 foot field perimeter with the robot starting centered against one wall, facing the far
+ * one, the way skills starts.
+ *
+ * \param start_y
+ *        inches from the wall behind the robot to its tracking center
+ */
+field_map skills_field(double start_y);
+
+/**
+ * Distance sensors on a DriveModel looking at a field_map.
+ *
+ * Each sensor casts a ray from where it sits on the robot and reports the distance in mm, with
+ * noise that grows with distance like the real sensor's.  Readings only change every update_ms,
+ * and beyond max_mm or off the edge of the map the sensor reads 9999 like it does with nothing
+ * in view.
+ */
+class RangeModel {
+ public:
+  /**
+   * \param drive
+   *        drive model to take the pose from, has to outlive the range model
+   * \param field
+   *        what the sensors can see, has to outlive the range model
+   */
+  RangeModel(const DriveModel& drive, const field_map& field);
+
+  double noise_fraction = 0.015;  // standard deviation as a fraction of the distance
+  double noise_floor_mm = 3.0;    // and never less than this
+  int max_mm = 2000;
+  double update_ms = 33.0;
+
+  /**
+   * Adds a sensor.
+   *
+   * \param port
+   *        distance sensor port
+   * \param x
+   *        inches right of the drive's center
+   * \param y
+   *        inches forward of the drive's center
+   * \param angle
+   *        degrees clockwise from straight ahead
+   */
+  void sensor_add(int port, double x, double y, double angle);
+
+  /**
+   * Installs the sensors and steps the model every sim::STEP_TIME.  The model has to outlive
+   * every following sim::run.
+   */
+  void attach();
+
+  /**
+   * Updates the readings.  attach() calls this for you.
+   *
+   * \param dt
+   *        step size in seconds
+   */
+  void step(double dt);
+
+ private:
+  struct mount {
+    int port;
+    double x, y, angle;
+  };
+  const DriveModel& drive;
+  const field_map& field;
+  std::vector<mount> mounts;
+  double since_update = 1e9;    // seconds since the sensors last updated
+  std::mt19937 rng{1};
+};
+
+}  // namespace sim
@@ -0,0 +1,142 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace sim {
+
+/**
+ * What happened to a ring fed into an IntakeModel.
+ */
+enum ring_outcome { ON_HOOKS = 0,
+                    SCORED = 1,   // went over the top while the hooks were running
+                    FLUNG = 2,    // the hooks were cut while it was at the top
+                    DROPPED = 3 };  // carried back out the bottom
+
+struct ring_record {
+  double hue = 0.0;
+  std::uint32_t fed_ms = 0;     // virtual time it reached the bottom of the hooks
+  std::uint32_t seen_ms = 0;    // virtual time it first reached the sensor, 0 if it never did
+  ring_outcome outcome = ON_HOOKS;
+  bool on = false;              // made it onto the hooks
+  double entry = 0.0;           // hook travel when it got on, in degrees
+};
+
+/**
+ * A jam fed into an IntakeModel.
+ */
+struct jam_record {
+  std::uint32_t at_ms = 0;      // virtual time the hooks jam
+  int clears = 1;               // run backs it takes to free
+  double travel = 0.0;          // hook travel they jammed at
+  bool started = false;
+  int backed = 0;               // run backs so far
+  bool away = false;            // backed off, until the hooks come up to it again
+  std::uint32_t cleared_ms = 0; // virtual time it came free, 0 if it never did
+  double stalled_ms = 0.0;      // time the hooks spent driven up into it
+};
+
+/**
+ * A hook intake carrying rings past an optical sensor.
+ *
+ * Rings ride the hooks, so where each one is comes straight from the hook motor's position.
+ * The optical sensor on optical_port sees the ring in front of it, or the purple hooks when
+ * there isn't one, and like the real sensor only updates once per integration time.  Rings at
+ * the top when the hooks are cut to below eject_mv are flung, the rest go over the top and are
+ * scored, even if the hooks were coasting by then.
+ *
+ * A jam stops the hooks going up, stalled at full current, until they've been run back
+ * clear_travel degrees.  Some take more than one run back.
+ *
+ * Positions are hook motor degrees from where rings get on, in the direction the robot code
+ * runs the hooks to score.
+ */
+class IntakeModel {
+ public:
+  /**
+   * \param hooks_port
+   *        hook motor port, negative if the robot code reverses it
+   * \param optical_port
+   *        optical sensor port
+   */
+  IntakeModel(int hooks_port, int optical_port);
+
+  double sensor_at = 100.0;     // center of the sensor's view
+  double sensor_width = 50.0;   // hook travel a ring is in view for
+  double top = 305.0;           // where a stopped hook flings a ring
+  double top_width = 60.0;      // how far around top a ring can still be flung
+  double ring_gap = 120.0;      // closest two rings can be on the hooks
+  double eject_mv = 2000.0;     // hooks dropping below this count as cut
+  double clear_travel = 45.0;   // hooks have to run back this far to free a jam
+  double hook_hue = 300.0;
+  int hook_proximity = 40;
+  int ring_proximity = 255;
+
+  /**
+   * Puts a ring at the bottom of the hooks at a time in the run.  It gets on once the ring
+   * before it is ring_gap up the hooks.
+   *
+   * \param hue
+   *        0 red, 240 blue
+   * \param at_ms
+   *        ms after attach() to feed it
+   */
+  void feed(double hue, std::uint32_t at_ms);
+
+  /**
+   * Jams the hooks where they are at a time in the run, like a ring caught on the ramp.
+   *
+   * \param at_ms
+   *        ms after attach()
+   * \param clears
+   *        how many times the hooks have to be run back before it comes free
+   */
+  void jam(std::uint32_t at_ms, int clears = 1);
+
+  /**
+   * Installs the hook motor and optical sensor and steps the model every sim::STEP_TIME.  The
+   * model has to outlive every following sim::run.
+   */
+  void attach();
+
+  /**
+   * Advances the rings and the sensor.  attach() calls this for you.
+   *
+   * \param dt
+   *        step size in seconds
+   */
+  void step(double dt);
+
+  /**
+   * Hook travel in degrees, positive toward the top.
+   */
+  double travel() const;
+
+  /**
+   * Every ring fed so far, in the order they were fed.
+   */
+  const std::vector<ring_record>& rings() const;
+
+  /**
+   * Every jam, in the order they were added.
+   */
+  const std::vector<jam_record>& jams() const;
+
+ private:
+  int hooks;
+  int optical;
+  std::vector<ring_record> fed;
+  std::vector<jam_record> jammed;
+  std::size_t next_feed = 0;
+  std::uint32_t attached_ms = 0;
+  double since_update = 1e9;    // seconds since the sensor last updated
+  bool driving = false;
+};
+
+}  // namespace sim
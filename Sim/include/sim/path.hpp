@@ -0,0 +1,78 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "packedPath.hpp"
+#include "pathProfile.hpp"
+
+namespace sim {
+
+/**
+ * A path point the way lemlib::Chassis::follow reads it from a text asset.
+ */
+struct text_point {
+  float x, y, speed;
+};
+
+/**
+ * Parses a path.jerryio LemLib path the same way lemlib::Chassis::follow does, one "x, y, speed"
+ * line per point up to the endData line.
+ *
+ * \param text
+ *        contents of the .txt file
+ */
+std::vector<text_point> path_parse_text(const std::string& text);
+
+/**
+ * Packs path points into the format packedpath::Path reads, working out the distance along the
+ * path and the curvature at every point.
+ *
+ * \param points
+ *        the path, at least one point
+ * \param limits
+ *        what the drivetrain can do, to give the path a time profile that replaces the text's
+ *        speeds.  nullptr keeps the speeds as they are
+ *
+ * \return header followed by the points, empty if there were no points
+ */
+std::vector<std::uint8_t> path_pack(const std::vector<text_point>& points, const packedpath::Limits* limits = nullptr);
+
+/**
+ * A packed path loaded from a file, kept 4 byte aligned so packedpath::Path can read it.
+ */
+struct packed_path_file {
+  packed_path_file() = default;
+  packed_path_file(const packed_path_file&) = delete;  // path points into storage
+
+  std::vector<std::uint32_t> storage;
+  packedpath::Path path;
+};
+
+/**
+ * Returns the index of the point a follower stops at, the first one with speed 0.  path.jerryio
+ * puts a ghost point past it to look ahead to, which is never driven to.  The last point if none
+ * has speed 0.
+ */
+int path_end(const packedpath::Path& path);
+
+/**
+ * Reads a .path file made by path_pack, or packs a .txt path on the spot.
+ *
+ * \param path
+ *        file on the host, ending in .path or .txt
+ * \param out
+ *        filled with the path
+ *
+ * \return false if the file can't be read or isn't a path
+ */
+bool path_load(const std::string& path, packed_path_file& out);
+
+}  // namespace sim
@@ -0,0 +1,83 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sensorLog.hpp"
+
+namespace sim {
+
+/**
+ * A sensorlog::Recorder file loaded into memory.
+ */
+struct sensor_log {
+  sensorlog::Header header = {};
+  std::vector<std::uint32_t> times;         // ms, one per frame
+  std::vector<sensorlog::Value> values;     // header.channelCount per frame
+
+  int frames() const { return (int)times.size(); }
+  const sensorlog::Value* frame(int i) const { return &values[(std::size_t)i * header.channelCount]; }
+};
+
+/**
+ * Reads a log written by sensorlog::Recorder.  A frame cut off at the end of the file, which
+ * happens when the robot loses power, is ignored.
+ *
+ * \param path
+ *        file on the host
+ * \param out
+ *        filled with the log
+ *
+ * \return false if the file can't be read or isn't a sensor log
+ */
+bool sensor_log_read(const std::string& path, sensor_log& out);
+
+/**
+ * Plays a sensor log back through the simulated devices.
+ *
+ * Every STEP_TIME the latest frame is written into the world, so robot code reading the imu,
+ * rotation sensors and drive motors sees exactly what they reported on the robot at the same
+ * time into the recording.  Recorded values win over any tares made by the code being
+ * replayed, since the tares the robot made are already in the log.
+ */
+class SensorReplay {
+ public:
+  /**
+   * \param log
+   *        the log to play, has to outlive the replay
+   */
+  explicit SensorReplay(const sensor_log& log);
+
+  /**
+   * Installs the recorded devices and starts playing from the current virtual time.  The
+   * replay has to outlive every following sim::run.
+   */
+  void attach();
+
+  /**
+   * Writes the last frame at or before a time into the world.  attach() calls this for you.
+   *
+   * \param time_ms
+   *        ms into the recording
+   */
+  void apply(std::uint32_t time_ms);
+
+  /**
+   * Time of the last frame, ms into the recording.
+   */
+  std::uint32_t end_ms() const;
+
+ private:
+  const sensor_log& log;
+  std::uint32_t start_ms = 0;
+  int next = 0;
+};
+
+}  // namespace sim
@@ -0,0 +1,90 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace sim {
+
+/**
+ * Physics step used when the virtual clock advances, in seconds.
+ *
+ * Every time the clock moves forward it is done in slices of this size, and every step
+ * hook (see step_hook_add) is called once per slice.
+ */
+const double STEP_TIME = 0.001;
+
+/**
+ * Result of a simulated run.
+ */
+struct run_result {
+  std::uint32_t virtual_ms = 0;  // virtual time that passed during the run
+  double wall_ms = 0.0;          // host time that passed during the run
+  bool finished = false;         // true if the entry function returned before the limit
+  bool deadlocked = false;       // true if every task ended up blocked forever
+};
+
+/**
+ * Returns the virtual time in microseconds.
+ */
+std::uint64_t now_us();
+
+/**
+ * Returns the virtual time in milliseconds.
+ */
+std::uint32_t now_ms();
+
+/**
+ * Runs a function as the "main" PROS task using the virtual clock.
+ *
+ * Every pros::Task created before this call (including global tasks made during static
+ * initialization) is started alongside it.  Tasks only ever run one at a time and time only
+ * moves forward when every task is blocked, so pros::delay costs no wall time and the same
+ * program always produces the same result.
+ *
+ * When the entry returns or the limit is hit, every remaining task is unwound and the
+ * scheduler is left empty, so tasks made at static initialization only exist for the first
+ * run in a process.  Use run_isolated to run many routines from one program.
+ *
+ * \param entry
+ *        the code to run, normally initialize() followed by autonomous()
+ * \param limit_ms
+ *        virtual time limit, 15000 for a match autonomous
+ */
+run_result run(std::function<void()> entry, std::uint32_t limit_ms);
+
+/**
+ * Same as run, but forks first so every call starts from a freshly initialized program.
+ *
+ * Global devices, tasks and EZ-Template state are all rebuilt in the child, which makes it
+ * safe to sweep through many routines from one host program.
+ */
+run_result run_isolated(std::function<void()> entry, std::uint32_t limit_ms);
+
+/**
+ * Adds a function that is called every STEP_TIME of virtual time.
+ *
+ * This is how physics models plug into the clock.  Hooks are called in the order they were
+ * added, after the built in motor models have updated.
+ *
+ * \param hook
+ *        function taking the step size in seconds
+ */
+void step_hook_add(std::function<void(double)> hook);
+
+/**
+ * Removes every step hook.
+ */
+void step_hooks_clear();
+
+/**
+ * Returns how many times tasks were switched in the last run.  Useful for profiling the host.
+ */
+std::uint64_t context_switches();
+
+}  // namespace sim
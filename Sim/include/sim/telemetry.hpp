@@ -0,0 +1,83 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+/**
+ * Every sample of one telemetry::BinarySink channel.
+ */
+struct telemetry_channel {
+  std::string name;                  // empty until the channel's schema has been seen
+  std::vector<std::string> fields;   // names from the schema, or field0, field1, ... before it
+  std::vector<std::uint32_t> times;  // ms, one per sample
+  std::vector<float> values;         // fields.size() per sample
+
+  int samples() const { return (int)times.size(); }
+  const float* sample(int i) const { return &values[(std::size_t)i * fields.size()]; }
+};
+
+/**
+ * A telemetry::BinarySink stream decoded into channels.
+ */
+struct telemetry_capture {
+  std::vector<telemetry_channel> channels;  // indexed by channel id
+  std::size_t records = 0;                  // good records, schema and data
+  std::size_t bad_records = 0;              // bad COBS or CRC, or a sample that doesn't fit its schema
+  std::size_t skipped_bytes = 0;            // bytes that weren't part of a good record
+
+  /**
+   * Decodes more of a stream.  Bytes can arrive in any size pieces, a record split across two
+   * calls is put back together.
+   *
+   * \param data
+   *        the next bytes of the stream
+   * \param size
+   *        number of bytes
+   */
+  void feed(const std::uint8_t* data, std::size_t size);
+
+ private:
+  void record(const std::uint8_t* encoded, std::size_t size);
+
+  std::vector<std::uint8_t> pending;
+};
+
+/**
+ * Decodes a captured telemetry::BinarySink stream.  Anything that isn't a record, like text
+ * printed to the same serial port, is skipped.
+ *
+ * \param path
+ *        file on the host
+ * \param out
+ *        filled with the decoded channels
+ *
+ * \return false if the file can't be read
+ */
+bool telemetry_read(const std::string& path, telemetry_capture& out);
+
+/**
+ * Writes each channel to <prefix><channel>.csv, a time column then one column per field.
+ *
+ * \return false if a file couldn't be written
+ */
+bool telemetry_write_csv(const telemetry_capture& capture, const std::string& prefix);
+
+/**
+ * Writes each channel as raw little endian columns, <prefix><channel>.time.u32 then
+ * <prefix><channel>.<field>.f32 for each field, ready for numpy.fromfile.
+ *
+ * \return false if a file couldn't be written
+ */
+bool telemetry_write_columns(const telemetry_capture& capture, const std::string& prefix);
+
+}  // namespace sim
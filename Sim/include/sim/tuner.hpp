@@ -0,0 +1,177 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "sim/drive.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+
+/**
+ * How a simulated motion ended.  The first four match ez::exit_output.
+ */
+enum pid_exit { EXIT_RUNNING = 0,
+                EXIT_SMALL = 1,
+                EXIT_BIG = 2,
+                EXIT_VELOCITY = 3,
+                EXIT_TIMEOUT = 4 };
+
+/**
+ * Returns the name EZ-Template prints for an exit.
+ */
+const char* pid_exit_name(int exit);
+
+/**
+ * One set of PID constants, same meaning as ez::PID::Constants.
+ */
+struct pid_gains {
+  double kp = 0.0;
+  double ki = 0.0;
+  double kd = 0.0;
+  double start_i = 0.0;
+};
+
+/**
+ * Same meaning as ez::PID::exit_condition_set, times in ms.
+ */
+struct pid_exit_conditions {
+  int small_exit_time = 0;
+  double small_error = 0.0;
+  int big_exit_time = 0;
+  double big_error = 0.0;
+  int velocity_exit_time = 0;
+};
+
+/**
+ * Many independent ez::PID controllers stored as one array per field.
+ *
+ * compute() and exit_update() follow ez::PID::compute and ez::PID::exit_condition for every
+ * lane at once, in loops with no branches so the compiler can vectorize them.
+ */
+class BatchPID {
+ public:
+  /**
+   * \param lanes
+   *        how many controllers
+   */
+  explicit BatchPID(int lanes);
+
+  /**
+   * Sets the constants of one controller and clears its state.
+   */
+  void gains_set(int lane, const pid_gains& gains);
+
+  /**
+   * Runs every controller once.  Results are in output.
+   *
+   * \param target
+   *        one target per lane
+   * \param current
+   *        one sensor reading per lane
+   */
+  void compute(const double* target, const double* current);
+
+  /**
+   * Runs the exit conditions for every controller that hasn't exited yet.  Call once per
+   * ez::util::DELAY_TIME after compute().
+   */
+  void exit_update(const pid_exit_conditions& conditions);
+
+  int lanes;
+  std::vector<double> kp, ki, kd, start_i;
+  std::vector<double> output, error, integral, derivative, prev_error, prev_current;
+  std::vector<int> small_timer, big_timer, velocity_timer, exit;
+};
+
+/**
+ * Many independent copies of DriveModel's forward and turning dynamics, one array per field.
+ *
+ * Every motor on a side is assumed identical, and sideways slip is left out since straight
+ * drives, point turns and swings barely slide.  Both sides hold when commanded 0, like a drive
+ * in MOTOR_BRAKE_HOLD.
+ */
+class DriveBatch {
+ public:
+  DriveBatch(const drive_config& config, int lanes);
+
+  /**
+   * Advances every lane.
+   *
+   * \param left_mv
+   *        commanded voltage for the left side of each lane, same as pros::Motor::move_voltage
+   * \param right_mv
+   *        commanded voltage for the right side of each lane
+   * \param dt
+   *        step size in seconds
+   */
+  void step(const double* left_mv, const double* right_mv, double dt);
+
+  int lanes;
+  std::vector<double> forward;    // m/s
+  std::vector<double> angular;    // rad/s, clockwise
+  std::vector<double> heading;    // degrees, clockwise, what the imu reads
+  std::vector<double> left_in;    // wheel travel, what ez::Drive reads from the motors
+  std::vector<double> right_in;
+
+ private:
+  drive_config cfg;
+  std::vector<motor_state> left_motor, right_motor;
+  std::vector<double> left_applied, right_applied, left_powered, right_powered;
+  std::vector<double> left_rpm, right_rpm, left_deg, right_deg;
+};
+
+/**
+ * Which EZ-Template motion is being tuned.
+ */
+enum pid_motion { MOTION_DRIVE,   // pid_drive_set, left and right PID plus heading hold
+                  MOTION_TURN,    // pid_turn_set
+                  MOTION_SWING }; // pid_swing_set(LEFT_SWING, ...) with the right side holding
+
+/**
+ * Everything that stays the same between candidates.
+ */
+struct tune_setup {
+  pid_motion motion = MOTION_DRIVE;
+  drive_config drive;
+  std::vector<double> targets;         // inches for drives, degrees for turns and swings
+  int max_speed = 127;                 // out of 127
+  pid_exit_conditions exit;
+  pid_gains heading;                   // drive motions only
+  int timeout_ms = 4000;               // a motion still running after this is EXIT_TIMEOUT
+  int settle_window_ms = 300;          // keeps watching for overshoot after the exit
+  double overshoot_weight = 100.0;     // ms of score per inch or degree of overshoot
+};
+
+/**
+ * How one candidate did across every target.
+ */
+struct tune_result {
+  pid_gains gains;
+  double settle_ms = 0.0;              // mean time until the motion exited
+  double overshoot = 0.0;              // worst overshoot past any target
+  double final_error = 0.0;            // worst error at the end of the settle window
+  int exits[5] = {0, 0, 0, 0, 0};      // how many targets ended with each pid_exit
+  double score = 0.0;                  // lower is better
+};
+
+/**
+ * Simulates every candidate against every target, spread over threads.
+ *
+ * Results come back in the same order as the candidates, and don't depend on the thread count.
+ *
+ * \param setup
+ *        the motion to run
+ * \param candidates
+ *        constants to try
+ * \param threads
+ *        worker threads, 0 uses every core
+ */
+std::vector<tune_result> tune(const tune_setup& setup, const std::vector<pid_gains>& candidates, int threads);
+
+}  // namespace sim
@@ -0,0 +1,253 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace sim {
+
+/**
+ * Number of smart ports on a V5 brain.
+ */
+const int SMART_PORTS = 21;
+
+/**
+ * Number of three wire ports on the brain or an expander.
+ */
+const int ADI_PORTS = 8;
+
+/**
+ * Longest command latency World::command_latency_ms can model, in steps.
+ */
+const int MAX_COMMAND_LATENCY = 64;
+
+/**
+ * Which control mode a motor was last commanded with.
+ */
+enum motor_mode { VOLTAGE = 0,
+                  VELOCITY = 1,
+                  POSITION = 2 };
+
+/**
+ * Everything the simulator knows about one smart motor.
+ *
+ * Positions and velocities are for the output shaft of the cartridge, and are never
+ * reversed.  The pros::Motor wrappers handle reversing and encoder units.
+ */
+struct motor_state {
+  bool installed = false;
+  int gearset = 1;         // 0 red, 1 green, 2 blue
+  int encoder_units = 0;   // 0 degrees, 1 rotations, 2 counts
+  int brake_mode = 0;      // 0 coast, 1 brake, 2 hold
+  int current_limit = 2500;
+  int voltage_limit = 0;   // 0 is no limit
+
+  motor_mode mode = VOLTAGE;
+  double command_mv = 0.0;       // voltage mode command
+  double target_rpm = 0.0;       // velocity and position mode command
+  double target_deg = 0.0;       // position mode target
+  double hold_deg = 0.0;         // where a hold brake is holding
+
+  double applied_mv = 0.0;       // voltage the motor is actually applying this step
+  bool coasting = false;         // true when the motor is unpowered and free to spin
+  double position_deg = 0.0;     // output shaft position
+  double zero_deg = 0.0;         // position that reads as zero
+  double velocity_rpm = 0.0;     // output shaft velocity
+  double current_ma = 0.0;
+  double torque_nm = 0.0;
+  double temperature_c = 25.0;
+
+  double load_nm = 0.0;          // external load torque opposing motion, set by scenarios
+  bool plant_driven = false;     // true when a physics model owns the velocity of this motor
+  std::uint32_t commands = 0;    // how many move commands this motor has received
+
+  double command_history[MAX_COMMAND_LATENCY] = {};  // voltage commands, for command latency
+  int command_head = 0;
+};
+
+/**
+ * Inertial sensor state.  Rotation is clockwise positive, same as the real sensor.
+ */
+struct imu_state {
+  bool installed = false;
+  double rotation_deg = 0.0;      // unbounded physical yaw
+  double rotation_zero = 0.0;
+  double heading_zero = 0.0;
+  double pitch_deg = 0.0;
+  double roll_deg = 0.0;
+  double gyro_z_dps = 0.0;
+  double accel_x_g = 0.0;
+  double accel_y_g = 0.0;
+  double scale = 1.0;             // multiplier on reported rotation, real sensors are rarely 1.0
+  std::uint32_t data_period_ms = 0;  // rotation only changes this often, 0 for every step
+  double sampled_deg = 0.0;
+  std::uint32_t sampled_ms = UINT32_MAX;
+  std::uint32_t calibrate_until_ms = 0;
+};
+
+/**
+ * Rotation sensor state, in centidegrees like the real sensor.
+ */
+struct rotation_state {
+  bool installed = false;
+  bool reversed = false;
+  double position_cdeg = 0.0;     // unbounded physical position, not reversed
+  double zero_cdeg = 0.0;
+  double velocity_cdps = 0.0;
+};
+
+/**
+ * Optical sensor state.  Scenarios write these to feed rings past the sensor.
+ */
+struct optical_state {
+  bool installed = false;
+  double hue = 0.0;
+  double saturation = 0.0;
+  double brightness = 0.0;
+  int proximity = 0;
+  double red = 0.0;
+  double green = 0.0;
+  double blue = 0.0;
+  int led_pwm = 0;
+  bool gesture_enabled = false;
+  double integration_ms = 100.0;
+};
+
+/**
+ * Distance sensor state, in millimeters like the real sensor.
+ */
+struct distance_state {
+  bool installed = false;
+  int distance_mm = 9999;
+  int confidence = 63;
+  int object_size = 0;
+  double object_velocity = 0.0;
+};
+
+/**
+ * GPS sensor state, in meters and degrees like the real sensor.
+ */
+struct gps_state {
+  bool installed = false;
+  double x_m = 0.0;
+  double y_m = 0.0;
+  double heading_deg = 0.0;
+  double error_m = 0.02;
+};
+
+/**
+ * One three wire port.
+ */
+struct adi_state {
+  int config = 0;
+  int value = 0;
+  bool reversed = false;          // encoders only
+  bool last_press = false;        // buttons only, for get_new_press
+  std::uint32_t writes = 0;       // how many times the value was set
+};
+
+/**
+ * Controller state.  Scenarios script buttons and sticks through this.
+ */
+struct controller_state {
+  bool connected = true;
+  int analog[4] = {0, 0, 0, 0};
+  bool digital[12] = {};
+  bool last_digital[12] = {};
+};
+
+/**
+ * The simulated robot.  Holds every device by port and runs the built in motor model.
+ */
+class World {
+ public:
+  motor_state motors[SMART_PORTS];
+  imu_state imus[SMART_PORTS];
+  rotation_state rotations[SMART_PORTS];
+  optical_state opticals[SMART_PORTS];
+  distance_state distances[SMART_PORTS];
+  gps_state gps[SMART_PORTS];
+
+  /**
+   * Three wire ports.  Index 0 is the brain, 1 - 21 are expanders on that smart port.
+   */
+  adi_state adi[SMART_PORTS + 1][ADI_PORTS];
+
+  /**
+   * Three wire encoder counts, stored on the top port of each pair.
+   */
+  double adi_encoder_ticks[SMART_PORTS + 1][ADI_PORTS] = {};
+
+  controller_state controllers[2];
+
+  bool competition_connected = false;
+  bool competition_autonomous = false;
+  bool competition_disabled = false;
+  bool sd_card_installed = false;
+
+  /**
+   * How long a voltage command takes to reach the motor, like the smart port round trip on
+   * the real robot.  Whole steps, at most MAX_COMMAND_LATENCY.
+   */
+  std::uint32_t command_latency_ms = 0;
+
+  /**
+   * Prints brain screen and controller text to stdout when true.
+   */
+  bool echo_screen = false;
+
+  /**
+   * Advances every motor that isn't owned by a physics model.
+   *
+   * \param dt
+   *        step size in seconds
+   */
+  void step(double dt);
+
+  /**
+   * Puts every device back to how it was at power on.
+   */
+  void reset();
+};
+
+/**
+ * Returns the simulated robot.
+ */
+World& world();
+
+/**
+ * Converts a 1 indexed smart port (negative if reversed) to a 0 indexed array slot.
+ */
+inline int port_index(int port) { return (port < 0 ? -port : port) - 1; }
+
+/**
+ * Returns true if a smart port is in range.
+ */
+inline bool port_valid(int port) {
+  int p = port < 0 ? -port : port;
+  return p >= 1 && p <= SMART_PORTS;
+}
+
+/**
+ * Free speed of a cartridge's output shaft in rpm at 12 volts.
+ */
+inline double gearset_free_rpm(int gearset) { return gearset == 0 ? 100.0 : gearset == 2 ? 600.0 : 200.0; }
+
+/**
+ * Encoder counts per output shaft revolution.
+ */
+inline double gearset_ticks_per_rev(int gearset) { return gearset == 0 ? 1800.0 : gearset == 2 ? 300.0 : 900.0; }
+
+/**
+ * Runs a motor's built in velocity/position controller and returns the voltage it applies.
+ *
+ * This is shared with the physics models so a motor commanded with move_velocity or
+ * move_absolute behaves the same whether or not a chassis model owns it.
+ */
+double motor_controller_mv(motor_state& m, double dt);
+
+}  // namespace sim
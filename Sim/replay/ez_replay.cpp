@@ -0,0 +1,64 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Replays a sensor log from the EZ robot through ez::Drive's tracking task and prints the pose
+// every 10 ms as csv.
+//
+//   make bin/ez_replay EZ_SRC=path/to/EZ-Template/src
+//   bin/ez_replay usd/match.slog [--pose x y theta] > pose.csv
+//
+// Devices match EZ-Code-Odom/src/main.cpp.  Keep them in sync when the robot changes.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "EZ-Template/api.hpp"
+#include "sim/replay.hpp"
+#include "sim/scheduler.hpp"
+
+namespace {
+
+ez::Drive chassis({18, -19, -20}, {-8, 9, 10}, 6, 2.75, 450);
+ez::tracking_wheel horiz_tracker(5, 2, 6.0);
+ez::tracking_wheel vert_tracker(4, 2, 0.0);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s log.slog [--pose x y theta]\n", argv[0]);
+    return 1;
+  }
+  ez::pose start = {0, 0, 0};
+  for (int i = 2; i < argc - 3; i++)
+    if (!std::strcmp(argv[i], "--pose")) start = {std::atof(argv[i + 1]), std::atof(argv[i + 2]), std::atof(argv[i + 3])};
+
+  sim::sensor_log log;
+  if (!sim::sensor_log_read(argv[1], log)) {
+    std::fprintf(stderr, "couldn't read a sensor log from %s\n", argv[1]);
+    return 1;
+  }
+  sim::SensorReplay replay(log);
+  replay.attach();
+
+  std::printf("time_ms,x,y,theta\n");
+  sim::run(
+      [&] {
+        // Same setup as initialize(), ez_tracking_task runs in the drive's own task like on the robot
+        chassis.odom_tracker_front_set(&horiz_tracker);
+        chassis.odom_tracker_left_set(&vert_tracker);
+        chassis.odom_xyt_set(start.x, start.y, start.theta);
+        chassis.odom_enable(true);
+        std::uint32_t now = pros::millis();
+        while (pros::millis() <= replay.end_ms()) {
+          std::printf("%u,%.4f,%.4f,%.4f\n", pros::millis(), chassis.odom_x_get(), chassis.odom_y_get(), chassis.odom_theta_get());
+          pros::Task::delay_until(&now, ez::util::DELAY_TIME);
+        }
+      },
+      replay.end_ms() + 20);
+  return 0;
+}
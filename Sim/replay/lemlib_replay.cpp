@@ -0,0 +1,70 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Replays a sensor log from the LemLib robot through lemlib::update() and prints the pose every
+// 10 ms as csv.
+//
+//   make bin/lemlib_replay LEMLIB_SRC=path/to/LemLib/src
+//   bin/lemlib_replay usd/match.slog [--pose x y theta] > pose.csv
+//
+// Devices match Comp3-24-25-LemLib-Odom/src/main.cpp.  Keep them in sync when the robot changes.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "lemlib/api.hpp"
+#include "lemlib/chassis/odom.hpp"
+#include "sim/replay.hpp"
+#include "sim/scheduler.hpp"
+
+namespace {
+
+pros::MotorGroup leftMotors({-9, -3, -8}, pros::MotorGearset::blue);
+pros::MotorGroup rightMotors({19, 12, 18}, pros::MotorGearset::blue);
+pros::Imu imu(15);
+pros::Rotation horizontalEnc(1);
+pros::Rotation verticalEnc(-13);
+lemlib::TrackingWheel horizontal(&horizontalEnc, lemlib::Omniwheel::NEW_2, -6);
+lemlib::TrackingWheel vertical(&verticalEnc, lemlib::Omniwheel::NEW_2, -1);
+lemlib::Drivetrain drivetrain(&leftMotors, &rightMotors, 13.5, lemlib::Omniwheel::NEW_275, 450, 2);
+lemlib::OdomSensors sensors(&vertical, nullptr, &horizontal, nullptr, &imu);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s log.slog [--pose x y theta]\n", argv[0]);
+    return 1;
+  }
+  lemlib::Pose start(0, 0, 0);
+  for (int i = 2; i < argc - 3; i++)
+    if (!std::strcmp(argv[i], "--pose")) start = lemlib::Pose(std::atof(argv[i + 1]), std::atof(argv[i + 2]), std::atof(argv[i + 3]));
+
+  sim::sensor_log log;
+  if (!sim::sensor_log_read(argv[1], log)) {
+    std::fprintf(stderr, "couldn't read a sensor log from %s\n", argv[1]);
+    return 1;
+  }
+  sim::SensorReplay replay(log);
+  replay.attach();
+
+  std::printf("time_ms,x,y,theta\n");
+  sim::run(
+      [&] {
+        lemlib::setSensors(sensors, drivetrain);
+        lemlib::setPose(start);
+        std::uint32_t now = pros::millis();
+        while (pros::millis() <= replay.end_ms()) {
+          lemlib::update();
+          lemlib::Pose pose = lemlib::getPose();
+          std::printf("%u,%.4f,%.4f,%.4f\n", pros::millis(), pose.x, pose.y, pose.theta);
+          pros::Task::delay_until(&now, 10);
+        }
+      },
+      replay.end_ms() + 20);
+  return 0;
+}
@@ -0,0 +1,32 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Entry point for a whole robot program built with ROBOT_SRC, runs one match autonomous
+
+#include <cstdio>
+
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+extern "C" {
+void initialize(void);
+void autonomous(void);
+}
+
+int main() {
+  sim::world().competition_connected = true;
+  sim::world().competition_autonomous = true;
+  sim::world().echo_screen = true;
+  sim::run_result result = sim::run(
+      [] {
+        initialize();
+        autonomous();
+      },
+      15000);
+  std::printf("autonomous %s after %u ms virtual, %.1f ms wall\n", result.finished ? "finished" : "timed out",
+              result.virtual_ms, result.wall_ms);
+  return 0;
+}
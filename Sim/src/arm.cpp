@@ -0,0 +1,89 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/arm.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "sim/drive.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+namespace {
+
+// Time constant of an unloaded motor, same as world.cpp's.  The rotor and gearbox inertia at
+// the output shaft is what gives it this
+const double FREE_TAU = 0.05;
+
+double rad_per_s(double rpm) { return rpm * 2.0 * M_PI / 60.0; }
+
+double motor_inertia(int gearset) { return FREE_TAU * gearset_stall_torque(gearset) / rad_per_s(gearset_free_rpm(gearset)); }
+
+// Everything the motor turns, seen from its output shaft, in kg m^2
+double total_inertia(const arm_config& c) { return motor_inertia(c.gearset) + c.inertia / (c.ratio * c.ratio); }
+
+}  // namespace
+
+arm_config ez_arm_config() { return arm_config(); }
+
+arm_feedforward_constants arm_feedforward(const arm_config& config) {
+  // torque = stall * (mV / 12000 - rpm / free) - gearbox friction, and at the output shaft
+  // inertia * a = torque - gravity / ratio
+  const double stall = gearset_stall_torque(config.gearset);
+  arm_feedforward_constants c;
+  c.kg = 12000.0 * config.mass * GRAVITY * config.center / config.ratio / stall;
+  c.ks = 12000.0 * GEARBOX_FRICTION;
+  c.kv = 12000.0 / (gearset_free_rpm(config.gearset) * 6.0);
+  c.ka = 12000.0 * total_inertia(config) / stall * M_PI / 180.0;
+  return c;
+}
+
+ArmModel::ArmModel(const arm_config& config) : cfg(config), pos(config.rest) {}
+
+void ArmModel::attach() {
+  motor_state& m = world().motors[port_index(cfg.port)];
+  m.installed = true;
+  m.plant_driven = true;
+  m.position_deg = (cfg.port < 0 ? -1.0 : 1.0) * pos;
+  step_hook_add([this](double dt) { step(dt); });
+}
+
+void ArmModel::step(double dt) {
+  motor_state& m = world().motors[port_index(cfg.port)];
+  const double direction = cfg.port < 0 ? -1.0 : 1.0;
+  const double free_rpm = gearset_free_rpm(cfg.gearset);
+  const double stall = gearset_stall_torque(cfg.gearset);
+  const double rpm = vel / 6.0;
+
+  double torque = 0.0;
+  if (!m.coasting) {
+    const double limit = stall * std::min(1.0, m.current_limit / 2500.0);
+    torque = std::clamp(stall * (direction * m.applied_mv / 12000.0 - rpm / free_rpm), -limit, limit);
+  }
+  m.torque_nm = direction * torque;
+  m.current_ma = 2500.0 * std::fabs(torque) / stall;
+  torque -= GEARBOX_FRICTION * stall * friction_sign(rpm, STOPPED_RPM);
+  torque -= cfg.mass * GRAVITY * cfg.center * std::cos(angle() * M_PI / 180.0) / cfg.ratio;
+
+  vel += torque / total_inertia(cfg) * 180.0 / M_PI * dt;
+  pos += vel * dt;
+  if (pos < cfg.rest) {
+    pos = cfg.rest;
+    vel = std::max(0.0, vel);
+  }
+  m.velocity_rpm = direction * vel / 6.0;
+  m.position_deg = direction * pos;
+}
+
+double ArmModel::position() const { return pos; }
+
+double ArmModel::angle() const { return (pos - cfg.level) / cfg.ratio; }
+
+double ArmModel::velocity() const { return vel; }
+
+}  // namespace sim
@@ -0,0 +1,177 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/drive.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+
+double gearset_stall_torque(int gearset) { return gearset == 0 ? 2.1 : gearset == 2 ? 0.35 : 1.05; }
+
+drive_config ez_drive_config() {
+  drive_config c;
+  c.left_ports = {18, -19, -20};
+  c.right_ports = {-8, 9, 10};
+  c.gearset = 2;
+  c.wheel_diameter = 2.75;
+  c.wheel_rpm = 450.0;
+  c.track_width = 13.5;
+  c.imu_port = 6;
+  c.trackers = {
+      {5, true, 2.0, 0.0, 6.0},   // horiz_tracker(5, 2, 6.0)
+      {4, false, 2.0, 0.0, 0.0},  // vert_tracker(4, 2, 0.0)
+  };
+  return c;
+}
+
+drive_config lemlib_drive_config() {
+  drive_config c;
+  c.left_ports = {-9, -3, -8};
+  c.right_ports = {19, 12, 18};
+  c.gearset = 2;
+  c.wheel_diameter = 2.75;
+  c.wheel_rpm = 450.0;
+  c.track_width = 13.5;
+  c.lateral_friction = 0.5;  // horizontal drift of 2, all omnis
+  c.imu_port = 15;
+  c.trackers = {
+      {1, true, 2.125, 0.0, -6.0},    // horizontalEnc(1), NEW_2, offset -6
+      {-13, false, 2.125, -1.0, 0.0}, // verticalEnc(-13), NEW_2, offset -1
+  };
+  return c;
+}
+
+feedforward_constants drive_feedforward(const drive_config& config) {
+  // Per motor, torque = stall * (mV / 12000 - rpm / free) - gearbox friction.  Summed over the
+  // drive, and through the wheels to force, mass * a = force - rolling friction
+  const double free_rpm = gearset_free_rpm(config.gearset);
+  const double stall_torque = gearset_stall_torque(config.gearset);
+  const double ratio = config.wheel_rpm / free_rpm;
+  const double radius = config.wheel_diameter * INCH / 2.0;
+  const double motors = config.left_ports.size() + config.right_ports.size();
+  // newtons the whole drive pushes at stall
+  const double stall_force = motors * stall_torque / ratio / radius;
+  const double rpm_per_ips = INCH / (2.0 * M_PI * radius) * 60.0 / ratio;
+  feedforward_constants c;
+  c.kv = 12000.0 * rpm_per_ips / free_rpm;
+  c.ks = 12000.0 * (GEARBOX_FRICTION + config.rolling_friction * config.mass * GRAVITY / stall_force);
+  c.ka = 12000.0 * config.mass * INCH / stall_force;
+  return c;
+}
+
+DriveModel::DriveModel(const drive_config& config) : cfg(config), tracker_travel(config.trackers.size(), 0.0) {}
+
+void DriveModel::attach() {
+  World& w = world();
+  for (const std::vector<int>* side : {&cfg.left_ports, &cfg.right_ports}) {
+    for (int port : *side) {
+      motor_state& m = w.motors[port_index(port)];
+      m.installed = true;
+      m.plant_driven = true;
+      m.gearset = cfg.gearset;
+    }
+  }
+  if (cfg.imu_port != 0) w.imus[port_index(cfg.imu_port)].installed = true;
+  for (const tracker_config& t : cfg.trackers) w.rotations[port_index(t.port)].installed = true;
+  step_hook_add([this](double dt) { step(dt); });
+}
+
+// Sums the force one side of the drive puts on the ground, in newtons, and moves its motors
+double DriveModel::side_force(const std::vector<int>& ports, double wheel_velocity, double dt) {
+  double free_rpm = gearset_free_rpm(cfg.gearset);
+  double stall_torque = gearset_stall_torque(cfg.gearset);
+  double ratio = cfg.wheel_rpm / free_rpm;  // wheel turns per motor turn
+  double radius = cfg.wheel_diameter * INCH / 2.0;
+  double shaft_rpm = wheel_velocity / (2.0 * M_PI * radius) * 60.0 / ratio;
+
+  double force = 0.0;
+  for (int port : ports) {
+    motor_state& m = world().motors[port_index(port)];
+    double direction = port < 0 ? -1.0 : 1.0;
+    double rpm = direction * shaft_rpm;
+
+    double torque = 0.0;
+    if (!m.coasting) {
+      double limit = stall_torque * std::min(1.0, m.current_limit / 2500.0);
+      torque = std::clamp(stall_torque * (m.applied_mv / 12000.0 - rpm / free_rpm), -limit, limit);
+    }
+    torque -= GEARBOX_FRICTION * stall_torque * friction_sign(rpm, STOPPED_RPM);
+    m.torque_nm = torque;
+    m.current_ma = 2500.0 * std::fabs(torque) / stall_torque;
+    m.velocity_rpm = rpm;
+    m.position_deg += rpm * 6.0 * dt;
+
+    force += direction * torque / ratio / radius;
+  }
+  return force;
+}
+
+void DriveModel::step(double dt) {
+  double half_track = cfg.track_width * INCH / 2.0;
+  double weight = cfg.mass * GRAVITY;
+
+  // Forces from each side, friction opposes motion
+  double left = side_force(cfg.left_ports, vel_forward + vel_angular * half_track, dt);
+  double right = side_force(cfg.right_ports, vel_forward - vel_angular * half_track, dt);
+  double rolling = cfg.rolling_friction * weight * friction_sign(vel_forward, STOPPED_SPEED);
+  double scrub = cfg.scrub * weight * half_track / 2.0 * friction_sign(vel_angular, STOPPED_TURN);
+
+  double forward_accel = (left + right - rolling) / cfg.mass + vel_angular * vel_lateral;
+  double angular_accel = ((left - right) * half_track - scrub) / cfg.inertia;
+
+  // Sideways slip only happens when the wheels can't provide the centripetal force
+  double grip = cfg.lateral_friction * GRAVITY;
+  double friction = std::clamp(vel_angular * vel_forward - vel_lateral / dt, -grip, grip);
+  double lateral_accel = -vel_angular * vel_forward + friction;
+
+  vel_forward += forward_accel * dt;
+  vel_angular += angular_accel * dt;
+  vel_lateral += lateral_accel * dt;
+
+  heading += vel_angular * dt;
+  pos_x += (vel_forward * std::sin(heading) + vel_lateral * std::cos(heading)) * dt;
+  pos_y += (vel_forward * std::cos(heading) - vel_lateral * std::sin(heading)) * dt;
+
+  // Sensors
+  World& w = world();
+  if (cfg.imu_port != 0) {
+    imu_state& imu = w.imus[port_index(cfg.imu_port)];
+    imu.rotation_deg += vel_angular * dt * 180.0 / M_PI;
+    imu.gyro_z_dps = vel_angular * 180.0 / M_PI;
+    imu.accel_y_g = forward_accel / GRAVITY;
+    imu.accel_x_g = lateral_accel / GRAVITY;
+  }
+  for (std::size_t i = 0; i < cfg.trackers.size(); i++) {
+    const tracker_config& t = cfg.trackers[i];
+    double speed = t.horizontal ? vel_lateral + vel_angular * t.y_offset * INCH : vel_forward - vel_angular * t.x_offset * INCH;
+    tracker_travel[i] += speed * dt;
+    double cdeg_per_meter = 36000.0 / (M_PI * t.diameter * INCH) * (t.port < 0 ? -1.0 : 1.0);
+    rotation_state& r = w.rotations[port_index(t.port)];
+    r.position_cdeg = tracker_travel[i] * cdeg_per_meter;
+    r.velocity_cdps = speed * cdeg_per_meter;
+  }
+}
+
+void DriveModel::pose_set(double x, double y, double theta) {
+  pos_x = x * INCH;
+  pos_y = y * INCH;
+  heading = theta * M_PI / 180.0;
+}
+
+double DriveModel::x() const { return pos_x / INCH; }
+double DriveModel::y() const { return pos_y / INCH; }
+double DriveModel::theta() const { return heading * 180.0 / M_PI; }
+double DriveModel::forward_velocity() const { return vel_forward / INCH; }
+double DriveModel::lateral_velocity() const { return vel_lateral / INCH; }
+double DriveModel::angular_velocity() const { return vel_angular * 180.0 / M_PI; }
+const drive_config& DriveModel::config() const { return cfg; }
+
+}  // namespace sim
@@ -0,0 +1,81 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/field.hpp"
+
+#include <cmath>
+
+#include "sim/drive.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+
+void field_map::box_add(double left, double bottom, double right, double top) {
+  segments.push_back({left, bottom, right, bottom});
+  segments.push_back({right, bottom, right, top});
+  segments.push_back({right, top, left, top});
+  segments.push_back({left, top, left, bottom});
+}
+
+double field_map::ray_cast(double x, double y, double heading) const {
+  double dx = std::sin(heading);
+  double dy = std::cos(heading);
+  double nearest = -1.0;
+  for (const segment& s : segments) {
+    // solve start + t * direction = s1 + u * (s2 - s1)
+    double ex = s.x2 - s.x1;
+    double ey = s.y2 - s.y1;
+    double denom = dx * ey - dy * ex;
+    if (std::fabs(denom) < 1e-12) continue;
+    double t = ((s.x1 - x) * ey - (s.y1 - y) * ex) / denom;
+    double u = ((s.x1 - x) * dy - (s.y1 - y) * dx) / denom;
+    if (t <= 0.0 || u < 0.0 || u > 1.0) continue;
+    if (nearest < 0.0 || t < nearest) nearest = t;
+  }
+  return nearest;
+}
+
+field_map skills_field(double start_y) {
+  field_map f;
+  f.box_add(-72.0, -start_y, 72.0, 144.0 - start_y);
+  return f;
+}
+
+RangeModel::RangeModel(const DriveModel& drive, const field_map& field) : drive(drive), field(field) {}
+
+void RangeModel::sensor_add(int port, double x, double y, double angle) { mounts.push_back({port, x, y, angle}); }
+
+void RangeModel::attach() {
+  for (const mount& m : mounts) world().distances[port_index(m.port)].installed = true;
+  step_hook_add([this](double dt) { step(dt); });
+}
+
+void RangeModel::step(double dt) {
+  since_update += dt;
+  if (since_update * 1000.0 + 1e-9 < update_ms) return;
+  since_update = 0.0;
+  double theta = drive.theta() * M_PI / 180.0;
+  for (const mount& m : mounts) {
+    double x = drive.x() + m.x * std::cos(theta) + m.y * std::sin(theta);
+    double y = drive.y() - m.x * std::sin(theta) + m.y * std::cos(theta);
+    double hit = field.ray_cast(x, y, theta + m.angle * M_PI / 180.0);
+    distance_state& d = world().distances[port_index(m.port)];
+    double mm = hit * INCH * 1000.0;
+    if (hit < 0.0 || mm > max_mm) {
+      d.distance_mm = 9999;
+      d.confidence = 0;
+      continue;
+    }
+    std::normal_distribution<double> noise(0.0, std::fmax(noise_floor_mm, noise_fraction * mm));
+    d.distance_mm = (int)std::lround(std::fmax(0.0, mm + noise(rng)));
+    // the real sensor only reports confidence past 200 mm
+    d.confidence = d.distance_mm < 200 ? 63 : (int)std::lround(63.0 * (1.0 - 0.5 * mm / max_mm));
+    d.object_size = 200;
+  }
+}
+
+}  // namespace sim
@@ -0,0 +1,110 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/intake.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+
+IntakeModel::IntakeModel(int hooks_port, int optical_port) : hooks(hooks_port), optical(optical_port) {}
+
+void IntakeModel::feed(double hue, std::uint32_t at_ms) {
+  ring_record r;
+  r.hue = hue;
+  r.fed_ms = attached_ms + at_ms;
+  fed.push_back(r);
+}
+
+void IntakeModel::jam(std::uint32_t at_ms, int clears) {
+  jam_record j;
+  j.at_ms = attached_ms + at_ms;
+  j.clears = clears;
+  jammed.push_back(j);
+}
+
+void IntakeModel::attach() {
+  world().motors[port_index(hooks)].installed = true;
+  world().opticals[port_index(optical)].installed = true;
+  attached_ms = now_ms();
+  for (ring_record& r : fed) r.fed_ms += attached_ms;
+  for (jam_record& j : jammed) j.at_ms += attached_ms;
+  step_hook_add([this](double dt) { step(dt); });
+}
+
+double IntakeModel::travel() const { return (hooks < 0 ? -1.0 : 1.0) * world().motors[port_index(hooks)].position_deg; }
+
+void IntakeModel::step(double dt) {
+  motor_state& m = world().motors[port_index(hooks)];
+  std::uint32_t time = now_ms();
+
+  // A jam holds the hooks where it caught them until they've backed off it enough times
+  for (jam_record& j : jammed) {
+    if (j.cleared_ms != 0 || j.at_ms > time) continue;
+    const double sign = hooks < 0 ? -1.0 : 1.0;
+    if (!j.started) {
+      j.started = true;
+      j.travel = travel();
+    }
+    if (travel() >= j.travel) {
+      j.away = false;
+      m.position_deg = sign * j.travel;
+      if (sign * m.velocity_rpm > 0.0) m.velocity_rpm = 0.0;
+      const double up = std::max(0.0, sign * m.applied_mv / 12000.0);
+      m.current_ma = std::min((double)m.current_limit, 2500.0 * up);
+      if (up > 0.0) j.stalled_ms += dt * 1000.0;
+    } else if (j.travel - travel() >= clear_travel && !j.away) {
+      // counts once per run back, the ring catches again if the hooks come back up to it
+      j.away = true;
+      if (++j.backed == j.clears) j.cleared_ms = time;
+    }
+    break;
+  }
+
+  double now = travel();
+  bool stopping = driving && (hooks < 0 ? -1.0 : 1.0) * m.applied_mv < eject_mv;
+  driving = (hooks < 0 ? -1.0 : 1.0) * m.applied_mv >= eject_mv;
+
+  while (next_feed < fed.size() && fed[next_feed].fed_ms <= time &&
+         (next_feed == 0 || now - fed[next_feed - 1].entry >= ring_gap)) {
+    fed[next_feed].on = true;
+    fed[next_feed++].entry = now;
+  }
+
+  const ring_record* in_view = nullptr;
+  for (std::size_t i = 0; i < next_feed; i++) {
+    ring_record& r = fed[i];
+    if (r.outcome != ON_HOOKS) continue;
+    double at = now - r.entry;
+    if (std::fabs(at - sensor_at) < sensor_width / 2) {
+      in_view = &r;
+      if (r.seen_ms == 0) r.seen_ms = time;
+    }
+    if (std::fabs(at - top) < top_width / 2 && stopping) r.outcome = FLUNG;
+    else if (at > top + top_width / 2) r.outcome = SCORED;
+    else if (at < -1.0) r.outcome = DROPPED;
+  }
+
+  // The sensor only has a new reading once per integration time
+  optical_state& o = world().opticals[port_index(optical)];
+  since_update += dt;
+  if (since_update * 1000.0 + 1e-9 < o.integration_ms) return;
+  since_update = 0.0;
+  o.hue = in_view ? in_view->hue : hook_hue;
+  o.proximity = in_view ? ring_proximity : hook_proximity;
+  o.saturation = in_view ? 0.8 : 0.5;
+  o.brightness = 0.3;
+}
+
+const std::vector<ring_record>& IntakeModel::rings() const { return fed; }
+
+const std::vector<jam_record>& IntakeModel::jams() const { return jammed; }
+
+}  // namespace sim
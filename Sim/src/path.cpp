@@ -0,0 +1,85 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/path.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+namespace sim {
+
+std::vector<text_point> path_parse_text(const std::string& text) {
+  std::vector<text_point> points;
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.rfind("endData", 0) == 0) break;
+    text_point p;
+    if (std::sscanf(line.c_str(), "%f , %f , %f", &p.x, &p.y, &p.speed) == 3) points.push_back(p);
+  }
+  return points;
+}
+
+std::vector<std::uint8_t> path_pack(const std::vector<text_point>& points, const packedpath::Limits* limits) {
+  if (points.empty()) return {};
+  std::vector<packedpath::Point> packed(points.size());
+  double distance = 0.0;
+  for (std::size_t i = 0; i < points.size(); i++) {
+    if (i > 0) distance += std::hypot(points[i].x - points[i - 1].x, points[i].y - points[i - 1].y);
+    packed[i] = {points[i].x, points[i].y, points[i].speed, (float)distance, 0.0f, 0.0f, 0.0f, 0.0f};
+  }
+  // signed curvature of the circle through each point and its neighbours, left turns positive
+  for (std::size_t i = 1; i + 1 < points.size(); i++) {
+    const text_point& a = points[i - 1];
+    const text_point& b = points[i];
+    const text_point& c = points[i + 1];
+    double cross = (double)(b.x - a.x) * (c.y - b.y) - (double)(b.y - a.y) * (c.x - b.x);
+    double lengths = std::hypot(b.x - a.x, b.y - a.y) * std::hypot(c.x - b.x, c.y - b.y) * std::hypot(c.x - a.x, c.y - a.y);
+    packed[i].curvature = lengths > 0.0 ? (float)(2.0 * cross / lengths) : 0.0f;
+  }
+  const float duration = limits != nullptr ? packedpath::timeProfile(packed.data(), packed.size(), *limits) : 0.0f;
+
+  packedpath::Header header = {};
+  std::memcpy(header.magic, packedpath::MAGIC, sizeof(packedpath::MAGIC));
+  header.version = packedpath::VERSION;
+  header.pointSize = sizeof(packedpath::Point);
+  header.count = packed.size();
+  header.length = distance;
+  header.duration = duration;
+  std::vector<std::uint8_t> out(sizeof(header) + packed.size() * sizeof(packedpath::Point));
+  std::memcpy(out.data(), &header, sizeof(header));
+  std::memcpy(out.data() + sizeof(header), packed.data(), packed.size() * sizeof(packedpath::Point));
+  return out;
+}
+
+bool path_load(const std::string& path, packed_path_file& out) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) return false;
+  std::string bytes;
+  char buffer[4096];
+  std::size_t size;
+  while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0) bytes.append(buffer, size);
+  std::fclose(file);
+
+  if (path.size() > 4 && path.compare(path.size() - 4, 4, ".txt") == 0) {
+    std::vector<std::uint8_t> packed = path_pack(path_parse_text(bytes));
+    bytes.assign(packed.begin(), packed.end());
+  }
+  out.storage.assign((bytes.size() + 3) / 4, 0);
+  std::memcpy(out.storage.data(), bytes.data(), bytes.size());
+  out.path = packedpath::Path(out.storage.data(), bytes.size());
+  return out.path.isValid();
+}
+
+int path_end(const packedpath::Path& path) {
+  for (int i = 0; i < path.size(); i++)
+    if (path[i].speed == 0) return i;
+  return path.size() - 1;
+}
+
+}  // namespace sim
@@ -0,0 +1,166 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host version of the three wire port classes robot code uses, backed by sim::world()
+
+#include <cerrno>
+#include <cmath>
+
+#include "pros/adi.hpp"
+#include "pros/error.h"
+#include "sim/world.hpp"
+
+namespace pros {
+namespace adi {
+namespace {
+
+// Smart port number the brain's own three wire ports report as
+const std::uint8_t INTERNAL_PORT = 22;
+
+// Accepts 1-8, 'a'-'h' or 'A'-'H', returns 0-7 or -1
+int adi_index(std::uint8_t port) {
+  if (port >= 'a' && port <= 'h') return port - 'a';
+  if (port >= 'A' && port <= 'H') return port - 'A';
+  if (port >= 1 && port <= sim::ADI_PORTS) return port - 1;
+  return -1;
+}
+
+// The brain is slot 0 of World::adi, expanders use their smart port
+int expander_index(std::uint8_t smart_port) {
+  if (smart_port == INTERNAL_PORT || smart_port == 0) return 0;
+  return sim::port_valid(smart_port) ? smart_port : -1;
+}
+
+sim::adi_state* state(std::uint8_t smart_port, std::uint8_t adi_port) {
+  int expander = expander_index(smart_port);
+  int index = adi_index(adi_port);
+  if (expander < 0 || index < 0) {
+    errno = ENXIO;
+    return nullptr;
+  }
+  return &sim::world().adi[expander][index];
+}
+
+}  // namespace
+
+/////
+// Port
+/////
+Port::Port(std::uint8_t adi_port, adi_port_config_e_t type) : _smart_port(INTERNAL_PORT), _adi_port(adi_port) {
+  if (type != E_ADI_TYPE_UNDEFINED) set_config(type);
+}
+
+Port::Port(ext_adi_port_pair_t port_pair, adi_port_config_e_t type) : _smart_port(port_pair.first), _adi_port(port_pair.second) {
+  if (type != E_ADI_TYPE_UNDEFINED) set_config(type);
+}
+
+std::int32_t Port::get_config() const {
+  sim::adi_state* s = state(_smart_port, _adi_port);
+  return s ? s->config : PROS_ERR;
+}
+
+std::int32_t Port::get_value() const {
+  sim::adi_state* s = state(_smart_port, _adi_port);
+  return s ? s->value : PROS_ERR;
+}
+
+std::int32_t Port::set_config(adi_port_config_e_t type) const {
+  sim::adi_state* s = state(_smart_port, _adi_port);
+  if (!s) return PROS_ERR;
+  s->config = type;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Port::set_value(std::int32_t value) const {
+  sim::adi_state* s = state(_smart_port, _adi_port);
+  if (!s) return PROS_ERR;
+  s->value = value;
+  s->writes++;
+  return PROS_SUCCESS;
+}
+
+ext_adi_port_tuple_t Port::get_port() const { return ext_adi_port_tuple_t(_smart_port, _adi_port, PROS_ERR_BYTE); }
+
+/////
+// DigitalOut
+/////
+DigitalOut::DigitalOut(std::uint8_t adi_port, bool init_state) : Port(adi_port, E_ADI_DIGITAL_OUT) { set_value(init_state); }
+
+DigitalOut::DigitalOut(ext_adi_port_pair_t port_pair, bool init_state) : Port(port_pair, E_ADI_DIGITAL_OUT) { set_value(init_state); }
+
+/////
+// DigitalIn
+/////
+DigitalIn::DigitalIn(std::uint8_t adi_port) : Port(adi_port, E_ADI_DIGITAL_IN) {}
+
+DigitalIn::DigitalIn(ext_adi_port_pair_t port_pair) : Port(port_pair, E_ADI_DIGITAL_IN) {}
+
+std::int32_t DigitalIn::get_new_press() const {
+  sim::adi_state* s = state(_smart_port, _adi_port);
+  if (!s) return PROS_ERR;
+  bool pressed = s->value && !s->last_press;
+  s->last_press = s->value;
+  return pressed;
+}
+
+/////
+// Encoder
+/////
+Encoder::Encoder(std::uint8_t adi_port_top, std::uint8_t adi_port_bottom, bool reversed)
+    : Port(adi_port_top, E_ADI_LEGACY_ENCODER), _port_pair(INTERNAL_PORT, adi_port_top) {
+  (void)adi_port_bottom;
+  sim::adi_state* s = state(_smart_port, _adi_port);
+  if (s) s->reversed = reversed;
+}
+
+Encoder::Encoder(ext_adi_port_tuple_t port_tuple, bool reversed)
+    : Port(ext_adi_port_pair_t(std::get<0>(port_tuple), std::get<1>(port_tuple)), E_ADI_LEGACY_ENCODER),
+      _port_pair(std::get<0>(port_tuple), std::get<1>(port_tuple)) {
+  sim::adi_state* s = state(_smart_port, _adi_port);
+  if (s) s->reversed = reversed;
+}
+
+std::int32_t Encoder::reset() const {
+  int expander = expander_index(_smart_port), index = adi_index(_adi_port);
+  if (expander < 0 || index < 0) return PROS_ERR;
+  sim::world().adi_encoder_ticks[expander][index] = 0.0;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Encoder::get_value() const {
+  int expander = expander_index(_smart_port), index = adi_index(_adi_port);
+  if (expander < 0 || index < 0) return PROS_ERR;
+  double ticks = sim::world().adi_encoder_ticks[expander][index];
+  return (std::int32_t)std::lround(sim::world().adi[expander][index].reversed ? -ticks : ticks);
+}
+
+ext_adi_port_tuple_t Encoder::get_port() const { return ext_adi_port_tuple_t(_smart_port, _adi_port, _adi_port + 1); }
+
+/////
+// Pneumatics
+/////
+Pneumatics::Pneumatics(std::uint8_t adi_port, bool start_extended, bool extended_is_low)
+    : DigitalOut(adi_port, start_extended != extended_is_low), state(start_extended), extended_is_low(extended_is_low) {}
+
+Pneumatics::Pneumatics(ext_adi_port_pair_t port_pair, bool start_extended, bool extended_is_low)
+    : DigitalOut(port_pair, start_extended != extended_is_low), state(start_extended), extended_is_low(extended_is_low) {}
+
+std::int32_t Pneumatics::extend() {
+  state = true;
+  return set_value(!extended_is_low);
+}
+
+std::int32_t Pneumatics::retract() {
+  state = false;
+  return set_value(extended_is_low);
+}
+
+std::int32_t Pneumatics::toggle() { return state ? retract() : extend(); }
+
+bool Pneumatics::is_extended() const { return state; }
+
+}  // namespace adi
+}  // namespace pros
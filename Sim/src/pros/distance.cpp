@@ -0,0 +1,35 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host version of pros::Distance backed by sim::world()
+
+#include "pros/distance.hpp"
+#include "sim/world.hpp"
+
+namespace pros {
+inline namespace v5 {
+namespace {
+
+sim::distance_state& state(std::uint8_t port) { return sim::world().distances[sim::port_index(port)]; }
+
+}  // namespace
+
+Distance::Distance(const std::uint8_t port) : Device(port, DeviceType::distance) { state(_port).installed = true; }
+
+std::vector<Distance> Distance::get_all_devices() {
+  std::vector<Distance> out;
+  for (std::uint8_t port = 1; port <= sim::SMART_PORTS; port++)
+    if (sim::world().distances[port - 1].installed) out.push_back(Distance(port));
+  return out;
+}
+
+std::int32_t Distance::get() { return state(_port).distance_mm; }
+std::int32_t Distance::get_distance() { return state(_port).distance_mm; }
+std::int32_t Distance::get_confidence() { return state(_port).confidence; }
+std::int32_t Distance::get_object_size() { return state(_port).object_size; }
+double Distance::get_object_velocity() { return state(_port).object_velocity; }
+}  // namespace v5
+}  // namespace pros
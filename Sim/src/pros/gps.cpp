@@ -0,0 +1,84 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host version of pros::Gps backed by sim::world().  Orientation other than heading and the
+// gyro and accelerometer always read zero.
+
+#include <cmath>
+
+#include "pros/error.h"
+#include "pros/gps.hpp"
+#include "sim/world.hpp"
+
+namespace pros {
+inline namespace v5 {
+namespace {
+
+sim::gps_state& state(std::uint8_t port) { return sim::world().gps[sim::port_index(port)]; }
+
+}  // namespace
+
+std::int32_t Gps::initialize_full(double xInitial, double yInitial, double headingInitial, double xOffset,
+                                  double yOffset) const {
+  set_offset(xOffset, yOffset);
+  return set_position(xInitial, yInitial, headingInitial);
+}
+
+std::int32_t Gps::set_offset(double, double) const {
+  state(_port).installed = true;
+  return PROS_SUCCESS;
+}
+
+std::vector<Gps> Gps::get_all_devices() {
+  std::vector<Gps> out;
+  for (std::uint8_t port = 1; port <= sim::SMART_PORTS; port++)
+    if (sim::world().gps[port - 1].installed) out.push_back(Gps(port));
+  return out;
+}
+
+pros::gps_position_s_t Gps::get_offset() const { return {0.0, 0.0}; }
+
+std::int32_t Gps::set_position(double xInitial, double yInitial, double headingInitial) const {
+  sim::gps_state& s = state(_port);
+  s.installed = true;
+  s.x_m = xInitial;
+  s.y_m = yInitial;
+  s.heading_deg = headingInitial;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Gps::set_data_rate(std::uint32_t) const { return PROS_SUCCESS; }
+
+double Gps::get_error() const { return state(_port).error_m; }
+
+pros::gps_status_s_t Gps::get_position_and_orientation() const {
+  const sim::gps_state& s = state(_port);
+  return {s.x_m, s.y_m, 0.0, 0.0, s.heading_deg};
+}
+
+pros::gps_position_s_t Gps::get_position() const { return {state(_port).x_m, state(_port).y_m}; }
+double Gps::get_position_x() const { return state(_port).x_m; }
+double Gps::get_position_y() const { return state(_port).y_m; }
+
+pros::gps_orientation_s_t Gps::get_orientation() const { return {0.0, 0.0, state(_port).heading_deg}; }
+double Gps::get_pitch() const { return 0.0; }
+double Gps::get_roll() const { return 0.0; }
+double Gps::get_yaw() const { return state(_port).heading_deg; }
+double Gps::get_heading() const { return std::fmod(std::fmod(state(_port).heading_deg, 360.0) + 360.0, 360.0); }
+double Gps::get_heading_raw() const { return state(_port).heading_deg; }
+
+pros::gps_gyro_s_t Gps::get_gyro_rate() const { return {0.0, 0.0, 0.0}; }
+double Gps::get_gyro_rate_x() const { return 0.0; }
+double Gps::get_gyro_rate_y() const { return 0.0; }
+double Gps::get_gyro_rate_z() const { return 0.0; }
+
+pros::gps_accel_s_t Gps::get_accel() const { return {0.0, 0.0, 0.0}; }
+double Gps::get_accel_x() const { return 0.0; }
+double Gps::get_accel_y() const { return 0.0; }
+double Gps::get_accel_z() const { return 0.0; }
+
+}  // namespace v5
+}  // namespace pros
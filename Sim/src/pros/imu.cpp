@@ -0,0 +1,224 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host version of pros::Imu backed by sim::world()
+
+#include <cerrno>
+#include <cmath>
+
+#include "pros/error.h"
+#include "pros/imu.hpp"
+#include "pros/rtos.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace pros {
+inline namespace v5 {
+namespace {
+
+// How long a reset keeps the sensor calibrating, same as the real sensor
+const std::uint32_t CALIBRATION_MS = 2000;
+
+// A sensor is plugged in as soon as robot code talks to it
+sim::imu_state& state(std::uint8_t port) {
+  sim::imu_state& s = sim::world().imus[sim::port_index(port)];
+  s.installed = true;
+  return s;
+}
+
+bool calibrating(const sim::imu_state& s) { return sim::now_ms() < s.calibrate_until_ms; }
+
+// Rotation as the sensor measures it, before any tares, only as fresh as its last update
+double raw_rotation(sim::imu_state& s) {
+  if (s.data_period_ms == 0) return s.rotation_deg * s.scale;
+  std::uint32_t now = sim::now_ms();
+  std::uint32_t update = now - now % s.data_period_ms;
+  if (update != s.sampled_ms) {
+    s.sampled_deg = s.rotation_deg;
+    s.sampled_ms = update;
+  }
+  return s.sampled_deg * s.scale;
+}
+
+double wrap_360(double angle) {
+  angle = std::fmod(angle, 360.0);
+  return angle < 0.0 ? angle + 360.0 : angle;
+}
+
+double wrap_180(double angle) {
+  angle = wrap_360(angle);
+  return angle > 180.0 ? angle - 360.0 : angle;
+}
+
+}  // namespace
+
+#define IMU_READY(s, err)    \
+  do {                       \
+    if (calibrating(s)) {    \
+      errno = EAGAIN;        \
+      return err;            \
+    }                        \
+  } while (0)
+
+Imu Imu::get_imu() {
+  for (std::uint8_t port = 1; port <= sim::SMART_PORTS; port++)
+    if (sim::world().imus[port - 1].installed) return Imu(port);
+  errno = ENODEV;
+  return Imu(PROS_ERR_BYTE);
+}
+
+std::vector<Imu> Imu::get_all_devices() {
+  std::vector<Imu> out;
+  for (std::uint8_t port = 1; port <= sim::SMART_PORTS; port++)
+    if (sim::world().imus[port - 1].installed) out.push_back(Imu(port));
+  return out;
+}
+
+std::int32_t Imu::reset(bool blocking) const {
+  sim::imu_state& s = state(_port);
+  s.calibrate_until_ms = sim::now_ms() + CALIBRATION_MS;
+  s.rotation_zero = raw_rotation(s);
+  s.heading_zero = raw_rotation(s);
+  if (blocking) pros::delay(CALIBRATION_MS);
+  return PROS_SUCCESS;
+}
+
+std::int32_t Imu::set_data_rate(std::uint32_t rate) const {
+  state(_port).data_period_ms = rate;
+  return PROS_SUCCESS;
+}
+
+double Imu::get_rotation() const {
+  sim::imu_state& s = state(_port);
+  IMU_READY(s, PROS_ERR_F);
+  return raw_rotation(s) - s.rotation_zero;
+}
+
+double Imu::get_heading() const {
+  sim::imu_state& s = state(_port);
+  IMU_READY(s, PROS_ERR_F);
+  return wrap_360(raw_rotation(s) - s.heading_zero);
+}
+
+pros::quaternion_s_t Imu::get_quaternion() const {
+  pros::euler_s_t e = get_euler();
+  double cy = std::cos(e.yaw * M_PI / 360.0), sy = std::sin(e.yaw * M_PI / 360.0);
+  double cp = std::cos(e.pitch * M_PI / 360.0), sp = std::sin(e.pitch * M_PI / 360.0);
+  double cr = std::cos(e.roll * M_PI / 360.0), sr = std::sin(e.roll * M_PI / 360.0);
+  pros::quaternion_s_t q;
+  q.w = cr * cp * cy + sr * sp * sy;
+  q.x = sr * cp * cy - cr * sp * sy;
+  q.y = cr * sp * cy + sr * cp * sy;
+  q.z = cr * cp * sy - sr * sp * cy;
+  return q;
+}
+
+pros::euler_s_t Imu::get_euler() const {
+  pros::euler_s_t e;
+  e.pitch = get_pitch();
+  e.roll = get_roll();
+  e.yaw = get_yaw();
+  return e;
+}
+
+double Imu::get_pitch() const {
+  sim::imu_state& s = state(_port);
+  IMU_READY(s, PROS_ERR_F);
+  return s.pitch_deg;
+}
+
+double Imu::get_roll() const {
+  sim::imu_state& s = state(_port);
+  IMU_READY(s, PROS_ERR_F);
+  return s.roll_deg;
+}
+
+double Imu::get_yaw() const {
+  sim::imu_state& s = state(_port);
+  IMU_READY(s, PROS_ERR_F);
+  return wrap_180(raw_rotation(s) - s.heading_zero);
+}
+
+pros::imu_gyro_s_t Imu::get_gyro_rate() const {
+  sim::imu_state& s = state(_port);
+  pros::imu_gyro_s_t g = {0.0, 0.0, s.gyro_z_dps * s.scale};
+  return g;
+}
+
+pros::imu_accel_s_t Imu::get_accel() const {
+  sim::imu_state& s = state(_port);
+  pros::imu_accel_s_t a = {s.accel_x_g, s.accel_y_g, 1.0};
+  return a;
+}
+
+std::int32_t Imu::tare_rotation() const { return set_rotation(0.0); }
+std::int32_t Imu::tare_heading() const { return set_heading(0.0); }
+std::int32_t Imu::tare_pitch() const { return set_pitch(0.0); }
+std::int32_t Imu::tare_yaw() const { return set_yaw(0.0); }
+std::int32_t Imu::tare_roll() const { return set_roll(0.0); }
+
+std::int32_t Imu::tare() const {
+  tare_euler();
+  return tare_rotation();
+}
+
+std::int32_t Imu::tare_euler() const {
+  tare_pitch();
+  tare_roll();
+  return tare_yaw();
+}
+
+std::int32_t Imu::set_heading(const double target) const {
+  sim::imu_state& s = state(_port);
+  IMU_READY(s, PROS_ERR);
+  s.heading_zero = raw_rotation(s) - target;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Imu::set_rotation(const double target) const {
+  sim::imu_state& s = state(_port);
+  IMU_READY(s, PROS_ERR);
+  s.rotation_zero = raw_rotation(s) - target;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Imu::set_yaw(const double target) const { return set_heading(wrap_360(target)); }
+
+std::int32_t Imu::set_pitch(const double target) const {
+  sim::imu_state& s = state(_port);
+  IMU_READY(s, PROS_ERR);
+  s.pitch_deg = target;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Imu::set_roll(const double target) const {
+  sim::imu_state& s = state(_port);
+  IMU_READY(s, PROS_ERR);
+  s.roll_deg = target;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Imu::set_euler(const pros::euler_s_t target) const {
+  set_pitch(target.pitch);
+  set_roll(target.roll);
+  return set_yaw(target.yaw);
+}
+
+pros::ImuStatus Imu::get_status() const {
+  return calibrating(state(_port)) ? pros::ImuStatus::calibrating : pros::ImuStatus::ready;
+}
+
+bool Imu::is_calibrating() const { return calibrating(state(_port)); }
+
+imu_orientation_e_t Imu::get_physical_orientation() const {
+  state(_port);
+  return pros::E_IMU_Z_UP;
+}
+
+#undef IMU_READY
+
+}  // namespace v5
+}  // namespace pros
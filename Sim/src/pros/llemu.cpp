@@ -0,0 +1,115 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host version of the brain screen.  LLEMU text is kept per line and echoed to stdout
+// when sim::world().echo_screen is set, LVGL calls the robot code makes are no-ops.
+
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+
+#include "liblvgl/llemu.hpp"
+#include "liblvgl/lvgl.h"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+const int LCD_LINES = 8;
+
+bool lcd_ready = false;
+std::string lcd_text[LCD_LINES];
+pros::lcd::lcd_btn_cb_fn_t lcd_callbacks[3] = {nullptr, nullptr, nullptr};
+
+bool lcd_write(int16_t line, const char* text) {
+  if (!lcd_ready || line < 0 || line >= LCD_LINES) return false;
+  if (lcd_text[line] == text) return true;
+  lcd_text[line] = text;
+  if (sim::world().echo_screen) std::printf("[%7.3f] lcd line %d: %s\n", sim::now_ms() / 1000.0, line, text);
+  return true;
+}
+
+// Every lvgl object the robot code creates is this one object
+lv_obj_t* screen_object() {
+  static char object[512];
+  return reinterpret_cast<lv_obj_t*>(object);
+}
+
+}  // namespace
+
+extern "C" {
+
+bool lcd_is_initialized(void) { return lcd_ready; }
+
+bool lcd_initialize(void) {
+  lcd_ready = true;
+  return true;
+}
+
+bool lcd_shutdown(void) {
+  lcd_ready = false;
+  return true;
+}
+
+bool lcd_print(int16_t line, const char* fmt, ...) {
+  char text[128];
+  va_list args;
+  va_start(args, fmt);
+  std::vsnprintf(text, sizeof(text), fmt, args);
+  va_end(args);
+  return lcd_write(line, text);
+}
+
+bool lcd_set_text(int16_t line, const char* text) { return lcd_write(line, text); }
+
+bool lcd_clear(void) {
+  for (int16_t line = 0; line < LCD_LINES; line++) lcd_write(line, "");
+  return lcd_ready;
+}
+
+bool lcd_clear_line(int16_t line) { return lcd_write(line, ""); }
+
+lv_disp_t* lv_disp_get_default(void) { return nullptr; }
+
+lv_obj_t* lv_disp_get_scr_act(lv_disp_t* disp) {
+  (void)disp;
+  return screen_object();
+}
+
+lv_obj_t* lv_img_create(lv_obj_t* parent) {
+  (void)parent;
+  return screen_object();
+}
+
+void lv_img_set_src(lv_obj_t* obj, const void* src) { (void)obj, (void)src; }
+
+void lv_obj_align(lv_obj_t* obj, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs) { (void)obj, (void)align, (void)x_ofs, (void)y_ofs; }
+
+void lv_obj_set_size(lv_obj_t* obj, lv_coord_t w, lv_coord_t h) { (void)obj, (void)w, (void)h; }
+
+void lv_fs_drv_init(lv_fs_drv_t* drv) { *drv = lv_fs_drv_t{}; }
+
+void lv_fs_drv_register(lv_fs_drv_t* drv) { (void)drv; }
+
+}  // extern "C"
+
+namespace pros {
+namespace lcd {
+
+bool is_initialized(void) { return lcd_is_initialized(); }
+bool initialize(void) { return lcd_initialize(); }
+bool shutdown(void) { return lcd_shutdown(); }
+bool set_text(std::int16_t line, std::string text) { return lcd_write(line, text.c_str()); }
+bool clear(void) { return lcd_clear(); }
+bool clear_line(std::int16_t line) { return lcd_clear_line(line); }
+void register_btn0_cb(lcd_btn_cb_fn_t cb) { lcd_callbacks[0] = cb; }
+void register_btn1_cb(lcd_btn_cb_fn_t cb) { lcd_callbacks[1] = cb; }
+void register_btn2_cb(lcd_btn_cb_fn_t cb) { lcd_callbacks[2] = cb; }
+void set_text_align(Text_Align alignment) { (void)alignment; }
+std::uint8_t read_buttons(void) { return 0; }
+
+}  // namespace lcd
+}  // namespace pros
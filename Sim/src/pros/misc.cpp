@@ -0,0 +1,209 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host version of the controller, competition, battery and sd card api backed by sim::world()
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "pros/error.h"
+#include "pros/misc.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace {
+
+sim::controller_state* controller(pros::controller_id_e_t id) {
+  if (id != pros::E_CONTROLLER_MASTER && id != pros::E_CONTROLLER_PARTNER) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  return &sim::world().controllers[id];
+}
+
+int button_index(pros::controller_digital_e_t button) {
+  int index = (int)button - (int)pros::E_CONTROLLER_DIGITAL_L1;
+  return index >= 0 && index < 12 ? index : -1;
+}
+
+// The sd card is the usd folder next to the program
+const char USD_PREFIX[] = "/usd";
+
+std::string usd_host_path(const char* path) {
+  std::size_t n = sizeof(USD_PREFIX) - 1;
+  if (std::strncmp(path, USD_PREFIX, n) != 0 || (path[n] != '/' && path[n] != '\0')) return path;
+  return std::string("usd") + (path + n);
+}
+
+void echo(pros::controller_id_e_t id, std::uint8_t line, const char* text) {
+  if (sim::world().echo_screen)
+    std::printf("[%7.3f] controller %d line %d: %s\n", sim::now_ms() / 1000.0, (int)id, (int)line, text);
+}
+
+}  // namespace
+
+namespace pros {
+namespace c {
+
+uint8_t competition_get_status(void) {
+  sim::World& w = sim::world();
+  return (w.competition_disabled ? COMPETITION_DISABLED : 0) |
+         (w.competition_autonomous ? COMPETITION_AUTONOMOUS : 0) |
+         (w.competition_connected ? COMPETITION_CONNECTED : 0);
+}
+
+uint8_t competition_is_disabled(void) { return sim::world().competition_disabled; }
+uint8_t competition_is_connected(void) { return sim::world().competition_connected; }
+uint8_t competition_is_autonomous(void) { return sim::world().competition_autonomous; }
+uint8_t competition_is_field(void) { return 0; }
+uint8_t competition_is_switch(void) { return sim::world().competition_connected; }
+
+int32_t controller_is_connected(controller_id_e_t id) {
+  sim::controller_state* c = controller(id);
+  return c ? c->connected : PROS_ERR;
+}
+
+int32_t controller_get_analog(controller_id_e_t id, controller_analog_e_t channel) {
+  sim::controller_state* c = controller(id);
+  if (!c || channel < 0 || channel > 3) return 0;
+  return c->analog[channel];
+}
+
+int32_t controller_get_battery_capacity(controller_id_e_t id) { return controller(id) ? 100 : PROS_ERR; }
+
+int32_t controller_get_battery_level(controller_id_e_t id) { return controller(id) ? 100 : PROS_ERR; }
+
+int32_t controller_get_digital(controller_id_e_t id, controller_digital_e_t button) {
+  sim::controller_state* c = controller(id);
+  int index = button_index(button);
+  if (!c || index < 0) return 0;
+  return c->digital[index];
+}
+
+int32_t controller_get_digital_new_press(controller_id_e_t id, controller_digital_e_t button) {
+  sim::controller_state* c = controller(id);
+  int index = button_index(button);
+  if (!c || index < 0) return 0;
+  bool pressed = c->digital[index] && !c->last_digital[index];
+  c->last_digital[index] = c->digital[index];
+  return pressed;
+}
+
+int32_t controller_print(controller_id_e_t id, uint8_t line, uint8_t col, const char* fmt, ...) {
+  (void)col;
+  if (!controller(id)) return PROS_ERR;
+  char text[64];
+  va_list args;
+  va_start(args, fmt);
+  std::vsnprintf(text, sizeof(text), fmt, args);
+  va_end(args);
+  echo(id, line, text);
+  return 1;
+}
+
+int32_t controller_set_text(controller_id_e_t id, uint8_t line, uint8_t col, const char* str) {
+  return controller_print(id, line, col, "%s", str);
+}
+
+int32_t controller_clear_line(controller_id_e_t id, uint8_t line) { return controller_print(id, line, 0, "%s", ""); }
+
+int32_t controller_clear(controller_id_e_t id) { return controller(id) ? 1 : PROS_ERR; }
+
+int32_t controller_rumble(controller_id_e_t id, const char* rumble_pattern) {
+  if (!controller(id)) return PROS_ERR;
+  echo(id, 3, rumble_pattern);
+  return 1;
+}
+
+int32_t battery_get_voltage(void) { return 12800; }
+int32_t battery_get_current(void) { return 0; }
+double battery_get_temperature(void) { return 25.0; }
+double battery_get_capacity(void) { return 100.0; }
+
+int32_t usd_is_installed(void) { return sim::world().sd_card_installed; }
+
+int32_t usd_list_files(const char* path, char* buffer, int32_t len) {
+  if (!sim::world().sd_card_installed) {
+    errno = ENODEV;
+    return PROS_ERR;
+  }
+  DIR* dir = opendir(usd_host_path(path).c_str());
+  if (dir == nullptr) {
+    errno = ENOENT;
+    return PROS_ERR;
+  }
+  std::string list;
+  while (dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] == '.') continue;
+    list += std::string(path) + "/" + entry->d_name + "\n";
+  }
+  closedir(dir);
+  std::snprintf(buffer, len, "%s", list.c_str());
+  return PROS_SUCCESS;
+}
+
+}  // namespace c
+
+inline namespace v5 {
+
+Controller::Controller(controller_id_e_t id) : _id(id) {}
+
+std::int32_t Controller::is_connected(void) { return c::controller_is_connected(_id); }
+std::int32_t Controller::get_analog(controller_analog_e_t channel) { return c::controller_get_analog(_id, channel); }
+std::int32_t Controller::get_battery_capacity(void) { return c::controller_get_battery_capacity(_id); }
+std::int32_t Controller::get_battery_level(void) { return c::controller_get_battery_level(_id); }
+std::int32_t Controller::get_digital(controller_digital_e_t button) { return c::controller_get_digital(_id, button); }
+std::int32_t Controller::get_digital_new_press(controller_digital_e_t button) { return c::controller_get_digital_new_press(_id, button); }
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const char* str) { return c::controller_set_text(_id, line, col, str); }
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const std::string& str) { return c::controller_set_text(_id, line, col, str.c_str()); }
+std::int32_t Controller::clear_line(std::uint8_t line) { return c::controller_clear_line(_id, line); }
+std::int32_t Controller::rumble(const char* rumble_pattern) { return c::controller_rumble(_id, rumble_pattern); }
+std::int32_t Controller::clear(void) { return c::controller_clear(_id); }
+
+}  // namespace v5
+
+namespace battery {
+double get_capacity(void) { return c::battery_get_capacity(); }
+int32_t get_current(void) { return c::battery_get_current(); }
+double get_temperature(void) { return c::battery_get_temperature(); }
+int32_t get_voltage(void) { return c::battery_get_voltage(); }
+}  // namespace battery
+
+namespace competition {
+std::uint8_t get_status(void) { return c::competition_get_status(); }
+std::uint8_t is_autonomous(void) { return c::competition_is_autonomous(); }
+std::uint8_t is_connected(void) { return c::competition_is_connected(); }
+std::uint8_t is_disabled(void) { return c::competition_is_disabled(); }
+std::uint8_t is_field_control(void) { return c::competition_is_field(); }
+std::uint8_t is_competition_switch(void) { return c::competition_is_switch(); }
+}  // namespace competition
+
+namespace usd {
+std::int32_t is_installed(void) { return c::usd_is_installed(); }
+std::int32_t list_files(const char* path, char* buffer, std::int32_t len) { return c::usd_list_files(path, buffer, len); }
+}  // namespace usd
+
+}  // namespace pros
+
+// Linked with --wrap=fopen so robot code opening /usd/ files reads and writes the usd folder
+extern "C" FILE* __real_fopen(const char* path, const char* mode);
+
+extern "C" FILE* __wrap_fopen(const char* path, const char* mode) {
+  std::string host = usd_host_path(path);
+  if (host == path) return __real_fopen(path, mode);
+  if (!sim::world().sd_card_installed) {
+    errno = ENXIO;
+    return nullptr;
+  }
+  mkdir("usd", 0755);
+  return __real_fopen(host.c_str(), mode);
+}
@@ -0,0 +1,168 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host version of pros::MotorGroup, every call is forwarded to a pros::Motor per port
+
+#include <algorithm>
+#include <cmath>
+
+#include "pros/error.h"
+#include "pros/motor_group.hpp"
+#include "pros/motors.hpp"
+
+namespace pros {
+inline namespace v5 {
+
+#define EACH(call)                                         \
+  do {                                                     \
+    for (std::int8_t port : _ports) Motor(port).call;      \
+    return _ports.empty() ? PROS_ERR : PROS_SUCCESS;       \
+  } while (0)
+
+#define AT(index, call, err)                               \
+  do {                                                     \
+    if (index >= _ports.size()) return err;                \
+    return Motor(_ports[index]).call;                      \
+  } while (0)
+
+#define ALL(type, call)                                    \
+  do {                                                     \
+    std::vector<type> out;                                 \
+    for (std::int8_t port : _ports) out.push_back(Motor(port).call); \
+    return out;                                            \
+  } while (0)
+
+MotorGroup::MotorGroup(const std::initializer_list<std::int8_t> ports, const MotorGears gearset, const MotorUnits encoder_units)
+    : MotorGroup(std::vector<std::int8_t>(ports), gearset, encoder_units) {}
+
+MotorGroup::MotorGroup(const std::vector<std::int8_t>& ports, const MotorGears gearset, const MotorUnits encoder_units)
+    : _ports(ports) {
+  for (std::int8_t port : _ports) Motor(port, gearset, encoder_units);
+}
+
+MotorGroup::MotorGroup(AbstractMotor& motor_group) : _ports(motor_group.get_port_all()) {}
+
+std::int32_t MotorGroup::move(std::int32_t voltage) const { EACH(move(voltage)); }
+std::int32_t MotorGroup::move_absolute(const double position, const std::int32_t velocity) const { EACH(move_absolute(position, velocity)); }
+std::int32_t MotorGroup::move_relative(const double position, const std::int32_t velocity) const { EACH(move_relative(position, velocity)); }
+std::int32_t MotorGroup::move_velocity(const std::int32_t velocity) const { EACH(move_velocity(velocity)); }
+std::int32_t MotorGroup::move_voltage(const std::int32_t voltage) const { EACH(move_voltage(voltage)); }
+std::int32_t MotorGroup::brake(void) const { EACH(brake()); }
+std::int32_t MotorGroup::modify_profiled_velocity(const std::int32_t velocity) const { EACH(modify_profiled_velocity(velocity)); }
+
+double MotorGroup::get_target_position(const std::uint8_t index) const { AT(index, get_target_position(), PROS_ERR_F); }
+std::vector<double> MotorGroup::get_target_position_all(void) const { ALL(double, get_target_position()); }
+std::int32_t MotorGroup::get_target_velocity(const std::uint8_t index) const { AT(index, get_target_velocity(), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::get_target_velocity_all(void) const { ALL(std::int32_t, get_target_velocity()); }
+double MotorGroup::get_actual_velocity(const std::uint8_t index) const { AT(index, get_actual_velocity(), PROS_ERR_F); }
+std::vector<double> MotorGroup::get_actual_velocity_all(void) const { ALL(double, get_actual_velocity()); }
+std::int32_t MotorGroup::get_current_draw(const std::uint8_t index) const { AT(index, get_current_draw(), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::get_current_draw_all(void) const { ALL(std::int32_t, get_current_draw()); }
+std::int32_t MotorGroup::get_direction(const std::uint8_t index) const { AT(index, get_direction(), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::get_direction_all(void) const { ALL(std::int32_t, get_direction()); }
+double MotorGroup::get_efficiency(const std::uint8_t index) const { AT(index, get_efficiency(), PROS_ERR_F); }
+std::vector<double> MotorGroup::get_efficiency_all(void) const { ALL(double, get_efficiency()); }
+std::uint32_t MotorGroup::get_faults(const std::uint8_t index) const { AT(index, get_faults(), PROS_ERR); }
+std::vector<std::uint32_t> MotorGroup::get_faults_all(void) const { ALL(std::uint32_t, get_faults()); }
+std::uint32_t MotorGroup::get_flags(const std::uint8_t index) const { AT(index, get_flags(), PROS_ERR); }
+std::vector<std::uint32_t> MotorGroup::get_flags_all(void) const { ALL(std::uint32_t, get_flags()); }
+double MotorGroup::get_position(const std::uint8_t index) const { AT(index, get_position(), PROS_ERR_F); }
+std::vector<double> MotorGroup::get_position_all(void) const { ALL(double, get_position()); }
+double MotorGroup::get_power(const std::uint8_t index) const { AT(index, get_power(), PROS_ERR_F); }
+std::vector<double> MotorGroup::get_power_all(void) const { ALL(double, get_power()); }
+std::int32_t MotorGroup::get_raw_position(std::uint32_t* const timestamp, const std::uint8_t index) const { AT(index, get_raw_position(timestamp), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::get_raw_position_all(std::uint32_t* const timestamp) const { ALL(std::int32_t, get_raw_position(timestamp)); }
+double MotorGroup::get_temperature(const std::uint8_t index) const { AT(index, get_temperature(), PROS_ERR_F); }
+std::vector<double> MotorGroup::get_temperature_all(void) const { ALL(double, get_temperature()); }
+double MotorGroup::get_torque(const std::uint8_t index) const { AT(index, get_torque(), PROS_ERR_F); }
+std::vector<double> MotorGroup::get_torque_all(void) const { ALL(double, get_torque()); }
+std::int32_t MotorGroup::get_voltage(const std::uint8_t index) const { AT(index, get_voltage(), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::get_voltage_all(void) const { ALL(std::int32_t, get_voltage()); }
+std::int32_t MotorGroup::is_over_current(const std::uint8_t index) const { AT(index, is_over_current(), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::is_over_current_all(void) const { ALL(std::int32_t, is_over_current()); }
+std::int32_t MotorGroup::is_over_temp(const std::uint8_t index) const { AT(index, is_over_temp(), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::is_over_temp_all(void) const { ALL(std::int32_t, is_over_temp()); }
+MotorBrake MotorGroup::get_brake_mode(const std::uint8_t index) const { AT(index, get_brake_mode(), MotorBrake::invalid); }
+std::vector<MotorBrake> MotorGroup::get_brake_mode_all(void) const { ALL(MotorBrake, get_brake_mode()); }
+std::int32_t MotorGroup::get_current_limit(const std::uint8_t index) const { AT(index, get_current_limit(), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::get_current_limit_all(void) const { ALL(std::int32_t, get_current_limit()); }
+MotorUnits MotorGroup::get_encoder_units(const std::uint8_t index) const { AT(index, get_encoder_units(), MotorUnits::invalid); }
+std::vector<MotorUnits> MotorGroup::get_encoder_units_all(void) const { ALL(MotorUnits, get_encoder_units()); }
+MotorGears MotorGroup::get_gearing(const std::uint8_t index) const { AT(index, get_gearing(), MotorGears::invalid); }
+std::vector<MotorGears> MotorGroup::get_gearing_all(void) const { ALL(MotorGears, get_gearing()); }
+std::vector<std::int8_t> MotorGroup::get_port_all(void) const { return _ports; }
+std::int32_t MotorGroup::get_voltage_limit(const std::uint8_t index) const { AT(index, get_voltage_limit(), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::get_voltage_limit_all(void) const { ALL(std::int32_t, get_voltage_limit()); }
+std::int32_t MotorGroup::is_reversed(const std::uint8_t index) const { AT(index, is_reversed(), PROS_ERR); }
+std::vector<std::int32_t> MotorGroup::is_reversed_all(void) const { ALL(std::int32_t, is_reversed()); }
+
+std::int32_t MotorGroup::set_brake_mode(const MotorBrake mode, const std::uint8_t index) const { AT(index, set_brake_mode(mode), PROS_ERR); }
+std::int32_t MotorGroup::set_brake_mode(const pros::motor_brake_mode_e_t mode, const std::uint8_t index) const { AT(index, set_brake_mode(mode), PROS_ERR); }
+std::int32_t MotorGroup::set_brake_mode_all(const MotorBrake mode) const { EACH(set_brake_mode(mode)); }
+std::int32_t MotorGroup::set_brake_mode_all(const pros::motor_brake_mode_e_t mode) const { EACH(set_brake_mode(mode)); }
+std::int32_t MotorGroup::set_current_limit(const std::int32_t limit, const std::uint8_t index) const { AT(index, set_current_limit(limit), PROS_ERR); }
+std::int32_t MotorGroup::set_current_limit_all(const std::int32_t limit) const { EACH(set_current_limit(limit)); }
+std::int32_t MotorGroup::set_encoder_units(const MotorUnits units, const std::uint8_t index) const { AT(index, set_encoder_units(units), PROS_ERR); }
+std::int32_t MotorGroup::set_encoder_units(const pros::motor_encoder_units_e_t units, const std::uint8_t index) const { AT(index, set_encoder_units(units), PROS_ERR); }
+std::int32_t MotorGroup::set_encoder_units_all(const MotorUnits units) const { EACH(set_encoder_units(units)); }
+std::int32_t MotorGroup::set_encoder_units_all(const pros::motor_encoder_units_e_t units) const { EACH(set_encoder_units(units)); }
+
+std::int32_t MotorGroup::set_gearing(std::vector<pros::motor_gearset_e_t> gearsets) const {
+  for (std::size_t i = 0; i < std::min(gearsets.size(), _ports.size()); i++) Motor(_ports[i]).set_gearing(gearsets[i]);
+  return PROS_SUCCESS;
+}
+
+std::int32_t MotorGroup::set_gearing(std::vector<MotorGears> gearsets) const {
+  for (std::size_t i = 0; i < std::min(gearsets.size(), _ports.size()); i++) Motor(_ports[i]).set_gearing(gearsets[i]);
+  return PROS_SUCCESS;
+}
+
+std::int32_t MotorGroup::set_gearing(const pros::motor_gearset_e_t gearset, const std::uint8_t index) const { AT(index, set_gearing(gearset), PROS_ERR); }
+std::int32_t MotorGroup::set_gearing(const MotorGears gearset, const std::uint8_t index) const { AT(index, set_gearing(gearset), PROS_ERR); }
+std::int32_t MotorGroup::set_gearing_all(const MotorGears gearset) const { EACH(set_gearing(gearset)); }
+std::int32_t MotorGroup::set_gearing_all(const pros::motor_gearset_e_t gearset) const { EACH(set_gearing(gearset)); }
+
+std::int32_t MotorGroup::set_reversed(const bool reverse, const std::uint8_t index) {
+  if (index >= _ports.size()) return PROS_ERR;
+  _ports[index] = reverse ? -std::abs(_ports[index]) : std::abs(_ports[index]);
+  return PROS_SUCCESS;
+}
+
+std::int32_t MotorGroup::set_reversed_all(const bool reverse) {
+  for (std::uint8_t i = 0; i < _ports.size(); i++) set_reversed(reverse, i);
+  return PROS_SUCCESS;
+}
+
+std::int32_t MotorGroup::set_voltage_limit(const std::int32_t limit, const std::uint8_t index) const { AT(index, set_voltage_limit(limit), PROS_ERR); }
+std::int32_t MotorGroup::set_voltage_limit_all(const std::int32_t limit) const { EACH(set_voltage_limit(limit)); }
+std::int32_t MotorGroup::set_zero_position(const double position, const std::uint8_t index) const { AT(index, set_zero_position(position), PROS_ERR); }
+std::int32_t MotorGroup::set_zero_position_all(const double position) const { EACH(set_zero_position(position)); }
+std::int32_t MotorGroup::tare_position(const std::uint8_t index) const { AT(index, tare_position(), PROS_ERR); }
+std::int32_t MotorGroup::tare_position_all(void) const { EACH(tare_position()); }
+
+std::int8_t MotorGroup::size(void) const { return (std::int8_t)_ports.size(); }
+
+std::int8_t MotorGroup::get_port(const std::uint8_t index) const {
+  if (index >= _ports.size()) return PROS_ERR_BYTE;
+  return _ports[index];
+}
+
+void MotorGroup::operator+=(AbstractMotor& other) { append(other); }
+
+void MotorGroup::append(AbstractMotor& other) {
+  for (std::int8_t port : other.get_port_all()) _ports.push_back(port);
+}
+
+void MotorGroup::erase_port(std::int8_t port) {
+  _ports.erase(std::remove_if(_ports.begin(), _ports.end(), [port](std::int8_t p) { return std::abs(p) == std::abs(port); }), _ports.end());
+}
+
+#undef EACH
+#undef AT
+#undef ALL
+
+}  // namespace v5
+}  // namespace pros
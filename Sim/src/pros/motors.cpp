@@ -0,0 +1,294 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host versions of pros::Device and pros::Motor backed by sim::world()
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "pros/device.hpp"
+#include "pros/error.h"
+#include "pros/motors.hpp"
+#include "sim/world.hpp"
+
+namespace pros {
+inline namespace v5 {
+
+/////
+// Device
+/////
+Device::Device(const std::uint8_t port) : _port(port) {}
+
+std::uint8_t Device::get_port(void) const { return _port; }
+
+bool Device::is_installed() { return get_plugged_type() != DeviceType::none; }
+
+DeviceType Device::get_plugged_type() const { return get_plugged_type(_port); }
+
+DeviceType Device::get_plugged_type(std::uint8_t port) {
+  if (!sim::port_valid(port)) return DeviceType::undefined;
+  sim::World& w = sim::world();
+  int i = sim::port_index(port);
+  if (w.motors[i].installed) return DeviceType::motor;
+  if (w.imus[i].installed) return DeviceType::imu;
+  if (w.rotations[i].installed) return DeviceType::rotation;
+  if (w.opticals[i].installed) return DeviceType::optical;
+  if (w.distances[i].installed) return DeviceType::distance;
+  if (w.gps[i].installed) return DeviceType::gps;
+  return DeviceType::none;
+}
+
+std::vector<Device> Device::get_all_devices(DeviceType device_type) {
+  std::vector<Device> devices;
+  for (std::uint8_t port = 1; port <= sim::SMART_PORTS; port++) {
+    DeviceType type = get_plugged_type(port);
+    if (type != DeviceType::none && (device_type == DeviceType::undefined || type == device_type))
+      devices.push_back(Device(port));
+  }
+  return devices;
+}
+
+/////
+// Motor
+/////
+namespace {
+
+sim::motor_state& state(std::int8_t port) { return sim::world().motors[sim::port_index(port)]; }
+
+double sign(std::int8_t port) { return port < 0 ? -1.0 : 1.0; }
+
+// Degrees of output shaft per encoder unit
+double units_to_deg(const sim::motor_state& m) {
+  if (m.encoder_units == 1) return 360.0;
+  if (m.encoder_units == 2) return 360.0 / sim::gearset_ticks_per_rev(m.gearset);
+  return 1.0;
+}
+
+}  // namespace
+
+Motor::Motor(const std::int8_t port, const MotorGears gearset, const MotorUnits encoder_units)
+    : Device(std::abs(port), DeviceType::motor), _port(port) {
+  sim::motor_state& m = state(port);
+  m.installed = true;
+  if (gearset != MotorGears::invalid) m.gearset = (int)gearset;
+  if (encoder_units != MotorUnits::invalid) m.encoder_units = (int)encoder_units;
+}
+
+std::int32_t Motor::move(std::int32_t voltage) const {
+  voltage = std::clamp(voltage, -127, 127);
+  return move_voltage(voltage * 12000 / 127);
+}
+
+std::int32_t Motor::move_absolute(const double position, const std::int32_t velocity) const {
+  sim::motor_state& m = state(_port);
+  m.mode = sim::POSITION;
+  m.target_deg = m.zero_deg + sign(_port) * position * units_to_deg(m);
+  m.target_rpm = std::abs(velocity);
+  m.commands++;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::move_relative(const double position, const std::int32_t velocity) const {
+  return move_absolute(get_position() + position, velocity);
+}
+
+std::int32_t Motor::move_velocity(const std::int32_t velocity) const {
+  sim::motor_state& m = state(_port);
+  m.mode = sim::VELOCITY;
+  m.target_rpm = sign(_port) * velocity;
+  m.commands++;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::move_voltage(const std::int32_t voltage) const {
+  sim::motor_state& m = state(_port);
+  m.mode = sim::VOLTAGE;
+  m.command_mv = sign(_port) * std::clamp(voltage, -12000, 12000);
+  m.commands++;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::brake(void) const { return move_velocity(0); }
+
+std::int32_t Motor::modify_profiled_velocity(const std::int32_t velocity) const {
+  state(_port).target_rpm = std::abs(velocity);
+  return PROS_SUCCESS;
+}
+
+double Motor::get_target_position(const std::uint8_t index) const {
+  const sim::motor_state& m = state(_port);
+  return sign(_port) * (m.target_deg - m.zero_deg) / units_to_deg(m);
+}
+
+std::int32_t Motor::get_target_velocity(const std::uint8_t index) const { return (std::int32_t)(sign(_port) * state(_port).target_rpm); }
+
+double Motor::get_actual_velocity(const std::uint8_t index) const { return sign(_port) * state(_port).velocity_rpm; }
+
+std::int32_t Motor::get_current_draw(const std::uint8_t index) const { return (std::int32_t)state(_port).current_ma; }
+
+std::int32_t Motor::get_direction(const std::uint8_t index) const { return get_actual_velocity() < 0 ? -1 : 1; }
+
+double Motor::get_efficiency(const std::uint8_t index) const {
+  const sim::motor_state& m = state(_port);
+  if (m.applied_mv == 0.0) return 0.0;
+  return std::clamp(100.0 * std::fabs(m.velocity_rpm / sim::gearset_free_rpm(m.gearset)) / std::fabs(m.applied_mv / 12000.0), 0.0, 100.0);
+}
+
+std::uint32_t Motor::get_faults(const std::uint8_t index) const { return 0; }
+
+std::uint32_t Motor::get_flags(const std::uint8_t index) const { return 0; }
+
+double Motor::get_position(const std::uint8_t index) const {
+  const sim::motor_state& m = state(_port);
+  return sign(_port) * (m.position_deg - m.zero_deg) / units_to_deg(m);
+}
+
+double Motor::get_power(const std::uint8_t index) const {
+  const sim::motor_state& m = state(_port);
+  return std::fabs(m.applied_mv / 1000.0 * m.current_ma / 1000.0);
+}
+
+std::int32_t Motor::get_raw_position(std::uint32_t* const timestamp, const std::uint8_t index) const {
+  const sim::motor_state& m = state(_port);
+  if (timestamp != nullptr) *timestamp = pros::c::millis();
+  return (std::int32_t)(sign(_port) * m.position_deg / 360.0 * sim::gearset_ticks_per_rev(m.gearset));
+}
+
+double Motor::get_temperature(const std::uint8_t index) const { return state(_port).temperature_c; }
+
+double Motor::get_torque(const std::uint8_t index) const { return state(_port).torque_nm; }
+
+std::int32_t Motor::get_voltage(const std::uint8_t index) const { return (std::int32_t)(sign(_port) * state(_port).applied_mv); }
+
+std::int32_t Motor::is_over_current(const std::uint8_t index) const {
+  const sim::motor_state& m = state(_port);
+  return m.current_ma >= m.current_limit ? 1 : 0;
+}
+
+std::int32_t Motor::is_over_temp(const std::uint8_t index) const { return state(_port).temperature_c >= 55.0 ? 1 : 0; }
+
+MotorBrake Motor::get_brake_mode(const std::uint8_t index) const { return (MotorBrake)state(_port).brake_mode; }
+
+std::int32_t Motor::get_current_limit(const std::uint8_t index) const { return state(_port).current_limit; }
+
+MotorUnits Motor::get_encoder_units(const std::uint8_t index) const { return (MotorUnits)state(_port).encoder_units; }
+
+MotorGears Motor::get_gearing(const std::uint8_t index) const { return (MotorGears)state(_port).gearset; }
+
+std::int32_t Motor::get_voltage_limit(const std::uint8_t index) const { return state(_port).voltage_limit; }
+
+std::int32_t Motor::is_reversed(const std::uint8_t index) const { return _port < 0 ? 1 : 0; }
+
+std::int32_t Motor::set_brake_mode(const MotorBrake mode, const std::uint8_t index) const {
+  sim::motor_state& m = state(_port);
+  m.brake_mode = (int)mode;
+  m.hold_deg = m.position_deg;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::set_brake_mode(const pros::motor_brake_mode_e_t mode, const std::uint8_t index) const {
+  return set_brake_mode((MotorBrake)mode, index);
+}
+
+std::int32_t Motor::set_current_limit(const std::int32_t limit, const std::uint8_t index) const {
+  state(_port).current_limit = limit;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::set_encoder_units(const MotorUnits units, const std::uint8_t index) const {
+  state(_port).encoder_units = (int)units;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::set_encoder_units(const pros::motor_encoder_units_e_t units, const std::uint8_t index) const {
+  return set_encoder_units((MotorUnits)units, index);
+}
+
+std::int32_t Motor::set_gearing(const MotorGears gearset, const std::uint8_t index) const {
+  state(_port).gearset = (int)gearset;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::set_gearing(const pros::motor_gearset_e_t gearset, const std::uint8_t index) const {
+  return set_gearing((MotorGears)gearset, index);
+}
+
+std::int32_t Motor::set_reversed(const bool reverse, const std::uint8_t index) {
+  _port = reverse ? -std::abs(_port) : std::abs(_port);
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::set_voltage_limit(const std::int32_t limit, const std::uint8_t index) const {
+  state(_port).voltage_limit = limit;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::set_zero_position(const double position, const std::uint8_t index) const {
+  sim::motor_state& m = state(_port);
+  m.zero_deg += sign(_port) * position * units_to_deg(m);
+  return PROS_SUCCESS;
+}
+
+std::int32_t Motor::tare_position(const std::uint8_t index) const {
+  sim::motor_state& m = state(_port);
+  m.zero_deg = m.position_deg;
+  return PROS_SUCCESS;
+}
+
+std::int8_t Motor::size(void) const { return 1; }
+
+std::vector<Motor> Motor::get_all_devices() {
+  std::vector<Motor> motors;
+  for (std::int8_t port = 1; port <= sim::SMART_PORTS; port++)
+    if (state(port).installed) motors.push_back(Motor(port));
+  return motors;
+}
+
+std::int8_t Motor::get_port(const std::uint8_t index) const { return _port; }
+
+std::vector<double> Motor::get_target_position_all(void) const { return {get_target_position()}; }
+std::vector<std::int32_t> Motor::get_target_velocity_all(void) const { return {get_target_velocity()}; }
+std::vector<double> Motor::get_actual_velocity_all(void) const { return {get_actual_velocity()}; }
+std::vector<std::int32_t> Motor::get_current_draw_all(void) const { return {get_current_draw()}; }
+std::vector<std::int32_t> Motor::get_direction_all(void) const { return {get_direction()}; }
+std::vector<double> Motor::get_efficiency_all(void) const { return {get_efficiency()}; }
+std::vector<std::uint32_t> Motor::get_faults_all(void) const { return {get_faults()}; }
+std::vector<std::uint32_t> Motor::get_flags_all(void) const { return {get_flags()}; }
+std::vector<double> Motor::get_position_all(void) const { return {get_position()}; }
+std::vector<double> Motor::get_power_all(void) const { return {get_power()}; }
+std::vector<std::int32_t> Motor::get_raw_position_all(std::uint32_t* const timestamp) const { return {get_raw_position(timestamp)}; }
+std::vector<double> Motor::get_temperature_all(void) const { return {get_temperature()}; }
+std::vector<double> Motor::get_torque_all(void) const { return {get_torque()}; }
+std::vector<std::int32_t> Motor::get_voltage_all(void) const { return {get_voltage()}; }
+std::vector<std::int32_t> Motor::is_over_current_all(void) const { return {is_over_current()}; }
+std::vector<std::int32_t> Motor::is_over_temp_all(void) const { return {is_over_temp()}; }
+std::vector<MotorBrake> Motor::get_brake_mode_all(void) const { return {get_brake_mode()}; }
+std::vector<std::int32_t> Motor::get_current_limit_all(void) const { return {get_current_limit()}; }
+std::vector<MotorUnits> Motor::get_encoder_units_all(void) const { return {get_encoder_units()}; }
+std::vector<MotorGears> Motor::get_gearing_all(void) const { return {get_gearing()}; }
+std::vector<std::int8_t> Motor::get_port_all(void) const { return {_port}; }
+std::vector<std::int32_t> Motor::get_voltage_limit_all(void) const { return {get_voltage_limit()}; }
+std::vector<std::int32_t> Motor::is_reversed_all(void) const { return {is_reversed()}; }
+std::int32_t Motor::set_brake_mode_all(const MotorBrake mode) const { return set_brake_mode(mode); }
+std::int32_t Motor::set_brake_mode_all(const pros::motor_brake_mode_e_t mode) const { return set_brake_mode(mode); }
+std::int32_t Motor::set_current_limit_all(const std::int32_t limit) const { return set_current_limit(limit); }
+std::int32_t Motor::set_encoder_units_all(const MotorUnits units) const { return set_encoder_units(units); }
+std::int32_t Motor::set_encoder_units_all(const pros::motor_encoder_units_e_t units) const { return set_encoder_units(units); }
+std::int32_t Motor::set_gearing_all(const MotorGears gearset) const { return set_gearing(gearset); }
+std::int32_t Motor::set_gearing_all(const pros::motor_gearset_e_t gearset) const { return set_gearing(gearset); }
+std::int32_t Motor::set_reversed_all(const bool reverse) { return set_reversed(reverse); }
+std::int32_t Motor::set_voltage_limit_all(const std::int32_t limit) const { return set_voltage_limit(limit); }
+std::int32_t Motor::set_zero_position_all(const double position) const { return set_zero_position(position); }
+std::int32_t Motor::tare_position_all(void) const { return tare_position(); }
+
+namespace literals {
+const pros::Motor operator"" _mtr(const unsigned long long int m) { return Motor(m); }
+const pros::Motor operator"" _rmtr(const unsigned long long int m) { return Motor(-m); }
+}  // namespace literals
+
+}  // namespace v5
+}  // namespace pros
@@ -0,0 +1,86 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host version of pros::Optical backed by sim::world()
+
+#include <algorithm>
+#include <cmath>
+
+#include "pros/error.h"
+#include "pros/optical.hpp"
+#include "sim/world.hpp"
+
+namespace pros {
+inline namespace v5 {
+namespace {
+
+sim::optical_state& state(std::uint8_t port) { return sim::world().opticals[sim::port_index(port)]; }
+
+}  // namespace
+
+Optical::Optical(const std::uint8_t port) : Device(port, DeviceType::optical) { state(_port).installed = true; }
+
+std::vector<Optical> Optical::get_all_devices() {
+  std::vector<Optical> out;
+  for (std::uint8_t port = 1; port <= sim::SMART_PORTS; port++)
+    if (sim::world().opticals[port - 1].installed) out.push_back(Optical(port));
+  return out;
+}
+
+double Optical::get_hue() { return state(_port).hue; }
+double Optical::get_saturation() { return state(_port).saturation; }
+double Optical::get_brightness() { return state(_port).brightness; }
+std::int32_t Optical::get_proximity() { return state(_port).proximity; }
+
+std::int32_t Optical::set_led_pwm(uint8_t value) {
+  state(_port).led_pwm = std::min<int>(value, 100);
+  return PROS_SUCCESS;
+}
+
+std::int32_t Optical::get_led_pwm() { return state(_port).led_pwm; }
+
+pros::c::optical_rgb_s_t Optical::get_rgb() {
+  const sim::optical_state& s = state(_port);
+  pros::c::optical_rgb_s_t rgb = {s.red, s.green, s.blue, s.brightness};
+  return rgb;
+}
+
+pros::c::optical_raw_s_t Optical::get_raw() {
+  const sim::optical_state& s = state(_port);
+  pros::c::optical_raw_s_t raw;
+  raw.red = (std::uint32_t)std::lround(s.red);
+  raw.green = (std::uint32_t)std::lround(s.green);
+  raw.blue = (std::uint32_t)std::lround(s.blue);
+  raw.clear = raw.red + raw.green + raw.blue;
+  return raw;
+}
+
+pros::c::optical_direction_e_t Optical::get_gesture() { return pros::c::NO_GESTURE; }
+
+pros::c::optical_gesture_s_t Optical::get_gesture_raw() {
+  pros::c::optical_gesture_s_t gesture = {};
+  return gesture;
+}
+
+std::int32_t Optical::enable_gesture() {
+  state(_port).gesture_enabled = true;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Optical::disable_gesture() {
+  state(_port).gesture_enabled = false;
+  return PROS_SUCCESS;
+}
+
+double Optical::get_integration_time() { return state(_port).integration_ms; }
+
+std::int32_t Optical::set_integration_time(double time) {
+  state(_port).integration_ms = std::clamp(time, 3.0, 712.0);
+  return PROS_SUCCESS;
+}
+
+}  // namespace v5
+}  // namespace pros
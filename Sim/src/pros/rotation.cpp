@@ -0,0 +1,84 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+// Host version of pros::Rotation backed by sim::world()
+
+#include <cmath>
+#include <cstdlib>
+
+#include "pros/error.h"
+#include "pros/rotation.hpp"
+#include "sim/world.hpp"
+
+namespace pros {
+inline namespace v5 {
+namespace {
+
+sim::rotation_state& state(std::uint8_t port) { return sim::world().rotations[sim::port_index(port)]; }
+
+// Position the sensor reports, in centidegrees, after reversing and zeroing
+double reported(const sim::rotation_state& s) {
+  double position = s.position_cdeg - s.zero_cdeg;
+  return s.reversed ? -position : position;
+}
+
+}  // namespace
+
+Rotation::Rotation(const std::int8_t port) : Device(std::abs(port), DeviceType::rotation) {
+  sim::rotation_state& s = state(_port);
+  s.installed = true;
+  if (port < 0) s.reversed = true;
+}
+
+// Clears the turn count, the position becomes the current angle
+std::int32_t Rotation::reset() { return set_position(get_angle()); }
+
+std::int32_t Rotation::set_data_rate(std::uint32_t rate) const {
+  (void)rate;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Rotation::set_position(std::uint32_t position) const {
+  sim::rotation_state& s = state(_port);
+  double physical = s.reversed ? -(double)position : (double)position;
+  s.zero_cdeg = s.position_cdeg - physical;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Rotation::reset_position(void) const { return set_position(0); }
+
+std::vector<Rotation> Rotation::get_all_devices() {
+  std::vector<Rotation> out;
+  for (std::uint8_t port = 1; port <= sim::SMART_PORTS; port++)
+    if (sim::world().rotations[port - 1].installed) out.push_back(Rotation(port));
+  return out;
+}
+
+std::int32_t Rotation::get_position() const { return (std::int32_t)std::lround(reported(state(_port))); }
+
+std::int32_t Rotation::get_velocity() const {
+  const sim::rotation_state& s = state(_port);
+  return (std::int32_t)std::lround(s.reversed ? -s.velocity_cdps : s.velocity_cdps);
+}
+
+std::int32_t Rotation::get_angle() const {
+  const sim::rotation_state& s = state(_port);
+  double angle = std::fmod(s.reversed ? -s.position_cdeg : s.position_cdeg, 36000.0);
+  return (std::int32_t)std::lround(angle < 0.0 ? angle + 36000.0 : angle);
+}
+
+std::int32_t Rotation::set_reversed(bool value) const {
+  sim::rotation_state& s = state(_port);
+  s.reversed = value;
+  return PROS_SUCCESS;
+}
+
+std::int32_t Rotation::reverse() const { return set_reversed(!state(_port).reversed); }
+
+std::int32_t Rotation::get_reversed() const { return state(_port).reversed; }
+
+}  // namespace v5
+}  // namespace pros
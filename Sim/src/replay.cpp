@@ -0,0 +1,125 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/replay.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "sim/scheduler.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+namespace {
+
+// Degrees per encoder unit, same as the pros::Motor wrapper
+double units_to_deg(int units, int gearset) {
+  if (units == 1) return 360.0;
+  if (units == 2) return 360.0 / gearset_ticks_per_rev(gearset);
+  return 1.0;
+}
+
+}  // namespace
+
+bool sensor_log_read(const std::string& path, sensor_log& out) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) return false;
+  out = sensor_log();
+  bool ok = std::fread(&out.header, sizeof(out.header), 1, file) == 1 &&
+            std::memcmp(out.header.magic, sensorlog::MAGIC, sizeof(sensorlog::MAGIC)) == 0 &&
+            out.header.version == sensorlog::VERSION && out.header.channelCount <= sensorlog::MAX_CHANNELS;
+  if (ok) {
+    std::uint32_t time;
+    sensorlog::Value values[sensorlog::MAX_CHANNELS];
+    while (std::fread(&time, sizeof(time), 1, file) == 1 &&
+           std::fread(values, sizeof(sensorlog::Value), out.header.channelCount, file) == out.header.channelCount) {
+      out.times.push_back(time);
+      out.values.insert(out.values.end(), values, values + out.header.channelCount);
+    }
+  }
+  std::fclose(file);
+  return ok;
+}
+
+SensorReplay::SensorReplay(const sensor_log& log) : log(log) {}
+
+void SensorReplay::attach() {
+  start_ms = now_ms();
+  next = 0;
+  World& w = world();
+  for (int c = 0; c < log.header.channelCount; c++) {
+    const sensorlog::Channel& channel = log.header.channels[c];
+    int slot = port_index(channel.port);
+    switch (channel.kind) {
+      case sensorlog::ChannelKind::IMU_ROTATION:
+        w.imus[slot].installed = true;
+        break;
+      case sensorlog::ChannelKind::ROTATION_POSITION:
+        w.rotations[slot].installed = true;
+        break;
+      case sensorlog::ChannelKind::MOTOR_POSITION:
+        w.motors[slot].installed = true;
+        w.motors[slot].plant_driven = true;  // the log decides where the motor is
+        break;
+    }
+  }
+  step_hook_add([this](double) { apply(now_ms() - start_ms); });
+}
+
+void SensorReplay::apply(std::uint32_t time_ms) {
+  int last = next;
+  while (next < log.frames() && log.times[next] <= time_ms) next++;
+  if (next == 0 || next == last) return;
+
+  int f = next - 1;
+  const sensorlog::Value* now = log.frame(f);
+  const sensorlog::Value* before = f > 0 ? log.frame(f - 1) : now;
+  double dt = f > 0 ? (log.times[f] - log.times[f - 1]) / 1000.0 : 1.0;
+
+  World& w = world();
+  for (int c = 0; c < log.header.channelCount; c++) {
+    const sensorlog::Channel& channel = log.header.channels[c];
+    int slot = port_index(channel.port);
+    switch (channel.kind) {
+      case sensorlog::ChannelKind::IMU_ROTATION: {
+        imu_state& s = w.imus[slot];
+        // the sensor was calibrating or unplugged while it read PROS_ERR_F
+        bool valid = std::isfinite(now[c].f);
+        s.calibrate_until_ms = valid ? 0 : std::numeric_limits<std::uint32_t>::max();
+        if (!valid) break;
+        s.scale = 1.0;
+        s.rotation_zero = s.heading_zero = 0.0;
+        s.rotation_deg = now[c].f;
+        s.gyro_z_dps = std::isfinite(before[c].f) ? (now[c].f - before[c].f) / dt : 0.0;
+        break;
+      }
+      case sensorlog::ChannelKind::ROTATION_POSITION: {
+        rotation_state& s = w.rotations[slot];
+        double sign = channel.port < 0 ? -1.0 : 1.0;
+        s.reversed = channel.port < 0;
+        s.zero_cdeg = 0.0;
+        s.position_cdeg = sign * now[c].i;
+        s.velocity_cdps = sign * (now[c].i - before[c].i) / dt;
+        break;
+      }
+      case sensorlog::ChannelKind::MOTOR_POSITION: {
+        motor_state& s = w.motors[slot];
+        double scale = (channel.port < 0 ? -1.0 : 1.0) * units_to_deg(channel.units, s.gearset);
+        s.encoder_units = channel.units;
+        s.zero_deg = 0.0;
+        s.position_deg = scale * now[c].f;
+        s.velocity_rpm = scale * (now[c].f - before[c].f) / dt / 6.0;
+        break;
+      }
+    }
+  }
+}
+
+std::uint32_t SensorReplay::end_ms() const { return log.times.empty() ? 0 : log.times.back(); }
+
+}  // namespace sim
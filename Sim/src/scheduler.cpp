@@ -0,0 +1,516 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/scheduler.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pros/rtos.h"
+#include "sim/world.hpp"
+
+namespace sim {
+namespace {
+
+const std::uint64_t NEVER = std::numeric_limits<std::uint64_t>::max();
+
+// Thrown inside a task to unwind it when it is deleted or the run ends
+struct task_killed {};
+
+enum class state { NEW,
+                   READY,
+                   BLOCKED,
+                   SUSPENDED,
+                   DONE };
+
+struct sim_task;
+
+struct sim_mutex {
+  sim_task* owner = nullptr;
+};
+
+struct sim_task {
+  int id = 0;
+  std::string name;
+  std::uint32_t prio = TASK_PRIORITY_DEFAULT;
+  pros::task_fn_t fn = nullptr;
+  void* param = nullptr;
+  std::thread thread;
+
+  state st = state::NEW;
+  std::uint64_t wake_us = 0;        // when a blocked task times out
+  std::uint64_t last_run = 0;       // switch count at last resume, used for round robin
+  void* waiting_on = nullptr;       // mutex or task being waited on
+  bool waiting_notify = false;
+  bool kill = false;
+  std::uint32_t notify_value = 0;
+  bool notify_pending = false;
+
+  std::condition_variable cv;
+  bool go = false;
+};
+
+struct scheduler {
+  std::mutex m;
+  std::condition_variable host_cv;
+  bool host_turn = true;
+
+  std::vector<sim_task*> tasks;
+  sim_task* current = nullptr;
+  std::uint64_t time_us = 0;
+  std::uint64_t switches = 0;
+  bool running = false;
+  bool killing = false;
+  int next_id = 1;
+
+  std::vector<std::function<void(double)>> hooks;
+};
+
+// Never destroyed so parked task threads can't outlive it during exit
+scheduler& sched() {
+  static scheduler* s = new scheduler();
+  return *s;
+}
+
+void task_body(sim_task* t);
+
+void spawn(sim_task* t) {
+  t->st = state::READY;
+  t->wake_us = sched().time_us;
+  t->thread = std::thread(task_body, t);
+}
+
+// Hands control back to the host and parks until the scheduler resumes this task.
+// Must be called with the lock held and the task's state already updated.
+void park(std::unique_lock<std::mutex>& lock, sim_task* t) {
+  scheduler& s = sched();
+  s.current = nullptr;
+  s.host_turn = true;
+  s.host_cv.notify_one();
+  t->cv.wait(lock, [t] { return t->go; });
+  t->go = false;
+  s.current = t;
+  if (s.killing || t->kill) throw task_killed{};
+}
+
+void task_body(sim_task* t) {
+  scheduler& s = sched();
+  {
+    std::unique_lock<std::mutex> lock(s.m);
+    t->cv.wait(lock, [t] { return t->go; });
+    t->go = false;
+    s.current = t;
+  }
+  try {
+    if (!s.killing && !t->kill) t->fn(t->param);
+  } catch (task_killed&) {
+  }
+  std::unique_lock<std::mutex> lock(s.m);
+  t->st = state::DONE;
+  for (sim_task* other : s.tasks) {
+    if (other->st == state::BLOCKED && other->waiting_on == t) {
+      other->st = state::READY;
+      other->wake_us = s.time_us;
+      other->waiting_on = nullptr;
+    }
+  }
+  s.current = nullptr;
+  s.host_turn = true;
+  s.host_cv.notify_one();
+}
+
+// Blocks the calling task until timeout_ms passes or something readies it again
+void block_current(std::uint32_t timeout_ms) {
+  scheduler& s = sched();
+  std::unique_lock<std::mutex> lock(s.m);
+  sim_task* t = s.current;
+  if (t == nullptr) {
+    // Called from the host thread (static init or between runs), just move time
+    if (timeout_ms != TIMEOUT_MAX) s.time_us += timeout_ms * 1000ULL;
+    return;
+  }
+  t->st = state::BLOCKED;
+  t->wake_us = timeout_ms == TIMEOUT_MAX ? NEVER : s.time_us + timeout_ms * 1000ULL;
+  park(lock, t);
+}
+
+void advance_to(std::uint64_t target_us) {
+  scheduler& s = sched();
+  while (s.time_us < target_us) {
+    std::uint64_t step = std::min<std::uint64_t>(target_us - s.time_us, (std::uint64_t)(STEP_TIME * 1e6));
+    double dt = step / 1e6;
+    s.time_us += step;
+    world().step(dt);
+    for (auto& hook : s.hooks) hook(dt);
+  }
+}
+
+sim_task* pick_next() {
+  scheduler& s = sched();
+  sim_task* best = nullptr;
+  for (sim_task* t : s.tasks) {
+    if (t->st != state::READY && t->st != state::BLOCKED) continue;
+    if (t->wake_us == NEVER) continue;
+    if (best == nullptr || t->wake_us < best->wake_us ||
+        (t->wake_us == best->wake_us && (t->prio > best->prio || (t->prio == best->prio && t->last_run < best->last_run))))
+      best = t;
+  }
+  return best;
+}
+
+void resume(std::unique_lock<std::mutex>& lock, sim_task* t) {
+  scheduler& s = sched();
+  s.switches++;
+  t->last_run = s.switches;
+  t->st = state::READY;
+  s.host_turn = false;
+  t->go = true;
+  t->cv.notify_one();
+  s.host_cv.wait(lock, [&s] { return s.host_turn; });
+}
+
+void entry_trampoline(void* param) {
+  (*static_cast<std::function<void()>*>(param))();
+}
+
+}  // namespace
+
+std::uint64_t now_us() { return sched().time_us; }
+
+std::uint32_t now_ms() { return (std::uint32_t)(sched().time_us / 1000); }
+
+std::uint64_t context_switches() { return sched().switches; }
+
+void step_hook_add(std::function<void(double)> hook) { sched().hooks.push_back(hook); }
+
+void step_hooks_clear() { sched().hooks.clear(); }
+
+run_result run(std::function<void()> entry, std::uint32_t limit_ms) {
+  scheduler& s = sched();
+  run_result result;
+  auto wall_start = std::chrono::steady_clock::now();
+  std::uint64_t start_us = s.time_us;
+  std::uint64_t limit_us = start_us + limit_ms * 1000ULL;
+
+  sim_task* main_task = static_cast<sim_task*>(pros::c::task_create(entry_trampoline, &entry, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "main"));
+
+  std::unique_lock<std::mutex> lock(s.m);
+  s.running = true;
+  for (sim_task* t : s.tasks)
+    if (t->st == state::NEW) spawn(t);
+
+  while (true) {
+    if (main_task->st == state::DONE) {
+      result.finished = true;
+      break;
+    }
+    sim_task* next = pick_next();
+    if (next == nullptr) {
+      result.deadlocked = true;
+      break;
+    }
+    if (next->wake_us > limit_us) {
+      advance_to(limit_us);
+      break;
+    }
+    if (next->wake_us > s.time_us) advance_to(next->wake_us);
+    resume(lock, next);
+  }
+
+  // Unwind every task that is still alive, one at a time
+  s.killing = true;
+  for (sim_task* t : s.tasks) {
+    if (t->st != state::DONE && t->thread.joinable()) resume(lock, t);
+    t->st = state::DONE;
+  }
+  lock.unlock();
+  for (sim_task* t : s.tasks)
+    if (t->thread.joinable()) t->thread.join();
+  lock.lock();
+  for (sim_task* t : s.tasks) delete t;
+  s.tasks.clear();
+  s.killing = false;
+  s.running = false;
+
+  result.virtual_ms = (std::uint32_t)((s.time_us - start_us) / 1000);
+  result.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+  return result;
+}
+
+run_result run_isolated(std::function<void()> entry, std::uint32_t limit_ms) {
+  int fds[2];
+  run_result result;
+  if (pipe(fds) != 0) return result;
+  std::fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    run_result child = run(entry, limit_ms);
+    ssize_t written = write(fds[1], &child, sizeof(child));
+    std::fflush(stdout);
+    _exit(written == sizeof(child) ? 0 : 1);
+  }
+  close(fds[1]);
+  ssize_t got = pid > 0 ? read(fds[0], &result, sizeof(result)) : -1;
+  close(fds[0]);
+  if (pid > 0) waitpid(pid, nullptr, 0);
+  if (got != sizeof(result)) result = run_result{};
+  return result;
+}
+
+}  // namespace sim
+
+/////
+// PROS RTOS C API backed by the virtual clock
+/////
+using sim::sched;
+using sim::sim_mutex;
+using sim::sim_task;
+using sim::state;
+
+namespace pros {
+namespace c {
+
+uint32_t millis(void) { return sim::now_ms(); }
+
+uint64_t micros(void) { return sim::now_us(); }
+
+task_t task_create(task_fn_t function, void* const parameters, uint32_t prio, const uint16_t stack_depth, const char* const name) {
+  (void)stack_depth;
+  auto& s = sched();
+  sim_task* t = new sim_task();
+  t->id = s.next_id++;
+  t->name = name == nullptr ? "" : name;
+  t->prio = prio;
+  t->fn = function;
+  t->param = parameters;
+  t->wake_us = s.time_us;
+  s.tasks.push_back(t);
+  if (s.running) spawn(t);
+  return t;
+}
+
+void task_delete(task_t task) {
+  auto& s = sched();
+  sim_task* t = task == nullptr ? s.current : static_cast<sim_task*>(task);
+  if (t == nullptr || t->st == state::DONE) return;
+  if (t == s.current) throw sim::task_killed{};
+  t->kill = true;
+  if (t->st == state::NEW) {
+    t->st = state::DONE;
+    return;
+  }
+  t->st = state::READY;
+  t->wake_us = s.time_us;
+}
+
+void task_delay(const uint32_t milliseconds) { sim::block_current(milliseconds); }
+
+void delay(const uint32_t milliseconds) { sim::block_current(milliseconds); }
+
+void task_delay_until(uint32_t* const prev_time, const uint32_t delta) {
+  uint32_t wake = *prev_time + delta;
+  uint32_t now = millis();
+  if (wake > now) sim::block_current(wake - now);
+  *prev_time = wake;
+}
+
+uint32_t task_get_priority(task_t task) {
+  sim_task* t = task == nullptr ? sched().current : static_cast<sim_task*>(task);
+  return t == nullptr ? 0 : t->prio;
+}
+
+void task_set_priority(task_t task, uint32_t prio) {
+  sim_task* t = task == nullptr ? sched().current : static_cast<sim_task*>(task);
+  if (t != nullptr) t->prio = prio;
+}
+
+task_state_e_t task_get_state(task_t task) {
+  auto& s = sched();
+  sim_task* t = static_cast<sim_task*>(task);
+  if (std::find(s.tasks.begin(), s.tasks.end(), t) == s.tasks.end()) return E_TASK_STATE_INVALID;
+  if (t == s.current) return E_TASK_STATE_RUNNING;
+  switch (t->st) {
+    case state::NEW:
+    case state::READY:
+      return E_TASK_STATE_READY;
+    case state::BLOCKED:
+      return E_TASK_STATE_BLOCKED;
+    case state::SUSPENDED:
+      return E_TASK_STATE_SUSPENDED;
+    default:
+      return E_TASK_STATE_DELETED;
+  }
+}
+
+void task_suspend(task_t task) {
+  auto& s = sched();
+  sim_task* t = task == nullptr ? s.current : static_cast<sim_task*>(task);
+  if (t == nullptr || t->st == state::DONE) return;
+  if (t == s.current) {
+    std::unique_lock<std::mutex> lock(s.m);
+    t->st = state::SUSPENDED;
+    t->wake_us = sim::NEVER;
+    sim::park(lock, t);
+    return;
+  }
+  t->st = state::SUSPENDED;
+}
+
+void task_resume(task_t task) {
+  sim_task* t = static_cast<sim_task*>(task);
+  if (t == nullptr || t->st != state::SUSPENDED) return;
+  t->st = state::READY;
+  t->wake_us = sched().time_us;
+}
+
+uint32_t task_get_count(void) {
+  uint32_t count = 0;
+  for (sim_task* t : sched().tasks)
+    if (t->st != state::DONE) count++;
+  return count;
+}
+
+char* task_get_name(task_t task) {
+  sim_task* t = task == nullptr ? sched().current : static_cast<sim_task*>(task);
+  return t == nullptr ? nullptr : const_cast<char*>(t->name.c_str());
+}
+
+task_t task_get_by_name(const char* name) {
+  for (sim_task* t : sched().tasks)
+    if (t->name == name && t->st != state::DONE) return t;
+  return nullptr;
+}
+
+task_t task_get_current() { return sched().current; }
+
+uint32_t task_notify(task_t task) { return task_notify_ext(task, 0, E_NOTIFY_ACTION_INCR, nullptr); }
+
+void task_join(task_t task) {
+  auto& s = sched();
+  sim_task* t = static_cast<sim_task*>(task);
+  sim_task* self = s.current;
+  if (t == nullptr || self == nullptr || t == self) return;
+  std::unique_lock<std::mutex> lock(s.m);
+  while (t->st != state::DONE) {
+    self->st = state::BLOCKED;
+    self->wake_us = sim::NEVER;
+    self->waiting_on = t;
+    sim::park(lock, self);
+  }
+}
+
+uint32_t task_notify_ext(task_t task, uint32_t value, notify_action_e_t action, uint32_t* prev_value) {
+  sim_task* t = static_cast<sim_task*>(task);
+  if (t == nullptr) return 0;
+  if (prev_value != nullptr) *prev_value = t->notify_value;
+  switch (action) {
+    case E_NOTIFY_ACTION_BITS:
+      t->notify_value |= value;
+      break;
+    case E_NOTIFY_ACTION_INCR:
+      t->notify_value++;
+      break;
+    case E_NOTIFY_ACTION_OWRITE:
+      t->notify_value = value;
+      break;
+    case E_NOTIFY_ACTION_NO_OWRITE:
+      if (t->notify_pending) return 0;
+      t->notify_value = value;
+      break;
+    default:
+      break;
+  }
+  t->notify_pending = true;
+  if (t->waiting_notify && t->st == state::BLOCKED) {
+    t->st = state::READY;
+    t->wake_us = sched().time_us;
+  }
+  return 1;
+}
+
+uint32_t task_notify_take(bool clear_on_exit, uint32_t timeout) {
+  auto& s = sched();
+  sim_task* t = s.current;
+  if (t == nullptr) return 0;
+  if (!t->notify_pending && timeout != 0) {
+    t->waiting_notify = true;
+    try {
+      sim::block_current(timeout);
+    } catch (...) {
+      t->waiting_notify = false;
+      throw;
+    }
+    t->waiting_notify = false;
+  }
+  if (!t->notify_pending) return 0;
+  uint32_t value = t->notify_value;
+  if (clear_on_exit || t->notify_value <= 1) {
+    t->notify_value = 0;
+    t->notify_pending = false;
+  } else {
+    t->notify_value--;
+  }
+  return value;
+}
+
+bool task_notify_clear(task_t task) {
+  sim_task* t = task == nullptr ? sched().current : static_cast<sim_task*>(task);
+  if (t == nullptr) return false;
+  bool was_pending = t->notify_pending;
+  t->notify_pending = false;
+  return was_pending;
+}
+
+mutex_t mutex_create(void) { return new sim_mutex(); }
+
+bool mutex_take(mutex_t mutex, uint32_t timeout) {
+  auto& s = sched();
+  sim_mutex* mtx = static_cast<sim_mutex*>(mutex);
+  if (mtx == nullptr) return false;
+  sim_task* self = s.current;
+  std::uint64_t give_up = timeout == TIMEOUT_MAX ? sim::NEVER : s.time_us + timeout * 1000ULL;
+  while (mtx->owner != nullptr && self != nullptr) {
+    if (s.time_us >= give_up) return false;
+    std::unique_lock<std::mutex> lock(s.m);
+    self->st = state::BLOCKED;
+    self->wake_us = give_up;
+    self->waiting_on = mtx;
+    sim::park(lock, self);
+    self->waiting_on = nullptr;
+  }
+  if (mtx->owner != nullptr) return false;
+  // Host thread takes use a sentinel owner so a task can't steal it
+  mtx->owner = self != nullptr ? self : reinterpret_cast<sim_task*>(mtx);
+  return true;
+}
+
+bool mutex_give(mutex_t mutex) {
+  auto& s = sched();
+  sim_mutex* mtx = static_cast<sim_mutex*>(mutex);
+  if (mtx == nullptr || mtx->owner == nullptr) return false;
+  mtx->owner = nullptr;
+  sim_task* waiter = nullptr;
+  for (sim_task* t : s.tasks)
+    if (t->st == state::BLOCKED && t->waiting_on == mtx && (waiter == nullptr || t->prio > waiter->prio)) waiter = t;
+  if (waiter != nullptr) waiter->wake_us = s.time_us;
+  return true;
+}
+
+void mutex_delete(mutex_t mutex) { delete static_cast<sim_mutex*>(mutex); }
+
+}  // namespace c
+}  // namespace pros
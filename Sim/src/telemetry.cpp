@@ -0,0 +1,148 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/telemetry.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include "binaryTelemetry.hpp"
+
+namespace sim {
+namespace {
+
+// Longest encoded record worth keeping, anything longer is noise between records
+const std::size_t MAX_ENCODED = telemetry::cobsMaxSize(telemetry::MAX_RECORD);
+
+telemetry_channel& channel_at(std::vector<telemetry_channel>& channels, std::size_t id) {
+  if (channels.size() <= id) channels.resize(id + 1);
+  return channels[id];
+}
+
+bool write_file(const std::string& path, const void* data, std::size_t size) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) return false;
+  bool ok = std::fwrite(data, 1, size, file) == size;
+  return std::fclose(file) == 0 && ok;
+}
+
+}  // namespace
+
+void telemetry_capture::feed(const std::uint8_t* data, std::size_t size) {
+  for (std::size_t i = 0; i < size; i++) {
+    if (data[i] != 0) {
+      pending.push_back(data[i]);
+      continue;
+    }
+    if (!pending.empty()) {
+      if (pending.size() <= MAX_ENCODED)
+        record(pending.data(), pending.size());
+      else
+        skipped_bytes += pending.size();
+    }
+    pending.clear();
+  }
+}
+
+void telemetry_capture::record(const std::uint8_t* encoded, std::size_t size) {
+  std::uint8_t r[telemetry::cobsMaxSize(telemetry::MAX_RECORD)];
+  int length = telemetry::cobsDecode(encoded, size, r);
+  if (length < 2 || telemetry::crc8(r, length - 1) != r[length - 1]) {
+    bad_records++;
+    skipped_bytes += size;
+    return;
+  }
+  length--;  // the crc
+
+  if (r[0] == (std::uint8_t)telemetry::RecordType::SCHEMA && length >= 4 && r[1] == telemetry::VERSION) {
+    // names are \0 terminated, the last one has to be too
+    std::vector<std::string> names;
+    for (int i = 4; i < length;) {
+      const void* end = std::memchr(r + i, 0, length - i);
+      if (end == nullptr) break;
+      names.emplace_back((const char*)r + i);
+      i = (const std::uint8_t*)end - r + 1;
+    }
+    if (names.size() == (std::size_t)r[3] + 1) {
+      telemetry_channel& c = channel_at(channels, r[2]);
+      std::vector<std::string> fields(names.begin() + 1, names.end());
+      // samples from before the schema only have placeholder names, and a restart can change the schema
+      if (!c.times.empty() && c.fields.size() != fields.size()) {
+        c.times.clear();
+        c.values.clear();
+      }
+      c.name = names[0];
+      c.fields = fields;
+      records++;
+      return;
+    }
+  } else if (r[0] == (std::uint8_t)telemetry::RecordType::DATA && length >= 6 && (length - 6) % 4 == 0) {
+    telemetry_channel& c = channel_at(channels, r[1]);
+    std::size_t count = (length - 6) / 4;
+    if (c.fields.empty() && c.times.empty())
+      for (std::size_t f = 0; f < count; f++) c.fields.push_back("field" + std::to_string(f));
+    if (c.fields.size() == count) {
+      std::uint32_t time;
+      std::memcpy(&time, r + 2, 4);
+      c.times.push_back(time);
+      std::size_t at = c.values.size();
+      c.values.resize(at + count);
+      std::memcpy(&c.values[at], r + 6, 4 * count);
+      records++;
+      return;
+    }
+  }
+  bad_records++;
+  skipped_bytes += size;
+}
+
+bool telemetry_read(const std::string& path, telemetry_capture& out) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) return false;
+  out = telemetry_capture();
+  std::uint8_t buffer[4096];
+  std::size_t size;
+  while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0) out.feed(buffer, size);
+  std::fclose(file);
+  return true;
+}
+
+bool telemetry_write_csv(const telemetry_capture& capture, const std::string& prefix) {
+  for (std::size_t id = 0; id < capture.channels.size(); id++) {
+    const telemetry_channel& c = capture.channels[id];
+    if (c.times.empty()) continue;
+    std::string name = c.name.empty() ? "channel" + std::to_string(id) : c.name;
+    std::FILE* file = std::fopen((prefix + name + ".csv").c_str(), "w");
+    if (file == nullptr) return false;
+    std::fprintf(file, "time");
+    for (const std::string& field : c.fields) std::fprintf(file, ",%s", field.c_str());
+    std::fprintf(file, "\n");
+    for (int i = 0; i < c.samples(); i++) {
+      std::fprintf(file, "%u", c.times[i]);
+      for (std::size_t f = 0; f < c.fields.size(); f++) std::fprintf(file, ",%.9g", c.sample(i)[f]);
+      std::fprintf(file, "\n");
+    }
+    if (std::fclose(file) != 0) return false;
+  }
+  return true;
+}
+
+bool telemetry_write_columns(const telemetry_capture& capture, const std::string& prefix) {
+  for (std::size_t id = 0; id < capture.channels.size(); id++) {
+    const telemetry_channel& c = capture.channels[id];
+    if (c.times.empty()) continue;
+    std::string name = prefix + (c.name.empty() ? "channel" + std::to_string(id) : c.name);
+    if (!write_file(name + ".time.u32", c.times.data(), c.times.size() * sizeof(std::uint32_t))) return false;
+    std::vector<float> column(c.times.size());
+    for (std::size_t f = 0; f < c.fields.size(); f++) {
+      for (int i = 0; i < c.samples(); i++) column[i] = c.sample(i)[f];
+      if (!write_file(name + "." + c.fields[f] + ".f32", column.data(), column.size() * sizeof(float))) return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace sim
@@ -0,0 +1,325 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/tuner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "sim/scheduler.hpp"
+
+namespace sim {
+namespace {
+
+// Same as ez::util::DELAY_TIME and ez::PID's velocity_zero_main
+const int DELAY_TIME = 10;
+const double VELOCITY_ZERO = 0.05;
+
+// Candidates handed to a worker at a time
+const int CHUNK = 64;
+
+// Score added per target for exits that didn't settle
+const double EXIT_PENALTY_MS[5] = {0.0, 0.0, 250.0, 1000.0, 2000.0};
+
+double sgn(double x) { return (double)((x > 0.0) - (x < 0.0)); }
+
+}  // namespace
+
+const char* pid_exit_name(int exit) {
+  switch (exit) {
+    case EXIT_SMALL:
+      return "SMALL_EXIT";
+    case EXIT_BIG:
+      return "BIG_EXIT";
+    case EXIT_VELOCITY:
+      return "VELOCITY_EXIT";
+    case EXIT_TIMEOUT:
+      return "TIMEOUT";
+    default:
+      return "RUNNING";
+  }
+}
+
+/////
+// BatchPID
+/////
+BatchPID::BatchPID(int lanes)
+    : lanes(lanes), kp(lanes), ki(lanes), kd(lanes), start_i(lanes), output(lanes), error(lanes), integral(lanes), derivative(lanes), prev_error(lanes), prev_current(lanes), small_timer(lanes), big_timer(lanes), velocity_timer(lanes), exit(lanes) {}
+
+void BatchPID::gains_set(int lane, const pid_gains& gains) {
+  kp[lane] = gains.kp;
+  ki[lane] = gains.ki;
+  kd[lane] = gains.kd;
+  start_i[lane] = gains.start_i;
+  output[lane] = error[lane] = integral[lane] = derivative[lane] = prev_error[lane] = prev_current[lane] = 0.0;
+  small_timer[lane] = big_timer[lane] = velocity_timer[lane] = 0;
+  exit[lane] = EXIT_RUNNING;
+}
+
+void BatchPID::compute(const double* __restrict target, const double* __restrict current) {
+  double* __restrict out = output.data();
+  double* __restrict err = error.data();
+  double* __restrict in = integral.data();
+  double* __restrict der = derivative.data();
+  double* __restrict perr = prev_error.data();
+  double* __restrict pcur = prev_current.data();
+  const double* __restrict p = kp.data();
+  const double* __restrict i = ki.data();
+  const double* __restrict d = kd.data();
+  const double* __restrict si = start_i.data();
+
+  for (int l = 0; l < lanes; l++) {
+    double e = target[l] - current[l];
+    double dv = pcur[l] - current[l];  // derivative on measurement, no kick on new targets
+
+    // Integral only builds inside start_i and resets when the error changes sign
+    double sum = in[l] + (std::fabs(e) < si[l] ? e : 0.0);
+    sum = sgn(e) != sgn(perr[l]) ? 0.0 : sum;
+    sum = i[l] != 0.0 ? sum : in[l];
+
+    out[l] = e * p[l] + sum * i[l] + dv * d[l];
+    err[l] = e;
+    der[l] = dv;
+    in[l] = sum;
+    perr[l] = e;
+    pcur[l] = current[l];
+  }
+}
+
+void BatchPID::exit_update(const pid_exit_conditions& c) {
+  for (int l = 0; l < lanes; l++) {
+    if (exit[l] != EXIT_RUNNING) continue;
+    double e = std::fabs(error[l]);
+
+    bool small = c.small_error != 0.0 && e < c.small_error;
+    small_timer[l] = small ? small_timer[l] + DELAY_TIME : 0;
+    if (small) big_timer[l] = 0;  // big exit doesn't run while small exit is counting
+    if (small && small_timer[l] > c.small_exit_time) {
+      exit[l] = EXIT_SMALL;
+      continue;
+    }
+
+    if (c.big_error != 0.0 && c.big_exit_time != 0) {
+      big_timer[l] = e < c.big_error ? big_timer[l] + DELAY_TIME : 0;
+      if (big_timer[l] > c.big_exit_time) {
+        exit[l] = EXIT_BIG;
+        continue;
+      }
+    }
+
+    if (c.velocity_exit_time != 0) {
+      velocity_timer[l] = std::fabs(derivative[l]) <= VELOCITY_ZERO ? velocity_timer[l] + DELAY_TIME : 0;
+      if (velocity_timer[l] > c.velocity_exit_time) exit[l] = EXIT_VELOCITY;
+    }
+  }
+}
+
+/////
+// DriveBatch
+/////
+DriveBatch::DriveBatch(const drive_config& config, int lanes)
+    : lanes(lanes), forward(lanes), angular(lanes), heading(lanes), left_in(lanes), right_in(lanes), cfg(config), left_motor(lanes), right_motor(lanes), left_applied(lanes), right_applied(lanes), left_powered(lanes), right_powered(lanes), left_rpm(lanes), right_rpm(lanes), left_deg(lanes), right_deg(lanes) {
+  for (int l = 0; l < lanes; l++) {
+    for (motor_state* m : {&left_motor[l], &right_motor[l]}) {
+      m->installed = true;
+      m->gearset = cfg.gearset;
+      m->brake_mode = 2;
+    }
+  }
+}
+
+void DriveBatch::step(const double* left_mv, const double* right_mv, double dt) {
+  // The motors' own controllers, shared with the single robot model
+  for (int l = 0; l < lanes; l++) {
+    motor_state& lm = left_motor[l];
+    motor_state& rm = right_motor[l];
+    lm.command_mv = left_mv[l];
+    rm.command_mv = right_mv[l];
+    lm.velocity_rpm = left_rpm[l];
+    rm.velocity_rpm = right_rpm[l];
+    lm.position_deg = left_deg[l];
+    rm.position_deg = right_deg[l];
+    left_applied[l] = motor_controller_mv(lm, dt);
+    right_applied[l] = motor_controller_mv(rm, dt);
+    left_powered[l] = lm.coasting ? 0.0 : 1.0;
+    right_powered[l] = rm.coasting ? 0.0 : 1.0;
+  }
+
+  const double free_rpm = gearset_free_rpm(cfg.gearset);
+  const double stall = gearset_stall_torque(cfg.gearset);
+  const double ratio = cfg.wheel_rpm / free_rpm;
+  const double radius = cfg.wheel_diameter * INCH / 2.0;
+  const double rpm_per_mps = 60.0 / (2.0 * M_PI * radius) / ratio;
+  const double force_per_torque = 1.0 / ratio / radius;
+  const double left_count = (double)cfg.left_ports.size();
+  const double right_count = (double)cfg.right_ports.size();
+  const double half_track = cfg.track_width * INCH / 2.0;
+  const double weight = cfg.mass * GRAVITY;
+  const double rolling = cfg.rolling_friction * weight;
+  const double scrub = cfg.scrub * weight * half_track / 2.0;
+  const double in_per_deg = ratio * M_PI * cfg.wheel_diameter / 360.0;
+
+  double* __restrict vf = forward.data();
+  double* __restrict w = angular.data();
+  double* __restrict hd = heading.data();
+  double* __restrict lin = left_in.data();
+  double* __restrict rin = right_in.data();
+  double* __restrict lrpm = left_rpm.data();
+  double* __restrict rrpm = right_rpm.data();
+  double* __restrict ldeg = left_deg.data();
+  double* __restrict rdeg = right_deg.data();
+  const double* __restrict lmv = left_applied.data();
+  const double* __restrict rmv = right_applied.data();
+  const double* __restrict lp = left_powered.data();
+  const double* __restrict rp = right_powered.data();
+
+  for (int l = 0; l < lanes; l++) {
+    double lr = (vf[l] + w[l] * half_track) * rpm_per_mps;
+    double rr = (vf[l] - w[l] * half_track) * rpm_per_mps;
+    double lt = lp[l] * std::clamp(stall * (lmv[l] / 12000.0 - lr / free_rpm), -stall, stall) - GEARBOX_FRICTION * stall * friction_sign(lr, STOPPED_RPM);
+    double rt = rp[l] * std::clamp(stall * (rmv[l] / 12000.0 - rr / free_rpm), -stall, stall) - GEARBOX_FRICTION * stall * friction_sign(rr, STOPPED_RPM);
+    double lf = left_count * lt * force_per_torque;
+    double rf = right_count * rt * force_per_torque;
+
+    double a = (lf + rf - rolling * friction_sign(vf[l], STOPPED_SPEED)) / cfg.mass;
+    double alpha = ((lf - rf) * half_track - scrub * friction_sign(w[l], STOPPED_TURN)) / cfg.inertia;
+
+    ldeg[l] += lr * 6.0 * dt;
+    rdeg[l] += rr * 6.0 * dt;
+    lrpm[l] = lr;
+    rrpm[l] = rr;
+    vf[l] += a * dt;
+    w[l] += alpha * dt;
+    hd[l] += w[l] * dt * (180.0 / M_PI);
+    lin[l] = ldeg[l] * in_per_deg;
+    rin[l] = rdeg[l] * in_per_deg;
+  }
+}
+
+/////
+// Tuning
+/////
+namespace {
+
+// Runs one chunk of candidates, every target of every candidate is a lane
+void run_chunk(const tune_setup& s, const pid_gains* candidates, int count, tune_result* results) {
+  const int targets = (int)s.targets.size();
+  const int lanes = count * targets;
+  const bool drive = s.motion == MOTION_DRIVE;
+  const double max_out = s.max_speed;
+
+  BatchPID main(lanes), second(drive ? lanes : 0), heading(drive ? lanes : 0);
+  DriveBatch plant(s.drive, lanes);
+  std::vector<double> target(lanes), zero(lanes, 0.0), left_cmd(lanes, 0.0), right_cmd(lanes, 0.0);
+  std::vector<double> overshoot(lanes, 0.0), settle(lanes, 0.0), final_error(lanes, 0.0);
+  std::vector<int> exit_type(lanes, EXIT_RUNNING), window_end(lanes, -1);
+
+  for (int c = 0; c < count; c++) {
+    for (int t = 0; t < targets; t++) {
+      int l = c * targets + t;
+      target[l] = s.targets[t];
+      main.gains_set(l, candidates[c]);
+      if (drive) {
+        second.gains_set(l, candidates[c]);
+        heading.gains_set(l, s.heading);
+      }
+    }
+  }
+
+  int open = lanes;
+  const int steps_per_tick = (int)std::lround(DELAY_TIME / 1000.0 / STEP_TIME);
+  for (int ms = 0; open > 0 && ms <= s.timeout_ms + s.settle_window_ms; ms += DELAY_TIME) {
+    // Controller tick, same order as EZ-Template's drive task
+    const std::vector<double>& progress = drive ? plant.left_in : plant.heading;
+    main.compute(target.data(), progress.data());
+    if (drive) {
+      second.compute(target.data(), plant.right_in.data());
+      heading.compute(zero.data(), plant.heading.data());
+    }
+    for (int l = 0; l < lanes; l++) {
+      double out = std::clamp(main.output[l], -max_out, max_out);
+      if (s.motion == MOTION_DRIVE) {
+        double right = std::clamp(second.output[l], -max_out, max_out);
+        left_cmd[l] = std::clamp(out + heading.output[l], -127.0, 127.0) * 12000.0 / 127.0;
+        right_cmd[l] = std::clamp(right - heading.output[l], -127.0, 127.0) * 12000.0 / 127.0;
+      } else if (s.motion == MOTION_TURN) {
+        left_cmd[l] = out * 12000.0 / 127.0;
+        right_cmd[l] = -out * 12000.0 / 127.0;
+      } else {
+        left_cmd[l] = out * 12000.0 / 127.0;
+        right_cmd[l] = 0.0;
+      }
+    }
+
+    // Exit conditions, a drive is done once both sides are
+    main.exit_update(s.exit);
+    if (drive) second.exit_update(s.exit);
+    for (int l = 0; l < lanes; l++) {
+      if (window_end[l] >= 0) continue;
+      int e = main.exit[l];
+      if (drive && e != EXIT_RUNNING) e = second.exit[l] == EXIT_RUNNING ? EXIT_RUNNING : std::max(e, second.exit[l]);
+      if (e == EXIT_RUNNING && ms >= s.timeout_ms) e = EXIT_TIMEOUT;
+      if (e == EXIT_RUNNING) continue;
+      exit_type[l] = e;
+      settle[l] = ms;
+      window_end[l] = ms + s.settle_window_ms;
+    }
+
+    for (int i = 0; i < steps_per_tick; i++) plant.step(left_cmd.data(), right_cmd.data(), STEP_TIME);
+
+    // Overshoot and final error, measured on the same sensor the PID uses
+    for (int l = 0; l < lanes; l++) {
+      if (window_end[l] >= 0 && ms >= window_end[l]) continue;
+      double now = drive ? (plant.left_in[l] + plant.right_in[l]) / 2.0 : plant.heading[l];
+      double past = sgn(target[l]) * (now - target[l]);
+      overshoot[l] = std::max(overshoot[l], past);
+      final_error[l] = std::fabs(target[l] - now);
+      if (window_end[l] >= 0 && ms + DELAY_TIME >= window_end[l]) open--;
+    }
+  }
+
+  for (int c = 0; c < count; c++) {
+    tune_result& r = results[c];
+    r = tune_result();
+    r.gains = candidates[c];
+    for (int t = 0; t < targets; t++) {
+      int l = c * targets + t;
+      r.settle_ms += settle[l] / targets;
+      r.overshoot = std::max(r.overshoot, overshoot[l]);
+      r.final_error = std::max(r.final_error, final_error[l]);
+      r.exits[exit_type[l]]++;
+      r.score += (settle[l] + EXIT_PENALTY_MS[exit_type[l]] + s.overshoot_weight * (overshoot[l] + final_error[l])) / targets;
+    }
+  }
+}
+
+}  // namespace
+
+std::vector<tune_result> tune(const tune_setup& setup, const std::vector<pid_gains>& candidates, int threads) {
+  std::vector<tune_result> results(candidates.size());
+  if (candidates.empty() || setup.targets.empty()) return results;
+  if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::atomic<std::size_t> next{0};
+  auto worker = [&] {
+    while (true) {
+      std::size_t start = next.fetch_add(CHUNK);
+      if (start >= candidates.size()) return;
+      int count = (int)std::min<std::size_t>(CHUNK, candidates.size() - start);
+      run_chunk(setup, &candidates[start], count, &results[start]);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int i = 1; i < threads; i++) pool.emplace_back(worker);
+  worker();
+  for (std::thread& t : pool) t.join();
+  return results;
+}
+
+}  // namespace sim
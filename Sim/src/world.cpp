@@ -0,0 +1,112 @@
+/*
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "sim/world.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+namespace {
+
+// Time constant of an unloaded motor reaching its target speed
+const double FREE_TAU = 0.05;
+
+// Gains of the motor's internal controllers, in mV per rpm and rpm per degree
+const double VELOCITY_KP = 3.0;
+const double POSITION_KP = 2.0;
+const double HOLD_KP = 400.0;
+const double HOLD_KD = 20.0;
+
+// A holding motor brakes until it is this slow, then holds where it came to rest
+const double HOLD_ENGAGE_RPM = 5.0;
+
+double clamp_mv(const motor_state& m, double mv) {
+  double limit = m.voltage_limit > 0 ? std::min(12000.0, (double)m.voltage_limit) : 12000.0;
+  return std::clamp(mv, -limit, limit);
+}
+
+}  // namespace
+
+World& world() {
+  static World w;
+  return w;
+}
+
+double motor_controller_mv(motor_state& m, double dt) {
+  (void)dt;
+  double free_rpm = gearset_free_rpm(m.gearset);
+  double mv = 0.0;
+  m.coasting = false;
+
+  switch (m.mode) {
+    case VOLTAGE:
+      if (m.command_mv != 0.0) {
+        mv = m.command_mv;
+        m.hold_deg = m.position_deg;
+      } else if (m.brake_mode == 2 && std::fabs(m.velocity_rpm) > HOLD_ENGAGE_RPM) {
+        m.hold_deg = m.position_deg;
+      } else if (m.brake_mode == 2) {
+        mv = HOLD_KP * (m.hold_deg - m.position_deg) - HOLD_KD * m.velocity_rpm;
+      } else if (m.brake_mode == 1) {
+        mv = 0.0;  // shorted windings, back emf does the braking
+      } else {
+        m.coasting = true;
+      }
+      break;
+
+    case POSITION: {
+      double max_rpm = std::fabs(m.target_rpm);
+      double wanted = std::clamp(POSITION_KP * (m.target_deg - m.position_deg), -max_rpm, max_rpm);
+      mv = 12000.0 * wanted / free_rpm + VELOCITY_KP * 12000.0 / free_rpm * (wanted - m.velocity_rpm);
+      break;
+    }
+
+    case VELOCITY:
+      if (m.target_rpm == 0.0 && m.brake_mode == 0) {
+        m.coasting = true;
+        break;
+      }
+      mv = 12000.0 * m.target_rpm / free_rpm + VELOCITY_KP * 12000.0 / free_rpm * (m.target_rpm - m.velocity_rpm);
+      if (m.target_rpm == 0.0 && m.brake_mode == 2)
+        mv += HOLD_KP * (m.hold_deg - m.position_deg);
+      else
+        m.hold_deg = m.position_deg;
+      break;
+  }
+
+  m.applied_mv = m.coasting ? 0.0 : clamp_mv(m, mv);
+  return m.applied_mv;
+}
+
+void World::step(double dt) {
+  for (motor_state& m : motors) {
+    if (!m.installed) continue;
+    // the motor acts on the command from command_latency_ms ago
+    const double latest = m.command_mv;
+    const int latency = std::min(MAX_COMMAND_LATENCY - 1, (int)std::lround(command_latency_ms / (dt * 1000.0)));
+    m.command_history[m.command_head] = latest;
+    m.command_mv = m.command_history[(m.command_head + MAX_COMMAND_LATENCY - latency) % MAX_COMMAND_LATENCY];
+    m.command_head = (m.command_head + 1) % MAX_COMMAND_LATENCY;
+    double mv = motor_controller_mv(m, dt);
+    m.command_mv = latest;
+    if (m.plant_driven) continue;
+
+    // Unloaded motor: speed follows the applied voltage with a first order lag
+    double free_rpm = gearset_free_rpm(m.gearset);
+    double target = m.coasting ? 0.0 : free_rpm * mv / 12000.0;
+    double tau = m.coasting ? FREE_TAU * 4.0 : FREE_TAU;
+    m.velocity_rpm += (target - m.velocity_rpm) * std::min(1.0, dt / tau);
+    m.position_deg += m.velocity_rpm * 6.0 * dt;
+
+    double stall_fraction = m.coasting ? 0.0 : std::fabs(mv / 12000.0 - m.velocity_rpm / free_rpm);
+    m.current_ma = std::min((double)m.current_limit, 2500.0 * stall_fraction);
+  }
+}
+
+void World::reset() { *this = World(); }
+
+}  // namespace sim